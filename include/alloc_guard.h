@@ -0,0 +1,25 @@
+/**
+ * @file alloc_guard.h
+ * @brief Heap-Zuteilungen nach setup() zählen (Build-Modus CLOCK_STATIC_ALLOC)
+ *
+ * Im Modus CLOCK_STATIC_ALLOC werden alle Zuteilungen nach allocGuardArm()
+ * gezählt, mit CLOCK_STATIC_ALLOC_ASSERT führt die erste zum Abbruch.
+ * Arduino-Core 2.x: über die Linker-Option --wrap (Umgebung
+ * wemos_d1_mini32_static). ESP-IDF >= 5.1: über den Heap-Hook
+ * (CONFIG_HEAP_USE_HOOKS=y im sdkconfig).
+ *
+ * Ohne den Modus zählt nichts, allocGuardReport() meldet dann nur den Heap.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ab jetzt gilt jede Zuteilung als Verstoß
+void allocGuardArm();
+
+uint32_t allocGuardCount();
+uint32_t allocGuardBytes();
+
+// Heap-Zustand nach dem Sync melden und als TELE_HEAP protokollieren
+void allocGuardReport();
@@ -0,0 +1,54 @@
+/**
+ * @file clock_config.h
+ * @brief Zeitplan im NVS, im Sync-Fenster bedingt vom Konfigurationsserver abrufen
+ *
+ * Der Zeitplan (clockSchedule in clock_core.h: Beginn und Ende der Nacht,
+ * Sync-Zeit) liegt zusammen mit dem ETag seiner Quelle als ein NVS-Blob, dazu
+ * eine Kopie im RTC-Speicher. Nach dem NTP-Sync fragt clockConfigFetch() mit
+ * If-None-Match beim Server an:
+ * - 304: unverändert, eine kurze Anfrage
+ * - 200: Dokument prüfen, Zeitplan und ETag in einem Schritt speichern; gültig ab
+ *   dem nächsten clockConfigTick() vor clockPlan()
+ * Ein ungültiges Dokument wird verworfen, der bisherige Zeitplan bleibt.
+ *
+ * Dokument (text/plain), je Zeile "schlüssel=wert", "#" leitet einen Kommentar
+ * ein; fehlende Schlüssel behalten ihren Wert:
+ *
+ *     sleep_start=22
+ *     sleep_end=6
+ *     sync_hour=4
+ *     sync_min=30
+ *
+ * Abgerufen wird nur mit -DCLOCK_CONFIG_HOST=\"192.168.1.10\" (IPv4-Adresse wie
+ * beim Telemetrie-Upload); ein gespeicherter Zeitplan gilt auch ohne.
+ * Je Abruf ein TELE_CONFIG-Eintrag. Konsole: "config". Zum Testen:
+ * scripts/config_standin.py.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef CLOCK_CONFIG_PORT
+#define CLOCK_CONFIG_PORT      80
+#endif
+#ifndef CLOCK_CONFIG_PATH
+#define CLOCK_CONFIG_PATH      "/clock.cfg"
+#endif
+#ifndef CLOCK_CONFIG_BUDGET_MS
+#define CLOCK_CONFIG_BUDGET_MS 300      // zusätzliche Radio-an-Zeit höchstens
+#endif
+#define CLOCK_CONFIG_MAX_BYTES 512      // Antwort samt Kopf
+#define CLOCK_CONFIG_ETAG_MAX  64
+
+// Zeitplan aus RTC-Speicher oder NVS nach clockSchedule übernehmen
+void clockConfigInit();
+
+// bedingter Abruf; true, wenn ein neuer Zeitplan gespeichert wurde.
+// Nur mit verbundenem WLAN aufrufen.
+bool clockConfigFetch();
+
+// aus der Hauptschleife vor clockPlan(): abgerufenen Zeitplan übernehmen
+void clockConfigTick();
+
+// Zeitplan, Quelle und ETag auf der Konsole
+void clockConfigPrint();
@@ -0,0 +1,152 @@
+/**
+ * @file clock_core.h
+ * @brief Gemeinsamer Uhr-Kern: Zeitplan (Sync, Tag/Nacht) und Zeichnen über u8g2
+ *
+ * Wird vom Arduino-Build (ESP32-ssh1106.cpp) und vom ESP-IDF-Build (main_idf.cpp)
+ * gleichermaßen benutzt. Enthält keine Arduino- oder WiFi-Abhängigkeiten,
+ * gezeichnet wird über die C-API von u8g2 (u8g2_t).
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <clib/u8g2.h>
+
+// Mit -DCLOCK_IRAM_RENDER (env wemos_d1_mini32_iram) liegt der Renderpfad im IRAM
+// und seine Konstanten im DRAM: nach dem Sync läuft die CPU mit 40 MHz, dort kostet
+// jeder Fehlgriff im Flash-Cache am meisten. U8g2 und die Schriften verschiebt
+// scripts/iram_render.py.
+#ifdef CLOCK_IRAM_RENDER
+#include "esp_attr.h"
+#define CLOCK_HOT      IRAM_ATTR
+#define CLOCK_HOT_DATA DRAM_ATTR
+#else
+#define CLOCK_HOT
+#define CLOCK_HOT_DATA
+#endif
+
+// Berlin/Europa mit DST
+#define TIMEZONE "CET-1CEST,M3.5.0/02,M10.5.0/3"
+#ifndef NTP_SERVER
+#define NTP_SERVER "de.pool.ntp.org"  // für Versuche per -DNTP_SERVER=\"...\" überschreibbar
+#endif
+
+#define Sync_Stunde 4         // rechtzeitig vor 6 Uhr synchronisieren: Zeitumstellung muss so nicht beachtet werden
+#define Sync_Min    30
+const int sleepTime_Start = 22;  // 22:00 Uhr
+const int sleepTime_End  =  6;   // 06:00 Uhr
+
+#define SYNC_RETRY_MIN   5    // nach fehlgeschlagenem Sync erneut versuchen
+#define SYNC_MAX_RETRIES 2
+
+// Display steht auf dem Kopf: um 180° drehen. Standard ist die Drehung im SH1106
+// (Segment-Remap 0xA0, COM-Scan 0xC0 über u8g2_SetFlipMode), gezeichnet wird in R0.
+// Mit -DCLOCK_SW_ROTATION dreht wie früher u8g2 jedes Pixel (U8G2_R2).
+#ifdef CLOCK_SW_ROTATION
+#define OLED_ROTATION U8G2_R2
+#define OLED_FLIP     0
+#else
+#define OLED_ROTATION U8G2_R0
+#define OLED_FLIP     1
+#endif
+
+// Zifferblatt "HH:MM" (logisoso42, Grundlinie 52) liegt in den Zeilen 10..51 = Seiten 1..6;
+// die übrigen Zifferblätter werden in diesem Band zentriert
+#define CLOCK_FACE_PAGE0 1
+#define CLOCK_FACE_PAGES 6
+
+#define CONTRAST_STATUS 64
+#define CONTRAST_TIME   30
+
+// Tagesbudget leuchtender Pixel in Pixelminuten (Summe über alle Tagesminuten);
+// 0 = kein Budget, immer das volle Zifferblatt. Der Strom des OLED wächst etwa
+// mit der Zahl leuchtender Pixel.
+#ifndef CLOCK_EMISSION_BUDGET
+#define CLOCK_EMISSION_BUDGET 0
+#endif
+
+// Zifferblätter, geordnet nach abnehmender Leuchtfläche
+enum ClockFace : uint8_t {
+  FACE_BOLD = 0,      // logisoso42, wie bisher
+  FACE_THIN,          // fur42: dünnere Striche
+  FACE_OUTLINE,       // logisoso42 nur als Umriss
+  FACE_SMALL,         // logisoso32, an den Randstunden zur Nacht
+  FACE_COUNT,
+};
+
+// --- Zeitplan ---
+
+// Aktionen, die clockPlan() für den aktuellen Durchlauf verlangt (Bitmaske)
+enum ClockAction : uint8_t {
+  CLOCK_NONE  = 0,
+  CLOCK_SYNC  = 1 << 0,   // NTP-Sync ausführen
+  CLOCK_DRAW  = 1 << 1,   // Uhrzeit neu zeichnen
+  CLOCK_BLANK = 1 << 2,   // Display aus (Schlafenszeit)
+  CLOCK_DAY   = 1 << 3,   // Tageszeit, Display soll an sein
+};
+
+// Zeitplan zur Laufzeit: Vorgaben aus den Konstanten oben, über clock_config.h
+// (NVS, Abruf beim Sync) änderbar. Die Nacht reicht über Mitternacht (sleepStart > sleepEnd).
+struct ClockSchedule {
+  uint8_t sleepStart = sleepTime_Start;
+  uint8_t sleepEnd   = sleepTime_End;
+  uint8_t syncHour   = Sync_Stunde;
+  uint8_t syncMin    = Sync_Min;
+};
+
+extern ClockSchedule clockSchedule;
+
+struct ClockState {
+  int     lastDisplayedMinute = -1;
+  bool    syncDoneThisMinute  = false;
+  time_t  retryAt = 0;          // nächster Wiederholungsversuch, 0 = keiner
+  uint8_t retries = 0;
+  uint32_t litToday = 0;        // Pixelminuten seit Tagesbeginn
+  int16_t  litDay = -1;         // tm_yday, zu dem litToday gehört
+};
+
+// Entscheidet anhand der lokalen Zeit, was in diesem Durchlauf zu tun ist.
+// Der Zustand wird dabei so fortgeschrieben, als wären alle Aktionen ausgeführt.
+uint8_t clockPlan(ClockState& st, const struct tm& nowLocal, time_t now);
+
+// Ergebnis eines Syncs melden; bei Fehler wird eine Wiederholung eingeplant
+void clockSyncDone(ClockState& st, bool ok, time_t now);
+
+// true zwischen clockSchedule.sleepStart und sleepEnd
+bool clockIsNight(const struct tm& nowLocal);
+
+// Sekunden bis zur nächsten Minute, in der clockPlan() mehr tut als neu zu zeichnen
+// (Tag/Nacht-Wechsel, Sync-Minute, Wiederholung); für Tiefschlaf mit dunklem Display
+uint32_t clockSecondsToNextEvent(const ClockState& st, const struct tm& nowLocal, time_t now);
+
+// Millisekunden bis zum nächsten Minutenwechsel
+uint32_t clockMsToNextMinute(time_t now, uint32_t subsecMs);
+
+// so lange nach dem Minutenwechsel aufwachen; ein zu frühes Aufwachen kostet nur
+// einen weiteren, sehr kurzen Schlaf
+#define CLOCK_WAKE_MARGIN_MS 2
+
+// --- Zeichnen ---
+void renderStatus(u8g2_t* u8g2, const char* msg);
+// wählt das Zifferblatt nach CLOCK_EMISSION_BUDGET und zählt die Pixelminuten in st
+void renderTime(u8g2_t* u8g2, ClockState& st, const struct tm* timeinfo);
+// Uhrzeit im zuletzt gewählten Zifferblatt nur in den Puffer zeichnen, ohne zu senden
+void composeTime(u8g2_t* u8g2, const struct tm* timeinfo);
+void composeFace(u8g2_t* u8g2, const struct tm* timeinfo, ClockFace face);
+void renderBlank(u8g2_t* u8g2);
+
+// Bild der nächsten Minute schon jetzt zeichnen (eigener Puffer) und die
+// geänderten Seiten merken; renderTime() muss am Minutenwechsel dann nur noch
+// diese Seiten senden. Ohne Wirkung, wenn schon vorbereitet.
+void clockPrepareNext(u8g2_t* u8g2, const ClockState& st, const struct tm& shown);
+// Konsole: Millisekunden vom Minutenwechsel bis zum gesendeten Bild
+void clockFramePrint();
+
+// --- Leuchtende Pixel ---
+uint16_t clockLitPixels(u8g2_t* u8g2);
+ClockFace clockFace();
+const char* clockFaceName(uint8_t face);
+// Konsole: Zifferblatt, Pixel der letzten Minute, Tagessumme und Budget
+void clockFacePrint();
+// Display und Uhrzeit des zuletzt gezeichneten Bildes; nullptr vor dem ersten Bild
+u8g2_t* clockShownFrame(struct tm* shown);
@@ -0,0 +1,47 @@
+/**
+ * @file clock_drift.h
+ * @brief Gang der Uhr zwischen zwei Syncs schätzen und laufend ausgleichen, mit Temperaturterm
+ *
+ * Bei jedem Sync wird die Abweichung der lokalen Uhr gegen NTP festgehalten
+ * (vor dem Setzen der Zeit, siehe sntp_sync_time in clock_events.cpp). Zusammen
+ * mit den seit dem letzten Sync schon angebrachten Korrekturen ergibt das den
+ * Gang in ppm, zusammen mit der mittleren Temperatur im Intervall eine Stichprobe.
+ * Aus den letzten DRIFT_SAMPLES Stichproben entsteht das Modell
+ *
+ *     ppm(T) = a + b · (T − T0)
+ *
+ * (b = 0, solange die Temperaturen zu nahe beieinander liegen oder kein Sensor da
+ * ist). driftTick() misst höchstens alle DRIFT_TICK_S die Temperatur und bremst
+ * bzw. beschleunigt die Systemzeit mit adjtime() um ppm(T) · Δt; der Rest unter
+ * einer µs wird in die nächste Korrektur übernommen.
+ *
+ * Die Temperatur liefert das Framework (driftInit): Arduino den Chip-Sensor oder
+ * mit -DCLOCK_TEMP_LM75 einen LM75 am Display-Bus, ESP-IDF nur den LM75.
+ * Konsole: "drift". Auf dem Rechner: scripts/drift_sim.py.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define DRIFT_SAMPLES         8
+#define DRIFT_MIN_INTERVAL_S  3600     // kürzere Abstände (Wiederholungen) nicht auswerten
+#define DRIFT_MAX_PPM         500.0f   // Ausreißer (Zeitsprung, erste Zeit nach dem Einschalten)
+#define DRIFT_MIN_TEMP_SPAN   0.3f     // °C Standardabweichung der Intervallmittel, ab der b geschätzt wird
+#define DRIFT_TICK_S          60       // Abstand der Korrekturen, häufigere Aufrufe kehren sofort zurück
+#define TEMP_LM75_ADDR        0x48
+
+// °C, NAN = kein Messwert
+typedef float (*DriftTempRead)();
+
+void driftInit(DriftTempRead read);
+
+// aus der Hauptschleife, wirksam alle DRIFT_TICK_S: Temperatur mitteln, Korrektur anbringen
+void driftTick(time_t now);
+
+// aus dem SNTP-Task, bevor die neue Zeit gesetzt wird
+void driftSynced(const struct timeval& local, const struct timeval& ntp);
+
+// Konsole: Modell, Stichproben, Korrektur seit dem letzten Sync
+void driftPrint();
@@ -0,0 +1,35 @@
+/**
+ * @file clock_events.h
+ * @brief Ereignisse vom Netzwerk-Task zur Anzeige
+ *
+ * Je Erzeuger ein eigener EventRing (ein Erzeuger, ein Verbraucher). Verbraucher
+ * ist immer die Hauptschleife (loop() bzw. app_main), die clockEventsDrain()
+ * vor clockPlan() aufruft. Ein weiterer Erzeuger (z. B. eine GPIO-ISR) bekommt
+ * einen eigenen Ring und einen eigenen Ereignistyp.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "clock_core.h"
+#include "event_ring.h"
+
+enum ClockEventType : uint8_t {
+  EVT_NONE = 0,
+  EVT_TIME_SYNCED,    // SNTP hat die Systemzeit gesetzt (lwIP/tcpip-Task)
+};
+
+struct ClockEvent {
+  uint8_t  type;      // ClockEventType
+  uint8_t  arg;
+  uint16_t data;
+  uint32_t time;      // Unix-Zeit beim Erzeugen
+};
+
+// Erzeuger: SNTP-Callback im Netzwerk-Task
+extern EventRing<ClockEvent, 16> netEvents;
+
+// SNTP-Benachrichtigung auf netEvents umleiten
+void clockEventsInit();
+
+// alle anstehenden Ereignisse abarbeiten; Verbraucherseite
+void clockEventsDrain(ClockState& st);
@@ -0,0 +1,92 @@
+/**
+ * @file clock_log.h
+ * @brief Binärprotokoll: Meldungsnummer und Zahlen in einen Ring, Ausgabe später
+ *
+ * Ein Serial.println("NTP-Sync starten…") formatiert Text und hält die CPU wach,
+ * bis er mit 115200 Baud draußen ist. CLOG(MSG_SYNC_START) schreibt stattdessen
+ * nur die Nummer der Meldung (log_messages.h), die Zeit seit dem Boot und die
+ * Argumente als Varints in einen Ringpuffer, typisch 4..10 Byte. Ausgegeben wird
+ * der Ring
+ * - nebenbei: clockLogTick() aus der Hauptschleife, wenn er zu drei Vierteln voll
+ *   ist oder die älteste Meldung CLOCK_LOG_FLUSH_MS alt ist,
+ * - auf Anfrage: Konsolenbefehl "flush", vor Tiefschlaf und Neustart.
+ *
+ * Rahmen auf der seriellen Schnittstelle: 0x1F, Länge, Nutzdaten, Summe der
+ * Nutzbytes (8 Bit). Nutzdaten: Millisekunden seit Boot, Meldungsnummer, je
+ * Argument ein ZigZag-Varint. Text der Konsolenbefehle läuft unverändert
+ * dazwischen; scripts/log_decode.py trennt beides und setzt die Meldungen mit der
+ * beim Build erzeugten Tabelle (scripts/log_table.py) wieder zusammen.
+ *
+ * CLOCK_LOG_LEVEL (Standard CLOG_INFO) filtert zur Übersetzungszeit: Aufrufe
+ * mit höherer Stufe bleiben als konstant falsche Bedingung stehen und fallen
+ * samt Argumenten aus dem Code. Alle Meldungen der Firmware laufen über das
+ * Protokoll, Gründe als Zahl (z. B. DeltaReject); Text bleiben nur die
+ * Ausgaben von Konsolenbefehlen und die Meldung aus dem Allokator
+ * (alloc_guard.cpp, dort kein Spinlock).
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "log_messages.h"
+
+#define CLOG_ERROR 1
+#define CLOG_WARN  2
+#define CLOG_INFO  3
+#define CLOG_DEBUG 4
+
+#ifndef CLOCK_LOG_LEVEL
+#define CLOCK_LOG_LEVEL    CLOG_INFO
+#endif
+#ifndef CLOCK_LOG_BYTES
+#define CLOCK_LOG_BYTES    2048      // Ringpuffer, Zweierpotenz
+#endif
+#ifndef CLOCK_LOG_FLUSH_MS
+#define CLOCK_LOG_FLUSH_MS 3600000   // spätestens stündlich ausgeben; 0 = bei jedem clockLogTick()
+#endif
+#define CLOCK_LOG_MAX_ARGS 6
+#ifndef CLOCK_LOG_TABLE
+#define CLOCK_LOG_TABLE    0         // Prüfsumme der Tabelle, setzt scripts/log_table.py
+#endif
+
+#define CLOCK_LOG_ID(name, level, text) name,
+enum ClockLogId : uint16_t { CLOCK_LOG_MESSAGES(CLOCK_LOG_ID) CLOCK_LOG_COUNT };
+#undef CLOCK_LOG_ID
+
+#define CLOCK_LOG_LEVEL_OF(name, level, text) name##_LEVEL = level,
+enum : uint8_t { CLOCK_LOG_MESSAGES(CLOCK_LOG_LEVEL_OF) };
+#undef CLOCK_LOG_LEVEL_OF
+
+// schreibt einen Teil des Rings auf die serielle Schnittstelle (Serial.write, uart_write_bytes)
+typedef void (*ClockLogWriter)(const uint8_t* data, size_t len);
+
+// Ausgabe einrichten und MSG_LOG_START mit der Tabellenprüfsumme eintragen;
+// Meldungen davor bleiben im Ring
+void clockLogInit(ClockLogWriter write);
+
+void clockLogWrite(uint16_t id, const int32_t* args, uint8_t count);
+
+template <typename... Args>
+inline void clockLog(uint16_t id, Args... args) {
+  static_assert(sizeof...(Args) <= CLOCK_LOG_MAX_ARGS, "zu viele Argumente für eine Meldung");
+  const int32_t v[sizeof...(Args) + 1] = {(int32_t)args...};
+  clockLogWrite(id, v, sizeof...(Args));
+}
+
+// CLOG(MSG_RADIO_ON, ms): Stufe aus der Tabelle, abgeschaltete Stufen entfallen ganz
+#define CLOG(name, ...)                                                   \
+  do {                                                                    \
+    if (name##_LEVEL <= CLOCK_LOG_LEVEL) clockLog(name, ##__VA_ARGS__);   \
+  } while (0)
+
+// Meldung aus einer Gruppe aufeinanderfolgender Einträge (name + Index), Stufe von name
+#define CLOG_NTH(name, index, ...)                                                        \
+  do {                                                                                    \
+    if (name##_LEVEL <= CLOCK_LOG_LEVEL) clockLog(name + (index), ##__VA_ARGS__);         \
+  } while (0)
+
+// aus der Hauptschleife, wenn die CPU ohnehin wach ist
+void clockLogTick();
+
+// alles sofort ausgeben (Konsole "flush", vor Tiefschlaf und Neustart)
+void clockLogFlush();
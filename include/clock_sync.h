@@ -0,0 +1,41 @@
+/**
+ * @file clock_sync.h
+ * @brief Ablauf eines NTP-Syncs, gemeinsam für den Arduino- und den ESP-IDF-Build
+ *
+ * clockSyncRun(): Takt hoch, Radio-Budget starten, WLAN an, mit wifiConnect()
+ * verbinden, SNTP über ntp_dns starten und auf die Zeit warten (nach
+ * NTP_DNS_FALLBACK_MS mit frisch aufgelösten Adressen), dann die Arbeiten bei
+ * laufendem WLAN, zuletzt WLAN aus und Radio-an-Zeit protokollieren (TELE_SYNC).
+ *
+ * Fertig ist die Zeit, wenn SNTP den Sync-Status setzt (sntp_sync_time in
+ * clock_events.cpp), nicht schon bei einer plausiblen Jahreszahl: beim täglichen
+ * Sync läuft die Uhr ja bereits.
+ *
+ * Was vom Framework abhängt (WLAN-Treiber, Takt, Display), liefert SyncOps;
+ * derselbe Ablauf läuft so auch in den Host-Tests (test/host).
+ */
+#pragma once
+
+#include <stdint.h>
+#include "wifi_creds.h"
+
+#define CLOCK_SYNC_NTP_MS  30000   // so lange auf die Antwort von SNTP warten
+#define CLOCK_SYNC_POLL_MS   100   // Abfrage des Sync-Status
+
+enum SyncResult : uint8_t {
+  SYNC_FAILED = 0,
+  SYNC_OK,
+  SYNC_OK_RESTART,        // neues Image als Boot-Partition gesetzt: nach der Meldung neu starten
+};
+
+struct SyncOps {
+  const WifiConnectOps* wifi;
+  void (*status)(const char* msg);   // Statusmeldung aufs Display
+  void (*cpu)(bool full);            // true: volle Leistung, kein Light-Sleep; false: wieder sparen
+  void (*radioOn)();                 // WLAN im STA-Modus starten
+  void (*radioOff)(bool ok);         // WLAN trennen und abschalten
+  bool (*online)();                  // mit Zeit und WLAN: Zeitplan, Delta-Update, Telemetrie; true = Neustart
+};
+
+// ein Sync; liefert SyncResult, das WLAN ist danach aus
+uint8_t clockSyncRun(const SyncOps& ops);
@@ -0,0 +1,15 @@
+/**
+ * @file console.h
+ * @brief Einfache Befehlszeile auf der seriellen Konsole
+ *
+ * Zeichen werden vom jeweiligen Framework (Serial bzw. UART-Treiber) mit
+ * consoleFeed() übergeben; ein Zeilenende führt den Befehl aus.
+ *
+ * Befehle: help, stats, log, heap, panel, pixel, frame, bench, drift, config, ota, flush
+ */
+#pragma once
+
+// UART0 als Wakeup-Quelle für den Light-Sleep einrichten
+void consoleInit();
+
+void consoleFeed(char c);
@@ -0,0 +1,81 @@
+/**
+ * @file delta_ota.h
+ * @brief Firmware-Update als Delta zum laufenden Image, blockweise im Sync-Fenster
+ *
+ * Ein volles OTA-Image ist fast 1 MB groß; bei schwachem WLAN hieße das lange
+ * Radio-an-Zeit. Stattdessen liegt auf einem Server im LAN ein Delta (erzeugt mit
+ * scripts/delta_ota.py make alt.bin neu.bin), meist wenige KB. deltaOtaStep()
+ * lädt davon im täglichen Sync-Fenster, was das Zeitbudget erlaubt, und setzt am
+ * nächsten Tag mit dem nächsten Block fort:
+ *
+ * - Kopf per Range-Anfrage mit If-None-Match: 304, solange sich das Delta nicht
+ *   ändert. Ein neues Delta gilt nur, wenn sein Quell-Hash zum laufenden Image
+ *   passt (esp_partition_get_sha256).
+ * - Je Block (Standard 32 KB des neuen Images) eine Range-Anfrage mit If-Match;
+ *   der Block wird beim Empfang entpackt (miniz-Inflater aus dem ROM), mit dem
+ *   laufenden Image verrechnet und sektorweise in die freie OTA-Partition
+ *   geschrieben. RAM: etwa 48 KB nur während des Schritts.
+ * - Nach jedem Block mit stimmender CRC-32 wird der Fortschritt im NVS gesichert;
+ *   ein abgebrochener Block wird beim nächsten Sync wiederholt.
+ * - Nach dem letzten Block: SHA-256 der Zielpartition prüfen, als Boot-Partition
+ *   setzen; der Aufrufer startet nach dem Sync neu.
+ *
+ * Braucht eine Partitionstabelle mit zwei OTA-Partitionen (Arduino: default.csv).
+ * Nur mit -DDELTA_OTA_HOST=\"192.168.1.10\" (IPv4-Adresse wie beim
+ * Telemetrie-Upload). Je Schritt ein TELE_OTA-Eintrag. Konsole: "ota".
+ * Zum Testen: scripts/delta_ota.py serve --rate (gedrosselte Verbindung).
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef DELTA_OTA_PORT
+#define DELTA_OTA_PORT       80
+#endif
+#ifndef DELTA_OTA_PATH
+#define DELTA_OTA_PATH       "/delta.bin"
+#endif
+#ifndef DELTA_OTA_BUDGET_MS
+#define DELTA_OTA_BUDGET_MS  10000   // zusätzliche Radio-an-Zeit je Sync höchstens
+#endif
+#define DELTA_OTA_RESERVE_MS 1000    // vom Radio-Budget übrig lassen (Telemetrie, Abschalten)
+#define DELTA_OTA_MAX_BLOCKS 64      // 2 MB bei 32-KB-Blöcken
+#define DELTA_OTA_RETRIES    2       // abgerissene Verbindungen je Sync, bevor bis morgen gewartet wird
+#define DELTA_OTA_MAX_FAILS  3       // Block mit falscher CRC so oft, dann Update verwerfen
+#define DELTA_OTA_ETAG_MAX   48
+
+// Grund für ein verworfenes Update, als Zahl in MSG_OTA_REJECTED und
+// MSG_OTA_BLOCK_BAD (log_messages.h); neue Gründe hinten anfügen
+enum DeltaReject : uint8_t {
+  REJECT_NONE = 0,
+  REJECT_HEAD_SHORT,         // 1: Kopf unvollständig
+  REJECT_NOT_DELTA,          // 2: kein Delta (Magic)
+  REJECT_HEAD_BAD,           // 3: Kopf ungültig
+  REJECT_TABLE_SHORT,        // 4: Blocktabelle unvollständig
+  REJECT_RUNNING_SHA,        // 5: SHA-256 des laufenden Images unbekannt
+  REJECT_OTHER_SOURCE,       // 6: passt nicht zum laufenden Image
+  REJECT_NO_PARTITION,       // 7: keine OTA-Partition
+  REJECT_TOO_LARGE,          // 8: Image zu groß
+  REJECT_SOURCE_CHANGED,     // 9: laufendes Image oder Zielpartition geändert
+  REJECT_SERVER_CHANGED,     // 10: Delta auf dem Server geändert
+  REJECT_SOURCE_RANGE,       // 11: Quellposition außerhalb des Images
+  REJECT_SOURCE_READ,        // 12: Quelle nicht lesbar
+  REJECT_TARGET_WRITE,       // 13: Zielpartition nicht beschreibbar
+  REJECT_BLOCK_LONG,         // 14: Block zu lang
+  REJECT_COMMAND,            // 15: Befehl ungültig
+  REJECT_INFLATE,            // 16: Delta nicht entpackbar
+  REJECT_TRAILING,           // 17: Daten hinter dem Block
+  REJECT_BLOCK_INCOMPLETE,   // 18: Block unvollständig
+  REJECT_BLOCK_SHORT,        // 19: Block zu kurz
+  REJECT_CRC,                // 20: CRC falsch
+  REJECT_NEW_SHA,            // 21: SHA-256 des neuen Images falsch
+  REJECT_BOOT_PARTITION,     // 22: Boot-Partition nicht gesetzt
+};
+
+// Delta-Kopf prüfen und weitere Blöcke laden, wenn ein Server eingestellt ist;
+// true, wenn das neue Image vollständig und als Boot-Partition gesetzt ist (dann
+// nach dem Sync neu starten). Nur mit verbundenem WLAN aufrufen.
+bool deltaOtaStep();
+
+// Stand des Updates auf der Konsole
+void deltaOtaPrint();
@@ -0,0 +1,74 @@
+/**
+ * @file event_ring.h
+ * @brief Lock-freier Ringpuffer für genau einen Erzeuger und einen Verbraucher
+ *
+ * Feste Kapazität, kein Heap. push() darf aus einer ISR oder einem anderen Task
+ * aufgerufen werden als pop(); ohne Mutex, nur mit Acquire/Release auf den Indizes.
+ * Kopf und Ende liegen in getrennten Cache-Zeilen (auf dem Host relevant, auf dem
+ * ESP32 ohne Datencache reicht Wortausrichtung).
+ *
+ * N muss eine Zweierpotenz sein; nutzbar sind alle N Plätze.
+ */
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#define EVENT_RING_ALIGN 4
+#else
+#define EVENT_RING_ALIGN 64
+#endif
+
+template <typename T, uint32_t N>
+class EventRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "EventRing: N muss eine Zweierpotenz sein");
+
+ public:
+  // Erzeuger: false, wenn voll (Ereignis verworfen, wird in dropped() gezählt)
+  bool push(const T& item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tailCache_ >= N) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (head - tailCache_ >= N) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    buf_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Verbraucher: false, wenn leer
+  bool pop(T& item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == headCache_) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail == headCache_) return false;
+    }
+    item = buf_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Näherungswert, nur zur Anzeige
+  uint32_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  static constexpr uint32_t capacity() { return N; }
+
+ private:
+  // Erzeugerseite
+  alignas(EVENT_RING_ALIGN) std::atomic<uint32_t> head_{0};
+  uint32_t tailCache_ = 0;
+  std::atomic<uint32_t> dropped_{0};
+  // Verbraucherseite
+  alignas(EVENT_RING_ALIGN) std::atomic<uint32_t> tail_{0};
+  uint32_t headCache_ = 0;
+  alignas(EVENT_RING_ALIGN) T buf_[N];
+};
@@ -0,0 +1,32 @@
+/**
+ * @file heap_monitor.h
+ * @brief Stündliche Heap- und Stack-Stichproben im RTC-Speicher
+ *
+ * Je Stunde: freier Heap, größter freier Block, Minimum seit Boot und die
+ * Stack-Reserve (High-Water-Mark) der bekannten Tasks. Aus den Stichproben wird
+ * ein Trend des größten Blocks berechnet, um Fragmentierung durch den täglichen
+ * WLAN-Zyklus zu erkennen. Konsole: "heap".
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#define HEAP_MON_SAMPLES 72    // drei Tage stündlich
+#define HEAP_MON_TASKS    6
+
+struct HeapSample {
+  uint32_t hour;                          // Unix-Zeit / 3600, 0 = leer
+  uint16_t freeHeap;                      // alle Heap-Werte in 16-Byte-Einheiten
+  uint16_t largest;
+  uint16_t minFree;
+  uint16_t stackFree[HEAP_MON_TASKS];     // Byte, 0xFFFF = Task nicht vorhanden
+};
+
+void heapMonitorInit();
+
+// bei Stundenwechsel eine Stichprobe nehmen
+void heapMonitorTick(time_t now);
+
+// Stichproben und Trend auf der Konsole ausgeben
+void heapMonitorPrint();
@@ -0,0 +1,41 @@
+/**
+ * @file lan_http.h
+ * @brief Eine HTTP/1.0-Anfrage an einen Server im LAN, mit fester Frist
+ *
+ * Für die Anfragen im Sync-Fenster (Telemetrie-Upload, Konfiguration, Delta-Update):
+ * Adresse als IPv4-Literal, kein DNS, kein TLS, ein Socket ohne Blockieren. Jedes
+ * Warten (Verbinden, Senden, Antwort) endet spätestens zur Frist, damit die
+ * Radio-an-Zeit begrenzt bleibt.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// bis s lesbar bzw. schreibbar ist oder die Frist (esp_timer, µs) abläuft
+bool lanWait(int s, bool write, int64_t deadlineUs);
+
+// Kopf (mit Leerzeile) und Rumpf senden, Antwort bis zum Schließen der Verbindung,
+// bis resp voll ist oder bis zur Frist lesen. Länge der Antwort, -1 ohne Verbindung
+// oder wenn nichts gesendet werden konnte.
+int lanHttpExchange(const char* host, uint16_t port, const char* head, const void* body, size_t bodyLen,
+                    char* resp, size_t max, int64_t deadlineUs);
+
+// Teil des Rumpfs verarbeiten; false bricht die Übertragung ab
+typedef bool (*LanHttpSink)(void* ctx, const uint8_t* data, size_t len);
+
+// GET o. Ä. ohne Rumpf; der Kopf der Antwort muss in buf passen, der Rumpf geht
+// stückweise (höchstens max Byte je Aufruf) an sink. *status ist der Statuscode,
+// 0 ohne vollständigen Kopf. Anzahl der Rumpfbytes, -1 ohne Verbindung.
+int lanHttpStream(const char* host, uint16_t port, const char* head, char* buf, size_t max, int* status,
+                  LanHttpSink sink, void* ctx, int64_t deadlineUs);
+
+// Statuscode der Antwort, 0 wenn keine Statuszeile da ist
+int lanHttpStatus(const char* resp, int len);
+
+// Wert eines Kopffelds (ohne Beachtung der Groß-/Kleinschreibung des Namens),
+// nullptr wenn es fehlt; *valueLen ohne Zeilenende
+const char* lanHttpHeader(const char* resp, int len, const char* name, size_t* valueLen);
+
+// Rumpf hinter der Leerzeile, nullptr ohne vollständigen Kopf
+const char* lanHttpBody(const char* resp, int len, size_t* bodyLen);
@@ -0,0 +1,87 @@
+/**
+ * @file log_messages.h
+ * @brief Meldungstabelle des Binärprotokolls (clock_log.h)
+ *
+ * Je Meldung Name, Stufe und Text im printf-Stil. Die Firmware kennt nur Name
+ * (als Nummer = Position in der Liste) und Stufe; der Text steht nur hier und in
+ * der Tabelle, die scripts/log_table.py beim Build daraus erzeugt
+ * (.pio/build/<env>/log_table.json). scripts/log_decode.py setzt die Meldungen
+ * damit wieder zusammen.
+ *
+ * Argumente sind ganze Zahlen (höchstens CLOCK_LOG_MAX_ARGS): %d, %u, %x, %c mit
+ * Breite und Füllzeichen; keine Zeichenketten, keine Gleitkommazahlen.
+ * Neue Meldungen hinten anfügen, damit ältere Mitschnitte lesbar bleiben.
+ */
+#pragma once
+
+#define CLOCK_LOG_MESSAGES(X) \
+  X(MSG_LOG_START,       CLOG_INFO,  "Protokoll gestartet, Tabelle %08x") \
+  X(MSG_LOG_DROPPED,     CLOG_WARN,  "%u Meldungen verworfen (Puffer voll)") \
+  X(MSG_POWER_PROFILE,   CLOG_INFO,  "Energiesparprofil: esp_pm, Light-Sleep") \
+  X(MSG_BOOT_FRAME,      CLOG_INFO,  "Boot bis erste Zeitanzeige: %u ms") \
+  X(MSG_BOOT_SYNC,       CLOG_INFO,  "Boot bis Sync: %u ms (ok=%u)") \
+  X(MSG_SYNC_START,      CLOG_INFO,  "NTP-Sync starten…") \
+  X(MSG_WIFI_TRY,        CLOG_DEBUG, "WLAN: Zugang %u") \
+  X(MSG_WIFI_TRY_HINT,   CLOG_DEBUG, "WLAN: Zugang %u ohne Scan, Kanal %u") \
+  X(MSG_WIFI_UNREACHED,  CLOG_WARN,  "WLAN: Zugang %u nicht erreichbar nach %u ms") \
+  X(MSG_WIFI_NO_AP,      CLOG_WARN,  "WLAN: kein bekannter AP in Reichweite") \
+  X(MSG_WIFI_TIMEOUT,    CLOG_WARN,  "WLAN Timeout") \
+  X(MSG_RADIO_BUDGET,    CLOG_ERROR, "Radio-Budget überschritten") \
+  X(MSG_WIFI_CONNECTED,  CLOG_INFO,  "WLAN verbunden: Zugang %u") \
+  X(MSG_AP_DETAILS,      CLOG_DEBUG, "AP: Kanal %u, RSSI %d dBm, TX %d.%02d dBm, verbunden nach %u ms") \
+  X(MSG_DNS_FAILED,      CLOG_WARN,  "DNS: Abfrage fehlgeschlagen (%u ms), SNTP löst selbst auf") \
+  X(MSG_DNS_RESOLVED,    CLOG_DEBUG, "DNS: in %u ms aufgelöst, %d Adressen, TTL %u s") \
+  X(MSG_DNS_CACHED,      CLOG_DEBUG, "DNS: %u Adressen aus dem Cache") \
+  X(MSG_DNS_FALLBACK,    CLOG_WARN,  "DNS: gespeicherte Server antworten nicht, neu auflösen") \
+  X(MSG_NTP_FAILED,      CLOG_WARN,  "NTP fehlgeschlagen") \
+  X(MSG_TIME_SET,        CLOG_INFO,  "Zeit gesetzt") \
+  X(MSG_CONFIG_SAME,     CLOG_DEBUG, "Konfiguration unverändert (%u ms)") \
+  X(MSG_CONFIG_NEW,      CLOG_INFO,  "Konfiguration neu: Nacht %u-%u Uhr, Sync %u:%02u (%u ms)") \
+  X(MSG_CONFIG_UNREACHED, CLOG_WARN, "Konfiguration nicht abrufbar (Status %d, %u ms)") \
+  X(MSG_OTA_NONE,        CLOG_DEBUG, "Kein Update") \
+  X(MSG_OTA_CURRENT,     CLOG_DEBUG, "Update: aktuell (%u ms)") \
+  X(MSG_OTA_IDLE,        CLOG_DEBUG, "Update: verworfenes Delta, warte auf ein neues (%u ms)") \
+  X(MSG_OTA_UNREACHED,   CLOG_WARN,  "Update-Server nicht erreichbar (Status %d, %u ms)") \
+  X(MSG_OTA_PROGRESS,    CLOG_INFO,  "Update: Block %u/%u, %u neu, %u Byte in %u ms") \
+  X(MSG_OTA_RESUME,      CLOG_INFO,  "Update: Block %u/%u, %u neu, %u Byte in %u ms, Fortsetzung beim nächsten Sync") \
+  X(MSG_TELE_ACKED,      CLOG_DEBUG, "Telemetrie: %u Einträge, %u Byte in %u ms bestätigt") \
+  X(MSG_TELE_LATE,       CLOG_WARN,  "Telemetrie: %u Einträge, %u Byte in %u ms - Zeitbudget erschöpft") \
+  X(MSG_TELE_FAILED,     CLOG_WARN,  "Telemetrie: %u Einträge, %u Byte in %u ms - fehlgeschlagen") \
+  X(MSG_WIFI_OFF,        CLOG_INFO,  "WLAN aus") \
+  X(MSG_RADIO_ON,        CLOG_INFO,  "Radio an: %u ms") \
+  X(MSG_DAILY_OK,        CLOG_INFO,  "Täglicher NTP-Sync erfolgreich") \
+  X(MSG_DAILY_RETRY,     CLOG_WARN,  "Täglicher NTP-Sync fehlgeschlagen, neuer Versuch in %u Min") \
+  X(MSG_DAILY_FAILED,    CLOG_ERROR, "Täglicher NTP-Sync fehlgeschlagen") \
+  X(MSG_WAKE_HOUR,       CLOG_INFO,  "Wakeups letzte Stunde: %u (Timer %u, GPIO %u, UART %u, WLAN %u, sonst %u)") \
+  X(MSG_WAKE_HOUR_STORM, CLOG_WARN,  "Wakeups letzte Stunde: %u (Timer %u, GPIO %u, UART %u, WLAN %u, sonst %u) WAKE-STORM") \
+  X(MSG_WAKE_HOUR_BOOTS, CLOG_INFO,  "Wakeups letzte Stunde: nicht verfügbar (Light-Sleep ohne Exit-Callback), %u Boots") \
+  X(MSG_WAKE_STORM_TIMER, CLOG_WARN, "WAKE-STORM: Timer %u Wakeups in dieser Stunde, Budget %u") \
+  X(MSG_WAKE_STORM_GPIO, CLOG_WARN,  "WAKE-STORM: GPIO %u Wakeups in dieser Stunde, Budget %u") \
+  X(MSG_WAKE_STORM_UART, CLOG_WARN,  "WAKE-STORM: UART %u Wakeups in dieser Stunde, Budget %u") \
+  X(MSG_WAKE_STORM_WIFI, CLOG_WARN,  "WAKE-STORM: WLAN %u Wakeups in dieser Stunde, Budget %u") \
+  X(MSG_WAKE_STORM_UNKNOWN, CLOG_WARN, "WAKE-STORM: sonst %u Wakeups in dieser Stunde, Budget %u") \
+  X(MSG_HEAP_AFTER_SYNC, CLOG_INFO,  "Heap nach Sync: frei %u, größter Block %u, Minimum %u, Zuteilungen nach setup() %u (%u Byte)") \
+  X(MSG_STUB_REPORT,     CLOG_INFO,  "Wake-Stub: %u Minuten, Ø %u µs, max %u µs, I2C-Fehler %u") \
+  X(MSG_ULP_REPORT,      CLOG_INFO,  "ULP: %u Minuten gezeichnet, letzter Lauf %u µs, I2C-Fehler %u") \
+  X(MSG_STUB_CELL_SIZE,  CLOG_WARN,  "Wake-Stub: Ziffernbereich zu groß (%d x %d)") \
+  X(MSG_ULP_CELL_SIZE,   CLOG_WARN,  "ULP: Ziffernbereich zu groß (%d x %d)") \
+  X(MSG_ULP_TENS_CELL,   CLOG_WARN,  "ULP: Zehnerziffer passt nicht auf die Glyphen der Einerstelle") \
+  X(MSG_ULP_PROGRAM_SIZE, CLOG_ERROR, "ULP: Programm passt nicht in CONFIG_ULP_COPROC_RESERVE_MEM") \
+  X(MSG_CONFIG_RANGE,    CLOG_WARN,  "Konfiguration verworfen: Wert außerhalb des Bereichs (%u ms)") \
+  X(MSG_CONFIG_NIGHT,    CLOG_WARN,  "Konfiguration verworfen: sleep_start muss nach sleep_end liegen (%u ms)") \
+  X(MSG_CONFIG_NO_EQUALS, CLOG_WARN, "Konfiguration verworfen: Zeile ohne '=' (%u ms)") \
+  X(MSG_CONFIG_KEY,      CLOG_WARN,  "Konfiguration verworfen: unbekannter Schlüssel (%u ms)") \
+  X(MSG_CONFIG_NUMBER,   CLOG_WARN,  "Konfiguration verworfen: Wert keine Zahl 0..99 (%u ms)") \
+  X(MSG_CONFIG_EMPTY,    CLOG_WARN,  "Konfiguration verworfen: Wert fehlt (%u ms)") \
+  X(MSG_CONFIG_TOO_LARGE, CLOG_WARN, "Konfiguration verworfen: Antwort zu groß (%u ms)") \
+  X(MSG_CONFIG_TRUNCATED, CLOG_WARN, "Konfiguration verworfen: Antwort unvollständig (%u ms)") \
+  X(MSG_CONFIG_NVS,      CLOG_ERROR, "Konfiguration verworfen: NVS nicht beschreibbar (%u ms)") \
+  X(MSG_CONFIG_APPLIED,  CLOG_INFO,  "Zeitplan übernommen: Nacht %u-%u Uhr, Sync %u:%02u") \
+  X(MSG_OTA_BOOTED,      CLOG_INFO,  "Update läuft") \
+  X(MSG_OTA_NOT_BOOTED,  CLOG_WARN,  "Update nicht gestartet, altes Image läuft") \
+  X(MSG_OTA_NO_MEMORY,   CLOG_ERROR, "Update: zu wenig Speicher (%u Byte)") \
+  X(MSG_OTA_BLOCK_BAD,   CLOG_WARN,  "Update: Block %u fehlerhaft, Grund %u (DeltaReject, delta_ota.h)") \
+  X(MSG_OTA_REJECTED,    CLOG_WARN,  "Update verworfen: Grund %u (DeltaReject, delta_ota.h), %u ms") \
+  X(MSG_OTA_COMPLETE,    CLOG_INFO,  "Update vollständig (%u KB, %u ms), Neustart nach dem Sync") \
+  X(MSG_OTA_PHASE,       CLOG_DEBUG, "Update: Phase %u (0 kein Delta, 2 bereit; %u ms)") \
+  X(MSG_RADIO_WATCHDOG,  CLOG_ERROR, "Radio-Budget: Sync hing, Neustart durch den RTC-Watchdog")
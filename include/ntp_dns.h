@@ -0,0 +1,39 @@
+/**
+ * @file ntp_dns.h
+ * @brief Adressen des NTP-Servers mit TTL zwischenspeichern (RTC-Speicher und NVS)
+ *
+ * Statt bei jedem Sync NTP_SERVER über DNS aufzulösen, bekommt SNTP die
+ * gespeicherten Adressen direkt, solange deren TTL nicht abgelaufen ist. Ist der
+ * Cache alt oder leer, fragt ntpDnsStart() selbst beim DNS-Server (per DHCP oder
+ * -DNTP_DNS_SERVER) an und übernimmt Adressen und TTL. Antwortet keiner der
+ * gespeicherten Server innerhalb von NTP_DNS_FALLBACK_MS, wird der Cache
+ * verworfen und neu aufgelöst. Schlägt die eigene Abfrage fehl, erhält SNTP wie
+ * bisher den Hostnamen.
+ *
+ * Je Sync ein TELE_DNS-Eintrag; v[0] ist die Dauer der Auflösung, also die Zeit,
+ * die ein Treffer im Cache spart.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define NTP_DNS_MAX          3        // Adressen je Antwort (höchstens SNTP_MAX_SERVERS)
+#define NTP_DNS_TIMEOUT_MS   1500
+#define NTP_DNS_FALLBACK_MS  4000     // so lange auf die gespeicherten Server warten
+// Mindesthaltezeit: pool.ntp.org liefert nur rund 150 s TTL, gesynct wird täglich.
+// Eine Woche entspricht dem, was ntpd/chrony tun (Pool einmal beim Start auflösen,
+// Server behalten, solange sie antworten); einen verschwundenen Server fängt
+// NTP_DNS_FALLBACK_MS ab. -DNTP_DNS_MIN_TTL=0 hält sich an die TTL des DNS.
+#ifndef NTP_DNS_MIN_TTL
+#define NTP_DNS_MIN_TTL      604800   // s
+#endif
+#ifndef NTP_DNS_PORT
+#define NTP_DNS_PORT         53
+#endif
+
+// SNTP mit den Servern starten (Betriebsart POLL); läuft SNTP schon, wird es
+// vorher angehalten. true, wenn die Adressen aus dem Cache stammen.
+bool ntpDnsStart();
+
+// gespeicherte Server antworten nicht: Cache verwerfen, neu auflösen, SNTP neu starten
+void ntpDnsFallback();
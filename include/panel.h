@@ -0,0 +1,51 @@
+/**
+ * @file panel.h
+ * @brief Leistungsprofile des SH1106: Ladungspumpe, Oszillator und Pre-Charge
+ *
+ * u8g2 initialisiert das Panel auf Helligkeit. Für die Uhr mit Kontrast 30
+ * reichen kleinere Pumpenspannung, langsamerer Oszillator und kürzere
+ * Pre-Charge. Ein Wechsel kostet vier Befehle (5 Byte) und wird nur gesendet,
+ * wenn sich das Profil ändert.
+ *
+ * panelCrop() beschränkt den Scan auf die Seiten des Zifferblatts
+ * (-DCLOCK_MUX_CROP): Multiplex-Ratio 48, Offset 56 und Startzeile 8.
+ * COM c zeigt damit weiter RAM-Zeile c, das Bild verschiebt sich nicht;
+ * COM 0..7 und 56..63 bleiben dunkel und werden nicht gescannt.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <clib/u8g2.h>
+
+enum PanelProfile : uint8_t {
+  PANEL_DAY = 0,      // Werte der u8g2-Initialisierung: Statusmeldungen
+  PANEL_DIM,          // Zeitanzeige mit CONTRAST_TIME
+  PANEL_PROFILE_COUNT,
+  PANEL_AUTO = 0xFF,  // nur für panelForce(): wieder nach Anzeige wählen
+};
+
+struct PanelSettings {
+  uint8_t pump;       // 0x30–0x33: 6,4 / 7,4 / 8,0 / 9,0 V
+  uint8_t clock;      // Argument zu 0xD5: Oszillator (Bit 7..4), Teiler − 1 (Bit 3..0)
+  uint8_t precharge;  // Argument zu 0xD9: Discharge (Bit 7..4), Pre-Charge (Bit 3..0)
+};
+
+extern const PanelSettings panelProfiles[PANEL_PROFILE_COUNT];
+
+// Profil setzen, falls es nicht schon aktiv ist (ein erzwungenes Profil hat Vorrang)
+void panelApply(u8g2_t* u8g2, PanelProfile profile);
+
+// nach u8g2_InitDisplay() aufrufen: der Controller steht wieder auf den u8g2-Werten
+void panelReset();
+
+// Profil für Strommessungen festhalten; wird mit dem nächsten Zeichnen übernommen
+void panelForce(uint8_t profile);
+
+// Nur die Zeilen des Zifferblatts ansteuern (Multiplex-Ratio, Offset, Startzeile)
+// oder wieder alle 64; wird nur gesendet, wenn sich der Zustand ändert
+void panelCrop(u8g2_t* u8g2, bool on);
+
+const char* panelProfileName(uint8_t profile);
+
+// Konsole: AUTO → DAY → DIM → AUTO
+void panelCycle();
@@ -0,0 +1,48 @@
+/**
+ * @file power.h
+ * @brief Energiesparprofil: esp_pm mit automatischem Light-Sleep und Wakeup-Zählung
+ *
+ * Wirksam nur, wenn das sdkconfig CONFIG_PM_ENABLE und Tickless-Idle enthält
+ * (Umgebungen wemos_d1_mini32_idf und wemos_d1_mini32_lowpower). Im reinen
+ * Arduino-Build liefern die Funktionen false und die Zähler bleiben 0.
+ */
+#pragma once
+
+#include <stdint.h>
+
+enum WakeCause : uint8_t {
+  WAKE_TIMER = 0,
+  WAKE_GPIO,
+  WAKE_UART,
+  WAKE_WIFI,
+  WAKE_UNKNOWN,
+  WAKE_CAUSE_COUNT
+};
+
+struct WakeStats {
+  uint32_t total;
+  uint32_t byCause[WAKE_CAUSE_COUNT];
+  uint64_t sleptUs;      // Summe der Light-Sleep-Dauer (nur mit PM-Callbacks)
+};
+
+// esp_pm konfigurieren (40..160 MHz, Light-Sleep) und Wakeup-Zählung starten
+bool powerInit();
+
+// true, wenn automatischer Light-Sleep aktiv ist
+bool powerAutoSleep();
+
+// true, wenn Light-Sleep-Wakeups gezählt werden (Exit-Callback, IDF >= 5.2);
+// sonst enthalten die Zähler nur Boots
+bool powerWakeCounting();
+
+// Volle CPU-Leistung und kein Light-Sleep während des Syncs; false ohne esp_pm
+bool powerSyncBegin();
+bool powerSyncEnd();
+
+const char* wakeCauseName(uint8_t cause);
+
+// esp_sleep_wakeup_cause_t -> WakeCause
+uint8_t powerClassifyWake(int cause);
+
+// aktuelle Zähler lesen, optional zurücksetzen (Auswertung: wake_stats.h)
+void powerWakeSnapshot(WakeStats* out, bool reset);
@@ -0,0 +1,33 @@
+/**
+ * @file radio_guard.h
+ * @brief Harte Obergrenze für die Radio-an-Zeit eines Syncs
+ *
+ * radioGuardStart() startet beim Einschalten des WLANs einen One-Shot-esp_timer.
+ * Läuft das Budget ab, setzt der Timer nur radioGuardExpired(); die Warteschleifen
+ * des Syncs (wifiConnect, clockSyncRun) fragen das höchstens alle 100 ms ab,
+ * brechen ab und schalten das WLAN im eigenen Task ab (TELE_RADIO_BUDGET,
+ * Flag 1). Hängt der Sync-Task, setzt der RTC-Watchdog nach Budget plus
+ * RADIO_GRACE_MS das System zurück; das meldet radioGuardInit() nach dem Neustart
+ * (Flag 2).
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define RADIO_ON_BUDGET_MS 30000   // Verbinden (max. 20 s) + NTP
+#define RADIO_GRACE_MS     10000   // danach Neustart durch den RTC-Watchdog, falls der Sync hängt
+
+// nach telemetryInit(): meldet einen Neustart durch den Watchdog
+void radioGuardInit();
+
+// Radio an: Budget beginnt, RTC-Watchdog scharf
+void radioGuardStart();
+
+// Radio aus: Timer stoppen, Watchdog aus; liefert die Radio-an-Zeit in ms
+uint32_t radioGuardStop();
+
+// true, sobald das Budget abgelaufen ist; der Aufrufer bricht ab und schaltet das WLAN aus
+bool radioGuardExpired();
+
+// verbleibendes Budget in ms (0, wenn abgelaufen)
+uint32_t radioGuardRemainingMs();
@@ -0,0 +1,14 @@
+/**
+ * @file render_bench.h
+ * @brief Takte je Zeitbild (zeichnen und senden) mit kaltem und warmem Flash-Cache
+ *
+ * Zeichnet das angezeigte Bild erneut und sendet es, das Display ändert sich
+ * dabei nicht. Für "kalt" wird vorher der Flash-Cache des Kerns durch Lesen
+ * von 64 KB aus der App-Partition verdrängt. Vergleich mit und ohne
+ * -DCLOCK_IRAM_RENDER, am besten nach dem Sync bei 40 MHz. Konsole: "bench".
+ */
+#pragma once
+
+#define RENDER_BENCH_RUNS 8
+
+void renderBench();
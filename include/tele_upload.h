@@ -0,0 +1,47 @@
+/**
+ * @file tele_upload.h
+ * @brief Telemetrie gesammelt an einen Sammler im LAN senden, im Sync-Fenster
+ *
+ * Einmal am Tag ist das WLAN für syncTime() ohnehin an. Nach dem NTP-Sync und vor
+ * dem Abschalten packt teleUpload() alle noch nicht bestätigten Einträge des
+ * Telemetrie-Rings (Sync- und Drift-Werte, Radio-an-Zeiten, Wakeups je Stunde,
+ * Heap-Stichproben, ...) zusammen mit einem Kopf (MAC, Laufzeit, Heap jetzt,
+ * Light-Sleep-Anteil) in einen Binärblock und schickt ihn in einer Anfrage:
+ *
+ * - UDP (Standard): ein Datagramm an TELE_UPLOAD_HOST:TELE_UPLOAD_PORT, der
+ *   Sammler bestätigt mit "ACK1" und der nächsten erwarteten Nummer.
+ * - HTTP (-DTELE_UPLOAD_HTTP): POST TELE_UPLOAD_PATH, bestätigt durch 2xx.
+ *
+ * Die Radio-an-Zeit verlängert sich dadurch um höchstens TELE_UPLOAD_BUDGET_MS
+ * (und nie über das Budget von radio_guard hinaus); danach wird abgebrochen und
+ * beim nächsten Sync erneut gesendet. Nur bestätigte Einträge gelten als gesendet.
+ *
+ * Ohne -DTELE_UPLOAD_HOST=\"192.168.1.10\" (IPv4-Adresse, kein Name: eine
+ * DNS-Abfrage würde das Budget aufbrauchen) ist der Upload aus.
+ * Sammler zum Testen: scripts/tele_collector.py.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef TELE_UPLOAD_PORT
+#define TELE_UPLOAD_PORT      8471
+#endif
+#ifndef TELE_UPLOAD_PATH
+#define TELE_UPLOAD_PATH      "/telemetry"
+#endif
+#ifndef TELE_UPLOAD_BUDGET_MS
+#define TELE_UPLOAD_BUDGET_MS 300      // zusätzliche Radio-an-Zeit höchstens
+#endif
+#define TELE_UPLOAD_MAX_BYTES 1400     // ein Datagramm ohne IP-Fragmentierung
+
+// Blockformat (Little Endian), Version 1:
+//   "CTU1", MAC[6], erste Nummer u32, Einträge u16, Basiszeit u32, Laufzeit s u32,
+//   Heap frei u32, Heap-Minimum u32, größter Block u32, Light-Sleep ‰ u16,
+//   Reset-Grund u8; je Eintrag: Zeit − vorige (ZigZag-Varint), Typ u8, Flags u8,
+//   Maske u8 der Werte ≠ 0, diese als Varint
+#define TELE_UPLOAD_HEADER    39
+
+// Einträge seit der letzten Bestätigung senden, wenn ein Sammler eingestellt ist;
+// true, wenn der Sammler bestätigt hat. Nur mit verbundenem WLAN aufrufen.
+bool teleUpload();
@@ -0,0 +1,57 @@
+/**
+ * @file telemetry.h
+ * @brief Kompaktes Ereignisprotokoll im RTC-Speicher
+ *
+ * Feste Datensätze (16 Byte) in einem Ring, der Deep-Sleep und Software-Resets
+ * übersteht. Über die Konsole mit "log" auslesbar.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+enum TelemetryType : uint8_t {
+  TELE_NONE = 0,
+  TELE_BOOT,         // flags: Reset-Grund, v[0]: Wake-Ursache
+  TELE_WAKE_HOUR,    // flags: Storm-Maske, v[0..4]: Wakeups je Ursache
+  TELE_WAKE_STORM,   // flags: Ursache, v[0..1]: Anzahl (lo/hi), v[2]: Budget
+  TELE_HEAP,         // v[0]: frei, v[1]: größter Block, v[2]: Minimum (je 16 Byte), v[3]: Zuteilungen nach setup()
+  TELE_RADIO_BUDGET, // flags: 1 = Budget überschritten, Sync abgebrochen, 2 = Neustart durch den RTC-Watchdog; v[0]: Grenze in s
+  TELE_SYNC,         // flags: 1 = erfolgreich; v[0]: Radio-an-Zeit, v[1]: Verbindungszeit (ms), v[2]: TX (0,25 dBm), v[3]: RSSI
+  TELE_WAKE_STUB,    // v[0]: Stub-Minuten, v[1]: Ø Wake-Dauer (µs), v[2]: Maximum (µs), v[3]: I2C-Fehler
+  TELE_ULP,          // v[0]: vom ULP gezeichnete Minuten, v[1]: letzter Lauf (µs), v[2]: I2C-Fehler
+  TELE_DNS,          // flags: 1 = Cache, 2 = Cache verworfen; v[0]: Auflösung (ms), v[1]: TTL-Rest (min), v[2]: Adressen
+  TELE_DRIFT,        // flags: 1 = Stichprobe übernommen, 2 = mit Temperaturterm; v[0]: Abweichung (ms), v[1]: ppm·10, v[2]: °C·10 (alle mit Vorzeichen), v[3]: Stichproben
+  TELE_UPLOAD,       // flags: 1 = bestätigt, 2 = Zeitbudget erschöpft; v[0]: Dauer (ms), v[1]: Byte, v[2]: Einträge, v[3]: noch offen
+  TELE_CONFIG,       // flags: 1 = unverändert (304), 2 = neu gespeichert, 4 = verworfen, 8 = nicht erreichbar; v[0]: Dauer (ms), v[1]: HTTP-Status, v[2]: Byte
+  TELE_OTA,          // flags: 1 = unverändert (304), 2 = neues Delta, 4 = Blöcke geladen, 8 = fertig, 16 = verworfen, 32 = abgebrochen; v[0]: Dauer (ms), v[1]: HTTP-Status, v[2]: nächster Block, v[3]: Blöcke, v[4]: empfangen (16 Byte)
+};
+
+#define TELEMETRY_VALUES 5
+
+struct TelemetryRecord {
+  uint32_t time;                      // Unix-Zeit
+  uint8_t  type;                      // TelemetryType
+  uint8_t  flags;
+  uint16_t v[TELEMETRY_VALUES];
+};
+
+#define TELEMETRY_CAPACITY 96
+
+// RTC-Ring prüfen, nach Kaltstart leeren
+void telemetryInit();
+
+void telemetryAdd(uint8_t type, uint8_t flags, const uint16_t* v = nullptr, uint8_t n = 0);
+
+// Anzahl gespeicherter Datensätze; idx 0 ist der älteste
+uint16_t telemetryCount();
+bool telemetryGet(uint16_t idx, TelemetryRecord* out);
+
+// laufende Nummer des nächsten Datensatzes (seit dem Leeren des Rings)
+uint32_t telemetrySeq();
+
+// Datensätze ab Nummer *seq kopieren (höchstens max); überschriebene werden
+// übersprungen, *seq zeigt danach auf den ersten kopierten
+uint16_t telemetrySince(uint32_t* seq, TelemetryRecord* out, uint16_t max);
+
+void telemetryPrint();
@@ -0,0 +1,35 @@
+/**
+ * @file ulp_clock.h
+ * @brief Minutentakt und Display-Update durch den ULP-Coprozessor (FSM)
+ *
+ * Nur mit -DCLOCK_ULP (env wemos_d1_mini32_ulp). Der ULP zählt im Tiefschlaf
+ * die Sekunden, schreibt bei jedem Minutenwechsel die geänderten Minutenziffern
+ * per Bit-Banging-I2C ins SH1106 und weckt die Xtensa-Kerne nur zum
+ * Stundenwechsel, zur Sync-Minute oder nach einem I2C-Fehler.
+ *
+ * Der ULP erreicht nur RTC-GPIOs; GPIO 21/22 sind keine. Das Display hängt in
+ * diesem Modus an SDA = GPIO 32 (RTC_GPIO9) und SCL = GPIO 33 (RTC_GPIO8),
+ * siehe README.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <clib/u8g2.h>
+#include "clock_core.h"
+
+#define ULP_OLED_SDA 32
+#define ULP_OLED_SCL 33
+#define ULP_OLED_ADDR 0x3C
+#define ULP_GLYPH_WORDS 72       // je Ziffer: Spalten × Seiten / 2 (zwei Byte je RTC-Wort)
+
+// true, wenn dieser Start aus dem ULP-Tiefschlaf kommt und die Uhrzeit gültig ist;
+// hält dann den ULP an und gibt die Display-Pins an den I2C-Treiber zurück
+bool ulpClockResumed();
+
+// Minuten, Wiederholungen und I2C-Fehler des ULP seit dem letzten Wecken ausgeben
+void ulpClockReport();
+
+// Ziffern vorbereiten, ULP starten und in den Tiefschlaf gehen; kehrt nicht zurück.
+// Ist das Display aus (Nacht) oder der ULP nicht nutzbar, weckt nur der Timer.
+void ulpClockSleep(u8g2_t* u8g2, const ClockState& st, const struct tm& shown, bool displayOn);
@@ -0,0 +1,48 @@
+/**
+ * @file wake_stats.h
+ * @brief Wakeups je Stunde und Ursache im RTC-Speicher, Erkennung von Wake-Storms
+ *
+ * Die Zähler aus power.h werden bei jedem Durchlauf der Hauptschleife in den
+ * Stundeneintrag übernommen. Überschreitet eine Ursache ihr Stundenbudget, wird
+ * das einmal pro Stunde gemeldet und ins Telemetrie-Protokoll geschrieben.
+ * Ohne Exit-Callback des Light-Sleeps (powerWakeCounting()) enthalten die
+ * Stunden nur die Boots; die Stundenmeldung sagt das, statt Zahlen zu erfinden.
+ * Vor dem ersten Sync gibt es keine Stunde: die Wakeups laufen dann in einen
+ * Zwischenzähler, der mit der ersten gültigen Stunde verworfen wird.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include "power.h"
+
+// erwartete Wakeups pro Stunde; darüber gilt es als Wake-Storm
+#define WAKE_BUDGET_TIMER    180   // Minutenwechsel + esp_timer-Reserve
+#define WAKE_BUDGET_GPIO      30
+#define WAKE_BUDGET_UART     120   // Eingaben auf der Konsole
+#define WAKE_BUDGET_WIFI      60
+#define WAKE_BUDGET_UNKNOWN   10
+
+#define WAKE_STATS_HOURS 24
+#define WAKE_STATS_TIME_VALID 1700000000   // davor ist die Uhr noch nicht gestellt (Sekunden seit dem Boot)
+
+// Flag im Telemetrie-Eintrag wake/h: Light-Sleep-Wakeups nicht gezählt, nur Boots
+#define WAKE_HOUR_BOOTS_ONLY 0x80
+
+struct WakeHour {
+  uint32_t hour;                        // Unix-Zeit / 3600
+  uint32_t byCause[WAKE_CAUSE_COUNT];
+  uint8_t  stormMask;                   // Bit je Ursache über Budget
+};
+
+// RTC-Daten prüfen und Boot-Ursache buchen
+void wakeStatsInit();
+
+// Zähler übernehmen, Budgets prüfen, bei Stundenwechsel abschließen
+void wakeStatsTick(time_t now);
+
+// Summe der Light-Sleep-Dauer seit dem Boot (nur mit PM-Callbacks, sonst 0)
+uint64_t wakeStatsSleptUs();
+
+// Tabelle der letzten Stunden auf der Konsole ("stats")
+void wakeStatsPrint();
@@ -0,0 +1,40 @@
+/**
+ * @file wake_stub.h
+ * @brief Tiefschlaf zwischen den Minuten, einfache Minutenwechsel im Wake-Stub
+ *
+ * Nur mit -DCLOCK_DEEP_SLEEP (Arduino-Build, env wemos_d1_mini32_deepsleep).
+ * Vor dem Tiefschlaf rendert der volle Boot die Einerziffer der nächsten
+ * Minuten vor und legt die geänderten Kacheln im RTC-Speicher ab. Der Stub
+ * läuft beim Aufwachen direkt aus dem RTC-IRAM, schreibt die Kacheln per
+ * Bit-Banging-I2C ins SH1106 und legt sich sofort wieder schlafen.
+ * Zehnerwechsel, Stundenwechsel, Syncs, Nachtphase und I2C-Fehler gehen
+ * weiter durch den vollen Boot.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <clib/u8g2.h>
+#include "clock_core.h"
+
+#define WAKE_STUB_SDA 21             // wie oled_SDA/oled_CLK, der Stub kennt keine Treiber
+#define WAKE_STUB_SCL 22
+#define WAKE_STUB_OLED_ADDR 0x3C
+#define WAKE_STUB_CELL_BYTES 168     // Kacheln je Ziffer (Spalten × Seiten)
+#define WAKE_STUB_DIGITS 9           // höchstens x1 … x9
+#define WAKE_STUB_LOG 60             // Wake-Dauer der letzten Minuten
+
+// true, wenn dieser Start ein Timer-Wakeup aus dem Tiefschlaf mit gültiger Uhrzeit ist
+bool wakeStubResumed();
+
+// Wake-Dauern der Stub-Minuten seit dem letzten vollen Boot ausgeben und protokollieren
+void wakeStubReport();
+
+// wie viele Minuten der Stub ab der angezeigten Zeit selbst weiterzählen darf
+uint8_t wakeStubMinutes(const ClockState& st, const struct tm& shown, time_t now);
+
+// Kacheln für die nächsten @p minutes Minuten vorbereiten; false = Stub bleibt aus
+bool wakeStubArm(u8g2_t* u8g2, const struct tm& shown, uint8_t minutes);
+
+// Tiefschlaf bis zum nächsten Minutenwechsel; kehrt nicht zurück
+void wakeStubSleep(uint32_t msToNextMinute);
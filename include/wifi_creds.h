@@ -0,0 +1,83 @@
+/**
+ * @file wifi_creds.h
+ * @brief Mehrere WLAN-Zugänge mit Rangfolge und schnellem Wechsel
+ *
+ * Die Zugänge stehen in secrets.h, entweder wie bisher als einzelnes
+ * SECRET_SSID/SECRET_PASS oder als Liste:
+ *
+ *     #define SECRET_WIFI_LIST { {"Zuhause", "..."}, {"Werkstatt", "..."} }
+ *
+ * Reihenfolge: zuletzt erfolgreich verbundene APs zuerst (wifi_tune, NVS).
+ * Zuerst werden die APs mit bekanntem Kanal/BSSID ohne Scan versucht; meldet
+ * der Treiber einen Fehlschlag (AP nicht gefunden, Anmeldung abgelehnt), geht es
+ * sofort zum nächsten. Danach ein einziger kurzer Scan, aus dem der stärkste
+ * bekannte AP gewählt wird.
+ *
+ * Das Verbinden selbst erledigt das Framework über WifiConnectOps
+ * (Arduino: WiFi-Klasse, ESP-IDF: esp_wifi). Den Zustand des laufenden Versuchs
+ * führen beide über wifiAttempt*(): die Ereignis-Handler melden Verbindung und
+ * Trennung, ein Abbruch wartet auf seine eigene Trennung. So kann das
+ * Trennungsereignis eines abgebrochenen Versuchs nicht den nächsten Versuch als
+ * gescheitert markieren.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "wifi_tune.h"
+
+#define WIFI_CREDS_MAX          8
+#define WIFI_FAST_TIMEOUT_MS 4000     // Connect mit bekanntem Kanal, inkl. DHCP
+#define WIFI_SCAN_TIMEOUT_MS 10000    // Connect nach Scan
+#define WIFI_POLL_MS           50
+#define WIFI_ABORT_WAIT_MS    300     // höchstens so lange auf das Trennungsereignis warten
+
+struct WifiCred {
+  const char* ssid;
+  const char* pass;
+};
+
+enum WifiAttempt : uint8_t {
+  WIFI_ATTEMPT_PENDING = 0,
+  WIFI_ATTEMPT_CONNECTED,
+  WIFI_ATTEMPT_FAILED,        // Treiber hat aufgegeben, nicht weiter warten
+};
+
+struct WifiScanRecord {
+  char    ssid[33];
+  int8_t  rssi;
+  uint8_t channel;
+  uint8_t bssid[6];
+};
+
+struct WifiConnectOps {
+  void    (*begin)(const WifiCred& cred, const WifiTuneHint& hint);  // Radio ist schon an
+  uint8_t (*poll)();                                                // WifiAttempt
+  void    (*abort)();                                               // Versuch abbrechen
+  int     (*scan)(WifiScanRecord* out, int max);                    // Anzahl, < 0 bei Fehler
+};
+
+// --- Zustand des laufenden Versuchs, für die WifiConnectOps der Mains ---
+
+// vor WiFi.begin() / esp_wifi_connect()
+void wifiAttemptBegin(const char* ssid);
+
+// aus dem Ereignis-Handler: verbunden (mit IP) oder getrennt; ssid der Trennung,
+// falls der Treiber sie meldet (Länge 0: unbekannt). Trennungen eines anderen APs
+// und nach einem abgeschlossenen Abbruch zählen nicht.
+void wifiAttemptEvent(bool connected, const uint8_t* ssid, uint8_t ssidLen);
+
+// WifiAttempt für ops.poll()
+uint8_t wifiAttemptState();
+
+// ops.abort(): disconnect() aufrufen und auf das Trennungsereignis warten,
+// höchstens WIFI_ABORT_WAIT_MS; hat der Treiber schon aufgegeben, sofort zurück
+void wifiAttemptAbort(void (*disconnect)());
+
+uint8_t wifiCredCount();
+const WifiCred& wifiCred(uint8_t idx);
+
+// Indizes nach Rangfolge sortiert; liefert die Anzahl
+uint8_t wifiCredsRanked(uint8_t* order);
+
+// mit dem besten erreichbaren AP verbinden; Index des Zugangs oder -1
+int wifiConnect(const WifiConnectOps& ops);
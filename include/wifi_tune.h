@@ -0,0 +1,61 @@
+/**
+ * @file wifi_tune.h
+ * @brief Sendeleistung und Verbindungsparameter je AP aus dem letzten Sync lernen
+ *
+ * Je SSID wird im NVS gespeichert: RSSI, Kanal und BSSID der letzten erfolgreichen
+ * Verbindung, die verwendete Sendeleistung und die 802.11-Modi des AP. Beim
+ * nächsten Sync wird daraus
+ * - ein schneller Connect ohne Kanalscan (Kanal + BSSID),
+ * - eine abgesenkte maximale Sendeleistung bei gutem RSSI,
+ * - 11b/g bzw. 11b/g/n passend zum AP.
+ * Nach einem Fehlschlag wird wieder mit voller Leistung und Scan verbunden.
+ *
+ * Je Sync entsteht ein TELE_SYNC-Eintrag mit Radio-an-Zeit, Verbindungszeit,
+ * Sendeleistung und RSSI, um den Energiebedarf vorher/nachher zu vergleichen.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define WIFI_TX_POWER_MAX 78       // 19,5 dBm in 0,25-dBm-Schritten (esp_wifi_set_max_tx_power)
+
+struct ApTune {
+  int8_t   rssi;                   // dBm, 0 = unbekannt
+  int8_t   txPower;                // 0,25 dBm
+  uint8_t  channel;
+  uint8_t  bssid[6];
+  uint8_t  protocol;               // WIFI_PROTOCOL_* des AP
+  uint8_t  failures;               // Fehlschläge in Folge
+  uint16_t connectMs;              // Dauer bis IP bei der letzten Verbindung
+  uint32_t lastOk;                 // Unix-Zeit der letzten erfolgreichen Verbindung
+};
+
+struct WifiTuneHint {
+  uint8_t channel;                 // 0 = scannen
+  uint8_t bssid[6];
+  bool    bssidValid;
+};
+
+// gespeicherte Werte zur SSID lesen (für die Rangfolge in wifi_creds)
+bool wifiTuneLoad(const char* ssid, ApTune* out);
+
+// Zustand des letzten Syncs verwerfen (Beginn von wifiConnect(), Ende von wifiTuneEnd())
+void wifiTuneReset();
+
+// gespeicherte Werte zur SSID laden, Hinweise für einen schnellen Connect liefern
+void wifiTuneBegin(const char* ssid, WifiTuneHint* hint);
+
+// nach esp_wifi_start(): Sendeleistung, Protokoll und Scan-Verweilzeiten setzen
+void wifiTuneAfterStart();
+
+// nach erfolgreicher Verbindung: RSSI, Kanal, BSSID und Modi des AP übernehmen
+void wifiTuneConnected(uint32_t connectMs);
+
+// Verbindungsversuch zum aktuellen AP fehlgeschlagen, nächster AP folgt
+void wifiTuneFailed();
+
+// Ende des Syncs: speichern und TELE_SYNC protokollieren; ohne Versuch wird nichts gespeichert
+void wifiTuneEnd(bool ok, uint32_t radioMs);
+
+// Sendeleistung für ein gemessenes RSSI (0,25 dBm)
+int8_t wifiTunePowerForRssi(int8_t rssi);
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+# Lokaler Konfigurationsserver fuer den bedingten Abruf der Uhr (src/clock_config.cpp).
+#
+# Liefert eine Datei mit "schluessel=wert"-Zeilen aus, unter CLOCK_CONFIG_PATH
+# (Standard /clock.cfg). Das ETag ist ein Hash des Inhalts; die Datei wird bei
+# jeder Anfrage neu gelesen, eine Aenderung ergibt also beim naechsten Sync eine
+# 200-Antwort, sonst 304. Verzoegerung und Verlust sind einstellbar, um das
+# Zeitbudget zu pruefen (CLOCK_CONFIG_BUDGET_MS); --truncate bricht den Rumpf
+# nach so vielen Byte ab, Content-Length nennt weiter die volle Laenge.
+#
+# Aufruf (Port 80 braucht Root-Rechte, sonst -DCLOCK_CONFIG_PORT=8080):
+#     python3 scripts/config_standin.py --file clock.cfg --port 8080 --delay 0.05
+# Firmware dazu mit -DCLOCK_CONFIG_HOST=\"192.168.1.10\" bauen.
+
+import argparse
+import hashlib
+import http.server
+import random
+import time
+
+
+def make_handler(args):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def do_GET(self):
+            if random.random() < args.loss:
+                print("%s: verworfen (--loss)" % self.client_address[0])
+                self.close_connection = True
+                return
+            time.sleep(args.delay)
+            if self.path != args.path:
+                self.send_response(404)
+                self.end_headers()
+                return
+            try:
+                with open(args.file, "rb") as f:
+                    body = f.read()
+            except OSError as e:
+                print("%s: %s" % (args.file, e))
+                self.send_response(500)
+                self.end_headers()
+                return
+            etag = '"%s"' % hashlib.sha1(body).hexdigest()[:16]
+            if self.headers.get("If-None-Match") == etag:
+                print("%s: 304 %s" % (self.client_address[0], etag))
+                self.send_response(304)
+                self.send_header("ETag", etag)
+                self.end_headers()
+                return
+            print("%s: 200 %s, %d Byte (If-None-Match: %s)" % (
+                self.client_address[0], etag, len(body), self.headers.get("If-None-Match", "-")))
+            self.send_response(200)
+            self.send_header("Content-Type", "text/plain")
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("ETag", etag)
+            self.end_headers()
+            self.wfile.write(body if args.truncate < 0 else body[:args.truncate])
+
+        def log_message(self, *a):
+            pass
+
+    return Handler
+
+
+def main():
+    p = argparse.ArgumentParser(description="Konfigurationsserver mit ETag fuer die Uhr")
+    p.add_argument("--bind", default="0.0.0.0")
+    p.add_argument("--port", type=int, default=80, help="CLOCK_CONFIG_PORT")
+    p.add_argument("--path", default="/clock.cfg", help="CLOCK_CONFIG_PATH")
+    p.add_argument("--file", required=True, help="Konfiguration, je Zeile schluessel=wert")
+    p.add_argument("--delay", type=float, default=0.0, help="Antwortverzoegerung in s")
+    p.add_argument("--loss", type=float, default=0.0, help="Anteil unbeantworteter Anfragen 0..1")
+    p.add_argument("--truncate", type=int, default=-1, help="Rumpf nach so vielen Byte abbrechen")
+    args = p.parse_args()
+
+    server = http.server.ThreadingHTTPServer((args.bind, args.port), make_handler(args))
+    print("Konfiguration %s unter http://%s:%d%s" % (args.file, args.bind, args.port, args.path))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
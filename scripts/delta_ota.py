@@ -0,0 +1,319 @@
+#!/usr/bin/env python3
+# Delta-Updates fuer die Uhr (src/delta_ota.cpp): erzeugen, pruefen, ausliefern.
+#
+#     python3 scripts/delta_ota.py make alt.bin neu.bin delta.bin [--block 32768]
+#     python3 scripts/delta_ota.py apply alt.bin delta.bin ergebnis.bin
+#     python3 scripts/delta_ota.py serve --dir fw --port 8080 --rate 4000 --drop 0.1
+#
+# alt.bin ist das Image, das auf der Uhr laeuft (.pio/build/<env>/firmware.bin),
+# neu.bin das neue. Das Delta besteht aus unabhaengigen Bloecken zu --block Byte
+# des neuen Images; die Uhr laedt je Sync-Fenster so viele Bloecke, wie das
+# Zeitbudget erlaubt, und setzt am naechsten Tag mit dem naechsten Block fort.
+#
+# Format (Little Endian):
+#   Kopf (80 Byte): "CDP1", SHA-256 alt, SHA-256 neu, Groesse neu u32,
+#                   Blockgroesse u32, Bloecke u16, 0 u16
+#   je Block (16 Byte): Offset im Delta u32, Laenge u32, Quellposition u32, CRC-32 der Ausgabe u32
+#   je Block ein zlib-Strom aus Befehlen im Stil von bsdiff:
+#       Diff-Laenge (Varint), Extra-Laenge (Varint), Sprung (ZigZag-Varint),
+#       Diff-Bytes (werden zu den Bytes der Quelle addiert), Extra-Bytes (wortwoertlich);
+#       die Quellposition rueckt um Diff- und Extra-Laenge vor, dann um "Sprung"
+# Der SHA-256 eines ESP-Images ist der angehaengte Hash (letzte 32 Byte), wie ihn
+# esp_partition_get_sha256() auf der Uhr liefert; bei anderen Dateien der SHA-256
+# der ganzen Datei.
+#
+# "serve" liefert die Dateien aus --dir mit Range, ETag, If-Match und
+# If-None-Match aus, mit --rate auf Byte/s gedrosselt und mit --drop als Anteil
+# abgebrochener Verbindungen (schwaches WLAN).
+
+import argparse
+import hashlib
+import http.server
+import os
+import random
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"CDP1"
+HEADER = struct.Struct("<4s32s32sIIHH")
+ENTRY = struct.Struct("<IIII")
+KEY = 8          # Laenge der Schluessel im Index der alten Datei
+STEP = 4         # jede STEP-te Position der alten Datei indizieren
+MIN_RUN = 8      # kuerzester Diff-Lauf, der sich lohnt
+
+
+def image_hash(data):
+    # ESP-Image mit angehaengtem SHA-256: Byte 23 des Kopfs ist 1
+    if len(data) > 56 and data[0] == 0xE9 and data[23] == 1:
+        if hashlib.sha256(data[:-32]).digest() == data[-32:]:
+            return data[-32:]
+    return hashlib.sha256(data).digest()
+
+
+def varint(v):
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+def zigzag(v):
+    return v << 1 if v >= 0 else ((-v) << 1) - 1
+
+
+def read_varint(data, pos):
+    value, shift = 0, 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+# --- Delta erzeugen ---
+
+def build_index(old):
+    index = {}
+    for p in range(0, len(old) - KEY + 1, STEP):
+        index.setdefault(old[p:p + KEY], []).append(p)
+    return index
+
+
+def extend(old, o, new, n, end):
+    # ungefaehre Uebereinstimmung wie bei bsdiff: solange Treffer die Fehler ueberwiegen
+    lim = min(end - n, len(old) - o)
+    score = best_score = best = k = 0
+    while k < lim:
+        score += 1 if old[o + k] == new[n + k] else -1
+        k += 1
+        if score > best_score:
+            best_score, best = score, k
+        elif score < best_score - 16:
+            break
+    return best
+
+
+def exact(old, o, new, n, end):
+    k, lim = 0, min(end - n, len(old) - o)
+    while k < lim and old[o + k] == new[n + k]:
+        k += 1
+    return k
+
+
+def diff_block(old, new, start, end, index, src):
+    # Befehle fuer new[start:end]; src ist die Quellposition am Blockanfang
+    diff_len, extra = 0, bytearray()
+    diff_bytes = bytearray()
+    body = bytearray()
+    i = start
+
+    def flush(seek):
+        nonlocal diff_len, extra, diff_bytes
+        body.extend(varint(diff_len) + varint(len(extra)) + varint(zigzag(seek)))
+        body.extend(diff_bytes)
+        body.extend(extra)
+        diff_len, extra, diff_bytes = 0, bytearray(), bytearray()
+
+    while i < end:
+        n = extend(old, src, new, i, end) if 0 <= src < len(old) else 0
+        if n >= MIN_RUN or (n and not extra and diff_len):
+            if extra:
+                flush(0)
+            diff_bytes.extend((new[i + k] - old[src + k]) & 0xFF for k in range(n))
+            diff_len += n
+            i += n
+            src += n
+            continue
+        best, best_len = None, 0
+        for p in index.get(new[i:i + KEY], ())[:8]:
+            m = exact(old, p, new, i, end)
+            if m > best_len:
+                best, best_len = p, m
+        if best is not None and best_len >= MIN_RUN and best != src:
+            flush(best - src)
+            src = best
+            continue
+        extra.append(new[i])
+        i += 1
+        src += 1           # gleiche Ausrichtung behalten: ein geaendertes Byte ersetzt eines
+    if diff_len or extra:
+        flush(0)
+    return bytes(body), src
+
+
+def make(args):
+    old = open(args.old, "rb").read()
+    new = open(args.new, "rb").read()
+    if args.block % 4096:
+        sys.exit("--block muss ein Vielfaches von 4096 sein (Flash-Sektor)")
+    index = build_index(old)
+    blocks, entries = [], []
+    src = 0
+    count = (len(new) + args.block - 1) // args.block
+    offset = HEADER.size + ENTRY.size * count
+    t0 = time.time()
+    for b in range(count):
+        start, end = b * args.block, min(len(new), (b + 1) * args.block)
+        body, next_src = diff_block(old, new, start, end, index, src)
+        packed = zlib.compress(body, 9)
+        entries.append(ENTRY.pack(offset, len(packed), src, zlib.crc32(new[start:end])))
+        blocks.append(packed)
+        offset += len(packed)
+        src = next_src
+    with open(args.out, "wb") as f:
+        f.write(HEADER.pack(MAGIC, image_hash(old), image_hash(new), len(new), args.block, count, 0))
+        f.write(b"".join(entries))
+        f.write(b"".join(blocks))
+    size = offset
+    print("%s: %d Byte fuer %d Byte neues Image (%.1f %%), %d Bloecke zu %d Byte, %.1f s" % (
+        args.out, size, len(new), 100.0 * size / len(new), count, args.block, time.time() - t0))
+
+
+# --- Delta anwenden (Referenz fuer src/delta_ota.cpp) ---
+
+def apply_block(old, packed, src, want):
+    body = zlib.decompress(packed)
+    out = bytearray()
+    pos = 0
+    while pos < len(body):
+        d, pos = read_varint(body, pos)
+        e, pos = read_varint(body, pos)
+        s, pos = read_varint(body, pos)
+        for k in range(d):
+            out.append((body[pos + k] + old[src + k]) & 0xFF)
+        pos += d
+        src += d
+        out += body[pos:pos + e]
+        pos += e
+        src += e + unzigzag(s)
+    if len(out) != want:
+        raise ValueError("Block ergibt %d statt %d Byte" % (len(out), want))
+    return bytes(out)
+
+
+def apply(args):
+    old = open(args.old, "rb").read()
+    patch = open(args.patch, "rb").read()
+    magic, h_old, h_new, size, block, count, _ = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        sys.exit("kein Delta")
+    if image_hash(old) != h_old:
+        sys.exit("Delta passt nicht zu %s" % args.old)
+    out = bytearray()
+    for b in range(count):
+        off, length, src, crc = ENTRY.unpack_from(patch, HEADER.size + ENTRY.size * b)
+        data = apply_block(old, patch[off:off + length], src, min(block, size - b * block))
+        if zlib.crc32(data) != crc:
+            sys.exit("Block %d: CRC falsch" % b)
+        out += data
+    if image_hash(bytes(out)) != h_new:
+        sys.exit("SHA-256 des Ergebnisses falsch")
+    open(args.out, "wb").write(out)
+    print("%s: %d Byte, SHA-256 stimmt" % (args.out, len(out)))
+
+
+# --- Ausliefern ---
+
+def make_handler(args):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def do_GET(self):
+            path = os.path.join(args.dir, os.path.basename(self.path))
+            try:
+                data = open(path, "rb").read()
+            except OSError:
+                self.send_response(404)
+                self.end_headers()
+                return
+            etag = '"%s"' % hashlib.sha1(data).hexdigest()[:16]
+            if self.headers.get("If-None-Match") == etag:
+                self.send_response(304)
+                self.send_header("ETag", etag)
+                self.end_headers()
+                print("%s %s: 304" % (self.client_address[0], self.path))
+                return
+            if self.headers.get("If-Match") not in (None, etag):
+                self.send_response(412)
+                self.end_headers()
+                print("%s %s: 412 (Datei geaendert)" % (self.client_address[0], self.path))
+                return
+            start, end = 0, len(data) - 1
+            rng = self.headers.get("Range")
+            if rng and rng.startswith("bytes="):
+                a, _, b = rng[6:].partition("-")
+                start = int(a)
+                end = min(int(b), len(data) - 1) if b else len(data) - 1
+                self.send_response(206)
+                self.send_header("Content-Range", "bytes %d-%d/%d" % (start, end, len(data)))
+            else:
+                self.send_response(200)
+            body = data[start:end + 1]
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("ETag", etag)
+            self.end_headers()
+            drop = random.random() < args.drop
+            cut = random.randint(0, len(body)) if drop else len(body)
+            sent = 0
+            chunk = max(1, args.rate // 20) if args.rate else len(body) or 1
+            gone = False
+            while sent < cut and not gone:
+                part = body[sent:min(cut, sent + chunk)]
+                try:
+                    self.wfile.write(part)
+                    self.wfile.flush()
+                except (BrokenPipeError, ConnectionResetError):
+                    gone = True   # Uhr hat ihr Zeitbudget erreicht
+                    break
+                sent += len(part)
+                if args.rate:
+                    time.sleep(len(part) / args.rate)
+            print("%s %s: %s Byte %d-%d%s" % (self.client_address[0], self.path, "206" if rng else "200",
+                                             start, start + sent - 1,
+                                             " von der Uhr abgebrochen" if gone else " abgebrochen" if drop else ""))
+
+        def log_message(self, *a):
+            pass
+
+    return Handler
+
+
+def serve(args):
+    server = http.server.ThreadingHTTPServer((args.bind, args.port), make_handler(args))
+    print("Delta-Server: %s auf %s:%d, %s" % (args.dir, args.bind, args.port,
+                                              "%d Byte/s" % args.rate if args.rate else "ungedrosselt"))
+    server.serve_forever()
+
+
+def main():
+    p = argparse.ArgumentParser(description="Delta-Updates fuer die Uhr")
+    sub = p.add_subparsers(dest="cmd", required=True)
+    m = sub.add_parser("make", help="Delta erzeugen")
+    m.add_argument("old")
+    m.add_argument("new")
+    m.add_argument("out")
+    m.add_argument("--block", type=int, default=32768, help="Byte des neuen Images je Block")
+    a = sub.add_parser("apply", help="Delta auf dem Rechner anwenden und pruefen")
+    a.add_argument("old")
+    a.add_argument("patch")
+    a.add_argument("out")
+    s = sub.add_parser("serve", help="Deltas per HTTP ausliefern (Range, ETag, Drossel)")
+    s.add_argument("--dir", default=".")
+    s.add_argument("--bind", default="0.0.0.0")
+    s.add_argument("--port", type=int, default=80)
+    s.add_argument("--rate", type=int, default=0, help="Byte/s, 0 = ungedrosselt")
+    s.add_argument("--drop", type=float, default=0.0, help="Anteil abgebrochener Antworten 0..1")
+    args = p.parse_args()
+    {"make": make, "apply": apply, "serve": serve}[args.cmd](args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# Driftmodell aus src/clock_drift.cpp auf dem Rechner mit künstlichen Verläufen.
+#
+# Die "echte" Uhr geht mit ppm(T) = base + curve * (T - turn)^2 (Quarz-Parabel,
+# RC-Oszillatoren mit --curve und --slope anpassen), die Raumtemperatur folgt
+# einem Tagesgang mit Rauschen. Alle --interval Tage ein Sync; dazwischen wird
+# minütlich korrigiert wie in driftTick(). Ausgegeben wird die größte
+# Abweichung vor dem Sync für: keine Korrektur, nur Mittelwert (ohne Sensor)
+# und Modell mit Temperaturterm.
+#
+#     python3 scripts/drift_sim.py --days 60 --interval 1 2 4 7
+#
+# Mit --trace DATEI ('-' = stdout) statt der Tabelle den Verlauf für den ersten
+# --interval: je Minute Sensorwert und wahrer Gang, dazu im Kopf die größten
+# Abweichungen dieses Modells. test/host/test_drift spielt ihn durch
+# clock_drift.cpp und vergleicht.
+
+import argparse
+import math
+import random
+import sys
+
+DRIFT_SAMPLES = 8
+DRIFT_MIN_INTERVAL_S = 3600
+DRIFT_MAX_PPM = 500.0
+DRIFT_MIN_TEMP_SPAN = 0.3
+
+
+class Estimator:
+    """Gleiche Rechnung wie clock_drift.cpp (fit, modelPpm, driftSynced)."""
+
+    def __init__(self, use_temp):
+        self.use_temp = use_temp
+        self.samples = []
+        self.model = False
+        self.a = self.b = self.t0 = 0.0
+        self.applied_us = 0.0
+        self.temp_sum = 0.0
+        self.temp_count = 0
+
+    def fit(self):
+        s = self.samples
+        self.model = bool(s)
+        if not s:
+            return
+        self.a = sum(p for _, p in s) / len(s)
+        self.b = 0.0
+        with_t = [(t, p) for t, p in s if t is not None]
+        self.t0 = sum(t for t, _ in with_t) / len(with_t) if with_t else 0.0
+        if len(with_t) >= 3:
+            mp = sum(p for _, p in with_t) / len(with_t)
+            cov = sum((t - self.t0) * (p - mp) for t, p in with_t)
+            var = sum((t - self.t0) ** 2 for t, _ in with_t)
+            if var / len(with_t) >= DRIFT_MIN_TEMP_SPAN ** 2:
+                self.b = cov / var
+                self.a = mp
+
+    def ppm(self, temp):
+        if not self.model:
+            return 0.0
+        if temp is None:
+            return self.a
+        return self.a + self.b * (temp - self.t0)
+
+    def tick(self, temp, dt):
+        t = temp if self.use_temp else None
+        if t is not None:
+            self.temp_sum += t
+            self.temp_count += 1
+        corr = -self.ppm(t) * dt
+        self.applied_us += corr
+        return corr
+
+    def synced(self, offset_us, interval):
+        if interval >= DRIFT_MIN_INTERVAL_S:
+            ppm = (-offset_us - self.applied_us) / interval
+            temp = self.temp_sum / self.temp_count if self.temp_count else None
+            if abs(ppm) < DRIFT_MAX_PPM:
+                self.samples = (self.samples + [(temp, ppm)])[-DRIFT_SAMPLES:]
+                self.fit()
+        self.applied_us = 0.0
+        self.temp_sum = 0.0
+        self.temp_count = 0
+
+
+def room_temp(minute, args, rng):
+    day = minute / 1440.0
+    daily = math.sin(2 * math.pi * (day - 0.375))            # Maximum am Nachmittag
+    seasonal = math.sin(2 * math.pi * day / 30.0)            # langsame Wetterlage
+    return args.mean + args.swing * daily + args.weather * seasonal + rng.gauss(0, args.noise)
+
+
+def true_ppm(temp, args):
+    return args.base + args.slope * (temp - args.turn) + args.curve * (temp - args.turn) ** 2
+
+
+def run(interval_days, mode, args, trace=None):
+    rng = random.Random(args.seed)
+    est = Estimator(use_temp=(mode == "temp")) if mode != "none" else None
+    err_us = 0.0                  # lokale Uhr minus wahre Zeit
+    worst = []
+    since_sync = 0
+    period = int(interval_days * 1440)
+    for minute in range(int(args.days * 1440)):
+        temp = room_temp(minute, args, rng)
+        ppm = true_ppm(temp, args)
+        err_us += ppm * 60
+        if est:
+            sensor = temp + rng.gauss(0, args.sensor_noise)
+            err_us += est.tick(sensor, 60)
+            if trace is not None:
+                trace.append((sensor, ppm))
+        since_sync += 1
+        if since_sync >= period:
+            if minute >= args.warmup * 1440:
+                worst.append(abs(err_us))
+            if est:
+                est.synced(-err_us, since_sync * 60)
+            err_us = 0.0
+            since_sync = 0
+    return max(worst) / 1000 if worst else float("nan")
+
+
+def main():
+    p = argparse.ArgumentParser(description="Driftmodell mit künstlichen Temperatur-/Gangverläufen")
+    p.add_argument("--days", type=float, default=60)
+    p.add_argument("--warmup", type=float, default=14, help="Tage, bevor gewertet wird")
+    p.add_argument("--interval", type=float, nargs="+", default=[1, 2, 4, 7], help="Sync-Abstand in Tagen")
+    p.add_argument("--mean", type=float, default=21.0, help="mittlere Raumtemperatur °C")
+    p.add_argument("--swing", type=float, default=3.0, help="Tagesgang ± °C")
+    p.add_argument("--weather", type=float, default=2.0, help="langsamer Gang ± °C")
+    p.add_argument("--noise", type=float, default=0.2, help="Rauschen der Raumtemperatur °C")
+    p.add_argument("--sensor-noise", type=float, default=0.3, help="Messrauschen des Sensors °C")
+    p.add_argument("--base", type=float, default=12.0, help="Gang bei --turn in ppm")
+    p.add_argument("--slope", type=float, default=0.0, help="linearer Anteil ppm/°C (RC-Oszillator)")
+    p.add_argument("--curve", type=float, default=-0.034, help="Parabel ppm/°C² (Quarz)")
+    p.add_argument("--turn", type=float, default=25.0, help="Umkehrpunkt °C")
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--trace", help="Verlauf für den ersten --interval schreiben ('-' = stdout)")
+    args = p.parse_args()
+
+    if args.trace:
+        d = args.interval[0]
+        trace = []
+        worst = [run(d, "none", args), run(d, "mean", args), run(d, "temp", args, trace)]
+        out = sys.stdout if args.trace == "-" else open(args.trace, "w")
+        # Kopf: Sync-Abstand und Wertungsbeginn in Minuten, größte Abweichung (ms) ohne/Mittelwert/Temperatur
+        out.write(f"# {int(d * 1440)} {int(args.warmup * 1440)} {worst[0]:.3f} {worst[1]:.3f} {worst[2]:.3f}\n")
+        for sensor, ppm in trace:
+            out.write(f"{sensor:.4f} {ppm:.5f}\n")
+        out.flush()
+        return
+
+    print("größte Abweichung vor dem Sync (ms)")
+    print(f"{'Abstand':>8} {'ohne':>9} {'Mittelwert':>11} {'Temperatur':>11}")
+    for d in args.interval:
+        print(f"{d:>6g} d {run(d, 'none', args):9.1f} {run(d, 'mean', args):11.1f} {run(d, 'temp', args):11.1f}")
+
+
+if __name__ == "__main__":
+    main()
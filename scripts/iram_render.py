@@ -0,0 +1,110 @@
+# Renderpfad ins IRAM, Glyphen ins DRAM (env wemos_d1_mini32_iram, -DCLOCK_IRAM_RENDER).
+#
+# Die eigenen Funktionen sind mit CLOCK_HOT markiert (include/clock_core.h). U8g2 wird
+# als Bibliothek aus den Quellen gebaut; dort benennt objcopy die Abschnitte der
+# heißen Funktionen (-ffunction-sections: .text.<name>, .literal.<name>) in
+# .iram1.<name> um und die benutzten Schriften (.rodata.<name>) in .dram1.<name>.
+# Das Linker-Skript von ESP-IDF legt .iram1.* ins IRAM und .dram1.* ins DRAM.
+#
+# Nach dem Linken folgt der IRAM-Bericht: belegt, frei, davon Renderpfad;
+# unterschreitet die freie Reserve custom_iram_reserve, bricht der Build ab.
+import re
+import subprocess
+
+Import("env")
+
+# u8g2-Funktionen, die beim Zeichnen einer Minute laufen
+HOT_FUNCTIONS = [
+    # Schrift dekodieren und zeichnen (u8g2_font.c)
+    "u8g2_font_get_glyph_data", "u8g2_font_setup_decode", "u8g2_font_decode_get_unsigned_bits",
+    "u8g2_font_decode_get_signed_bits", "u8g2_font_decode_len", "u8g2_font_decode_glyph",
+    "u8g2_font_draw_glyph", "u8g2_DrawGlyph", "u8g2_draw_string", "u8g2_DrawStr",
+    # Linien in den Seitenpuffer (u8g2_hvline.c, u8g2_ll_hvline.c, u8g2_intersection.c)
+    "u8g2_DrawHVLine", "u8g2_draw_hv_line_2dir", "u8g2_clip_intersection2",
+    "u8g2_ll_hvline_vertical_top_lsb", "u8g2_IsIntersection", "u8g2_is_intersection_decision_tree",
+    # Puffer senden (u8g2_buffer.c, u8x8_display.c, Treiber SH1106)
+    "u8g2_ClearBuffer", "u8g2_send_tile_row", "u8g2_send_buffer", "u8g2_SendBuffer",
+    "u8g2_UpdateDisplayArea", "u8x8_DrawTile", "u8x8_d_sh1106_128x64_noname",
+    "u8x8_d_ssd1306_sh1106_generic",
+    # I2C-Übertragung (u8x8_cad.c, u8x8_byte.c, U8x8lib.cpp)
+    "u8x8_cad_ssd13xx_fast_i2c", "u8x8_cad_SendCmd", "u8x8_cad_SendArg", "u8x8_cad_SendData",
+    "u8x8_cad_StartTransfer", "u8x8_cad_EndTransfer", "u8x8_byte_SendByte", "u8x8_byte_SendBytes",
+    "u8x8_byte_StartTransfer", "u8x8_byte_EndTransfer", "u8x8_byte_arduino_hw_i2c",
+]
+
+# Schriften der Zifferblätter (include/clock_core.h, ClockFace)
+HOT_FONTS = [
+    "u8g2_font_logisoso42_tr", "u8g2_font_logisoso32_tn", "u8g2_font_fur42_tn",
+]
+
+# eigene CLOCK_HOT-Funktionen, nur für den Bericht
+OWN_FUNCTIONS = [
+    "composeFace", "composeTime", "drawCentered", "selectFace", "nightEdge", "renderTime",
+    "clockLitPixels", "noteLatency", "panelApply", "panelCrop", "u8x8ByteI2c",
+]
+
+IRAM_START, IRAM_END = 0x40080000, 0x400A0000
+DRAM_START, DRAM_END = 0x3FFAE000, 0x40000000
+
+
+def tool(name):
+    # $OBJCOPY ist bei espressif32 esptool.py; die Binutils liegen neben dem Compiler
+    return re.sub(r"gcc(\.exe)?$", name + r"\1", env.subst("$CC"))
+
+
+def rename_args():
+    args = []
+    for f in HOT_FUNCTIONS:
+        args += ["--rename-section", ".text.%s=.iram1.%s" % (f, f)]
+        args += ["--rename-section", ".literal.%s=.iram1.%s.literal" % (f, f)]
+    for f in HOT_FONTS:
+        args += ["--rename-section", ".rodata.%s=.dram1.%s" % (f, f)]
+    return args
+
+
+def move_sections(target, source, env):
+    for obj in target:
+        subprocess.check_call([tool("objcopy")] + rename_args() + [obj.get_abspath()])
+
+
+def hot_objects(env, node):
+    obj = env.Object(node)
+    env.AddPostAction(obj, move_sections)
+    return obj
+
+
+for pattern in ("*/U8g2/src/clib/*.c", "*/U8g2/src/U8x8lib.cpp"):
+    env.AddBuildMiddleware(hot_objects, pattern)
+
+
+def iram_report(target, source, env):
+    elf = target[0].get_abspath()
+    sizes = subprocess.check_output([env.subst("$SIZETOOL"), "-A", elf]).decode()
+    iram = sum(int(m.group(1)) for m in re.finditer(r"^\.iram0\.\w+\s+(\d+)", sizes, re.M))
+    budget = int(env.GetProjectOption("custom_iram_size", str(IRAM_END - IRAM_START)))
+    reserve = int(env.GetProjectOption("custom_iram_reserve", "4096"))
+
+    moved = {"IRAM": 0, "DRAM": 0}
+    names = set(HOT_FUNCTIONS + HOT_FONTS + OWN_FUNCTIONS)
+    symbols = subprocess.check_output([tool("nm"), "-S", "-C", elf]).decode()
+    for line in symbols.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) < 4:
+            continue
+        addr, size, name = int(parts[0], 16), int(parts[1], 16), parts[3]
+        if not any(n in name for n in names):
+            continue
+        if IRAM_START <= addr < IRAM_END:
+            moved["IRAM"] += size
+        elif DRAM_START <= addr < DRAM_END:
+            moved["DRAM"] += size
+
+    free = budget - iram
+    print("IRAM: %d von %d Byte belegt, %d frei (Reserve %d)" % (iram, budget, free, reserve))
+    print("Renderpfad: %d Byte im IRAM, Schriften %d Byte im DRAM" % (moved["IRAM"], moved["DRAM"]))
+    if free < reserve:
+        print("IRAM-Budget überschritten: weniger als %d Byte frei" % reserve)
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", iram_report)
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# Binaerprotokoll der Uhr lesbar machen (src/clock_log.cpp).
+#
+# Liest die serielle Ausgabe (direkt mit --port oder einen Mitschnitt), laesst
+# Text wie die Antworten der Konsolenbefehle durch und setzt die Rahmen des
+# Protokolls mit der Meldungstabelle wieder zu Text zusammen:
+#
+#     python3 scripts/log_decode.py --port /dev/ttyUSB0 --table .pio/build/wemos_d1_mini32/log_table.json
+#     python3 scripts/log_decode.py mitschnitt.bin
+#
+# Ohne --table wird die Tabelle aus include/log_messages.h gelesen (passt zum
+# aktuellen Stand der Quellen, nicht unbedingt zur Firmware auf der Uhr). Die
+# Uhr meldet beim Start die Pruefsumme ihrer Tabelle; bei Abweichung gibt es eine
+# Warnung. --port braucht pyserial; Eingaben auf stdin gehen dann an die Konsole
+# der Uhr ("flush" gibt den Ring sofort aus).
+
+import argparse
+import json
+import os
+import re
+import sys
+import threading
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import log_table  # noqa: E402
+
+SYNC = 0x1F
+LEVEL_MARK = {"ERROR": "E", "WARN": "W", "INFO": "I", "DEBUG": "D"}
+SPEC = re.compile(r"%([-+ 0#]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXc%])")
+
+
+def render(fmt, args):
+    it = iter(args)
+
+    def sub(m):
+        flags, conv = m.groups()
+        if conv == "%":
+            return "%"
+        v = next(it, None)
+        if v is None:
+            return "<?>"
+        if conv in "uxX":
+            v &= 0xFFFFFFFF
+        if conv == "c":
+            return chr(v & 0xFF)
+        return ("%" + flags + ("d" if conv in "diu" else conv)) % v
+
+    return SPEC.sub(sub, fmt)
+
+
+def varints(data):
+    values, value, shift = [], 0, 0
+    for b in data:
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            values.append(value)
+            value, shift = 0, 0
+        elif shift > 28:
+            return None
+    return values if shift == 0 else None
+
+
+class Decoder:
+    def __init__(self, messages, table, out):
+        self.messages = messages
+        self.table = table
+        self.out = out
+        self.buf = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        i = 0
+        while i < len(self.buf):
+            b = self.buf[i]
+            if b != SYNC:
+                self.text.append(b)
+                if b == 0x0A:
+                    self.flush_text()
+                i += 1
+                continue
+            if i + 2 > len(self.buf) or i + 3 + self.buf[i + 1] > len(self.buf):
+                break   # Rahmen noch unvollstaendig
+            n = self.buf[i + 1]
+            payload = bytes(self.buf[i + 2:i + 2 + n])
+            values = varints(payload)
+            if sum(payload) & 0xFF != self.buf[i + 2 + n] or not values or len(values) < 2:
+                i += 1   # kein gueltiger Rahmen: Byte verwerfen, weitersuchen
+                continue
+            if self.text:
+                self.text.append(0x0A)   # angefangene Textzeile abschliessen
+            self.flush_text()
+            self.frame(values[0], values[1], [(v >> 1) ^ -(v & 1) for v in values[2:]])
+            i += 3 + n
+        del self.buf[:i]
+
+    def flush_text(self):
+        if self.text:
+            self.out.write(self.text.decode("utf-8", errors="replace"))
+            self.text.clear()
+            self.out.flush()
+
+    def frame(self, ms, msg_id, args):
+        if msg_id < len(self.messages):
+            m = self.messages[msg_id]
+            line = "%s %s" % (LEVEL_MARK[m["level"]], render(m["text"], args))
+            if m["name"] == "MSG_LOG_START" and args and args[0] and (args[0] & 0xFFFFFFFF) != self.table:
+                line += "  (Warnung: Tabelle hier %08x, Firmware passt nicht dazu)" % self.table
+        else:
+            line = "? Meldung %d %s (Tabelle zu alt?)" % (msg_id, args)
+        self.out.write("[%10.3f s] %s\n" % (ms / 1000.0, line))
+        self.out.flush()
+
+
+def load_table(path):
+    if path:
+        with open(path, encoding="utf-8") as f:
+            t = json.load(f)
+        return t["messages"], int(t["table"], 16)
+    header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "log_messages.h")
+    messages = log_table.parse(header)
+    return messages, log_table.checksum(messages)
+
+
+def main():
+    p = argparse.ArgumentParser(description="Binaerprotokoll der Uhr dekodieren")
+    p.add_argument("input", nargs="?", help="Mitschnitt der seriellen Ausgabe, - = stdin")
+    p.add_argument("--port", help="serielle Schnittstelle statt Datei (pyserial)")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--table", help="log_table.json aus dem Build, sonst include/log_messages.h")
+    args = p.parse_args()
+
+    messages, table = load_table(args.table)
+    dec = Decoder(messages, table, sys.stdout)
+    if args.port:
+        import serial
+        port = serial.Serial(args.port, args.baud, timeout=0.2)
+
+        def forward():
+            for line in sys.stdin:
+                port.write(line.encode("utf-8"))
+
+        threading.Thread(target=forward, daemon=True).start()
+        while True:
+            data = port.read(256)
+            if data:
+                dec.feed(data)
+    else:
+        src = sys.stdin.buffer if args.input in (None, "-") else open(args.input, "rb")
+        while True:
+            data = src.read(4096)
+            if not data:
+                break
+            dec.feed(data)
+        dec.flush_text()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,62 @@
+# Meldungstabelle fuer das Binaerprotokoll der Uhr (include/log_messages.h, src/clock_log.cpp).
+#
+# Als PlatformIO-Skript (extra_scripts = pre:scripts/log_table.py) schreibt es bei
+# jedem Build .pio/build/<env>/log_table.json und gibt die Pruefsumme der Tabelle
+# als CLOCK_LOG_TABLE an den Compiler. Die Uhr meldet sie beim Start
+# (MSG_LOG_START); scripts/log_decode.py warnt, wenn Mitschnitt und Tabelle nicht
+# zusammenpassen.
+#
+# Von Hand:
+#     python3 scripts/log_table.py include/log_messages.h log_table.json
+import json
+import os
+import re
+import sys
+import zlib
+
+ENTRY = re.compile(r'X\(\s*(\w+)\s*,\s*CLOG_(ERROR|WARN|INFO|DEBUG)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+ESCAPES = {"n": "\n", "t": "\t"}
+
+
+def parse(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    start = text.index("#define CLOCK_LOG_MESSAGES")
+    messages = []
+    for m in ENTRY.finditer(text, start):
+        name, level, fmt = m.groups()
+        fmt = re.sub(r"\\(.)", lambda e: ESCAPES.get(e.group(1), e.group(1)), fmt)
+        messages.append({"id": len(messages), "name": name, "level": level, "text": fmt})
+    if not messages:
+        raise ValueError("%s: keine Meldungen gefunden" % path)
+    return messages
+
+
+def checksum(messages):
+    canonical = json.dumps([[m["name"], m["level"], m["text"]] for m in messages], ensure_ascii=False)
+    return zlib.crc32(canonical.encode("utf-8"))
+
+
+def write(messages, out):
+    with open(out, "w", encoding="utf-8") as f:
+        json.dump({"table": "%08x" % checksum(messages), "messages": messages}, f, ensure_ascii=False, indent=1)
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO/SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    messages = parse(os.path.join(env.subst("$PROJECT_DIR"), "include", "log_messages.h"))
+    build_dir = env.subst("$BUILD_DIR")
+    os.makedirs(build_dir, exist_ok=True)
+    write(messages, os.path.join(build_dir, "log_table.json"))
+    env.Append(CPPDEFINES=[("CLOCK_LOG_TABLE", "0x%08x" % checksum(messages))])
+    print("Meldungstabelle: %d Meldungen, Pruefsumme %08x" % (len(messages), checksum(messages)))
+elif __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("Aufruf: log_table.py include/log_messages.h log_table.json")
+    messages = parse(sys.argv[1])
+    write(messages, sys.argv[2])
+    print("%s: %d Meldungen, Pruefsumme %08x" % (sys.argv[2], len(messages), checksum(messages)))
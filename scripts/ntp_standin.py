@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# Lokaler NTP-Ersatz fuer Versuche mit syncTime() ohne Internet.
+#
+# Beantwortet SNTP-Anfragen mit der Zeit des Rechners plus einstellbarem
+# Versatz. Verzoegerung, Schwankung, Paketverlust und Kiss-of-Death-Antworten
+# lassen sich einstellen, um das Verhalten der Uhr bei schlechtem Netz zu sehen
+# (Radio-an-Zeit und Sync-Dauer stehen danach im Telemetrie-Protokoll, `log`).
+#
+# Aufruf (Port 123 braucht Root-Rechte):
+#     sudo python3 scripts/ntp_standin.py --offset 3.5 --delay 0.2 --jitter 0.1 --loss 0.3
+# Firmware dazu mit -DNTP_SERVER=\"192.168.1.10\" bauen.
+#
+# Mit --dns-port 53 beantwortet das Skript zusaetzlich DNS-Anfragen (A-Record)
+# fuer jeden Namen mit --dns-answer und --dns-ttl, um den DNS-Cache der Uhr zu
+# pruefen (src/ntp_dns.cpp). Firmware dann mit -DNTP_DNS_SERVER=\"192.168.1.10\"
+# bauen, NTP_SERVER bleibt der Pool-Name:
+#     sudo python3 scripts/ntp_standin.py --dns-port 53 --dns-answer 192.168.1.10 --dns-ttl 86400 --dns-delay 0.08
+
+import argparse
+import random
+import select
+import socket
+import struct
+import time
+
+NTP_EPOCH = 2208988800  # 1900-01-01 bis 1970-01-01 in Sekunden
+
+
+def to_ntp(t):
+    sec = int(t) + NTP_EPOCH
+    frac = int((t - int(t)) * (1 << 32)) & 0xFFFFFFFF
+    return (sec << 32) | frac
+
+
+def build_reply(request, recv_time, offset, kod):
+    vn = (request[0] >> 3) & 0x07 or 4
+    poll = request[2]
+    originate = request[40:48]  # Sendezeit des Clients zurueckgeben
+
+    if kod:
+        # Stratum 0 mit ASCII-Code im Reference-ID: Client soll aufhoeren oder warten
+        li_vn_mode = (3 << 6) | (vn << 3) | 4
+        stratum, ref_id, ts = 0, kod.encode("ascii")[:4].ljust(4, b" "), 0
+        return struct.pack("!BBbbII4sQ8sQQ", li_vn_mode, stratum, poll, -20, 0, 0,
+                           ref_id, ts, originate, ts, ts)
+
+    li_vn_mode = (0 << 6) | (vn << 3) | 4
+    now = time.time() + offset
+    return struct.pack("!BBbbII4sQ8sQQ", li_vn_mode, 2, poll, -20,
+                       0x00000100, 0x00000100, b"LOCL",
+                       to_ntp(now - 16), originate, to_ntp(recv_time + offset), to_ntp(now))
+
+
+def dns_reply(query, answer, ttl):
+    # Frage uebernehmen, eine Antwort mit Zeiger auf den Namen in der Frage
+    if len(query) < 12 or query[2] & 0x80:
+        return None
+    end = 12
+    while end < len(query) and query[end] != 0:
+        end += query[end] + 1
+    question = query[12:end + 5]
+    qtype = struct.unpack("!H", query[end + 1:end + 3])[0] if end + 3 <= len(query) else 0
+    header = query[:2] + struct.pack("!HHHHH", 0x8180, 1, 1 if qtype == 1 else 0, 0, 0)
+    if qtype != 1:
+        return header + question
+    rr = struct.pack("!HHHIH", 0xC00C, 1, 1, ttl, 4) + socket.inet_aton(answer)
+    return header + question + rr
+
+
+def main():
+    p = argparse.ArgumentParser(description="Lokaler NTP-Server mit einstellbaren Stoerungen")
+    p.add_argument("--bind", default="0.0.0.0")
+    p.add_argument("--port", type=int, default=123)
+    p.add_argument("--offset", type=float, default=0.0, help="Versatz der gelieferten Zeit in s")
+    p.add_argument("--delay", type=float, default=0.0, help="Antwortverzoegerung in s")
+    p.add_argument("--jitter", type=float, default=0.0, help="zusaetzliche zufaellige Verzoegerung bis s")
+    p.add_argument("--loss", type=float, default=0.0, help="Anteil verworfener Anfragen 0..1")
+    p.add_argument("--kod", type=float, default=0.0, help="Anteil Kiss-of-Death-Antworten 0..1")
+    p.add_argument("--kod-code", default="RATE", help="RATE, DENY oder RSTR")
+    p.add_argument("--dns-port", type=int, default=0, help="DNS-Ersatz auf diesem Port, 0 = aus")
+    p.add_argument("--dns-answer", default="127.0.0.1", help="Adresse fuer jede A-Anfrage")
+    p.add_argument("--dns-ttl", type=int, default=86400, help="TTL der Antwort in s")
+    p.add_argument("--dns-delay", type=float, default=0.0, help="Antwortverzoegerung DNS in s")
+    args = p.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    print(f"NTP-Ersatz auf {args.bind}:{args.port}, Versatz {args.offset:+.3f} s")
+    dns = None
+    if args.dns_port:
+        dns = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        dns.bind((args.bind, args.dns_port))
+        print(f"DNS-Ersatz auf {args.bind}:{args.dns_port}: {args.dns_answer}, TTL {args.dns_ttl} s")
+
+    while True:
+        ready, _, _ = select.select([s for s in (sock, dns) if s], [], [])
+        if dns in ready:
+            query, addr = dns.recvfrom(512)
+            reply = dns_reply(query, args.dns_answer, args.dns_ttl)
+            if reply:
+                if args.dns_delay > 0:
+                    time.sleep(args.dns_delay)
+                dns.sendto(reply, addr)
+                print(f"{addr[0]}: DNS-Antwort nach {args.dns_delay * 1000:.0f} ms")
+        if sock not in ready:
+            continue
+        request, addr = sock.recvfrom(512)
+        recv_time = time.time()
+        if len(request) < 48:
+            continue
+        if random.random() < args.loss:
+            print(f"{addr[0]}: verworfen")
+            continue
+        wait = args.delay + random.uniform(0, args.jitter)
+        if wait > 0:
+            time.sleep(wait)
+        kod = args.kod_code if random.random() < args.kod else None
+        sock.sendto(build_reply(request, recv_time, args.offset, kod), addr)
+        print(f"{addr[0]}: {'KoD ' + kod if kod else 'Antwort'} nach {wait * 1000:.0f} ms")
+
+
+if __name__ == "__main__":
+    main()
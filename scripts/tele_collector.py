@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# Lokaler Sammler fuer den Telemetrie-Upload der Uhr (src/tele_upload.cpp).
+#
+# Nimmt Bloecke per UDP (Bestaetigung "ACK1" + naechste Nummer) und per HTTP-POST
+# (Antwort 204) an, entpackt sie und gibt Kopf und Eintraege aus; mit --out
+# zusaetzlich je Block eine JSON-Zeile. Verzoegerung und Verlust lassen sich
+# einstellen, um das Zeitbudget der Uhr zu pruefen: bei --delay ueber
+# TELE_UPLOAD_BUDGET_MS bricht die Uhr ab und sendet beim naechsten Sync erneut.
+# --drop-ack n nimmt die ersten n Bloecke an, bestaetigt sie aber nicht (verlorene
+# Bestaetigung): die Uhr sendet dieselben Nummern noch einmal.
+#
+# Aufruf:
+#     python3 scripts/tele_collector.py --out tele.jsonl --delay 0.05 --loss 0.2
+# Firmware dazu mit -DTELE_UPLOAD_HOST=\"192.168.1.10\" bauen (HTTP zusaetzlich
+# mit -DTELE_UPLOAD_HTTP).
+
+import argparse
+import http.server
+import json
+import random
+import socket
+import struct
+import threading
+import time
+
+# Reihenfolge wie TelemetryType in include/telemetry.h
+TYPES = ["none", "boot", "wake/h", "storm", "heap", "radio", "sync", "stub", "ulp",
+         "dns", "drift", "upload", "config", "ota"]
+
+HEADER = struct.Struct("<4s6sIHIIIIIHB")
+
+
+def varint(data, pos):
+    value, shift = 0, 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def decode(data):
+    magic, mac, first, count, base, uptime, heap_free, heap_min, largest, sleep, reset = \
+        HEADER.unpack_from(data)
+    if magic != b"CTU1":
+        raise ValueError("kein Telemetrie-Block")
+    block = {
+        "mac": mac.hex(":"), "first": first, "count": count, "uptime": uptime,
+        "heap_free": heap_free, "heap_min": heap_min, "heap_largest": largest,
+        "light_sleep_permille": sleep, "reset_reason": reset, "records": [],
+    }
+    pos, t = HEADER.size, base
+    for _ in range(count):
+        dt, pos = varint(data, pos)
+        t += (dt >> 1) ^ -(dt & 1)
+        rtype, flags, mask = data[pos], data[pos + 1], data[pos + 2]
+        pos += 3
+        values = []
+        for i in range(5):
+            v = 0
+            if mask & (1 << i):
+                v, pos = varint(data, pos)
+            values.append(v)
+        block["records"].append({"time": t, "type": TYPES[rtype] if rtype < len(TYPES) else rtype,
+                                 "flags": flags, "v": values})
+    if pos != len(data):
+        raise ValueError("%d Byte uebrig" % (len(data) - pos))
+    return block
+
+
+class Collector:
+    def __init__(self, args):
+        self.args = args
+        self.lock = threading.Lock()
+        self.next = {}   # MAC -> naechste erwartete Nummer
+        self.acks_to_drop = args.drop_ack
+
+    def accept(self, data, peer):
+        if random.random() < self.args.loss:
+            print("%s: verworfen (--loss)" % peer)
+            return None
+        time.sleep(self.args.delay)
+        block = decode(data)
+        with self.lock:
+            expected = self.next.get(block["mac"])
+            dup = expected is not None and block["first"] < expected
+            self.next[block["mac"]] = block["first"] + block["count"]
+            print("%s %s: %d Byte, Nummern %d..%d, Laufzeit %d s, Heap %d (min %d, Block %d), "
+                  "Light-Sleep %.1f %%, Reset %d%s" % (
+                      peer, block["mac"], len(data), block["first"], block["first"] + block["count"],
+                      block["uptime"], block["heap_free"], block["heap_min"], block["heap_largest"],
+                      block["light_sleep_permille"] / 10, block["reset_reason"],
+                      " (wiederholt)" if dup else ""))
+            for r in block["records"]:
+                print("  %s  %-8s %3d %s" % (time.strftime("%d.%m. %H:%M:%S", time.localtime(r["time"])),
+                                             r["type"], r["flags"], " ".join("%5d" % v for v in r["v"])))
+            if self.args.out:
+                block["repeated"] = dup
+                block["received"] = time.time()
+                block["bytes"] = len(data)
+                with open(self.args.out, "a") as f:
+                    f.write(json.dumps(block) + "\n")
+        return block
+
+    def drop_ack(self):
+        with self.lock:
+            if self.acks_to_drop <= 0:
+                return False
+            self.acks_to_drop -= 1
+            return True
+
+
+def serve_udp(collector, sock):
+    while True:
+        data, peer = sock.recvfrom(2048)
+        try:
+            block = collector.accept(data, "%s:%d udp" % peer)
+        except (ValueError, IndexError, struct.error) as e:
+            print("%s: %s" % (peer[0], e))
+            continue
+        if block and collector.drop_ack():
+            print("%s: Bestaetigung unterdrueckt (--drop-ack)" % peer[0])
+        elif block:
+            sock.sendto(b"ACK1" + struct.pack("<I", block["first"] + block["count"]), peer)
+
+
+def make_handler(collector, path):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def do_POST(self):
+            data = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+            if self.path != path:
+                self.send_response(404)
+                self.end_headers()
+                return
+            try:
+                block = collector.accept(data, "%s:%d http" % self.client_address)
+            except (ValueError, IndexError, struct.error) as e:
+                print("%s: %s" % (self.client_address[0], e))
+                self.send_response(400)
+                self.end_headers()
+                return
+            if block is None or collector.drop_ack():
+                self.close_connection = True   # wie ein verlorenes Paket: keine Antwort
+                return
+            self.send_response(204)
+            self.end_headers()
+
+        def log_message(self, *args):
+            pass
+
+    return Handler
+
+
+def main():
+    p = argparse.ArgumentParser(description="Sammler fuer den Telemetrie-Upload der Uhr")
+    p.add_argument("--bind", default="0.0.0.0")
+    p.add_argument("--port", type=int, default=8471, help="UDP- und HTTP-Port (TELE_UPLOAD_PORT)")
+    p.add_argument("--path", default="/telemetry", help="HTTP-Pfad (TELE_UPLOAD_PATH)")
+    p.add_argument("--delay", type=float, default=0.0, help="Antwortverzoegerung in s")
+    p.add_argument("--loss", type=float, default=0.0, help="Anteil unbeantworteter Bloecke 0..1")
+    p.add_argument("--drop-ack", type=int, default=0, help="die ersten n Bloecke nicht bestaetigen")
+    p.add_argument("--out", help="je Block eine JSON-Zeile anhaengen")
+    args = p.parse_args()
+
+    collector = Collector(args)
+    # vor der Meldung "Sammler auf" gebunden, die Host-Tests warten darauf
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    threading.Thread(target=serve_udp, args=(collector, sock), daemon=True).start()
+    server = http.server.ThreadingHTTPServer((args.bind, args.port), make_handler(collector, args.path))
+    print("Sammler auf %s:%d (UDP und HTTP %s)" % (args.bind, args.port, args.path))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
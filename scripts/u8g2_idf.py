@@ -0,0 +1,11 @@
+# U8g2 bringt neben dem C-Kern (src/clib) die C++-Wrapper fuer Arduino mit.
+# Im ESP-IDF-Build werden nur die C-Quellen gebraucht, die Wrapper werden
+# aus dem Build genommen (sie binden Arduino.h ein).
+Import("env")
+
+
+def skip_arduino_wrapper(node):
+    return None
+
+
+env.AddBuildMiddleware(skip_arduino_wrapper, "*/U8g2/src/*.cpp")
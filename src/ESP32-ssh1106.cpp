@@ -42,172 +42,424 @@
 
 */
 
+#ifdef ARDUINO   // ESP-IDF-Build: siehe main_idf.cpp
+
 #include <Arduino.h>
 #include <Wire.h>
 #include <SPI.h>
 #include <U8g2lib.h>
-#include <secrets.h>
 #include <WiFi.h>
 #include "esp_wifi.h"
+#include "esp_timer.h"
+#include <sys/time.h>
 #include <time.h>
-
+#include "clock_core.h"
+#include "power.h"
+#include "wake_stats.h"
+#include "telemetry.h"
+#include "console.h"
+#include "clock_events.h"
+#include "alloc_guard.h"
+#include "heap_monitor.h"
+#include "radio_guard.h"
+#include "wifi_tune.h"
+#include "wifi_creds.h"
+#include "wake_stub.h"
+#include "ulp_clock.h"
+#include "panel.h"
+#include "ntp_dns.h"
+#include "clock_drift.h"
+#include "tele_upload.h"
+#include "clock_config.h"
+#include "delta_ota.h"
+#include "clock_log.h"
+#include "clock_sync.h"
+
+#ifdef CLOCK_ULP
+# define oled_CLK ULP_OLED_SCL   // RTC-GPIOs, damit der ULP das Display erreicht
+# define oled_SDA ULP_OLED_SDA
+#else
 # define oled_CLK 22
 # define oled_SDA 21
+#endif
 
-const char *ssid = SECRET_SSID;
-const char *password = SECRET_PASS;
-
-U8G2_SH1106_128X64_NONAME_F_HW_I2C oled(U8G2_R2, /* reset=*/ U8X8_PIN_NONE, /* clock=*/ oled_CLK, /* data=*/ oled_SDA); // SH1106 128x64 via I2C
+U8G2_SH1106_128X64_NONAME_F_HW_I2C oled(OLED_ROTATION, /* reset=*/ U8X8_PIN_NONE, /* clock=*/ oled_CLK, /* data=*/ oled_SDA); // SH1106 128x64 via I2C
 
-// Berlin/Europa mit DST
-#define TIMEZONE "CET-1CEST,M3.5.0/02,M10.5.0/3"
-
-static int lastDisplayedMinute = -1; 
+#if defined(CLOCK_DEEP_SLEEP) || defined(CLOCK_ULP)
+RTC_DATA_ATTR static ClockState clockState;   // übersteht den Tiefschlaf
+#else
+static ClockState clockState;
+#endif
 static int lastSyncDay = -1;
+static bool firstFrameLogged = false;
+static TaskHandle_t loopTaskHandle;
+
+// Paralleler Boot: WLAN und NTP laufen in einer Task auf Kern 0, während loop()
+// auf Kern 1 das Display bedient. Im Tiefschlaf-Betrieb und mit
+// -DCLOCK_SERIAL_BOOT (zum Vergleich) bleibt es bei der alten Reihenfolge.
+#if !defined(CLOCK_SERIAL_BOOT) && !defined(CLOCK_DEEP_SLEEP) && !defined(CLOCK_ULP)
+#define CLOCK_PARALLEL_BOOT
+#endif
+#ifdef CLOCK_PARALLEL_BOOT
+static volatile bool bootSyncRunning = false;
+static volatile int8_t bootSyncResult = -1;      // -1 = läuft noch, sonst 0/1
+static const char* volatile pendingStatus;       // Statusmeldung der Boot-Task für loop()
+#endif
 
 // --- WiFi trennen ---
 void disconnectWiFi() {
+#ifdef CLOCK_STATIC_ALLOC
+  // Treiber bleibt initialisiert, damit der nächste Sync seine Puffer nicht neu anlegt
+  WiFi.disconnect(false, false);
+  esp_wifi_stop();
+#else
   WiFi.disconnect(true, true);
   WiFi.mode(WIFI_OFF);
-  Serial.println("WLAN aus");
+#endif
+}
+
+// --- WLAN-Verbindung für wifiConnect() ---
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    wifiAttemptEvent(true, nullptr, 0);
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    wifiAttemptEvent(false, info.wifi_sta_disconnected.ssid, info.wifi_sta_disconnected.ssid_len);
+  }
+}
+
+static void wifiOpsBegin(const WifiCred& cred, const WifiTuneHint& hint) {
+  wifiAttemptBegin(cred.ssid);
+  if (hint.channel) {
+    WiFi.begin(cred.ssid, cred.pass, hint.channel, hint.bssidValid ? hint.bssid : nullptr);  // ohne Kanalscan
+  } else {
+    WiFi.begin(cred.ssid, cred.pass);
+  }
+}
+
+static uint8_t wifiOpsPoll() {
+  return wifiAttemptState();
+}
+
+static void wifiOpsAbort() {
+  // wartet auf das Disconnect-Ereignis, bevor der nächste Versuch beginnt
+  wifiAttemptAbort([] { WiFi.disconnect(false, false); });
+}
+
+static int wifiOpsScan(WifiScanRecord* out, int max) {
+  int16_t n = WiFi.scanNetworks(false, false, false, 60);  // 60 ms je Kanal
+  if (n < 0) return -1;
+  int k = 0;
+  for (int i = 0; i < n && k < max; ++i, ++k) {
+    strncpy(out[k].ssid, WiFi.SSID(i).c_str(), sizeof(out[k].ssid) - 1);
+    out[k].ssid[sizeof(out[k].ssid) - 1] = '\0';
+    out[k].rssi = WiFi.RSSI(i);
+    out[k].channel = WiFi.channel(i);
+    memcpy(out[k].bssid, WiFi.BSSID(i), sizeof(out[k].bssid));
+  }
+  WiFi.scanDelete();
+  return k;
 }
 
+static const WifiConnectOps wifiOps = {wifiOpsBegin, wifiOpsPoll, wifiOpsAbort, wifiOpsScan};
+
+// --- CPU-Takt ---
+// Mit esp_pm (Profil lowpower) regelt ein PM-Lock den Takt, sonst setCpuFrequencyMhz.
+void cpuFull() {
+  if (!powerSyncBegin()) setCpuFrequencyMhz(160);
+}
+
+void cpuLow() {
+  if (!powerSyncEnd()) setCpuFrequencyMhz(40);
+}
+
+// --- Temperatur für das Driftmodell ---
+#ifdef CLOCK_TEMP_LM75
+// LM75 am Display-Bus (Wire ist durch U8g2 schon gestartet)
+static float readTemperature() {
+  Wire.beginTransmission(TEMP_LM75_ADDR);
+  Wire.write(0x00);   // Temperaturregister
+  if (Wire.endTransmission(false) != 0 || Wire.requestFrom(TEMP_LM75_ADDR, 2) != 2) return NAN;
+  int16_t raw = Wire.read() << 8;
+  raw |= Wire.read();
+  return raw / 256.0f;
+}
+#else
+static float readTemperature() {
+  return temperatureRead();   // Chip-Sensor: grob, folgt aber dem Raum
+}
+#endif
+
 // --- OLED Statusmeldung ---
 void showStatus(const char* msg) {
-  oled.setPowerSave(0);
-  oled.clearBuffer();
-  oled.setContrast(64);
-  oled.setFont(u8g2_font_courR08_tr);
-  oled.drawStr(0, 60, msg);
-  oled.sendBuffer();
+#ifdef CLOCK_PARALLEL_BOOT
+  if (bootSyncRunning) {
+    // Display gehört loop(); nur Zeichenketten-Literale, der Zeiger bleibt gültig
+    pendingStatus = msg;
+    xTaskNotifyGive(loopTaskHandle);
+    return;
+  }
+#endif
+  renderStatus(oled.getU8g2(), msg);
 }
 
 // --- Zeit anzeigen ---
 void drawTime(const struct tm* timeinfo) {
-  char timeStr[6];
-  oled.setPowerSave(0);
-  oled.clearBuffer();
-  strftime(timeStr, sizeof(timeStr), "%H:%M", timeinfo);
-  oled.setContrast(30);
-  oled.setFont(u8g2_font_logisoso42_tr);
-  oled.drawStr(1, 52, timeStr);
-  oled.sendBuffer();
+  renderTime(oled.getU8g2(), clockState, timeinfo);
+  if (!firstFrameLogged) {
+    CLOG(MSG_BOOT_FRAME, (uint32_t)(esp_timer_get_time() / 1000));
+    firstFrameLogged = true;
+  }
 }
 
-// --- NTP Synchronisation ---
-bool syncTime() {
-
-  Serial.println("NTP-Sync starten…");
-  showStatus("WLAN an…");
-  esp_wifi_set_ps(WIFI_PS_NONE); // aufwachen - WLAN volle Leistung (kein Sleep)
-  setCpuFrequencyMhz(160); // CPU auf 160 MHz
-  delay(200);
+// --- Sync: Ablauf in clock_sync.cpp, hier nur WLAN, Takt und Display ---
+static void syncCpu(bool full) {
+  if (full) {
+    esp_wifi_set_ps(WIFI_PS_NONE); // aufwachen - WLAN volle Leistung (kein Sleep)
+    cpuFull(); // CPU auf 160 MHz
+    delay(200);
+  } else {
+    cpuLow(); // wieder auf 40 MHz runter, spart Strom
+  }
+}
 
+static void syncRadioOn() {
   WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid, password);
+#ifdef CLOCK_STATIC_ALLOC
+  esp_wifi_start();   // nach esp_wifi_stop() bleibt der Modus STA, WiFi.mode() startet nicht neu
+#endif
+}
 
-  unsigned long t0 = millis();
-  while (WiFi.status() != WL_CONNECTED && millis() - t0 < 20000) {
-    delay(250);
-  }
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WLAN Timeout");
-    showStatus("WLAN Timeout");
-    disconnectWiFi();
-    return false;
+static void syncRadioOff(bool ok) {
+  disconnectWiFi();
+  if (ok) {
+    WiFi.setSleep(true);
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM); // Modem-Sleep
   }
+}
 
-  Serial.println("WLAN verbunden");
-  showStatus("NTP Sync…");
+// Zeitplan nachfragen (meist 304), Delta-Update fortsetzen und Telemetrie senden
+static bool syncOnline() {
+  clockConfigFetch();
+  const bool update = deltaOtaStep();
+  teleUpload();
+  return update;
+}
 
-  configTzTime(TIMEZONE, "de.pool.ntp.org");
-  tzset();
+static const SyncOps syncOps = {&wifiOps, showStatus, syncCpu, syncRadioOn, syncRadioOff, syncOnline};
 
-  time_t now = 0;
-  struct tm ti = {0};
-  bool ok = false;
-  for (int i = 0; i < 60; ++i) {
-    time(&now);
-    localtime_r(&now, &ti);
-    if (ti.tm_year >= (2024 - 1900)) { ok = true; break; }
-    delay(500);
-  }
-
-  if (!ok) {
-    Serial.println("NTP fehlgeschlagen");
-    showStatus("NTP fehlgeschlagen");
-    disconnectWiFi();
-    return false;
+// --- NTP Synchronisation ---
+bool syncTime() {
+  const uint8_t result = clockSyncRun(syncOps);
+  allocGuardReport();
+  if (result == SYNC_OK_RESTART) {
+    showStatus("Update, Neustart");
+    clockLogFlush();
+    delay(1000);
+    esp_restart();   // bootet aus der eben geschriebenen OTA-Partition
   }
-
+  if (result == SYNC_FAILED) return false;
   showStatus("Zeit OK");
   delay(1000);
+  return true;
+}
 
-  disconnectWiFi();
-  setCpuFrequencyMhz(40); // wieder auf 40 MHz runter, spart Strom
-  WiFi.setSleep(true);
-  esp_wifi_set_ps(WIFI_PS_MIN_MODEM); // Modem-Sleep
+// --- Boot ---
+static bool timeValid(time_t now) {
+  struct tm ti;
+  localtime_r(&now, &ti);
+  return ti.tm_year >= (2024 - 1900);
+}
 
-  return true;
+static void bootSynced(bool ok) {
+  CLOG(MSG_BOOT_SYNC, (uint32_t)(esp_timer_get_time() / 1000), ok);
+}
+
+#ifdef CLOCK_PARALLEL_BOOT
+static void bootSyncTask(void*) {
+  bool ok = syncTime();
+  bootSyncResult = ok;
+  xTaskNotifyGive(loopTaskHandle);
+  vTaskDelete(nullptr);
 }
 
+static void bootSyncStart() {
+  bootSyncRunning = true;
+#ifdef CLOCK_STATIC_ALLOC
+  static StackType_t stack[6144];
+  static StaticTask_t tcb;
+  xTaskCreateStaticPinnedToCore(bootSyncTask, "bootsync", sizeof(stack), nullptr, 1, stack, &tcb, 0);
+#else
+  xTaskCreatePinnedToCore(bootSyncTask, "bootsync", 6144, nullptr, 1, nullptr, 0);
+#endif
+}
+
+// Ergebnis der Boot-Task übernehmen; true, solange sie noch läuft
+static bool bootSyncPoll() {
+  if (!bootSyncRunning) return false;
+  if (bootSyncResult < 0) {
+    const char* msg = pendingStatus;
+    if (msg && !timeValid(time(nullptr))) {   // läuft die Uhr schon, hat sie Vorrang
+      pendingStatus = nullptr;
+      renderStatus(oled.getU8g2(), msg);
+    }
+    return true;
+  }
+  bootSyncRunning = false;
+  clockSyncDone(clockState, bootSyncResult, time(nullptr));
+  clockState.lastDisplayedMinute = -1;   // mit der synchronisierten Zeit neu zeichnen
+  bootSynced(bootSyncResult);
+  // erst jetzt: WLAN, DHCP und NTP der Boot-Task teilen noch bis zum Ende Heap zu
+  allocGuardArm();
+  return false;
+}
+#endif
+
 // --- Setup ---
 void setup() {
   Serial.begin(115200);
-  oled.begin();
-  oled.setPowerSave(0); // Display an
-  oled.setContrast(64);
-  oled.clearBuffer();
-  if (WiFi.status() == WL_CONNECTED) {
-    showStatus("NTP-Sync…");
+  // Meldungen gehen als Binärrahmen hinaus, gesammelt (scripts/log_decode.py)
+  clockLogInit([](const uint8_t* data, size_t len) { Serial.write(data, len); });
+  setenv("TZ", TIMEZONE, 1);
+  tzset();
+  telemetryInit();
+  clockConfigInit();   // gespeicherter Zeitplan vor dem ersten clockPlan()
+  wakeStatsInit();
+  heapMonitorInit();
+  if (powerInit()) {
+    CLOG(MSG_POWER_PROFILE);
+  }
+  // Konsoleneingaben wecken loop() vorzeitig auf
+  loopTaskHandle = xTaskGetCurrentTaskHandle();
+  consoleInit();
+  Serial.onReceive([]() { xTaskNotifyGive(loopTaskHandle); });
+  clockEventsInit();
+  driftInit(readTemperature);
+  radioGuardInit();
+  WiFi.setAutoReconnect(false);   // Versuche steuert wifiConnect()
+  WiFi.onEvent(onWiFiEvent);
+#ifdef CLOCK_DEEP_SLEEP
+  const bool resumed = wakeStubResumed();
+  wakeStubReport();
+#elif defined(CLOCK_ULP)
+  const bool resumed = ulpClockResumed();
+  ulpClockReport();
+#else
+  const bool resumed = false;
+#endif
+  if (resumed) {
+    // Display läuft seit dem letzten vollen Boot weiter, Uhrzeit hat den Tiefschlaf überstanden
+    oled.initInterface();
+    oled.setFlipMode(OLED_FLIP);   // setzt auch den x-Offset in u8x8 wieder
+  } else {
+#ifdef CLOCK_PARALLEL_BOOT
+    // WLAN, DHCP und NTP sofort auf Kern 0; hier das Display initialisieren,
+    // die erste Zeitanzeige (Uhrzeit aus der RTC nach Software-Reset) zeichnet loop()
+    bootSyncStart();
+#endif
+    oled.begin();
+    panelReset();
+    oled.setFlipMode(OLED_FLIP);   // Drehung im Controller statt je Pixel in u8g2
+    oled.setPowerSave(0); // Display an
+    oled.setContrast(CONTRAST_STATUS);
+    oled.clearBuffer();
+#ifndef CLOCK_PARALLEL_BOOT
+    if (WiFi.status() == WL_CONNECTED) {
+      showStatus("NTP-Sync…");
+    }
+    // erster NTP-Sync beim Start
+    bool ok = syncTime();
+    clockSyncDone(clockState, ok, time(nullptr));
+    bootSynced(ok);
+    delay(500);
+#endif
   }
-  // erster NTP-Sync beim Start
-  syncTime();
-  delay(500);
+  // alles Weitere soll ohne neue Heap-Zuteilungen auskommen (CLOCK_STATIC_ALLOC);
+  // beim parallelen Boot schaltet bootSyncPoll() den Wächter nach der Boot-Task scharf
+#ifndef CLOCK_PARALLEL_BOOT
+  allocGuardArm();
+#endif
 }
 
 // --- Loop ---
 
-static bool syncDoneThisMinute = false;
-#define Sync_Stunde 4         // rechtzeitig vor 6 Uhr synchronisieren: Zeitumstellung muss so nicht beachtet werden
-#define Sync_Min    30
-const int sleepTime_Start = 22;  // 22:00 Uhr
-const int sleepTime_End  =  6;   // 06:00 Uhr
-
 void loop() {
   time_t now = time(nullptr);
   struct tm nowLocal;
   localtime_r(&now, &nowLocal);
 
-   if (nowLocal.tm_hour >= Sync_Stunde && nowLocal.tm_min == Sync_Min && !syncDoneThisMinute ) { //
-    
-      if (syncTime()) {
-        Serial.println("Täglicher NTP-Sync erfolgreich");
+  while (Serial.available()) {
+    consoleFeed((char)Serial.read());
+  }
+  wakeStatsTick(now);
+  heapMonitorTick(now);
+  clockEventsDrain(clockState);
+  driftTick(now);
+  clockConfigTick();
+#ifdef CLOCK_PARALLEL_BOOT
+  const bool booting = bootSyncPoll();
+  if (booting && !timeValid(now)) {
+    // noch keine Uhrzeit: nur Statusmeldungen, bis die Boot-Task fertig ist
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    return;
+  }
+#else
+  const bool booting = false;
+#endif
+  uint8_t actions = clockPlan(clockState, nowLocal, now);
+
+  if ((actions & CLOCK_SYNC) && !booting) {
+      bool ok = syncTime();
+      clockSyncDone(clockState, ok, time(nullptr));
+      if (ok) {
+        CLOG(MSG_DAILY_OK);
+      } else if (clockState.retryAt) {
+            CLOG(MSG_DAILY_RETRY, SYNC_RETRY_MIN);
       } else {
-            Serial.println("Täglicher NTP-Sync fehlgeschlagen, neuer Versuch in 5 Min");
+            CLOG(MSG_DAILY_FAILED);
         }
-      syncDoneThisMinute = true;
-  }
-  if (nowLocal.tm_min != Sync_Min) {
-    syncDoneThisMinute = false;
   }
 
-  if (nowLocal.tm_hour >= sleepTime_Start || nowLocal.tm_hour < sleepTime_End) {
+  if (actions & CLOCK_BLANK) {
     // Zwischen 22:00 und 06:00 Uhr
-      if (nowLocal.tm_min != lastDisplayedMinute) { //
-          oled.setPowerSave(1); 
-          oled.clearBuffer();
-          oled.sendBuffer();
-          lastDisplayedMinute = nowLocal.tm_min;
-      }
-
-    } else {
+    renderBlank(oled.getU8g2());
+  }
+  if (actions & CLOCK_DAY) {
     // Tageszeit 06:00–22:00 Uhr
-      oled.setPowerSave(0);
-      if (nowLocal.tm_min != lastDisplayedMinute) { 
-          drawTime(&nowLocal);
-          lastDisplayedMinute = nowLocal.tm_min;
-      }  
+    oled.setPowerSave(0);
+  }
+  if (actions & CLOCK_DRAW) {
+    drawTime(&nowLocal);
   }
-  delay(1000); // 1 s Pause
+#ifdef CLOCK_DEEP_SLEEP
+  // Tiefschlaf bis kurz nach dem Minutenwechsel; einfache Wechsel zeichnet der Wake-Stub
+  wakeStubArm(oled.getU8g2(), nowLocal, (actions & CLOCK_SYNC) ? 0 : wakeStubMinutes(clockState, nowLocal, now));
+  clockLogFlush();   // der Ring übersteht den Tiefschlaf nicht
+  Serial.flush();
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  wakeStubSleep(clockMsToNextMinute(tv.tv_sec, tv.tv_usec / 1000) + 20);
+#elif defined(CLOCK_ULP)
+  // Tiefschlaf; die Minuten zeichnet der ULP, geweckt wird zur vollen Stunde und zur Sync-Minute
+  clockLogFlush();
+  Serial.flush();
+  ulpClockSleep(oled.getU8g2(), clockState, nowLocal, !clockIsNight(nowLocal));
+#else
+  // nächste Minute schon jetzt zeichnen, am Wechsel wird nur noch gesendet
+  if (!clockIsNight(nowLocal)) clockPrepareNext(oled.getU8g2(), clockState, nowLocal);
+  clockLogTick();   // gesammelte Meldungen nur ab und zu, solange die CPU ohnehin wach ist
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  uint32_t ms = clockMsToNextMinute(tv.tv_sec, tv.tv_usec / 1000) + CLOCK_WAKE_MARGIN_MS;
+  if (powerAutoSleep()) {
+    // bis kurz nach dem Minutenwechsel (oder bis zur nächsten Eingabe) blockieren,
+    // Tickless-Idle legt die CPU schlafen;
+    // vorher die serielle Ausgabe leeren, sonst bricht der Light-Sleep sie ab
+    Serial.flush();
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+  } else {
+    delay(ms < 1000 ? ms : 1000); // höchstens 1 s Pause, den Minutenwechsel nicht verpassen
+  }
+#endif
 }
+
+#endif // ARDUINO
@@ -0,0 +1,85 @@
+/**
+ * @file alloc_guard.cpp
+ * @brief Zählung von Heap-Zuteilungen nach der Initialisierung
+ */
+#include "alloc_guard.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+static std::atomic<bool> armed{false};
+static std::atomic<uint32_t> allocCount{0};
+static std::atomic<uint32_t> allocBytes{0};
+
+// wird aus dem Allokator heraus aufgerufen: kein printf, kein Heap
+static void IRAM_ATTR noteAlloc(size_t size) {
+  if (!armed.load(std::memory_order_relaxed)) return;
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef CLOCK_STATIC_ALLOC_ASSERT
+  armed.store(false, std::memory_order_relaxed);
+  esp_rom_printf("Heap-Zuteilung nach setup(): %u Byte\n", (unsigned)size);
+  abort();
+#endif
+}
+
+#ifdef CLOCK_STATIC_ALLOC
+#if CONFIG_HEAP_USE_HOOKS
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  noteAlloc(size);
+}
+#else
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  noteAlloc(size);
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+  noteAlloc(n * size);
+  return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  noteAlloc(size);
+  return __real_realloc(ptr, size);
+}
+}
+#endif
+#endif
+
+void allocGuardArm() {
+  armed.store(true);
+}
+
+uint32_t allocGuardCount() {
+  return allocCount.load();
+}
+
+uint32_t allocGuardBytes() {
+  return allocBytes.load();
+}
+
+void allocGuardReport() {
+  size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  size_t minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  uint32_t n = allocCount.load();
+
+  CLOG(MSG_HEAP_AFTER_SYNC, freeHeap, largest, minFree, n, allocBytes.load());
+
+  // in 16-Byte-Einheiten, damit 320 KB in 16 Bit passen
+  uint16_t v[4] = {(uint16_t)(freeHeap / 16), (uint16_t)(largest / 16), (uint16_t)(minFree / 16),
+                   (uint16_t)(n > 0xFFFF ? 0xFFFF : n)};
+  telemetryAdd(TELE_HEAP, 0, v, 4);
+}
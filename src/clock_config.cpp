@@ -0,0 +1,246 @@
+/**
+ * @file clock_config.cpp
+ * @brief Zeitplan-Blob im NVS (mit RTC-Kopie), bedingter HTTP-Abruf und Prüfung
+ */
+#include "clock_config.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "clock_core.h"
+#include "clock_log.h"
+#include "lan_http.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+
+#define CLOCK_CONFIG_MAGIC 0x43464731  // "CFG1"
+
+// ohne Konstruktor, damit RTC_NOINIT nicht beim Start überschrieben wird
+struct ConfigBlob {
+  uint32_t magic;
+  uint8_t  sleepStart, sleepEnd, syncHour, syncMin;
+  char     etag[CLOCK_CONFIG_ETAG_MAX];   // wie vom Server, mit Anführungszeichen; "" = keiner
+};
+
+RTC_NOINIT_ATTR static ConfigBlob stored;
+static const char* source = "Vorgabe";
+
+// Gründe für ein verworfenes Dokument, in der Reihenfolge von MSG_CONFIG_RANGE ff.
+enum ConfigReject : uint8_t {
+  CFG_OK = 0,
+  CFG_RANGE,
+  CFG_NIGHT,
+  CFG_NO_EQUALS,
+  CFG_KEY,
+  CFG_NUMBER,
+  CFG_EMPTY,
+  CFG_TOO_LARGE,
+  CFG_TRUNCATED,
+  CFG_NVS,
+};
+
+// abgerufen, aber noch nicht übernommen (Sync läuft beim Boot auf dem anderen Kern)
+static ClockSchedule pending;
+static bool pendingValid = false;
+static portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+
+static ClockSchedule scheduleOf(const ConfigBlob& b) {
+  ClockSchedule s;
+  s.sleepStart = b.sleepStart;
+  s.sleepEnd = b.sleepEnd;
+  s.syncHour = b.syncHour;
+  s.syncMin = b.syncMin;
+  return s;
+}
+
+// Nacht über Mitternacht (clockIsNight), Stunden und Minuten im Bereich
+static uint8_t checkSchedule(const ClockSchedule& s) {
+  if (s.sleepStart > 23 || s.sleepEnd > 23 || s.syncHour > 23 || s.syncMin > 59) return CFG_RANGE;
+  if (s.sleepStart <= s.sleepEnd) return CFG_NIGHT;   // sleep_start muss nach sleep_end liegen
+  return CFG_OK;
+}
+
+static bool blobValid(const ConfigBlob& b) {
+  return b.magic == CLOCK_CONFIG_MAGIC && memchr(b.etag, 0, sizeof(b.etag)) && !checkSchedule(scheduleOf(b));
+}
+
+void clockConfigInit() {
+  if (blobValid(stored)) {
+    source = "RTC";
+  } else {
+    memset(&stored, 0, sizeof(stored));
+    nvs_handle_t h;
+    if (nvs_open("clockcfg", NVS_READONLY, &h) == ESP_OK) {
+      size_t len = sizeof(stored);
+      if (nvs_get_blob(h, "plan", &stored, &len) == ESP_OK && len == sizeof(stored) && blobValid(stored)) {
+        source = "NVS";
+      } else {
+        memset(&stored, 0, sizeof(stored));
+      }
+      nvs_close(h);
+    }
+  }
+  if (stored.magic != CLOCK_CONFIG_MAGIC) return;   // keine gespeicherte Konfiguration: Vorgaben
+  clockSchedule = scheduleOf(stored);
+}
+
+#ifdef CLOCK_CONFIG_HOST
+
+// --- Dokument prüfen ---
+
+static uint8_t parseConfig(const char* doc, size_t len, ClockSchedule* out) {
+  static const struct { const char* key; size_t offset; } keys[] = {
+    {"sleep_start", offsetof(ClockSchedule, sleepStart)},
+    {"sleep_end",   offsetof(ClockSchedule, sleepEnd)},
+    {"sync_hour",   offsetof(ClockSchedule, syncHour)},
+    {"sync_min",    offsetof(ClockSchedule, syncMin)},
+  };
+  const char* end = doc + len;
+  for (const char* line = doc; line < end;) {
+    const char* eol = (const char*)memchr(line, '\n', end - line);
+    if (!eol) eol = end;
+    const char* p = line;
+    const char* q = eol;
+    line = eol + 1;
+    while (p < q && (*p == ' ' || *p == '\t')) ++p;
+    while (q > p && (q[-1] == '\r' || q[-1] == ' ' || q[-1] == '\t')) --q;
+    if (p == q || *p == '#') continue;
+
+    const char* eq = (const char*)memchr(p, '=', q - p);
+    if (!eq) return CFG_NO_EQUALS;
+    uint8_t* field = nullptr;
+    for (const auto& k : keys) {
+      if ((size_t)(eq - p) == strlen(k.key) && memcmp(p, k.key, eq - p) == 0) {
+        field = (uint8_t*)out + k.offset;
+      }
+    }
+    if (!field) return CFG_KEY;
+    int v = 0, digits = 0;
+    for (const char* d = eq + 1; d < q; ++d, ++digits) {
+      if (*d < '0' || *d > '9' || digits == 2) return CFG_NUMBER;
+      v = v * 10 + (*d - '0');
+    }
+    if (digits == 0) return CFG_EMPTY;
+    *field = (uint8_t)v;
+  }
+  return checkSchedule(*out);
+}
+
+// Zeitplan und ETag als ein Blob: nvs_set_blob ersetzt den alten Eintrag erst,
+// wenn der neue vollständig geschrieben ist
+static bool storeConfig(const ClockSchedule& s, const char* etag, size_t etagLen) {
+  ConfigBlob b = {};
+  b.magic = CLOCK_CONFIG_MAGIC;
+  b.sleepStart = s.sleepStart;
+  b.sleepEnd = s.sleepEnd;
+  b.syncHour = s.syncHour;
+  b.syncMin = s.syncMin;
+  if (etag && etagLen < sizeof(b.etag)) memcpy(b.etag, etag, etagLen);   // zu lang: künftig ohne If-None-Match
+
+  nvs_handle_t h;
+  if (nvs_open("clockcfg", NVS_READWRITE, &h) != ESP_OK) return false;
+  bool ok = nvs_set_blob(h, "plan", &b, sizeof(b)) == ESP_OK && nvs_commit(h) == ESP_OK;
+  nvs_close(h);
+  if (ok) stored = b;
+  return ok;
+}
+
+#endif // CLOCK_CONFIG_HOST
+
+// --- Abruf ---
+
+bool clockConfigFetch() {
+#ifdef CLOCK_CONFIG_HOST
+  static char resp[CLOCK_CONFIG_MAX_BYTES];
+  const int64_t t0 = esp_timer_get_time();
+  uint32_t budget = radioGuardRemainingMs();
+  if (budget > CLOCK_CONFIG_BUDGET_MS) budget = CLOCK_CONFIG_BUDGET_MS;
+
+  char head[192];
+  int n = snprintf(head, sizeof(head), "GET %s HTTP/1.0\r\nHost: %s:%d\r\n", CLOCK_CONFIG_PATH, CLOCK_CONFIG_HOST,
+                   CLOCK_CONFIG_PORT);
+  if (stored.magic == CLOCK_CONFIG_MAGIC && stored.etag[0]) {
+    n += snprintf(head + n, sizeof(head) - n, "If-None-Match: %s\r\n", stored.etag);
+  }
+  snprintf(head + n, sizeof(head) - n, "\r\n");
+
+  int got = budget ? lanHttpExchange(CLOCK_CONFIG_HOST, CLOCK_CONFIG_PORT, head, nullptr, 0, resp, sizeof(resp),
+                                     t0 + (int64_t)budget * 1000)
+                   : -1;
+  const int status = got > 0 ? lanHttpStatus(resp, got) : 0;
+  uint8_t flags = 0;
+  uint8_t why = CFG_OK;
+  size_t bodyLen = 0;
+
+  if (status == 304) {
+    flags = 1;
+  } else if (status == 200) {
+    size_t etagLen = 0, lenLen = 0;
+    const char* etag = lanHttpHeader(resp, got, "ETag", &etagLen);
+    const char* length = lanHttpHeader(resp, got, "Content-Length", &lenLen);
+    const char* body = lanHttpBody(resp, got, &bodyLen);
+    ClockSchedule next = clockSchedule;
+    if (got == (int)sizeof(resp)) {
+      why = CFG_TOO_LARGE;
+    } else if (!body || (length && (size_t)atoi(length) != bodyLen)) {
+      why = CFG_TRUNCATED;
+    } else if ((why = parseConfig(body, bodyLen, &next)) == CFG_OK) {
+      if (storeConfig(next, etag, etagLen)) {
+        portENTER_CRITICAL(&pendingMux);
+        pending = next;
+        pendingValid = true;
+        portEXIT_CRITICAL(&pendingMux);
+        source = "Server";
+        flags = 2;
+      } else {
+        why = CFG_NVS;
+      }
+    }
+    if (why) flags = 4;
+  } else {
+    flags = 8;
+  }
+
+  const uint16_t ms = (uint16_t)((esp_timer_get_time() - t0) / 1000);
+  if (flags == 1) {
+    CLOG(MSG_CONFIG_SAME, ms);
+  } else if (flags == 2) {
+    CLOG(MSG_CONFIG_NEW, pending.sleepStart, pending.sleepEnd, pending.syncHour, pending.syncMin, ms);
+  } else if (flags == 4) {
+    CLOG_NTH(MSG_CONFIG_RANGE, why - CFG_RANGE, ms);
+  } else {
+    CLOG(MSG_CONFIG_UNREACHED, status, ms);
+  }
+  uint16_t v[3] = {ms, (uint16_t)status, (uint16_t)(got > 0 ? got : 0)};
+  telemetryAdd(TELE_CONFIG, flags, v, 3);
+  return flags == 2;
+#else
+  return false;
+#endif
+}
+
+void clockConfigTick() {
+  if (!pendingValid) return;
+  portENTER_CRITICAL(&pendingMux);
+  clockSchedule = pending;
+  pendingValid = false;
+  portEXIT_CRITICAL(&pendingMux);
+  const ClockSchedule& s = clockSchedule;
+  CLOG(MSG_CONFIG_APPLIED, s.sleepStart, s.sleepEnd, s.syncHour, s.syncMin);
+}
+
+void clockConfigPrint() {
+  const ClockSchedule& s = clockSchedule;
+  printf("Nacht %u-%u Uhr, Sync ab %u:%02u (%s)\n", s.sleepStart, s.sleepEnd, s.syncHour, s.syncMin, source);
+  if (stored.magic == CLOCK_CONFIG_MAGIC) printf("ETag: %s\n", stored.etag[0] ? stored.etag : "-");
+#ifdef CLOCK_CONFIG_HOST
+  printf("Server: http://%s:%d%s\n", CLOCK_CONFIG_HOST, CLOCK_CONFIG_PORT, CLOCK_CONFIG_PATH);
+#else
+  printf("Kein Server (CLOCK_CONFIG_HOST)\n");
+#endif
+}
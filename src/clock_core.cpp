@@ -0,0 +1,354 @@
+/**
+ * @file clock_core.cpp
+ * @brief Zeitplan und Zeichenroutinen der Uhr, unabhängig vom Framework
+ */
+#include "clock_core.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include "panel.h"
+
+// --- Zeitplan ---
+
+ClockSchedule clockSchedule;
+
+bool clockIsNight(const struct tm& nowLocal) {
+  return nowLocal.tm_hour >= clockSchedule.sleepStart || nowLocal.tm_hour < clockSchedule.sleepEnd;
+}
+
+uint8_t clockPlan(ClockState& st, const struct tm& nowLocal, time_t now) {
+  uint8_t actions = CLOCK_NONE;
+  const ClockSchedule& plan = clockSchedule;
+
+  if (nowLocal.tm_hour >= plan.syncHour && nowLocal.tm_min == plan.syncMin && !st.syncDoneThisMinute) {
+    actions |= CLOCK_SYNC;
+    st.syncDoneThisMinute = true;
+    st.retries = 0;
+  } else if (st.retryAt != 0 && now >= st.retryAt) {
+    actions |= CLOCK_SYNC;
+  }
+  if (actions & CLOCK_SYNC) {
+    st.retryAt = 0;
+  }
+  if (nowLocal.tm_min != plan.syncMin) {
+    st.syncDoneThisMinute = false;
+  }
+
+  if (clockIsNight(nowLocal)) {
+    // Zwischen 22:00 und 06:00 Uhr
+    if (nowLocal.tm_min != st.lastDisplayedMinute) {
+      actions |= CLOCK_BLANK;
+      st.lastDisplayedMinute = nowLocal.tm_min;
+    }
+  } else {
+    // Tageszeit 06:00–22:00 Uhr
+    actions |= CLOCK_DAY;
+    if (nowLocal.tm_min != st.lastDisplayedMinute) {
+      actions |= CLOCK_DRAW;
+      st.lastDisplayedMinute = nowLocal.tm_min;
+    }
+  }
+  return actions;
+}
+
+void clockSyncDone(ClockState& st, bool ok, time_t now) {
+  if (ok || st.retries >= SYNC_MAX_RETRIES) {
+    st.retries = 0;
+    st.retryAt = 0;
+    return;
+  }
+  st.retries++;
+  st.retryAt = now + SYNC_RETRY_MIN * 60;
+}
+
+uint32_t clockSecondsToNextEvent(const ClockState& st, const struct tm& nowLocal, time_t now) {
+  const ClockSchedule& plan = clockSchedule;
+  const int start = nowLocal.tm_hour * 60 + nowLocal.tm_min;
+  uint32_t sec = 24 * 3600;
+  for (int k = 1; k <= 24 * 60; ++k) {
+    int hh = (start + k) / 60 % 24, mm = (start + k) % 60;
+    if ((hh >= plan.syncHour && mm == plan.syncMin) || (mm == 0 && (hh == plan.sleepStart || hh == plan.sleepEnd))) {
+      sec = k * 60 - nowLocal.tm_sec;
+      break;
+    }
+  }
+  if (st.retryAt != 0 && st.retryAt > now && (uint32_t)(st.retryAt - now) < sec) {
+    sec = (uint32_t)(st.retryAt - now);
+  }
+  return sec;
+}
+
+uint32_t clockMsToNextMinute(time_t now, uint32_t subsecMs) {
+  uint32_t sec = (uint32_t)(now % 60);
+  return (60 - sec) * 1000 - subsecMs;
+}
+
+// --- Vorbereitetes Bild der nächsten Minute ---
+static uint8_t nextFrame[128 * 8];
+static struct {
+  bool      valid;
+  int8_t    hour, min;
+  int16_t   yday;
+  ClockFace face;
+  uint16_t  lit;
+  uint8_t   page0, pages;   // geänderte Seiten gegenüber dem angezeigten Bild, pages 0 = keine
+} next;
+
+// Latenz Minutenwechsel → Bild gesendet, getrennt nach vorbereitet / neu gezeichnet
+struct FrameLatency {
+  uint32_t count, sumMs, maxMs;
+};
+static FrameLatency latency[2];
+static uint32_t latencyLastMs;
+
+static void CLOCK_HOT noteLatency(bool prepared) {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  uint32_t ms = (uint32_t)(tv.tv_sec % 60) * 1000 + tv.tv_usec / 1000;
+  FrameLatency& l = latency[prepared];
+  l.count++;
+  l.sumMs += ms;
+  if (ms > l.maxMs) l.maxMs = ms;
+  latencyLastMs = ms;
+}
+
+// --- OLED Statusmeldung ---
+void renderStatus(u8g2_t* u8g2, const char* msg) {
+  next.valid = false;   // das Display zeigt nicht mehr das Bild, gegen das verglichen wurde
+  u8g2_SetPowerSave(u8g2, 0);
+  u8g2_ClearBuffer(u8g2);
+  u8g2_SetContrast(u8g2, CONTRAST_STATUS);
+  panelApply(u8g2, PANEL_DAY);
+  panelCrop(u8g2, false);   // Statuszeile liegt außerhalb des Zifferblatts
+  u8g2_SetFont(u8g2, u8g2_font_courR08_tr);
+  u8g2_DrawStr(u8g2, 0, 60, msg);
+  u8g2_SendBuffer(u8g2);
+}
+
+// --- Zeit anzeigen ---
+static ClockFace face = FACE_BOLD;             // zuletzt gewählt, gilt auch für Wake-Stub und ULP
+static u8g2_t* faceDisplay = nullptr;          // für die Konsolenbefehle
+static struct tm faceShown;
+static uint16_t faceLit = 0;                   // Pixel der zuletzt gezeichneten Minute
+static uint32_t faceLitToday = 0;
+
+static const char timeFmt[] CLOCK_HOT_DATA = "%H:%M";
+static const char widthRef[] CLOCK_HOT_DATA = "00:00";
+
+// Ziffernbreite fest an "00:00" ausrichten, damit die Stellen nicht wandern
+static void CLOCK_HOT drawCentered(u8g2_t* u8g2, const uint8_t* font, const char* s) {
+  u8g2_SetFont(u8g2, font);
+  int w = u8g2_GetStrWidth(u8g2, widthRef);
+  int a = u8g2_GetAscent(u8g2);
+  u8g2_DrawStr(u8g2, (128 - w) / 2, CLOCK_FACE_PAGE0 * 8 + (CLOCK_FACE_PAGES * 8 + a) / 2, s);
+}
+
+void CLOCK_HOT composeFace(u8g2_t* u8g2, const struct tm* timeinfo, ClockFace f) {
+  char timeStr[6];
+  u8g2_ClearBuffer(u8g2);
+  strftime(timeStr, sizeof(timeStr), timeFmt, timeinfo);
+  switch (f) {
+    case FACE_THIN:
+      drawCentered(u8g2, u8g2_font_fur42_tn, timeStr);
+      break;
+    case FACE_OUTLINE:
+      // Ziffer um ein Pixel in vier Richtungen versetzt, Inneres wieder löschen
+      u8g2_SetFont(u8g2, u8g2_font_logisoso42_tr);
+      u8g2_SetFontMode(u8g2, 1);
+      u8g2_DrawStr(u8g2, 0, 52, timeStr);
+      u8g2_DrawStr(u8g2, 2, 52, timeStr);
+      u8g2_DrawStr(u8g2, 1, 51, timeStr);
+      u8g2_DrawStr(u8g2, 1, 53, timeStr);
+      u8g2_SetDrawColor(u8g2, 0);
+      u8g2_DrawStr(u8g2, 1, 52, timeStr);
+      u8g2_SetDrawColor(u8g2, 1);
+      u8g2_SetFontMode(u8g2, 0);
+      break;
+    case FACE_SMALL:
+      drawCentered(u8g2, u8g2_font_logisoso32_tn, timeStr);
+      break;
+    default:
+      u8g2_SetFont(u8g2, u8g2_font_logisoso42_tr);
+      u8g2_DrawStr(u8g2, 1, 52, timeStr);
+      break;
+  }
+}
+
+void CLOCK_HOT composeTime(u8g2_t* u8g2, const struct tm* timeinfo) {
+  composeFace(u8g2, timeinfo, face);
+}
+
+// Randstunden: erste und letzte Stunde vor der Nacht
+static bool CLOCK_HOT nightEdge(const struct tm& t) {
+  return t.tm_hour == clockSchedule.sleepEnd || t.tm_hour == (clockSchedule.sleepStart + 23) % 24;
+}
+
+// Zifferblatt wählen und in den Puffer zeichnen: das hellste, das im Mittel über
+// die restlichen Tagesminuten noch ins Budget passt; FACE_SMALL als letzte Stufe
+static ClockFace CLOCK_HOT selectFace(u8g2_t* u8g2, const ClockState& st, const struct tm* t) {
+  if (CLOCK_EMISSION_BUDGET == 0) {
+    composeFace(u8g2, t, FACE_BOLD);
+    return FACE_BOLD;
+  }
+  if (nightEdge(*t)) {
+    composeFace(u8g2, t, FACE_SMALL);
+    return FACE_SMALL;
+  }
+  int left = (clockSchedule.sleepStart * 60) - (t->tm_hour * 60 + t->tm_min);
+  if (left < 1) left = 1;
+  const uint32_t budget = CLOCK_EMISSION_BUDGET;
+  const uint32_t perMinute = st.litToday < budget ? (budget - st.litToday) / left : 0;
+  for (uint8_t f = FACE_BOLD; f < FACE_SMALL; ++f) {
+    composeFace(u8g2, t, (ClockFace)f);
+    if (clockLitPixels(u8g2) <= perMinute) return (ClockFace)f;
+  }
+  composeFace(u8g2, t, FACE_SMALL);
+  return FACE_SMALL;
+}
+
+void clockPrepareNext(u8g2_t* u8g2, const ClockState& st, const struct tm& shown) {
+  struct tm t = shown;
+  t.tm_sec = 0;
+  t.tm_min += 1;
+  mktime(&t);   // Stunden- und Tageswechsel
+  if (next.valid && next.hour == t.tm_hour && next.min == t.tm_min && next.yday == t.tm_yday) return;
+
+  uint8_t* buf = u8g2_GetBufferPtr(u8g2);
+  const int stride = u8g2_GetBufferTileWidth(u8g2) * 8;
+  const int rows = u8g2_GetBufferTileHeight(u8g2);
+  if (stride * rows > (int)sizeof(nextFrame)) return;
+
+  // angezeigtes Bild zwischenlagern, nächste Minute zeichnen, dann tauschen
+  memcpy(nextFrame, buf, stride * rows);
+  next.face = selectFace(u8g2, st, &t);
+  next.lit = clockLitPixels(u8g2);
+  int p0 = rows, p1 = -1;
+  for (int i = 0; i < stride * rows; ++i) {
+    uint8_t b = buf[i];
+    if (b != nextFrame[i]) {
+      if (i / stride < p0) p0 = i / stride;
+      p1 = i / stride;
+    }
+    buf[i] = nextFrame[i];
+    nextFrame[i] = b;
+  }
+  next.page0 = p1 < 0 ? 0 : (uint8_t)p0;
+  next.pages = p1 < 0 ? 0 : (uint8_t)(p1 - p0 + 1);
+  next.hour = (int8_t)t.tm_hour;
+  next.min = (int8_t)t.tm_min;
+  next.yday = (int16_t)t.tm_yday;
+  next.valid = true;
+}
+
+void CLOCK_HOT renderTime(u8g2_t* u8g2, ClockState& st, const struct tm* timeinfo) {
+  if (st.litDay != timeinfo->tm_yday) {
+    st.litDay = (int16_t)timeinfo->tm_yday;
+    st.litToday = 0;
+  }
+  const bool prepared = next.valid && next.hour == timeinfo->tm_hour && next.min == timeinfo->tm_min &&
+                        next.yday == timeinfo->tm_yday;
+  next.valid = false;
+  if (prepared) {
+    // am Minutenwechsel nur noch kopieren und die geänderten Seiten senden
+    const size_t len = (size_t)u8g2_GetBufferTileWidth(u8g2) * 8 * u8g2_GetBufferTileHeight(u8g2);
+    memcpy(u8g2_GetBufferPtr(u8g2), nextFrame, len);
+    face = next.face;
+    faceLit = next.lit;
+    if (next.pages) {
+      u8g2_UpdateDisplayArea(u8g2, 0, next.page0, u8g2_GetBufferTileWidth(u8g2), next.pages);
+    }
+    noteLatency(true);
+    u8g2_SetPowerSave(u8g2, 0);
+    u8g2_SetContrast(u8g2, CONTRAST_TIME);
+    panelApply(u8g2, PANEL_DIM);
+#ifdef CLOCK_MUX_CROP
+    panelCrop(u8g2, true);
+#endif
+    st.litToday += faceLit;
+    faceLitToday = st.litToday;
+    faceDisplay = u8g2;
+    faceShown = *timeinfo;
+    return;
+  }
+  u8g2_SetPowerSave(u8g2, 0);
+  face = selectFace(u8g2, st, timeinfo);
+  faceLit = clockLitPixels(u8g2);
+  st.litToday += faceLit;
+  faceLitToday = st.litToday;
+  faceDisplay = u8g2;
+  faceShown = *timeinfo;
+  u8g2_SetContrast(u8g2, CONTRAST_TIME);
+  panelApply(u8g2, PANEL_DIM);
+#ifdef CLOCK_MUX_CROP
+  // nur die Seiten des Zifferblatts scannen und übertragen
+  panelCrop(u8g2, true);
+  u8g2_UpdateDisplayArea(u8g2, 0, CLOCK_FACE_PAGE0, u8g2_GetBufferTileWidth(u8g2), CLOCK_FACE_PAGES);
+#else
+  u8g2_SendBuffer(u8g2);
+#endif
+  noteLatency(false);
+}
+
+// --- Display aus ---
+void renderBlank(u8g2_t* u8g2) {
+  next.valid = false;
+  u8g2_SetPowerSave(u8g2, 1);
+  u8g2_ClearBuffer(u8g2);
+  u8g2_SendBuffer(u8g2);
+}
+
+// --- Leuchtende Pixel ---
+uint16_t CLOCK_HOT clockLitPixels(u8g2_t* u8g2) {
+  const uint8_t* buf = u8g2_GetBufferPtr(u8g2);
+  const size_t len = (size_t)u8g2_GetBufferTileWidth(u8g2) * 8 * u8g2_GetBufferTileHeight(u8g2);
+  uint32_t n = 0;
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    uint32_t w;
+    memcpy(&w, buf + i, 4);
+    n += __builtin_popcount(w);
+  }
+  for (; i < len; ++i) n += __builtin_popcount(buf[i]);
+  return (uint16_t)n;
+}
+
+u8g2_t* clockShownFrame(struct tm* shown) {
+  if (faceDisplay) *shown = faceShown;
+  return faceDisplay;
+}
+
+ClockFace clockFace() {
+  return face;
+}
+
+const char* clockFaceName(uint8_t f) {
+  switch (f) {
+    case FACE_BOLD:    return "fett";
+    case FACE_THIN:    return "dünn";
+    case FACE_OUTLINE: return "Umriss";
+    case FACE_SMALL:   return "klein";
+    default:           return "?";
+  }
+}
+
+void clockFacePrint() {
+  printf("Zifferblatt %s, %u Pixel, heute %lu Pixelminuten", clockFaceName(face), faceLit,
+         (unsigned long)faceLitToday);
+  if (CLOCK_EMISSION_BUDGET) {
+    printf(" von %lu\n", (unsigned long)CLOCK_EMISSION_BUDGET);
+  } else {
+    printf(" (kein Budget)\n");
+  }
+}
+
+void clockFramePrint() {
+  static const char* const names[2] = {"neu gezeichnet", "vorbereitet"};
+  printf("Letztes Bild %lu ms nach dem Minutenwechsel\n", (unsigned long)latencyLastMs);
+  for (int i = 0; i < 2; ++i) {
+    const FrameLatency& l = latency[i];
+    if (l.count == 0) continue;
+    printf("  %-15s %5lu Bilder, Ø %lu ms, max %lu ms\n", names[i], (unsigned long)l.count,
+           (unsigned long)(l.sumMs / l.count), (unsigned long)l.maxMs);
+  }
+}
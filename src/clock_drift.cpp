@@ -0,0 +1,205 @@
+/**
+ * @file clock_drift.cpp
+ * @brief Gangschätzung (lineare Regression über Temperatur) und adjtime()-Korrektur
+ */
+#include "clock_drift.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "telemetry.h"
+
+#define DRIFT_MAGIC 0x44524632  // "DRF2"
+
+struct DriftSample {
+  float    tempC;      // Mittel im Intervall, NAN = ohne Sensor
+  float    ppm;        // positiv: lokale Uhr geht vor
+  uint32_t when;
+};
+
+struct DriftState {
+  uint32_t magic;
+  uint8_t  head, count;
+  DriftSample s[DRIFT_SAMPLES];
+  float    a, b, t0;           // ppm(T) = a + b·(T − t0)
+  bool     model;
+  // laufendes Intervall seit dem letzten Sync
+  uint32_t syncAt;             // Unix-Zeit, 0 = noch keiner
+  uint32_t lastTick;
+  int64_t  appliedUs;          // angebrachte Korrektur, Vorzeichen wie die Zeitänderung
+  float    restUs;             // Bruchteil der letzten Korrektur, geht in die nächste ein
+  float    tempSum;
+  uint32_t tempCount;
+  float    lastTemp;
+};
+
+// übersteht Tiefschlaf und Software-Reset; nach dem Einschalten neu lernen
+RTC_NOINIT_ATTR static DriftState ds;
+static portMUX_TYPE driftMux = portMUX_INITIALIZER_UNLOCKED;
+static DriftTempRead readTemp;
+static int64_t nextTickUs;     // Monotonuhr
+
+void driftInit(DriftTempRead read) {
+  readTemp = read;
+  nextTickUs = 0;   // erster Aufruf nach dem Boot wirkt sofort
+  if (ds.magic != DRIFT_MAGIC || ds.count > DRIFT_SAMPLES || ds.head >= DRIFT_SAMPLES) {
+    memset(&ds, 0, sizeof(ds));
+    ds.magic = DRIFT_MAGIC;
+    ds.lastTemp = NAN;
+  }
+}
+
+// Modell aus den Stichproben; ohne Temperaturspreizung nur der Mittelwert
+static void fit() {
+  if (ds.count == 0) {
+    ds.model = false;
+    return;
+  }
+  float sumP = 0, sumT = 0;
+  int nT = 0;
+  for (int i = 0; i < ds.count; ++i) {
+    sumP += ds.s[i].ppm;
+    if (!isnan(ds.s[i].tempC)) {
+      sumT += ds.s[i].tempC;
+      nT++;
+    }
+  }
+  ds.a = sumP / ds.count;
+  ds.b = 0;
+  ds.t0 = nT ? sumT / nT : 0;
+  if (nT >= 3) {
+    float mp = 0;
+    for (int i = 0; i < ds.count; ++i) if (!isnan(ds.s[i].tempC)) mp += ds.s[i].ppm;
+    mp /= nT;
+    float cov = 0, var = 0;
+    for (int i = 0; i < ds.count; ++i) {
+      if (isnan(ds.s[i].tempC)) continue;
+      float dt = ds.s[i].tempC - ds.t0;
+      cov += dt * (ds.s[i].ppm - mp);
+      var += dt * dt;
+    }
+    if (var / nT >= DRIFT_MIN_TEMP_SPAN * DRIFT_MIN_TEMP_SPAN) {
+      ds.b = cov / var;
+      ds.a = mp;
+    }
+  }
+  ds.model = true;
+}
+
+static float modelPpm(float tempC) {
+  if (!ds.model) return 0;
+  return isnan(tempC) ? ds.a : ds.a + ds.b * (tempC - ds.t0);
+}
+
+void driftTick(time_t now) {
+  const int64_t nowUs = esp_timer_get_time();
+  if (nowUs < nextTickUs) return;
+  nextTickUs = nowUs + (int64_t)DRIFT_TICK_S * 1000000;
+
+  float t = readTemp ? readTemp() : NAN;
+  struct timeval delta = {0, 0}, old = {0, 0};
+
+  portENTER_CRITICAL(&driftMux);
+  ds.lastTemp = t;
+  if (ds.syncAt == 0) {
+    portEXIT_CRITICAL(&driftMux);
+    return;
+  }
+  if (!isnan(t)) {
+    ds.tempSum += t;
+    ds.tempCount++;
+  }
+  int32_t dt = (int32_t)((uint32_t)now - ds.lastTick);
+  ds.lastTick = (uint32_t)now;
+  // Uhr geht um ppm vor: um ppm · Δt zurücknehmen; adjtime() kennt nur ganze µs
+  int32_t corrUs = 0;
+  if (dt > 0 && dt <= 6 * 3600) {
+    const float want = -modelPpm(t) * dt + ds.restUs;
+    corrUs = (int32_t)lroundf(want);
+    ds.restUs = want - corrUs;
+  }
+  portEXIT_CRITICAL(&driftMux);
+
+  if (corrUs == 0) return;
+  delta.tv_sec = corrUs / 1000000;
+  delta.tv_usec = corrUs % 1000000;
+  if (adjtime(&delta, &old) != 0) return;
+  // ein noch nicht abgeschlossener Ausgleich wird durch den neuen ersetzt
+  portENTER_CRITICAL(&driftMux);
+  ds.appliedUs += corrUs - ((int64_t)old.tv_sec * 1000000 + old.tv_usec);
+  portEXIT_CRITICAL(&driftMux);
+}
+
+void driftSynced(const struct timeval& local, const struct timeval& ntp) {
+  struct timeval rest = {0, 0};
+  adjtime(nullptr, &rest);   // wird durch das Setzen der Zeit verworfen
+  const int64_t offsetUs = ((int64_t)ntp.tv_sec - local.tv_sec) * 1000000 + (ntp.tv_usec - local.tv_usec);
+
+  float ppm = NAN, temp = NAN;
+  bool taken = false;
+  portENTER_CRITICAL(&driftMux);
+  ds.appliedUs -= (int64_t)rest.tv_sec * 1000000 + rest.tv_usec;
+  const int32_t interval = (int32_t)((uint32_t)ntp.tv_sec - ds.syncAt);
+  if (ds.syncAt != 0 && local.tv_sec >= (time_t)1704067200 && interval >= DRIFT_MIN_INTERVAL_S) {
+    // ohne Korrektur wäre die lokale Uhr um (−offset − applied) vorgegangen
+    ppm = (float)(-offsetUs - ds.appliedUs) / interval;
+    temp = ds.tempCount ? ds.tempSum / ds.tempCount : NAN;
+    if (fabsf(ppm) < DRIFT_MAX_PPM) {
+      ds.s[ds.head] = {temp, ppm, (uint32_t)ntp.tv_sec};
+      ds.head = (ds.head + 1) % DRIFT_SAMPLES;
+      if (ds.count < DRIFT_SAMPLES) ds.count++;
+      fit();
+      taken = true;
+    }
+  }
+  ds.syncAt = (uint32_t)ntp.tv_sec;
+  ds.lastTick = (uint32_t)ntp.tv_sec;
+  ds.appliedUs = 0;
+  ds.restUs = 0;
+  ds.tempSum = 0;
+  ds.tempCount = 0;
+  const uint8_t samples = ds.count;
+  const bool withTemp = ds.b != 0;
+  portEXIT_CRITICAL(&driftMux);
+
+  int64_t offMs = offsetUs / 1000;
+  if (offMs > INT16_MAX) offMs = INT16_MAX;
+  if (offMs < INT16_MIN) offMs = INT16_MIN;
+  uint16_t v[4] = {(uint16_t)(int16_t)offMs, (uint16_t)(int16_t)(isnan(ppm) ? 0 : lroundf(ppm * 10)),
+                   (uint16_t)(int16_t)(isnan(temp) ? INT16_MIN : lroundf(temp * 10)), samples};
+  telemetryAdd(TELE_DRIFT, (taken ? 1 : 0) | (withTemp ? 2 : 0), v, 4);
+}
+
+void driftPrint() {
+  DriftState c;
+  portENTER_CRITICAL(&driftMux);
+  c = ds;
+  portEXIT_CRITICAL(&driftMux);
+
+  if (!c.model) {
+    printf("Gang: noch kein Modell (%u Stichproben)\n", c.count);
+  } else if (c.b != 0) {
+    printf("Gang: %+.2f ppm %+.3f ppm/°C · (T − %.1f °C)\n", c.a, c.b, c.t0);
+  } else {
+    printf("Gang: %+.2f ppm, ohne Temperaturterm\n", c.a);
+  }
+  if (!isnan(c.lastTemp)) {
+    printf("Temperatur %.1f °C, Modell dort %+.2f ppm\n", c.lastTemp, modelPpm(c.lastTemp));
+  }
+  if (c.syncAt) {
+    printf("Seit dem Sync %lu s, korrigiert %+lld µs\n", (unsigned long)(time(nullptr) - c.syncAt),
+           (long long)c.appliedUs);
+  }
+  for (int i = 0; i < c.count; ++i) {
+    const DriftSample& s = c.s[(c.head + DRIFT_SAMPLES - c.count + i) % DRIFT_SAMPLES];
+    time_t t = s.when;
+    struct tm lt;
+    localtime_r(&t, &lt);
+    printf("  %02d.%02d. %02d:%02d  %+7.2f ppm  ", lt.tm_mday, lt.tm_mon + 1, lt.tm_hour, lt.tm_min, s.ppm);
+    if (isnan(s.tempC)) printf("   –\n");
+    else printf("%5.1f °C\n", s.tempC);
+  }
+}
@@ -0,0 +1,51 @@
+/**
+ * @file clock_events.cpp
+ * @brief Ereignisringe und ihre Auswertung in der Hauptschleife
+ */
+#include "clock_events.h"
+
+#include <sys/time.h>
+#include "esp_sntp.h"
+#include "clock_drift.h"
+#include "clock_log.h"
+
+EventRing<ClockEvent, 16> netEvents;
+
+static void onTimeSynced(struct timeval* tv) {
+  ClockEvent ev = {};
+  ev.type = EVT_TIME_SYNCED;
+  ev.time = (uint32_t)tv->tv_sec;
+  netEvents.push(ev);
+}
+
+// Ersetzt die schwache Funktion aus ESP-IDF (Modus SNTP_SYNC_MODE_IMMED): vor dem
+// Setzen die lokale Zeit für das Driftmodell festhalten. Den registrierten
+// Callback ruft die ersetzte Funktion nicht mehr, deshalb direkt onTimeSynced().
+extern "C" void sntp_sync_time(struct timeval* tv) {
+  struct timeval local;
+  gettimeofday(&local, nullptr);
+  driftSynced(local, *tv);
+  settimeofday(tv, nullptr);
+  sntp_set_sync_status(SNTP_SYNC_STATUS_COMPLETED);
+  onTimeSynced(tv);
+}
+
+void clockEventsInit() {
+  sntp_set_time_sync_notification_cb(onTimeSynced);
+}
+
+static void handle(ClockState& st, const ClockEvent& ev) {
+  switch (ev.type) {
+    case EVT_TIME_SYNCED:
+      CLOG(MSG_TIME_SET);
+      st.lastDisplayedMinute = -1;   // Statusmeldung durch die Uhrzeit ersetzen
+      break;
+    default:
+      break;
+  }
+}
+
+void clockEventsDrain(ClockState& st) {
+  ClockEvent ev;
+  while (netEvents.pop(ev)) handle(st, ev);
+}
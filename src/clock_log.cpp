@@ -0,0 +1,99 @@
+/**
+ * @file clock_log.cpp
+ * @brief Meldungen als Varint-Rahmen in einen Byte-Ring, Ausgabe gesammelt
+ */
+#include "clock_log.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static_assert((CLOCK_LOG_BYTES & (CLOCK_LOG_BYTES - 1)) == 0, "CLOCK_LOG_BYTES muss eine Zweierpotenz sein");
+
+#define CLOCK_LOG_SYNC      0x1F   // Rahmenbeginn; kommt in Text (UTF-8) nicht vor
+#define CLOCK_LOG_FRAME_MAX (2 + 5 + 3 + 5 * CLOCK_LOG_MAX_ARGS + 1)
+
+static uint8_t ring[CLOCK_LOG_BYTES];
+static uint32_t head = 0, tail = 0;   // fortlaufend, Position im Ring = Wert & (CLOCK_LOG_BYTES - 1)
+static uint32_t dropped = 0;
+static uint32_t oldestMs = 0;         // älteste noch nicht ausgegebene Meldung
+static bool flushing = false;
+static ClockLogWriter writer = nullptr;
+static portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t* putVarint(uint8_t* p, uint32_t v) {
+  while (v >= 0x80) {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+void clockLogInit(ClockLogWriter write) {
+  writer = write;
+  clockLog(MSG_LOG_START, CLOCK_LOG_TABLE);
+}
+
+void clockLogWrite(uint16_t id, const int32_t* args, uint8_t count) {
+  const uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+  uint8_t frame[CLOCK_LOG_FRAME_MAX];
+  uint8_t* p = putVarint(frame + 2, ms);
+  p = putVarint(p, id);
+  for (uint8_t i = 0; i < count; ++i) p = putVarint(p, ((uint32_t)args[i] << 1) ^ (uint32_t)(args[i] >> 31));
+  uint8_t sum = 0;
+  for (const uint8_t* q = frame + 2; q < p; ++q) sum += *q;
+  frame[0] = CLOCK_LOG_SYNC;
+  frame[1] = (uint8_t)(p - frame - 2);
+  *p++ = sum;
+  const uint32_t len = p - frame;
+
+  portENTER_CRITICAL(&logMux);
+  if (CLOCK_LOG_BYTES - (head - tail) < len) {
+    ++dropped;   // ganze Rahmen oder keiner, damit der Decoder synchron bleibt
+  } else {
+    if (head == tail) oldestMs = ms;
+    for (uint32_t i = 0; i < len; ++i) ring[(head + i) & (CLOCK_LOG_BYTES - 1)] = frame[i];
+    head += len;
+  }
+  portEXIT_CRITICAL(&logMux);
+}
+
+void clockLogFlush() {
+  if (!writer) return;
+  portENTER_CRITICAL(&logMux);
+  const bool busy = flushing;   // Konsole und Hauptschleife: nur einer gibt aus
+  flushing = true;
+  portEXIT_CRITICAL(&logMux);
+  if (busy) return;
+
+  uint8_t chunk[64];
+  for (;;) {
+    portENTER_CRITICAL(&logMux);
+    uint32_t n = head - tail;
+    if (n > sizeof(chunk)) n = sizeof(chunk);
+    for (uint32_t i = 0; i < n; ++i) chunk[i] = ring[(tail + i) & (CLOCK_LOG_BYTES - 1)];
+    tail += n;
+    const uint32_t lost = n ? 0 : dropped;
+    if (!n) dropped = 0;
+    portEXIT_CRITICAL(&logMux);
+    if (n) {
+      writer(chunk, n);
+    } else if (lost) {
+      clockLog(MSG_LOG_DROPPED, lost);   // landet im Ring und geht in der nächsten Runde hinaus
+    } else {
+      break;
+    }
+  }
+  portENTER_CRITICAL(&logMux);
+  flushing = false;
+  portEXIT_CRITICAL(&logMux);
+}
+
+void clockLogTick() {
+  const uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+  portENTER_CRITICAL(&logMux);
+  const uint32_t fill = head - tail;
+  const bool due = fill && (fill >= CLOCK_LOG_BYTES / 4 * 3 || ms - oldestMs >= CLOCK_LOG_FLUSH_MS);
+  portEXIT_CRITICAL(&logMux);
+  if (due) clockLogFlush();
+}
@@ -0,0 +1,91 @@
+/**
+ * @file clock_sync.cpp
+ * @brief Sync-Ablauf: WLAN, SNTP mit DNS-Cache, Radio-Budget, Abschalten
+ */
+#include "clock_sync.h"
+
+#include "esp_idf_version.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "clock_log.h"
+#include "ntp_dns.h"
+#include "radio_guard.h"
+#include "wifi_tune.h"
+
+// WLAN aus, Takt runter, Radio-an-Zeit protokollieren
+static void endSync(const SyncOps& ops, bool ok) {
+  ops.radioOff(ok);
+  CLOG(MSG_WIFI_OFF);
+  uint32_t radioMs = radioGuardStop();
+  ops.cpu(false);
+  CLOG(MSG_RADIO_ON, radioMs);
+  wifiTuneEnd(ok, radioMs);
+}
+
+// SNTP starten und warten, bis es die Zeit gesetzt hat
+static bool waitForTime() {
+  sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+  // Serveradressen aus dem DNS-Cache, solange die TTL läuft (ntp_dns.h)
+  bool cachedDns = ntpDnsStart();
+  const int64_t t0 = esp_timer_get_time();
+
+  bool ok = false;
+  while (!radioGuardExpired()) {
+    if (sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED) {
+      ok = true;
+      break;
+    }
+    const int64_t ms = (esp_timer_get_time() - t0) / 1000;
+    if (ms >= CLOCK_SYNC_NTP_MS) break;
+    if (cachedDns && ms >= NTP_DNS_FALLBACK_MS) {
+      ntpDnsFallback();
+      cachedDns = false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(CLOCK_SYNC_POLL_MS));
+  }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_sntp_stop();
+#else
+  sntp_stop();
+#endif
+  return ok;
+}
+
+uint8_t clockSyncRun(const SyncOps& ops) {
+  CLOG(MSG_SYNC_START);
+  ops.status("WLAN an…");
+  ops.cpu(true);
+
+  radioGuardStart();  // ab hier zählt das Radio-Budget
+  ops.radioOn();
+
+  int ap = wifiConnect(*ops.wifi);
+  if (ap < 0) {
+    if (radioGuardExpired()) CLOG(MSG_RADIO_BUDGET);
+    else CLOG(MSG_WIFI_TIMEOUT);
+    ops.status("WLAN Timeout");
+    endSync(ops, false);
+    return SYNC_FAILED;
+  }
+
+  CLOG(MSG_WIFI_CONNECTED, ap);
+  ops.status("NTP Sync…");
+
+  if (!waitForTime()) {
+    if (radioGuardExpired()) CLOG(MSG_RADIO_BUDGET);
+    else CLOG(MSG_NTP_FAILED);
+    ops.status("NTP fehlgeschlagen");
+    endSync(ops, false);
+    return SYNC_FAILED;
+  }
+
+  // Zeitplan, Delta-Update und Telemetrie, solange das WLAN noch an ist; jedes
+  // mit eigenem Zeitbudget (CLOCK_CONFIG_BUDGET_MS, DELTA_OTA_BUDGET_MS, TELE_UPLOAD_BUDGET_MS)
+  const bool restart = ops.online && ops.online();
+
+  // WLAN schon vor der Erfolgsmeldung abschalten, die Sekunde Anzeige braucht kein Radio
+  endSync(ops, true);
+  return restart ? SYNC_OK_RESTART : SYNC_OK;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file console.cpp
+ * @brief Befehlszeile: Statistiken und Telemetrie über die serielle Schnittstelle
+ */
+#include "console.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "clock_config.h"
+#include "clock_core.h"
+#include "clock_drift.h"
+#include "clock_log.h"
+#include "delta_ota.h"
+#include "sdkconfig.h"
+#include "driver/uart.h"
+#include "esp_sleep.h"
+#include "heap_monitor.h"
+#include "panel.h"
+#include "render_bench.h"
+#include "telemetry.h"
+#include "wake_stats.h"
+
+struct ConsoleCommand {
+  const char* name;
+  const char* help;
+  void (*run)();
+};
+
+static void cmdHelp();
+
+static const ConsoleCommand commands[] = {
+  {"help",  "diese Liste",                   cmdHelp},
+  {"stats", "Wakeups je Stunde und Ursache", wakeStatsPrint},
+  {"log",   "Telemetrie-Protokoll",          telemetryPrint},
+  {"heap",  "Heap und Stack je Stunde",      heapMonitorPrint},
+  {"panel", "Panel-Profil festhalten/lösen", panelCycle},
+  {"pixel", "leuchtende Pixel und Budget",   clockFacePrint},
+  {"frame", "Latenz am Minutenwechsel",      clockFramePrint},
+  {"bench", "Takte je Zeitbild, Cache kalt/warm", renderBench},
+  {"drift", "Gangmodell und Temperatur",     driftPrint},
+  {"config", "Zeitplan und Quelle",          clockConfigPrint},
+  {"ota",   "Partitionen und Delta-Update",  deltaOtaPrint},
+  {"flush", "gesammelte Meldungen ausgeben",  clockLogFlush},
+};
+
+static void cmdHelp() {
+  for (const ConsoleCommand& c : commands) {
+    printf("  %-8s %s\n", c.name, c.help);
+  }
+}
+
+void consoleInit() {
+#if CONFIG_PM_ENABLE
+  // im Light-Sleep weckt erst eine Flanke auf RX; die ersten Zeichen gehen dabei verloren
+  uart_set_wakeup_threshold(UART_NUM_0, 3);
+  esp_sleep_enable_uart_wakeup(UART_NUM_0);
+#endif
+}
+
+void consoleFeed(char c) {
+  static char line[32];
+  static size_t len;
+
+  if (c != '\r' && c != '\n') {
+    if (len < sizeof(line) - 1) line[len++] = c;
+    return;
+  }
+  if (len == 0) return;
+  line[len] = '\0';
+  len = 0;
+
+  for (const ConsoleCommand& cmd : commands) {
+    if (strcmp(line, cmd.name) == 0) {
+      cmd.run();
+      return;
+    }
+  }
+  printf("Unbekannter Befehl '%s', 'help' zeigt die Liste\n", line);
+}
@@ -0,0 +1,509 @@
+/**
+ * @file delta_ota.cpp
+ * @brief Delta-Kopf und -Blöcke per HTTP laden, entpacken, mit dem laufenden Image
+ *        verrechnen und sektorweise in die OTA-Partition schreiben
+ */
+#include "delta_ota.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "esp32/rom/miniz.h"
+#include "nvs.h"
+#include "clock_log.h"
+#include "lan_http.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+
+#ifdef DELTA_OTA_HOST
+
+#define DELTA_OTA_MAGIC  0x444F5431  // "DOT1"
+#define DELTA_SECTOR     4096
+#define DELTA_HEAD_BYTES (sizeof(DeltaHeader) + sizeof(DeltaEntry) * DELTA_OTA_MAX_BLOCKS)
+
+// Format wie in scripts/delta_ota.py (Little Endian wie der ESP32)
+struct DeltaHeader {
+  char     magic[4];      // "CDP1"
+  uint8_t  from[32];      // SHA-256 des Quell-Images
+  uint8_t  to[32];        // SHA-256 des neuen Images
+  uint32_t newSize;
+  uint32_t blockSize;     // Vielfaches von DELTA_SECTOR
+  uint16_t count;
+  uint16_t reserved;
+};
+
+struct DeltaEntry {
+  uint32_t offset;        // Lage im Delta
+  uint32_t length;
+  uint32_t srcStart;      // Quellposition am Blockanfang
+  uint32_t crc;           // CRC-32 der Ausgabe
+};
+
+static_assert(sizeof(DeltaHeader) == 80, "Kopf wie in scripts/delta_ota.py");
+static_assert(sizeof(DeltaEntry) == 16, "Eintrag wie in scripts/delta_ota.py");
+
+enum DeltaPhase : uint8_t {
+  PHASE_NONE = 0,   // kein Delta bekannt
+  PHASE_LOADING,    // Blöcke werden geladen
+  PHASE_READY,      // vollständig, Boot-Partition gesetzt
+  PHASE_CURRENT,    // neues Image läuft
+  PHASE_REJECTED,   // passt nicht zum laufenden Image oder fehlerhaft
+};
+
+// Fortschritt als ein NVS-Blob, nach jedem Block geschrieben
+struct DeltaState {
+  uint32_t    magic;
+  char        etag[DELTA_OTA_ETAG_MAX];   // "" = Server liefert keins
+  DeltaHeader header;
+  DeltaEntry  blocks[DELTA_OTA_MAX_BLOCKS];
+  uint32_t    target;     // Adresse der Zielpartition
+  uint16_t    next;       // nächster zu ladender Block
+  uint8_t     phase;
+  uint8_t     fails;      // Fehlversuche des Blocks next
+};
+
+// nur während deltaOtaStep(): Inflater, sein Fenster, ein Flash-Sektor Ausgabe
+struct DeltaWork {
+  tinfl_decompressor inflator;
+  uint8_t dict[TINFL_LZ_DICT_SIZE];
+  uint8_t out[DELTA_SECTOR];
+  uint8_t src[256];       // Lesecache für die Quelle
+};
+
+enum { CMD_DIFF_LEN, CMD_EXTRA_LEN, CMD_SEEK, CMD_DIFF, CMD_EXTRA };
+
+// ein Block in Arbeit
+struct BlockRun {
+  const esp_partition_t* source;
+  const esp_partition_t* target;
+  const int* httpStatus;
+  uint32_t length;        // Byte des Blocks im Delta
+  uint32_t received;
+  tinfl_status inflate;
+  uint32_t dictPos;
+  uint8_t  cmd;           // CMD_*
+  uint8_t  shift;
+  uint32_t var;
+  uint32_t diff, extra, seek;
+  uint32_t srcPos;
+  uint32_t cacheAt, cacheLen;
+  uint32_t outAt;         // Partitionsoffset von work->out[0]
+  uint32_t outFill;
+  uint32_t outEnd;
+  uint32_t crc;
+  DeltaReject why;        // Fehler, REJECT_NONE solange alles passt
+};
+
+static DeltaState state;
+static DeltaWork* work;
+static BlockRun run;
+static char buf[DELTA_HEAD_BYTES + 512];   // Kopf-Antwort, dann Empfangspuffer
+static uint8_t runningSha[32];
+static const esp_partition_t* runningShaOf = nullptr;   // Partition, zu der runningSha gehört
+#ifdef CLOCK_STATIC_ALLOC
+static DeltaWork workArea;   // keine Zuteilung nach setup()
+#endif
+
+static const char* phaseName(uint8_t phase) {
+  switch (phase) {
+    case PHASE_LOADING:  return "wird geladen";
+    case PHASE_READY:    return "bereit, Neustart ausstehend";
+    case PHASE_CURRENT:  return "läuft";
+    case PHASE_REJECTED: return "verworfen";
+    default:             return "-";
+  }
+}
+
+// --- Fortschritt im NVS ---
+
+// bei jedem Schritt neu: der Stand im NVS gilt, auch nach einem Neustart mitten im Update
+static void loadState() {
+  nvs_handle_t h;
+  size_t len = sizeof(state);
+  bool ok = false;
+  if (nvs_open("ota", NVS_READONLY, &h) == ESP_OK) {
+    ok = nvs_get_blob(h, "delta", &state, &len) == ESP_OK && len == sizeof(state) &&
+         state.magic == DELTA_OTA_MAGIC && memchr(state.etag, 0, sizeof(state.etag)) &&
+         state.header.count <= DELTA_OTA_MAX_BLOCKS && state.next <= state.header.count;
+    nvs_close(h);
+  }
+  if (!ok) memset(&state, 0, sizeof(state));
+}
+
+static bool saveState() {
+  nvs_handle_t h;
+  if (nvs_open("ota", NVS_READWRITE, &h) != ESP_OK) return false;
+  bool ok = nvs_set_blob(h, "delta", &state, sizeof(state)) == ESP_OK && nvs_commit(h) == ESP_OK;
+  nvs_close(h);
+  return ok;
+}
+
+// SHA-256 des laufenden Images, einmal je Boot (liest das ganze Image)
+static const uint8_t* runningHash() {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  if (runningShaOf != running) {
+    runningShaOf = esp_partition_get_sha256(running, runningSha) == ESP_OK ? running : nullptr;
+  }
+  return runningShaOf ? runningSha : nullptr;
+}
+
+// --- Kopf ---
+
+// neuen Kopf prüfen und als Fortschritt übernehmen; Grund bei Ablehnung
+static DeltaReject acceptHeader(int got, const esp_partition_t* target) {
+  size_t bodyLen = 0, etagLen = 0;
+  const char* body = lanHttpBody(buf, got, &bodyLen);
+  const char* etag = lanHttpHeader(buf, got, "ETag", &etagLen);
+  memset(&state, 0, sizeof(state));
+  state.magic = DELTA_OTA_MAGIC;
+  state.phase = PHASE_REJECTED;
+  if (etag && etagLen < sizeof(state.etag)) memcpy(state.etag, etag, etagLen);
+
+  DeltaHeader& h = state.header;
+  if (!body || bodyLen < sizeof(h)) return REJECT_HEAD_SHORT;
+  memcpy(&h, body, sizeof(h));
+  if (memcmp(h.magic, "CDP1", 4) != 0) return REJECT_NOT_DELTA;
+  if (h.count == 0 || h.count > DELTA_OTA_MAX_BLOCKS || h.blockSize == 0 || h.blockSize % DELTA_SECTOR ||
+      (uint64_t)(h.count - 1) * h.blockSize >= h.newSize || (uint64_t)h.count * h.blockSize < h.newSize) {
+    return REJECT_HEAD_BAD;
+  }
+  if (bodyLen < sizeof(h) + sizeof(DeltaEntry) * h.count) return REJECT_TABLE_SHORT;
+  memcpy(state.blocks, body + sizeof(h), sizeof(DeltaEntry) * h.count);
+
+  const uint8_t* sha = runningHash();
+  if (!sha) return REJECT_RUNNING_SHA;
+  if (memcmp(sha, h.to, sizeof(h.to)) == 0) {
+    state.phase = PHASE_CURRENT;
+    return REJECT_NONE;
+  }
+  if (memcmp(sha, h.from, sizeof(h.from)) != 0) return REJECT_OTHER_SOURCE;
+  if (!target) return REJECT_NO_PARTITION;
+  if ((h.newSize + DELTA_SECTOR - 1) / DELTA_SECTOR * DELTA_SECTOR > target->size) return REJECT_TOO_LARGE;
+  state.target = target->address;
+  state.phase = PHASE_LOADING;
+  return REJECT_NONE;
+}
+
+// --- Block anwenden ---
+
+static bool fail(DeltaReject why) {
+  if (!run.why) run.why = why;
+  return false;
+}
+
+// Quellbyte aus dem laufenden Image, über einen kleinen Cache (Diff-Läufe sind fortlaufend)
+static bool readSource(uint32_t pos, uint8_t* b) {
+  if (pos - run.cacheAt >= run.cacheLen) {
+    if (pos >= run.source->size) return fail(REJECT_SOURCE_RANGE);
+    run.cacheAt = pos;
+    run.cacheLen = run.source->size - pos < sizeof(work->src) ? run.source->size - pos : sizeof(work->src);
+    if (esp_partition_read(run.source, pos, work->src, run.cacheLen) != ESP_OK) {
+      run.cacheLen = 0;
+      return fail(REJECT_SOURCE_READ);
+    }
+  }
+  *b = work->src[pos - run.cacheAt];
+  return true;
+}
+
+// gesammelten Sektor löschen und schreiben
+static bool flushOut() {
+  if (run.outFill == 0) return true;
+  if (esp_partition_erase_range(run.target, run.outAt, DELTA_SECTOR) != ESP_OK ||
+      esp_partition_write(run.target, run.outAt, work->out, run.outFill) != ESP_OK) {
+    return fail(REJECT_TARGET_WRITE);
+  }
+  run.crc = esp_rom_crc32_le(run.crc, work->out, run.outFill);
+  run.outAt += run.outFill;
+  run.outFill = 0;
+  return true;
+}
+
+static bool emit(uint8_t b) {
+  if (run.outAt + run.outFill >= run.outEnd) return fail(REJECT_BLOCK_LONG);
+  work->out[run.outFill++] = b;
+  return run.outFill < DELTA_SECTOR || flushOut();
+}
+
+// nach einem Befehlsteil: Diff-Bytes, Extra-Bytes oder (Sprung anwenden) nächster Befehl
+static uint8_t nextPart() {
+  if (run.diff) return CMD_DIFF;
+  if (run.extra) return CMD_EXTRA;
+  run.srcPos += (uint32_t)((run.seek >> 1) ^ (0u - (run.seek & 1)));   // ZigZag
+  return CMD_DIFF_LEN;
+}
+
+// entpackte Befehle ausführen
+static bool execute(const uint8_t* p, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    const uint8_t b = p[i];
+    uint8_t s = 0;
+    switch (run.cmd) {
+      case CMD_DIFF_LEN:
+      case CMD_EXTRA_LEN:
+      case CMD_SEEK:
+        run.var |= (uint32_t)(b & 0x7F) << run.shift;
+        run.shift += 7;
+        if (b & 0x80) {
+          if (run.shift >= 35) return fail(REJECT_COMMAND);
+          continue;
+        }
+        if (run.cmd == CMD_DIFF_LEN) {
+          run.diff = run.var;
+          run.cmd = CMD_EXTRA_LEN;
+        } else if (run.cmd == CMD_EXTRA_LEN) {
+          run.extra = run.var;
+          run.cmd = CMD_SEEK;
+        } else {
+          run.seek = run.var;
+          run.cmd = nextPart();
+        }
+        run.var = 0;
+        run.shift = 0;
+        break;
+      case CMD_DIFF:
+        if (!readSource(run.srcPos++, &s) || !emit((uint8_t)(b + s))) return false;
+        if (--run.diff == 0) run.cmd = nextPart();
+        break;
+      case CMD_EXTRA:
+        if (!emit(b)) return false;
+        ++run.srcPos;
+        if (--run.extra == 0) run.cmd = nextPart();
+        break;
+    }
+  }
+  return true;
+}
+
+// LanHttpSink: Blockdaten durch den Inflater in die Befehle
+static bool inflateSink(void* ctx, const uint8_t* data, size_t len) {
+  (void)ctx;
+  if (*run.httpStatus != 206) return false;   // nur der angefragte Bereich
+  run.received += len;
+  if (run.received > run.length) return fail(REJECT_BLOCK_LONG);
+  const uint32_t flags =
+      TINFL_FLAG_PARSE_ZLIB_HEADER | (run.received < run.length ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+  for (;;) {
+    size_t inLen = len;
+    size_t outLen = TINFL_LZ_DICT_SIZE - run.dictPos;
+    run.inflate = tinfl_decompress(&work->inflator, data, &inLen, work->dict, work->dict + run.dictPos, &outLen,
+                                   flags);
+    data += inLen;
+    len -= inLen;
+    if (!execute(work->dict + run.dictPos, outLen)) return false;
+    run.dictPos = (run.dictPos + outLen) & (TINFL_LZ_DICT_SIZE - 1);
+    if (run.inflate < 0) return fail(REJECT_INFLATE);
+    if (run.inflate == TINFL_STATUS_DONE) return len == 0 || fail(REJECT_TRAILING);
+    if (run.inflate == TINFL_STATUS_HAS_MORE_OUTPUT) continue;
+    if (len == 0) return true;
+    if (inLen == 0 && outLen == 0) return fail(REJECT_INFLATE);
+  }
+}
+
+enum BlockResult { BLOCK_OK, BLOCK_ABORTED, BLOCK_BAD, BLOCK_CHANGED };
+
+static BlockResult loadBlock(const esp_partition_t* source, const esp_partition_t* target, int* httpStatus,
+                             uint32_t* received, int64_t deadlineUs) {
+  const DeltaHeader& h = state.header;
+  const DeltaEntry& e = state.blocks[state.next];
+  memset(&run, 0, sizeof(run));
+  run.source = source;
+  run.target = target;
+  run.httpStatus = httpStatus;
+  run.length = e.length;
+  run.inflate = TINFL_STATUS_NEEDS_MORE_INPUT;
+  run.srcPos = e.srcStart;
+  run.outAt = state.next * h.blockSize;
+  run.outEnd = run.outAt + h.blockSize < h.newSize ? run.outAt + h.blockSize : h.newSize;
+  tinfl_init(&work->inflator);
+
+  char head[256];
+  int n = snprintf(head, sizeof(head), "GET %s HTTP/1.0\r\nHost: %s:%d\r\nRange: bytes=%u-%u\r\n", DELTA_OTA_PATH,
+                   DELTA_OTA_HOST, DELTA_OTA_PORT, (unsigned)e.offset, (unsigned)(e.offset + e.length - 1));
+  if (state.etag[0]) n += snprintf(head + n, sizeof(head) - n, "If-Match: %s\r\n", state.etag);
+  snprintf(head + n, sizeof(head) - n, "\r\n");
+
+  lanHttpStream(DELTA_OTA_HOST, DELTA_OTA_PORT, head, buf, sizeof(buf), httpStatus, inflateSink, nullptr,
+                deadlineUs);
+  *received += run.received;
+  if (*httpStatus == 412) return BLOCK_CHANGED;
+  if (*httpStatus != 206) return BLOCK_ABORTED;
+  if (!run.why && run.received < run.length) return BLOCK_ABORTED;   // Frist oder Verbindung weg
+
+  if (!run.why && (run.inflate != TINFL_STATUS_DONE || run.cmd != CMD_DIFF_LEN || run.shift)) {
+    fail(REJECT_BLOCK_INCOMPLETE);
+  }
+  if (!run.why && flushOut() && run.outAt != run.outEnd) fail(REJECT_BLOCK_SHORT);
+  if (!run.why && run.crc != e.crc) fail(REJECT_CRC);
+  return run.why ? BLOCK_BAD : BLOCK_OK;
+}
+
+// alle Blöcke da: Hash der Zielpartition prüfen und beim nächsten Start booten
+static DeltaReject finish(const esp_partition_t* target) {
+  uint8_t sha[32];
+  if (esp_partition_get_sha256(target, sha) != ESP_OK || memcmp(sha, state.header.to, sizeof(sha)) != 0) {
+    return REJECT_NEW_SHA;
+  }
+  if (esp_ota_set_boot_partition(target) != ESP_OK) return REJECT_BOOT_PARTITION;
+  return REJECT_NONE;
+}
+
+#endif // DELTA_OTA_HOST
+
+// --- Schritt im Sync-Fenster ---
+
+bool deltaOtaStep() {
+#ifdef DELTA_OTA_HOST
+  const int64_t t0 = esp_timer_get_time();
+  uint32_t budget = radioGuardRemainingMs();
+  budget = budget > DELTA_OTA_RESERVE_MS ? budget - DELTA_OTA_RESERVE_MS : 0;
+  if (budget > DELTA_OTA_BUDGET_MS) budget = DELTA_OTA_BUDGET_MS;
+  const int64_t deadline = t0 + (int64_t)budget * 1000;
+
+  // der Sync hat geklappt: das laufende Image taugt (nur mit Rollback im Bootloader wirksam)
+  esp_ota_mark_app_valid_cancel_rollback();
+  loadState();
+  const esp_partition_t* source = esp_ota_get_running_partition();
+  const esp_partition_t* target = esp_ota_get_next_update_partition(nullptr);
+
+  // nach dem Neustart: läuft das neue Image?
+  if (state.phase == PHASE_READY) {
+    const uint8_t* sha = runningHash();
+    state.phase = sha && memcmp(sha, state.header.to, sizeof(state.header.to)) == 0 ? PHASE_CURRENT
+                                                                                      : PHASE_REJECTED;
+    if (state.phase == PHASE_CURRENT) CLOG(MSG_OTA_BOOTED);
+    else CLOG(MSG_OTA_NOT_BOOTED);
+    saveState();
+  }
+
+  char head[192];
+  int n = snprintf(head, sizeof(head), "GET %s HTTP/1.0\r\nHost: %s:%d\r\nRange: bytes=0-%u\r\n", DELTA_OTA_PATH,
+                   DELTA_OTA_HOST, DELTA_OTA_PORT, (unsigned)(DELTA_HEAD_BYTES - 1));
+  if (state.magic == DELTA_OTA_MAGIC && state.etag[0]) {
+    n += snprintf(head + n, sizeof(head) - n, "If-None-Match: %s\r\n", state.etag);
+  }
+  snprintf(head + n, sizeof(head) - n, "\r\n");
+  int got = budget ? lanHttpExchange(DELTA_OTA_HOST, DELTA_OTA_PORT, head, nullptr, 0, buf, sizeof(buf), deadline)
+                   : -1;
+  int status = got > 0 ? lanHttpStatus(buf, got) : 0;
+
+  // flags: 1 = unverändert (304), 2 = neues Delta, 4 = Blöcke geladen, 8 = fertig, 16 = verworfen, 32 = abgebrochen
+  uint8_t flags = 0;
+  DeltaReject why = REJECT_NONE;
+  uint16_t loaded = 0;
+  uint32_t received = 0;
+  if (status == 304) {
+    flags |= 1;
+  } else if (status == 200 || status == 206) {
+    why = acceptHeader(got, target);
+    flags |= why ? 16 : 2;
+    saveState();   // auch abgelehnt: bis zum nächsten Delta nur noch 304
+  } else if (status != 404) {
+    flags |= 32;
+  }
+
+  if (state.phase == PHASE_LOADING && (flags & 3)) {   // Delta noch da (304) oder eben angenommen
+    const uint8_t* sha = runningHash();
+    if (!sha || memcmp(sha, state.header.from, sizeof(state.header.from)) != 0 || !target ||
+        target->address != state.target) {
+      why = REJECT_SOURCE_CHANGED;
+    } else {
+#ifdef CLOCK_STATIC_ALLOC
+      work = &workArea;
+#else
+      work = (DeltaWork*)malloc(sizeof(DeltaWork));
+#endif
+      if (!work) {
+        CLOG(MSG_OTA_NO_MEMORY, sizeof(DeltaWork));
+        flags |= 32;
+      }
+      uint8_t retries = 0;
+      while (work && state.next < state.header.count && esp_timer_get_time() < deadline) {
+        BlockResult r = loadBlock(source, target, &status, &received, deadline);
+        if (r == BLOCK_ABORTED && retries++ < DELTA_OTA_RETRIES) continue;   // Verbindung abgerissen: gleich noch einmal
+        if (r == BLOCK_OK) {
+          ++state.next;
+          state.fails = 0;
+          ++loaded;
+          flags |= 4;
+        } else if (r == BLOCK_CHANGED) {
+          why = REJECT_SERVER_CHANGED;
+          state.magic = 0;   // beim nächsten Sync ohne If-None-Match neu anfangen
+        } else if (r == BLOCK_BAD && ++state.fails >= DELTA_OTA_MAX_FAILS) {
+          why = run.why;
+        } else {
+          if (r == BLOCK_BAD) CLOG(MSG_OTA_BLOCK_BAD, state.next, run.why);
+          flags |= 32;
+        }
+        if (r != BLOCK_ABORTED) saveState();
+        if (r != BLOCK_OK) break;
+      }
+      if (state.next < state.header.count && esp_timer_get_time() >= deadline) flags |= 32;
+#ifndef CLOCK_STATIC_ALLOC
+      free(work);
+#endif
+      work = nullptr;
+      if (state.magic && state.next == state.header.count) {
+        why = finish(target);
+        if (!why) {
+          state.phase = PHASE_READY;
+          flags |= 8;
+        }
+      }
+    }
+    if (why && state.magic) state.phase = PHASE_REJECTED;
+    if (why) flags |= 16;
+    saveState();
+  }
+
+  const uint16_t ms = (uint16_t)((esp_timer_get_time() - t0) / 1000);
+  if (flags & 16) {
+    CLOG(MSG_OTA_REJECTED, why, ms);
+  } else if (flags & 8) {
+    CLOG(MSG_OTA_COMPLETE, state.header.newSize / 1024, ms);
+  } else if (state.phase == PHASE_LOADING) {
+    if (flags & 32) CLOG(MSG_OTA_RESUME, state.next, state.header.count, loaded, received, ms);
+    else CLOG(MSG_OTA_PROGRESS, state.next, state.header.count, loaded, received, ms);
+  } else if (status == 404) {
+    CLOG(MSG_OTA_NONE);
+  } else if (flags & 32) {
+    CLOG(MSG_OTA_UNREACHED, status, ms);
+  } else if (state.phase == PHASE_CURRENT) {
+    CLOG(MSG_OTA_CURRENT, ms);
+  } else if (state.phase == PHASE_REJECTED) {
+    CLOG(MSG_OTA_IDLE, ms);
+  } else {
+    CLOG(MSG_OTA_PHASE, state.phase, ms);
+  }
+  uint16_t v[5] = {ms, (uint16_t)status, state.next, state.header.count,
+                   (uint16_t)(received / 16 > 0xFFFF ? 0xFFFF : received / 16)};
+  telemetryAdd(TELE_OTA, flags, v, 5);
+  return (flags & 8) != 0;
+#else
+  return false;
+#endif
+}
+
+void deltaOtaPrint() {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  const esp_partition_t* next = esp_ota_get_next_update_partition(nullptr);
+  printf("Läuft aus %s (0x%06x), Ziel %s\n", running ? running->label : "?",
+         running ? (unsigned)running->address : 0, next ? next->label : "- (keine OTA-Partition)");
+#ifdef DELTA_OTA_HOST
+  loadState();
+  if (state.magic != DELTA_OTA_MAGIC) {
+    printf("Kein Delta bekannt\n");
+  } else {
+    printf("Delta %s: %s, Block %u/%u zu %u KB, Image %u KB, %u Fehlversuche\n", state.etag[0] ? state.etag : "-",
+           phaseName(state.phase), state.next, state.header.count, (unsigned)(state.header.blockSize / 1024),
+           (unsigned)(state.header.newSize / 1024), state.fails);
+  }
+  printf("Server: http://%s:%d%s\n", DELTA_OTA_HOST, DELTA_OTA_PORT, DELTA_OTA_PATH);
+#else
+  printf("Kein Server (DELTA_OTA_HOST)\n");
+#endif
+}
@@ -0,0 +1,98 @@
+/**
+ * @file heap_monitor.cpp
+ * @brief Ring der stündlichen Heap-/Stack-Stichproben (RTC_NOINIT, mit Magic geprüft)
+ */
+#include "heap_monitor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define HEAP_MON_MAGIC 0x48454131  // "HEA1"
+
+// Arduino: loopTask; ESP-IDF: main, console; beide: lwIP, WLAN, esp_timer
+static const char* const taskNames[HEAP_MON_TASKS] = {
+  "loopTask", "main", "console", "tiT", "wifi", "esp_timer",
+};
+
+struct HeapMonitorRtc {
+  uint32_t magic;
+  uint8_t  head;                          // nächster Schreibplatz
+  HeapSample samples[HEAP_MON_SAMPLES];
+};
+
+RTC_NOINIT_ATTR static HeapMonitorRtc rtc;
+
+static uint16_t units16(size_t bytes) {
+  size_t u = bytes / 16;
+  return u > 0xFFFF ? 0xFFFF : (uint16_t)u;
+}
+
+void heapMonitorInit() {
+  if (rtc.magic != HEAP_MON_MAGIC || rtc.head >= HEAP_MON_SAMPLES) {
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = HEAP_MON_MAGIC;
+  }
+}
+
+void heapMonitorTick(time_t now) {
+  uint32_t hour = (uint32_t)(now / 3600);
+  const HeapSample& last = rtc.samples[(rtc.head + HEAP_MON_SAMPLES - 1) % HEAP_MON_SAMPLES];
+  if (last.hour == hour) return;
+
+  HeapSample& s = rtc.samples[rtc.head];
+  s.hour = hour;
+  s.freeHeap = units16(heap_caps_get_free_size(MALLOC_CAP_8BIT));
+  s.largest = units16(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  s.minFree = units16(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+  for (uint8_t i = 0; i < HEAP_MON_TASKS; ++i) {
+    TaskHandle_t t = xTaskGetHandle(taskNames[i]);
+    s.stackFree[i] = t ? (uint16_t)uxTaskGetStackHighWaterMark(t) : 0xFFFF;
+  }
+  rtc.head = (rtc.head + 1) % HEAP_MON_SAMPLES;
+}
+
+// Steigung des größten freien Blocks in Byte pro Tag (lineare Regression)
+static bool largestTrend(float* bytesPerDay) {
+  double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+  uint32_t h0 = 0;
+  for (uint8_t i = 0; i < HEAP_MON_SAMPLES; ++i) {
+    const HeapSample& s = rtc.samples[(rtc.head + i) % HEAP_MON_SAMPLES];
+    if (s.hour == 0) continue;
+    if (h0 == 0) h0 = s.hour;
+    double x = (double)(s.hour - h0);
+    double y = s.largest * 16.0;
+    n += 1; sx += x; sy += y; sxx += x * x; sxy += x * y;
+  }
+  double den = n * sxx - sx * sx;
+  if (n < 3 || den <= 0) return false;
+  *bytesPerDay = (float)((n * sxy - sx * sy) / den * 24.0);
+  return true;
+}
+
+void heapMonitorPrint() {
+  printf("Stunde       frei  Block    Min");
+  for (uint8_t i = 0; i < HEAP_MON_TASKS; ++i) printf(" %9.9s", taskNames[i]);
+  printf("\n");
+  for (uint8_t i = 0; i < HEAP_MON_SAMPLES; ++i) {
+    const HeapSample& s = rtc.samples[(rtc.head + i) % HEAP_MON_SAMPLES];  // älteste zuerst
+    if (s.hour == 0) continue;
+    time_t t = (time_t)s.hour * 3600;
+    struct tm lt;
+    localtime_r(&t, &lt);
+    printf("%02d.%02d. %02d %7u %6u %6u", lt.tm_mday, lt.tm_mon + 1, lt.tm_hour,
+           s.freeHeap * 16u, s.largest * 16u, s.minFree * 16u);
+    for (uint8_t k = 0; k < HEAP_MON_TASKS; ++k) {
+      if (s.stackFree[k] == 0xFFFF) printf("         -");
+      else printf(" %9u", s.stackFree[k]);
+    }
+    printf("\n");
+  }
+  float trend;
+  if (largestTrend(&trend)) {
+    printf("Trend größter Block: %+.0f Byte/Tag\n", trend);
+  }
+}
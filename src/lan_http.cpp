@@ -0,0 +1,149 @@
+/**
+ * @file lan_http.cpp
+ * @brief HTTP/1.0 über einen lwIP-Socket ohne Blockieren, jedes Warten über select()
+ */
+#include "lan_http.h"
+
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+
+bool lanWait(int s, bool write, int64_t deadlineUs) {
+  int64_t left = deadlineUs - esp_timer_get_time();
+  if (left <= 0) return false;
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(s, &set);
+  struct timeval tv = {(time_t)(left / 1000000), (suseconds_t)(left % 1000000)};
+  return select(s + 1, write ? nullptr : &set, write ? &set : nullptr, nullptr, &tv) > 0;
+}
+
+static bool sendAll(int s, const void* data, size_t len, int64_t deadlineUs) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len) {
+    int n = send(s, p, len, 0);
+    if (n > 0) {
+      p += n;
+      len -= n;
+    } else if (!((errno == EAGAIN || errno == EWOULDBLOCK) && lanWait(s, true, deadlineUs))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// verbinden und Kopf samt Rumpf senden; Socket oder -1
+static int openAndSend(const char* host, uint16_t port, const char* head, const void* body, size_t bodyLen,
+                       int64_t deadlineUs) {
+  int s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (s < 0) return -1;
+  fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(port);
+  to.sin_addr.s_addr = inet_addr(host);
+
+  int err = 0;
+  socklen_t errLen = sizeof(err);
+  if ((connect(s, (struct sockaddr*)&to, sizeof(to)) == 0 || errno == EINPROGRESS) &&
+      lanWait(s, true, deadlineUs) && getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0 && err == 0 &&
+      sendAll(s, head, strlen(head), deadlineUs) && (bodyLen == 0 || sendAll(s, body, bodyLen, deadlineUs))) {
+    return s;
+  }
+  close(s);
+  return -1;
+}
+
+// bis max Byte, bis zum Schließen der Verbindung oder bis zur Frist lesen
+static int readUpTo(int s, char* buf, size_t max, int64_t deadlineUs) {
+  size_t got = 0;
+  while (got < max && lanWait(s, false, deadlineUs)) {
+    int n = recv(s, buf + got, max - got, 0);
+    if (n <= 0) break;   // Server hat geschlossen (HTTP/1.0) oder Fehler
+    got += n;
+  }
+  return (int)got;
+}
+
+int lanHttpExchange(const char* host, uint16_t port, const char* head, const void* body, size_t bodyLen,
+                    char* resp, size_t max, int64_t deadlineUs) {
+  int s = openAndSend(host, port, head, body, bodyLen, deadlineUs);
+  if (s < 0) return -1;
+  int got = readUpTo(s, resp, max, deadlineUs);
+  close(s);
+  return got;
+}
+
+int lanHttpStream(const char* host, uint16_t port, const char* head, char* buf, size_t max, int* status,
+                  LanHttpSink sink, void* ctx, int64_t deadlineUs) {
+  *status = 0;
+  int s = openAndSend(host, port, head, nullptr, 0, deadlineUs);
+  if (s < 0) return -1;
+
+  // Kopf: lesen, bis die Leerzeile im Puffer ist
+  size_t got = 0, bodyLen = 0;
+  const char* body = nullptr;
+  while (!body && got < max && lanWait(s, false, deadlineUs)) {
+    int n = recv(s, buf + got, max - got, 0);
+    if (n <= 0) break;
+    got += n;
+    body = lanHttpBody(buf, (int)got, &bodyLen);
+  }
+  int delivered = -1;
+  if (body) {
+    *status = lanHttpStatus(buf, (int)got);
+    delivered = 0;
+    bool more = bodyLen == 0 || sink(ctx, (const uint8_t*)body, bodyLen);
+    delivered += bodyLen;
+    while (more && lanWait(s, false, deadlineUs)) {
+      int n = recv(s, buf, max, 0);
+      if (n <= 0) break;
+      delivered += n;
+      more = sink(ctx, (const uint8_t*)buf, n);
+    }
+  }
+  close(s);
+  return delivered;
+}
+
+int lanHttpStatus(const char* resp, int len) {
+  if (len < 12 || memcmp(resp, "HTTP/1.", 7) != 0 || resp[8] != ' ') return 0;
+  int code = 0;
+  for (int i = 9; i < 12; ++i) {
+    if (resp[i] < '0' || resp[i] > '9') return 0;
+    code = code * 10 + (resp[i] - '0');
+  }
+  return code;
+}
+
+const char* lanHttpHeader(const char* resp, int len, const char* name, size_t* valueLen) {
+  const size_t nameLen = strlen(name);
+  const char* end = resp + len;
+  const char* line = (const char*)memchr(resp, '\n', len);
+  while (line && ++line < end) {
+    const char* eol = (const char*)memchr(line, '\n', end - line);
+    if (!eol || eol - line <= 1) return nullptr;   // Leerzeile: Ende des Kopfs
+    if ((size_t)(eol - line) > nameLen && line[nameLen] == ':' && strncasecmp(line, name, nameLen) == 0) {
+      const char* v = line + nameLen + 1;
+      while (v < eol && *v == ' ') ++v;
+      const char* ve = eol;
+      if (ve > v && ve[-1] == '\r') --ve;
+      *valueLen = ve - v;
+      return v;
+    }
+    line = eol;
+  }
+  return nullptr;
+}
+
+const char* lanHttpBody(const char* resp, int len, size_t* bodyLen) {
+  for (int i = 0; i + 3 < len; ++i) {
+    if (memcmp(resp + i, "\r\n\r\n", 4) == 0) {
+      *bodyLen = len - i - 4;
+      return resp + i + 4;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,365 @@
+/**
+ * @file main_idf.cpp
+ * @brief Uhr auf reinem ESP-IDF (ohne Arduino-loopTask und WiFi-Wrapper)
+ *
+ * Benutzt denselben Kern wie der Arduino-Build (clock_core.h):
+ * - Display über den IDF-Treiber i2c_master (GPIO 21/22), u8g2 nur als C-Kern
+ * - Zeit über esp_sntp, WLAN direkt über esp_wifi
+ * - Schlafen über esp_pm mit automatischem Light-Sleep und Tickless-Idle
+ *   (siehe sdkconfig.defaults), der Haupttask wartet bis zum nächsten Minutenwechsel
+ *
+ * Build: pio run -e wemos_d1_mini32_idf
+ */
+#ifndef ARDUINO   // Arduino-Build: siehe ESP32-ssh1106.cpp
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2c_master.h"
+#include "driver/uart.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+
+#include "clock_core.h"
+#include "power.h"
+#include "wake_stats.h"
+#include "telemetry.h"
+#include "console.h"
+#include "clock_events.h"
+#include "alloc_guard.h"
+#include "heap_monitor.h"
+#include "radio_guard.h"
+#include "wifi_tune.h"
+#include "wifi_creds.h"
+#include "panel.h"
+#include "ntp_dns.h"
+#include "clock_drift.h"
+#include "tele_upload.h"
+#include "clock_config.h"
+#include "delta_ota.h"
+#include "clock_log.h"
+#include "clock_sync.h"
+
+#define oled_CLK  GPIO_NUM_22
+#define oled_SDA  GPIO_NUM_21
+#define OLED_ADDR 0x3C
+
+static u8g2_t oled;
+static i2c_master_dev_handle_t oledDev;
+#ifdef CLOCK_TEMP_LM75
+static i2c_master_dev_handle_t tempDev;   // am selben Bus wie das Display
+#endif
+static ClockState clockState;
+static bool firstFrameLogged = false;
+
+// --- u8g2 <-> i2c_master ---
+
+// u8g2 liefert eine I2C-Übertragung stückweise (START, SEND..., END);
+// gesammelt wird sie in einem Puffer und dann in einem Rutsch gesendet.
+static uint8_t CLOCK_HOT u8x8ByteI2c(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+  static uint8_t buf[160];
+  static size_t len;
+
+  switch (msg) {
+    case U8X8_MSG_BYTE_INIT:
+      break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      len = 0;
+      break;
+    case U8X8_MSG_BYTE_SEND:
+      if (len + arg_int > sizeof(buf)) return 0;
+      memcpy(buf + len, arg_ptr, arg_int);
+      len += arg_int;
+      break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      return i2c_master_transmit(oledDev, buf, len, 50) == ESP_OK;
+    case U8X8_MSG_BYTE_SET_DC:
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+static uint8_t u8x8GpioDelay(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+  if (msg == U8X8_MSG_DELAY_MILLI) {
+    vTaskDelay(pdMS_TO_TICKS(arg_int) ? pdMS_TO_TICKS(arg_int) : 1);
+  }
+  return 1;  // kein Reset-Pin, keine GPIOs zu bedienen
+}
+
+// --- Temperatur für das Driftmodell ---
+// ESP32 hat im IDF 5 keinen Treiber für den Chip-Sensor; ohne LM75 gilt nur der Mittelwert
+static float readTemperature() {
+#ifdef CLOCK_TEMP_LM75
+  const uint8_t reg = 0x00;   // Temperaturregister
+  uint8_t raw[2];
+  if (i2c_master_transmit_receive(tempDev, &reg, 1, raw, 2, 20) != ESP_OK) return NAN;
+  return (int16_t)((raw[0] << 8) | raw[1]) / 256.0f;
+#else
+  return NAN;
+#endif
+}
+
+static void oledBegin() {
+  i2c_master_bus_config_t busCfg = {};
+  busCfg.i2c_port = I2C_NUM_0;
+  busCfg.sda_io_num = oled_SDA;
+  busCfg.scl_io_num = oled_CLK;
+  busCfg.clk_source = I2C_CLK_SRC_DEFAULT;
+  busCfg.glitch_ignore_cnt = 7;
+  busCfg.flags.enable_internal_pullup = true;
+  i2c_master_bus_handle_t bus;
+  ESP_ERROR_CHECK(i2c_new_master_bus(&busCfg, &bus));
+
+  i2c_device_config_t devCfg = {};
+  devCfg.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+  devCfg.device_address = OLED_ADDR;
+  devCfg.scl_speed_hz = 400000;
+  ESP_ERROR_CHECK(i2c_master_bus_add_device(bus, &devCfg, &oledDev));
+#ifdef CLOCK_TEMP_LM75
+  devCfg.device_address = TEMP_LM75_ADDR;
+  devCfg.scl_speed_hz = 100000;
+  ESP_ERROR_CHECK(i2c_master_bus_add_device(bus, &devCfg, &tempDev));
+#endif
+
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(&oled, OLED_ROTATION, u8x8ByteI2c, u8x8GpioDelay);
+  u8g2_InitDisplay(&oled);
+  panelReset();
+  u8g2_SetFlipMode(&oled, OLED_FLIP);   // Drehung im Controller statt je Pixel in u8g2
+  u8g2_SetPowerSave(&oled, 0); // Display an
+  u8g2_SetContrast(&oled, CONTRAST_STATUS);
+  u8g2_ClearBuffer(&oled);
+}
+
+// --- OLED Statusmeldung ---
+static void showStatus(const char* msg) {
+  renderStatus(&oled, msg);
+}
+
+// --- Zeit anzeigen ---
+static void drawTime(const struct tm* timeinfo) {
+  renderTime(&oled, clockState, timeinfo);
+  if (!firstFrameLogged) {
+    CLOG(MSG_BOOT_FRAME, (uint32_t)(esp_timer_get_time() / 1000));
+    firstFrameLogged = true;
+  }
+}
+
+// --- WLAN ---
+
+static void onWifiEvent(void* arg, esp_event_base_t base, int32_t id, void* data) {
+  if (base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED) {
+    const wifi_event_sta_disconnected_t* d = (const wifi_event_sta_disconnected_t*)data;
+    wifiAttemptEvent(false, d->ssid, d->ssid_len);   // AP nicht gefunden, Anmeldung abgelehnt, Abbruch
+  } else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP) {
+    wifiAttemptEvent(true, nullptr, 0);
+  }
+}
+
+static void wifiInit() {
+  ESP_ERROR_CHECK(esp_netif_init());
+  ESP_ERROR_CHECK(esp_event_loop_create_default());
+  esp_netif_create_default_wifi_sta();
+
+  wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+  ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+  ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+  ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, onWifiEvent, nullptr));
+  ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, onWifiEvent, nullptr));
+}
+
+// --- WLAN-Verbindung für wifiConnect() ---
+static void wifiOpsBegin(const WifiCred& cred, const WifiTuneHint& hint) {
+  wifiAttemptBegin(cred.ssid);
+  wifi_config_t wc = {};
+  strncpy((char*)wc.sta.ssid, cred.ssid, sizeof(wc.sta.ssid));
+  strncpy((char*)wc.sta.password, cred.pass, sizeof(wc.sta.password));
+  wc.sta.scan_method = WIFI_FAST_SCAN;
+  wc.sta.channel = hint.channel;           // 0 = alle Kanäle scannen
+  if (hint.bssidValid) {
+    wc.sta.bssid_set = true;
+    memcpy(wc.sta.bssid, hint.bssid, sizeof(wc.sta.bssid));
+  }
+  esp_wifi_set_config(WIFI_IF_STA, &wc);
+  esp_wifi_connect();
+}
+
+static uint8_t wifiOpsPoll() {
+  return wifiAttemptState();
+}
+
+static void wifiOpsDisconnect() {
+  esp_wifi_disconnect();
+}
+
+static void wifiOpsAbort() {
+  wifiAttemptAbort(wifiOpsDisconnect);   // wartet auf das Disconnect-Ereignis, nicht auf eine feste Zeit
+}
+
+static int wifiOpsScan(WifiScanRecord* out, int max) {
+  wifi_scan_config_t sc = {};
+  sc.scan_time.active.min = 20;
+  sc.scan_time.active.max = 60;    // 60 ms je Kanal
+  if (esp_wifi_scan_start(&sc, true) != ESP_OK) return -1;
+  wifi_ap_record_t recs[16];
+  uint16_t n = max < 16 ? max : 16;
+  if (esp_wifi_scan_get_ap_records(&n, recs) != ESP_OK) return -1;
+  for (uint16_t i = 0; i < n; ++i) {
+    strncpy(out[i].ssid, (const char*)recs[i].ssid, sizeof(out[i].ssid) - 1);
+    out[i].ssid[sizeof(out[i].ssid) - 1] = '\0';
+    out[i].rssi = recs[i].rssi;
+    out[i].channel = recs[i].primary;
+    memcpy(out[i].bssid, recs[i].bssid, sizeof(out[i].bssid));
+  }
+  return n;
+}
+
+static const WifiConnectOps wifiOps = {wifiOpsBegin, wifiOpsPoll, wifiOpsAbort, wifiOpsScan};
+
+// --- Sync: Ablauf in clock_sync.cpp, hier nur WLAN, Takt und Display ---
+static void syncCpu(bool full) {
+  if (full) powerSyncBegin(); // CPU auf 160 MHz, kein Light-Sleep während des Syncs
+  else powerSyncEnd();        // wieder auf 40 MHz runter, Light-Sleep erlaubt
+}
+
+static void syncRadioOn() {
+  esp_wifi_set_mode(WIFI_MODE_STA);
+  esp_wifi_start();
+}
+
+static void syncRadioOff(bool /*ok*/) {
+  esp_wifi_disconnect();
+  esp_wifi_stop();
+}
+
+// Zeitplan nachfragen (meist 304), Delta-Update fortsetzen und Telemetrie senden
+static bool syncOnline() {
+  clockConfigFetch();
+  const bool update = deltaOtaStep();
+  teleUpload();
+  return update;
+}
+
+static const SyncOps syncOps = {&wifiOps, showStatus, syncCpu, syncRadioOn, syncRadioOff, syncOnline};
+
+// --- NTP Synchronisation ---
+static bool syncTime() {
+  const uint8_t result = clockSyncRun(syncOps);
+  allocGuardReport();
+  if (result == SYNC_OK_RESTART) {
+    showStatus("Update, Neustart");
+    clockLogFlush();
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    esp_restart();   // bootet aus der eben geschriebenen OTA-Partition
+  }
+  if (result == SYNC_FAILED) return false;
+  showStatus("Zeit OK");
+  vTaskDelay(pdMS_TO_TICKS(1000));
+  return true;
+}
+
+// --- Konsole ---
+static void consoleTask(void* arg) {
+  uint8_t ch;
+  for (;;) {
+    if (uart_read_bytes(UART_NUM_0, &ch, 1, portMAX_DELAY) == 1) consoleFeed((char)ch);
+  }
+}
+
+static void consoleStart() {
+  ESP_ERROR_CHECK(uart_driver_install(UART_NUM_0, 256, 0, 0, nullptr, 0));
+  // Meldungen gehen als Binärrahmen hinaus, gesammelt (scripts/log_decode.py)
+  clockLogInit([](const uint8_t* data, size_t len) { uart_write_bytes(UART_NUM_0, data, len); });
+  consoleInit();
+#ifdef CLOCK_STATIC_ALLOC
+  static StackType_t consoleStack[4096];
+  static StaticTask_t consoleTcb;
+  xTaskCreateStatic(consoleTask, "console", 4096, nullptr, 2, consoleStack, &consoleTcb);
+#else
+  xTaskCreate(consoleTask, "console", 4096, nullptr, 2, nullptr);
+#endif
+}
+
+// --- Hauptprogramm ---
+extern "C" void app_main() {
+  esp_err_t err = nvs_flash_init();
+  if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    err = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(err);
+
+  setenv("TZ", TIMEZONE, 1);
+  tzset();
+
+  telemetryInit();
+  clockConfigInit();   // gespeicherter Zeitplan vor dem ersten clockPlan()
+  wakeStatsInit();
+  heapMonitorInit();
+  powerInit();
+  consoleStart();
+  clockEventsInit();
+  driftInit(readTemperature);
+  radioGuardInit();
+  oledBegin();
+  wifiInit();
+
+  // erster NTP-Sync beim Start
+  clockSyncDone(clockState, syncTime(), time(nullptr));
+  // alles Weitere soll ohne neue Heap-Zuteilungen auskommen (CLOCK_STATIC_ALLOC)
+  allocGuardArm();
+
+  for (;;) {
+    time_t now = time(nullptr);
+    struct tm nowLocal;
+    localtime_r(&now, &nowLocal);
+
+    wakeStatsTick(now);
+    heapMonitorTick(now);
+    clockEventsDrain(clockState);
+    driftTick(now);
+    clockConfigTick();
+    uint8_t actions = clockPlan(clockState, nowLocal, now);
+
+    if (actions & CLOCK_SYNC) {
+      bool ok = syncTime();
+      clockSyncDone(clockState, ok, time(nullptr));
+      if (ok) {
+        CLOG(MSG_DAILY_OK);
+      } else if (clockState.retryAt) {
+        CLOG(MSG_DAILY_RETRY, SYNC_RETRY_MIN);
+      } else {
+        CLOG(MSG_DAILY_FAILED);
+      }
+    }
+    if (actions & CLOCK_BLANK) {
+      // Zwischen 22:00 und 06:00 Uhr
+      renderBlank(&oled);
+    }
+    if (actions & CLOCK_DRAW) {
+      // Tageszeit 06:00–22:00 Uhr
+      drawTime(&nowLocal);
+    }
+
+    // nächste Minute schon jetzt zeichnen, am Wechsel wird nur noch gesendet
+    if (!clockIsNight(nowLocal)) clockPrepareNext(&oled, clockState, nowLocal);
+    clockLogTick();   // gesammelte Meldungen nur ab und zu, solange die CPU ohnehin wach ist
+
+    // bis kurz nach dem nächsten Minutenwechsel schlafen (Tickless-Idle)
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    vTaskDelay(pdMS_TO_TICKS(clockMsToNextMinute(tv.tv_sec, tv.tv_usec / 1000) + CLOCK_WAKE_MARGIN_MS));
+  }
+}
+
+#endif // !ARDUINO
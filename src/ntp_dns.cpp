@@ -0,0 +1,249 @@
+/**
+ * @file ntp_dns.cpp
+ * @brief DNS-Abfrage (A-Records mit TTL) über lwIP-Sockets und Adress-Cache für SNTP
+ */
+#include "ntp_dns.h"
+
+#include <string.h>
+#include <time.h>
+#include "esp_attr.h"
+#include "esp_idf_version.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "lwip/dns.h"
+#include "lwip/sockets.h"
+#include "nvs.h"
+#include "clock_core.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+#define NTP_DNS_MAGIC 0x444E5331  // "DNS1"
+
+struct NtpDnsCache {
+  uint32_t magic;
+  uint32_t host;                  // FNV-1a von NTP_SERVER, bei anderem Server ungültig
+  uint32_t addr[NTP_DNS_MAX];     // IPv4, Netzwerk-Byte-Reihenfolge
+  uint8_t  count;
+  uint32_t expires;               // Unix-Zeit
+};
+
+// RTC-Kopie für Tiefschlaf und Software-Reset, NVS für das Ausschalten
+RTC_NOINIT_ATTR static NtpDnsCache cache;
+
+static uint32_t hostHash() {
+  uint32_t h = 2166136261u;
+  for (const char* p = NTP_SERVER; *p; ++p) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void cacheLoad() {
+  if (cache.magic == NTP_DNS_MAGIC && cache.host == hostHash() && cache.count <= NTP_DNS_MAX) return;
+  memset(&cache, 0, sizeof(cache));
+  nvs_handle_t h;
+  if (nvs_open("ntpdns", NVS_READONLY, &h) == ESP_OK) {
+    size_t len = sizeof(cache);
+    if (nvs_get_blob(h, "cache", &cache, &len) != ESP_OK || len != sizeof(cache) ||
+        cache.magic != NTP_DNS_MAGIC || cache.host != hostHash() || cache.count > NTP_DNS_MAX) {
+      memset(&cache, 0, sizeof(cache));
+    }
+    nvs_close(h);
+  }
+  cache.magic = NTP_DNS_MAGIC;
+  cache.host = hostHash();
+}
+
+static void cacheSave() {
+  nvs_handle_t h;
+  if (nvs_open("ntpdns", NVS_READWRITE, &h) == ESP_OK) {
+    nvs_set_blob(h, "cache", &cache, sizeof(cache));
+    nvs_commit(h);
+    nvs_close(h);
+  }
+}
+
+// gültig, solange die TTL läuft; ohne gültige Uhrzeit (nach dem Einschalten) erst einmal versuchen
+static bool cacheValid(time_t now) {
+  if (cache.count == 0) return false;
+  return now < (time_t)1704067200 || (uint32_t)now < cache.expires;   // vor 2024: Uhr unbekannt
+}
+
+// --- DNS-Abfrage ---
+
+static size_t buildQuery(uint8_t* q, uint16_t id) {
+  size_t n = 0;
+  q[n++] = id >> 8;
+  q[n++] = id & 0xFF;
+  q[n++] = 0x01;  q[n++] = 0x00;              // RD
+  q[n++] = 0x00;  q[n++] = 0x01;              // QDCOUNT 1
+  memset(q + n, 0, 6);
+  n += 6;
+  for (const char* label = NTP_SERVER; *label;) {
+    const char* dot = strchr(label, '.');
+    size_t len = dot ? (size_t)(dot - label) : strlen(label);
+    q[n++] = (uint8_t)len;
+    memcpy(q + n, label, len);
+    n += len;
+    label += len + (dot ? 1 : 0);
+  }
+  q[n++] = 0;
+  q[n++] = 0x00;  q[n++] = 0x01;              // A
+  q[n++] = 0x00;  q[n++] = 0x01;              // IN
+  return n;
+}
+
+// Name überspringen (Labels oder Zeiger); 0 bei kaputter Antwort
+static size_t skipName(const uint8_t* r, size_t len, size_t p) {
+  while (p < len) {
+    if ((r[p] & 0xC0) == 0xC0) return p + 2;
+    if (r[p] == 0) return p + 1;
+    p += r[p] + 1;
+  }
+  return 0;
+}
+
+static int parseAnswer(const uint8_t* r, size_t len, uint16_t id, uint32_t* addr, uint32_t* ttl) {
+  if (len < 12 || ((r[0] << 8) | r[1]) != id || !(r[2] & 0x80) || (r[3] & 0x0F) != 0) return -1;
+  uint16_t qd = (r[4] << 8) | r[5], an = (r[6] << 8) | r[7];
+  size_t p = 12;
+  for (; qd; --qd) {
+    p = skipName(r, len, p);
+    if (p == 0 || p + 4 > len) return -1;
+    p += 4;
+  }
+  int n = 0;
+  *ttl = UINT32_MAX;
+  for (; an && n < NTP_DNS_MAX; --an) {
+    p = skipName(r, len, p);
+    if (p == 0 || p + 10 > len) break;
+    uint16_t type = (r[p] << 8) | r[p + 1];
+    uint32_t t = ((uint32_t)r[p + 4] << 24) | ((uint32_t)r[p + 5] << 16) | (r[p + 6] << 8) | r[p + 7];
+    uint16_t rdlen = (r[p + 8] << 8) | r[p + 9];
+    p += 10;
+    if (p + rdlen > len) break;
+    if (type == 1 && rdlen == 4) {            // CNAME u. ä. überspringen
+      memcpy(&addr[n++], r + p, 4);
+      if (t < *ttl) *ttl = t;
+    }
+    p += rdlen;
+  }
+  return n;
+}
+
+static uint32_t dnsServer() {
+#ifdef NTP_DNS_SERVER
+  return inet_addr(NTP_DNS_SERVER);
+#else
+  const ip_addr_t* d = dns_getserver(0);
+  return (d && IP_IS_V4(d)) ? ip_2_ip4(d)->addr : 0;
+#endif
+}
+
+// A-Records von NTP_SERVER abfragen; Anzahl der Adressen, -1 bei Fehler
+static int resolve(uint32_t* addr, uint32_t* ttl) {
+  uint32_t server = dnsServer();
+  if (server == 0) return -1;
+  int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (s < 0) return -1;
+  struct timeval tv = {NTP_DNS_TIMEOUT_MS / 1000, (NTP_DNS_TIMEOUT_MS % 1000) * 1000};
+  setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  uint8_t buf[512];
+  const uint16_t id = (uint16_t)esp_timer_get_time();
+  size_t qlen = buildQuery(buf, id);
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(NTP_DNS_PORT);
+  to.sin_addr.s_addr = server;
+  int n = -1;
+  if (sendto(s, buf, qlen, 0, (struct sockaddr*)&to, sizeof(to)) == (int)qlen) {
+    int len = recv(s, buf, sizeof(buf), 0);
+    if (len > 0) n = parseAnswer(buf, (size_t)len, id, addr, ttl);
+  }
+  close(s);
+  return n > 0 ? n : -1;
+}
+
+// --- SNTP ---
+
+static void sntpSetup(bool useAddresses) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  if (esp_sntp_enabled()) esp_sntp_stop();
+  esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
+#else
+  if (sntp_enabled()) sntp_stop();
+  sntp_setoperatingmode(SNTP_OPMODE_POLL);
+#endif
+  const int n = useAddresses ? (cache.count < SNTP_MAX_SERVERS ? cache.count : SNTP_MAX_SERVERS) : 0;
+  for (int i = 0; i < SNTP_MAX_SERVERS; ++i) {
+    ip_addr_t a = {};
+    if (i < n) {
+      IP_SET_TYPE_VAL(a, IPADDR_TYPE_V4);
+      ip_2_ip4(&a)->addr = cache.addr[i];
+    }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_sntp_setservername(i, (i == 0 && n == 0) ? NTP_SERVER : nullptr);
+    esp_sntp_setserver(i, &a);
+#else
+    sntp_setservername(i, (char*)((i == 0 && n == 0) ? NTP_SERVER : nullptr));
+    sntp_setserver(i, &a);
+#endif
+  }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_sntp_init();
+#else
+  sntp_init();
+#endif
+}
+
+// neu auflösen und speichern; false, wenn die Abfrage scheitert
+static bool refresh(uint16_t* ms) {
+  int64_t t0 = esp_timer_get_time();
+  uint32_t addr[NTP_DNS_MAX], ttl = 0;
+  int n = resolve(addr, &ttl);
+  *ms = (uint16_t)((esp_timer_get_time() - t0) / 1000);
+  if (n < 0) {
+    CLOG(MSG_DNS_FAILED, *ms);
+    cache.count = 0;
+    return false;
+  }
+  if (ttl < NTP_DNS_MIN_TTL) ttl = NTP_DNS_MIN_TTL;
+  memcpy(cache.addr, addr, n * sizeof(uint32_t));
+  cache.count = (uint8_t)n;
+  cache.expires = (uint32_t)time(nullptr) + ttl;
+  cacheSave();
+  CLOG(MSG_DNS_RESOLVED, *ms, n, ttl);
+  return true;
+}
+
+static void report(uint8_t flags, uint16_t ms) {
+  time_t now = time(nullptr);
+  uint32_t left = (uint32_t)now < cache.expires ? cache.expires - (uint32_t)now : 0;
+  uint16_t v[3] = {ms, (uint16_t)(left / 60 > 0xFFFF ? 0xFFFF : left / 60), cache.count};
+  telemetryAdd(TELE_DNS, flags, v, 3);
+}
+
+bool ntpDnsStart() {
+  cacheLoad();
+  if (cacheValid(time(nullptr))) {
+    CLOG(MSG_DNS_CACHED, cache.count);
+    sntpSetup(true);
+    report(1, 0);
+    return true;
+  }
+  uint16_t ms;
+  bool ok = refresh(&ms);
+  sntpSetup(ok);
+  report(0, ms);
+  return false;
+}
+
+void ntpDnsFallback() {
+  CLOG(MSG_DNS_FALLBACK);
+  uint16_t ms;
+  bool ok = refresh(&ms);
+  sntpSetup(ok);
+  report(2, ms);
+}
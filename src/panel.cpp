@@ -0,0 +1,74 @@
+/**
+ * @file panel.cpp
+ * @brief Leistungsprofile des SH1106 über direkte Befehle (u8x8_cad)
+ */
+#include "panel.h"
+
+#include <stdio.h>
+#include "esp_attr.h"
+#include "clock_core.h"
+
+const PanelSettings panelProfiles[PANEL_PROFILE_COUNT] CLOCK_HOT_DATA = {
+  {0x32, 0x80, 0xF1},   // DAY: 8,0 V, Oszillator +15 %, Pre-Charge 1 / Discharge 15 (u8g2)
+  {0x30, 0x00, 0x22},   // DIM: 6,4 V, Oszillator −25 %, Pre-Charge 2 / Discharge 2 (Reset-Wert)
+};
+
+static uint8_t active = PANEL_AUTO;            // unbekannt bis zum ersten Setzen
+// Nach dem Tiefschlaf läuft das Display ohne neue Initialisierung weiter und ist
+// noch beschnitten; ohne die Kopie im RTC-Speicher bliebe die Statuszeile dunkel
+RTC_DATA_ATTR static bool cropActive = false;
+static volatile uint8_t forced = PANEL_AUTO;   // von der Konsole
+
+void CLOCK_HOT panelApply(u8g2_t* u8g2, PanelProfile profile) {
+  uint8_t p = forced != PANEL_AUTO ? forced : (uint8_t)profile;
+  if (p >= PANEL_PROFILE_COUNT || p == active) return;
+
+  const PanelSettings& s = panelProfiles[p];
+  u8x8_t* u8x8 = u8g2_GetU8x8(u8g2);
+  u8x8_cad_StartTransfer(u8x8);
+  u8x8_cad_SendCmd(u8x8, s.pump);
+  u8x8_cad_SendCmd(u8x8, 0xD5);
+  u8x8_cad_SendArg(u8x8, s.clock);
+  u8x8_cad_SendCmd(u8x8, 0xD9);
+  u8x8_cad_SendArg(u8x8, s.precharge);
+  u8x8_cad_EndTransfer(u8x8);
+  active = p;
+}
+
+void panelReset() {
+  active = PANEL_DAY;
+  cropActive = false;
+}
+
+void CLOCK_HOT panelCrop(u8g2_t* u8g2, bool on) {
+  if (on == cropActive) return;
+  const uint8_t rows = on ? CLOCK_FACE_PAGES * 8 : 64;
+  const uint8_t first = on ? CLOCK_FACE_PAGE0 * 8 : 0;
+  u8x8_t* u8x8 = u8g2_GetU8x8(u8g2);
+  u8x8_cad_StartTransfer(u8x8);
+  u8x8_cad_SendCmd(u8x8, 0xA8);                  // Multiplex-Ratio: Zeilen − 1
+  u8x8_cad_SendArg(u8x8, rows - 1);
+  u8x8_cad_SendCmd(u8x8, 0xD3);                  // Offset: Scanzeile 0 auf COM first
+  u8x8_cad_SendArg(u8x8, (64 - first) & 63);
+  u8x8_cad_SendCmd(u8x8, 0x40 | first);          // Startzeile: RAM-Zeile first auf Scanzeile 0
+  u8x8_cad_EndTransfer(u8x8);
+  cropActive = on;
+}
+
+void panelForce(uint8_t profile) {
+  forced = profile < PANEL_PROFILE_COUNT ? profile : (uint8_t)PANEL_AUTO;
+}
+
+const char* panelProfileName(uint8_t profile) {
+  switch (profile) {
+    case PANEL_DAY: return "Tag";
+    case PANEL_DIM: return "gedimmt";
+    default:        return "automatisch";
+  }
+}
+
+void panelCycle() {
+  uint8_t next = forced == PANEL_AUTO ? PANEL_DAY : forced + 1;
+  panelForce(next);
+  printf("Panel-Profil: %s (ab dem nächsten Zeichnen)\n", panelProfileName(forced));
+}
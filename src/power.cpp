@@ -0,0 +1,125 @@
+/**
+ * @file power.cpp
+ * @brief esp_pm-Konfiguration und Zählung der Wakeups aus dem Light-Sleep
+ *
+ * Gezählt wird im Exit-Callback des Light-Sleeps (IDF >= 5.2,
+ * CONFIG_PM_LIGHT_SLEEP_CALLBACKS). Ältere IDF-Versionen (Arduino-Core 2.x,
+ * Envs _lowpower und _ulp) haben keinen solchen Callback: der Skip-Callback
+ * läuft auch dann, wenn gar kein Light-Sleep folgt, und die Ursache dort ist
+ * die des letzten echten Wakeups. Dort zählt power.cpp nicht, und
+ * powerWakeCounting() meldet die Zähler als nicht verfügbar.
+ */
+#include "power.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+static WakeStats wakeStats;
+static portMUX_TYPE wakeMux = portMUX_INITIALIZER_UNLOCKED;
+static bool autoSleep = false;
+static bool counting = false;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t syncLock;
+#endif
+
+uint8_t IRAM_ATTR powerClassifyWake(int cause) {
+  switch ((esp_sleep_wakeup_cause_t)cause) {
+    case ESP_SLEEP_WAKEUP_TIMER:
+      return WAKE_TIMER;
+    case ESP_SLEEP_WAKEUP_EXT0:
+    case ESP_SLEEP_WAKEUP_EXT1:
+    case ESP_SLEEP_WAKEUP_GPIO:
+    case ESP_SLEEP_WAKEUP_TOUCHPAD:
+      return WAKE_GPIO;
+    case ESP_SLEEP_WAKEUP_UART:
+      return WAKE_UART;
+    case ESP_SLEEP_WAKEUP_WIFI:
+      return WAKE_WIFI;
+    default:
+      return WAKE_UNKNOWN;
+  }
+}
+
+#if CONFIG_PM_ENABLE && CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static esp_err_t IRAM_ATTR onLightSleepExit(int64_t sleepTimeUs, void* arg) {
+  uint8_t c = powerClassifyWake(esp_sleep_get_wakeup_cause());
+  portENTER_CRITICAL_SAFE(&wakeMux);
+  wakeStats.total++;
+  wakeStats.byCause[c]++;
+  wakeStats.sleptUs += sleepTimeUs > 0 ? (uint64_t)sleepTimeUs : 0;
+  portEXIT_CRITICAL_SAFE(&wakeMux);
+  return ESP_OK;
+}
+#endif
+
+bool powerInit() {
+#if CONFIG_PM_ENABLE
+  esp_pm_config_t pm = {};
+  pm.max_freq_mhz = 160;
+  pm.min_freq_mhz = 40;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  pm.light_sleep_enable = true;
+#endif
+  if (esp_pm_configure(&pm) != ESP_OK) return false;
+  esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "sync", &syncLock);
+  autoSleep = pm.light_sleep_enable;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+  esp_pm_sleep_cbs_register_config_t cbs = {};
+  cbs.exit_cb = onLightSleepExit;
+  counting = esp_pm_light_sleep_register_cbs(&cbs) == ESP_OK;
+#endif
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool powerAutoSleep() {
+  return autoSleep;
+}
+
+bool powerWakeCounting() {
+  return counting;
+}
+
+bool powerSyncBegin() {
+#if CONFIG_PM_ENABLE
+  if (syncLock) {
+    esp_pm_lock_acquire(syncLock);
+    return true;
+  }
+#endif
+  return false;
+}
+
+bool powerSyncEnd() {
+#if CONFIG_PM_ENABLE
+  if (syncLock) {
+    esp_pm_lock_release(syncLock);
+    return true;
+  }
+#endif
+  return false;
+}
+
+const char* wakeCauseName(uint8_t cause) {
+  static const char* const names[WAKE_CAUSE_COUNT] = {"Timer", "GPIO", "UART", "WLAN", "sonst"};
+  return cause < WAKE_CAUSE_COUNT ? names[cause] : "?";
+}
+
+void powerWakeSnapshot(WakeStats* out, bool reset) {
+  portENTER_CRITICAL(&wakeMux);
+  *out = wakeStats;
+  if (reset) memset(&wakeStats, 0, sizeof(wakeStats));
+  portEXIT_CRITICAL(&wakeMux);
+}
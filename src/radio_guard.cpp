@@ -0,0 +1,93 @@
+/**
+ * @file radio_guard.cpp
+ * @brief One-Shot-Timer für das Radio-Budget, RTC-Watchdog als harte Grenze
+ */
+#include "radio_guard.h"
+
+#include <atomic>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "hal/wdt_hal.h"
+#include "soc/rtc.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+#define RADIO_GUARD_ARMED 0x52474431  // "RGD1": Watchdog scharf, steht bis radioGuardStop()
+
+static esp_timer_handle_t guardTimer;
+static std::atomic<bool> expired{false};
+static std::atomic<bool> running{false};
+static int64_t startUs;
+static wdt_hal_context_t rtcWdt;
+
+// übersteht den Reset durch den Watchdog: radioGuardInit() meldet ihn dann
+RTC_NOINIT_ATTR static uint32_t armed;
+
+// im esp_timer-Task: nur das Flag setzen. Abgeschaltet wird im Sync-Task
+// (wifiConnect() und clockSyncRun() fragen radioGuardExpired() ab); esp_wifi_stop()
+// von hier aus kann sich mit dem WLAN-Task verklemmen.
+static void onBudgetExpired(void*) {
+  if (running.load()) expired.store(true);
+}
+
+static void watchdogArm(uint32_t ms) {
+  const uint32_t ticks = (uint32_t)((uint64_t)ms * rtc_clk_slow_freq_get_hz() / 1000);
+  wdt_hal_init(&rtcWdt, WDT_RWDT, 0, false);
+  wdt_hal_write_protect_disable(&rtcWdt);
+  wdt_hal_config_stage(&rtcWdt, WDT_STAGE0, ticks, WDT_STAGE_ACTION_RESET_SYSTEM);
+  wdt_hal_enable(&rtcWdt);
+  wdt_hal_write_protect_enable(&rtcWdt);
+}
+
+static void watchdogDisarm() {
+  wdt_hal_write_protect_disable(&rtcWdt);
+  wdt_hal_disable(&rtcWdt);
+  wdt_hal_write_protect_enable(&rtcWdt);
+}
+
+void radioGuardInit() {
+  if (armed == RADIO_GUARD_ARMED) {
+    // der Sync-Task hat das WLAN nicht innerhalb der Nachfrist abgeschaltet
+    uint16_t v = (RADIO_ON_BUDGET_MS + RADIO_GRACE_MS) / 1000;
+    telemetryAdd(TELE_RADIO_BUDGET, 2, &v, 1);
+    CLOG(MSG_RADIO_WATCHDOG);
+  }
+  armed = 0;
+  esp_timer_create_args_t args = {};
+  args.callback = onBudgetExpired;
+  args.name = "radio_guard";
+  esp_timer_create(&args, &guardTimer);
+}
+
+void radioGuardStart() {
+  expired.store(false);
+  running.store(true);
+  startUs = esp_timer_get_time();
+  esp_timer_stop(guardTimer);
+  esp_timer_start_once(guardTimer, (uint64_t)RADIO_ON_BUDGET_MS * 1000);
+  armed = RADIO_GUARD_ARMED;
+  watchdogArm(RADIO_ON_BUDGET_MS + RADIO_GRACE_MS);
+}
+
+uint32_t radioGuardStop() {
+  if (!running.exchange(false)) return 0;
+  esp_timer_stop(guardTimer);
+  watchdogDisarm();
+  armed = 0;
+  const uint32_t ms = (uint32_t)((esp_timer_get_time() - startUs) / 1000);
+  if (expired.load()) {
+    uint16_t v = RADIO_ON_BUDGET_MS / 1000;
+    telemetryAdd(TELE_RADIO_BUDGET, 1, &v, 1);
+  }
+  return ms;
+}
+
+bool radioGuardExpired() {
+  return expired.load();
+}
+
+uint32_t radioGuardRemainingMs() {
+  if (!running.load() || expired.load()) return 0;
+  int64_t left = (int64_t)RADIO_ON_BUDGET_MS - (esp_timer_get_time() - startUs) / 1000;
+  return left > 0 ? (uint32_t)left : 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file render_bench.cpp
+ * @brief Zyklenzähler um composeTime() + u8g2_SendBuffer(), Cache kalt und warm
+ */
+#include "render_bench.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_idf_version.h"
+#include "esp_partition.h"
+#include "esp_rom_sys.h"
+#include "xtensa/hal.h"
+#include "clock_core.h"
+
+#define EVICT_BYTES (64 * 1024)   // doppelt so groß wie der Flash-Cache eines Kerns
+#define CACHE_LINE  32
+
+// Flash-Cache verdrängen: jede Cache-Zeile eines fremden Bereichs einmal lesen
+static void evictCache(const volatile uint8_t* area) {
+  for (uint32_t i = 0; i < EVICT_BYTES; i += CACHE_LINE) (void)area[i];
+}
+
+static uint32_t frameCycles(u8g2_t* u8g2, const struct tm& shown) {
+  uint32_t c0 = xthal_get_ccount();
+  composeTime(u8g2, &shown);
+  u8g2_SendBuffer(u8g2);
+  return xthal_get_ccount() - c0;
+}
+
+void renderBench() {
+  struct tm shown;
+  u8g2_t* u8g2 = clockShownFrame(&shown);
+  if (!u8g2) {
+    printf("Noch keine Uhrzeit gezeichnet\n");
+    return;
+  }
+
+  const esp_partition_t* app = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, nullptr);
+  const void* area = nullptr;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_partition_mmap_handle_t handle;
+  if (app && esp_partition_mmap(app, 0, EVICT_BYTES, ESP_PARTITION_MMAP_DATA, &area, &handle) != ESP_OK) area = nullptr;
+#else
+  spi_flash_mmap_handle_t handle;
+  if (app && esp_partition_mmap(app, 0, EVICT_BYTES, SPI_FLASH_MMAP_DATA, &area, &handle) != ESP_OK) area = nullptr;
+#endif
+  if (!area) {
+    printf("Flash-Bereich zum Verdrängen nicht verfügbar\n");
+    return;
+  }
+
+  uint32_t cold = 0, warm = 0, coldMin = UINT32_MAX, warmMin = UINT32_MAX;
+  for (int i = 0; i < RENDER_BENCH_RUNS; ++i) {
+    evictCache((const volatile uint8_t*)area);
+    uint32_t c = frameCycles(u8g2, shown);
+    cold += c;
+    if (c < coldMin) coldMin = c;
+    c = frameCycles(u8g2, shown);
+    warm += c;
+    if (c < warmMin) warmMin = c;
+  }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_partition_munmap(handle);
+#else
+  spi_flash_munmap(handle);
+#endif
+
+  const uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+  printf("Zeitbild bei %lu MHz, %d Läufe%s\n", (unsigned long)mhz, RENDER_BENCH_RUNS,
+#ifdef CLOCK_IRAM_RENDER
+         ", Renderpfad im IRAM"
+#else
+         ""
+#endif
+  );
+  printf("  kalt: Ø %lu Takte (%lu µs), min %lu\n", (unsigned long)(cold / RENDER_BENCH_RUNS),
+         (unsigned long)(cold / RENDER_BENCH_RUNS / mhz), (unsigned long)coldMin);
+  printf("  warm: Ø %lu Takte (%lu µs), min %lu\n", (unsigned long)(warm / RENDER_BENCH_RUNS),
+         (unsigned long)(warm / RENDER_BENCH_RUNS / mhz), (unsigned long)warmMin);
+}
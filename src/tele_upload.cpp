@@ -0,0 +1,185 @@
+/**
+ * @file tele_upload.cpp
+ * @brief Telemetrie-Block packen und per UDP oder HTTP mit Zeitbudget senden
+ */
+#include "tele_upload.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "lwip/sockets.h"
+#include "clock_log.h"
+#include "lan_http.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+#include "wake_stats.h"
+
+#ifdef TELE_UPLOAD_HOST
+
+#define TELE_UPLOAD_MAGIC 0x55504C31  // "UPL1"
+
+struct UploadState {
+  uint32_t magic;
+  uint32_t acked;      // erste noch nicht bestätigte Nummer
+};
+
+// übersteht Tiefschlaf und Software-Reset; nach Kaltstart ist auch der Ring leer
+RTC_NOINIT_ATTR static UploadState state;
+
+static TelemetryRecord recs[TELEMETRY_CAPACITY];
+static uint8_t blob[TELE_UPLOAD_MAX_BYTES];
+static int64_t deadline;
+
+// --- Block packen ---
+
+static uint8_t* put16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static uint8_t* put32(uint8_t* p, uint32_t v) {
+  return put16(put16(p, v & 0xFFFF), v >> 16);
+}
+
+static uint8_t* putVarint(uint8_t* p, uint32_t v) {
+  while (v >= 0x80) {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+// Kopf und so viele Einträge, wie in den Block passen; Länge in Byte
+static size_t encode(uint32_t first, const TelemetryRecord* r, uint16_t n, uint16_t* used) {
+  const int64_t uptimeUs = esp_timer_get_time();
+  uint8_t* p = blob;
+  memcpy(p, "CTU1", 4);
+  p += 4;
+  if (esp_wifi_get_mac(WIFI_IF_STA, p) != ESP_OK) memset(p, 0, 6);
+  p += 6;
+  p = put32(p, first);
+  uint8_t* countAt = p;
+  p += 2;
+  uint32_t prev = n ? r[0].time : (uint32_t)time(nullptr);
+  p = put32(p, prev);
+  p = put32(p, (uint32_t)(uptimeUs / 1000000));
+  p = put32(p, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+  p = put32(p, heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+  p = put32(p, heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  p = put16(p, uptimeUs > 0 ? (uint16_t)(wakeStatsSleptUs() * 1000 / (uint64_t)uptimeUs) : 0);
+  *p++ = (uint8_t)esp_reset_reason();
+
+  // Zeitdifferenz + Typ + Flags + Maske + Werte, ungünstigster Fall
+  const size_t worst = 5 + 3 + 3 * TELEMETRY_VALUES;
+  uint16_t k = 0;
+  for (; k < n && (size_t)(p - blob) + worst <= sizeof(blob); ++k) {
+    int32_t dt = (int32_t)(r[k].time - prev);   // rückwärts nach dem Stellen der Uhr
+    prev = r[k].time;
+    p = putVarint(p, ((uint32_t)dt << 1) ^ (uint32_t)(dt >> 31));
+    *p++ = r[k].type;
+    *p++ = r[k].flags;
+    uint8_t* maskAt = p++;
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < TELEMETRY_VALUES; ++i) {
+      if (r[k].v[i] == 0) continue;
+      mask |= 1 << i;
+      p = putVarint(p, r[k].v[i]);
+    }
+    *maskAt = mask;
+  }
+  put16(countAt, k);
+  *used = k;
+  return p - blob;
+}
+
+// --- Senden ---
+
+static int remainingMs() {
+  int64_t left = (deadline - esp_timer_get_time()) / 1000;
+  return left > 0 ? (int)left : 0;
+}
+
+#ifdef TELE_UPLOAD_HTTP
+
+// POST, bestätigt durch eine 2xx-Statuszeile
+static bool transmit(size_t len, uint32_t next) {
+  (void)next;
+  char head[192];
+  snprintf(head, sizeof(head),
+           "POST %s HTTP/1.0\r\nHost: %s:%d\r\nContent-Type: application/octet-stream\r\n"
+           "Content-Length: %u\r\n\r\n",
+           TELE_UPLOAD_PATH, TELE_UPLOAD_HOST, TELE_UPLOAD_PORT, (unsigned)len);
+  char status[12];   // nur die Statuszeile
+  int got = lanHttpExchange(TELE_UPLOAD_HOST, TELE_UPLOAD_PORT, head, blob, len, status, sizeof(status), deadline);
+  int code = lanHttpStatus(status, got);
+  return code >= 200 && code < 300;
+}
+
+#else
+
+// ein Datagramm, bestätigt durch "ACK1" + nächste erwartete Nummer
+static bool transmit(size_t len, uint32_t next) {
+  int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (s < 0) return false;
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(TELE_UPLOAD_PORT);
+  to.sin_addr.s_addr = inet_addr(TELE_UPLOAD_HOST);
+  bool ok = false;
+  // verbunden, damit ein ICMP "Port unerreichbar" recv() gleich beendet
+  if (connect(s, (struct sockaddr*)&to, sizeof(to)) == 0 && send(s, blob, len, 0) == (int)len) {
+    uint8_t ack[8];
+    while (!ok && lanWait(s, false, deadline)) {
+      int n = recv(s, ack, sizeof(ack), 0);
+      if (n < 0) break;
+      ok = n == 8 && memcmp(ack, "ACK1", 4) == 0 &&
+           (ack[4] | ack[5] << 8 | ack[6] << 16 | (uint32_t)ack[7] << 24) == next;
+    }
+  }
+  close(s);
+  return ok;
+}
+
+#endif // TELE_UPLOAD_HTTP
+
+#endif // TELE_UPLOAD_HOST
+
+bool teleUpload() {
+#ifdef TELE_UPLOAD_HOST
+  const int64_t t0 = esp_timer_get_time();
+  uint32_t budget = radioGuardRemainingMs();
+  if (budget > TELE_UPLOAD_BUDGET_MS) budget = TELE_UPLOAD_BUDGET_MS;
+  deadline = t0 + (int64_t)budget * 1000;
+
+  if (state.magic != TELE_UPLOAD_MAGIC) {
+    state.magic = TELE_UPLOAD_MAGIC;
+    state.acked = 0;
+  }
+  uint32_t first = state.acked;
+  uint16_t n = telemetrySince(&first, recs, TELEMETRY_CAPACITY);
+  uint16_t used;
+  size_t len = encode(first, recs, n, &used);
+  const uint32_t next = first + used;
+  const bool ok = budget > 0 && transmit(len, next);
+  if (ok) state.acked = next;
+
+  const uint16_t ms = (uint16_t)((esp_timer_get_time() - t0) / 1000);
+  const bool late = !ok && remainingMs() == 0;
+  const uint32_t pending = telemetrySeq() - (ok ? next : first);
+  if (ok) CLOG(MSG_TELE_ACKED, used, len, ms);
+  else if (late) CLOG(MSG_TELE_LATE, used, len, ms);
+  else CLOG(MSG_TELE_FAILED, used, len, ms);
+  uint16_t v[4] = {ms, (uint16_t)len, used, (uint16_t)(pending > 0xFFFF ? 0xFFFF : pending)};
+  telemetryAdd(TELE_UPLOAD, (ok ? 1 : 0) | (late ? 2 : 0), v, 4);
+  return ok;
+#else
+  return false;
+#endif
+}
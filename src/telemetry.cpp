@@ -0,0 +1,113 @@
+/**
+ * @file telemetry.cpp
+ * @brief Ereignisprotokoll als Ring im RTC-Speicher (RTC_NOINIT, mit Magic geprüft)
+ */
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+
+#define TELEMETRY_MAGIC 0x54454C32  // "TEL2"
+
+struct TelemetryRing {
+  uint32_t magic;
+  uint16_t head;     // nächster Schreibplatz
+  uint16_t count;
+  uint32_t seq;      // Nummer des nächsten Datensatzes
+  TelemetryRecord rec[TELEMETRY_CAPACITY];
+};
+
+RTC_NOINIT_ATTR static TelemetryRing ring;
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+void telemetryInit() {
+  if (ring.magic != TELEMETRY_MAGIC || ring.head >= TELEMETRY_CAPACITY || ring.count > TELEMETRY_CAPACITY) {
+    memset(&ring, 0, sizeof(ring));
+    ring.magic = TELEMETRY_MAGIC;
+  }
+}
+
+void telemetryAdd(uint8_t type, uint8_t flags, const uint16_t* v, uint8_t n) {
+  TelemetryRecord r = {};
+  r.time = (uint32_t)time(nullptr);
+  r.type = type;
+  r.flags = flags;
+  if (n > TELEMETRY_VALUES) n = TELEMETRY_VALUES;
+  if (v && n) memcpy(r.v, v, n * sizeof(uint16_t));
+
+  portENTER_CRITICAL(&ringMux);
+  ring.rec[ring.head] = r;
+  ring.head = (ring.head + 1) % TELEMETRY_CAPACITY;
+  if (ring.count < TELEMETRY_CAPACITY) ring.count++;
+  ring.seq++;
+  portEXIT_CRITICAL(&ringMux);
+}
+
+uint16_t telemetryCount() {
+  return ring.count;
+}
+
+bool telemetryGet(uint16_t idx, TelemetryRecord* out) {
+  portENTER_CRITICAL(&ringMux);
+  bool ok = idx < ring.count;
+  if (ok) {
+    uint16_t first = (ring.head + TELEMETRY_CAPACITY - ring.count) % TELEMETRY_CAPACITY;
+    *out = ring.rec[(first + idx) % TELEMETRY_CAPACITY];
+  }
+  portEXIT_CRITICAL(&ringMux);
+  return ok;
+}
+
+uint32_t telemetrySeq() {
+  return ring.seq;
+}
+
+uint16_t telemetrySince(uint32_t* seq, TelemetryRecord* out, uint16_t max) {
+  portENTER_CRITICAL(&ringMux);
+  const uint32_t oldest = ring.seq - ring.count;
+  if (*seq < oldest || *seq > ring.seq) *seq = oldest;   // überschrieben oder Ring geleert
+  uint16_t n = 0;
+  uint16_t first = (ring.head + TELEMETRY_CAPACITY - ring.count) % TELEMETRY_CAPACITY;
+  for (uint32_t s = *seq; s < ring.seq && n < max; ++s, ++n) {
+    out[n] = ring.rec[(first + (s - oldest)) % TELEMETRY_CAPACITY];
+  }
+  portEXIT_CRITICAL(&ringMux);
+  return n;
+}
+
+static const char* typeName(uint8_t type) {
+  switch (type) {
+    case TELE_BOOT:       return "boot";
+    case TELE_WAKE_HOUR:  return "wake/h";
+    case TELE_WAKE_STORM: return "storm";
+    case TELE_HEAP:       return "heap";
+    case TELE_RADIO_BUDGET: return "radio";
+    case TELE_SYNC:       return "sync";
+    case TELE_WAKE_STUB:  return "stub";
+    case TELE_ULP:        return "ulp";
+    case TELE_DNS:        return "dns";
+    case TELE_DRIFT:      return "drift";
+    case TELE_UPLOAD:     return "upload";
+    case TELE_CONFIG:     return "config";
+    case TELE_OTA:        return "ota";
+    default:              return "?";
+  }
+}
+
+void telemetryPrint() {
+  uint16_t n = telemetryCount();
+  printf("Telemetrie: %u Einträge\n", n);
+  for (uint16_t i = 0; i < n; ++i) {
+    TelemetryRecord r;
+    if (!telemetryGet(i, &r)) break;
+    time_t t = r.time;
+    struct tm lt;
+    localtime_r(&t, &lt);
+    printf("%02d.%02d. %02d:%02d  %-8s %3u", lt.tm_mday, lt.tm_mon + 1, lt.tm_hour, lt.tm_min,
+           typeName(r.type), r.flags);
+    for (uint8_t k = 0; k < TELEMETRY_VALUES; ++k) printf(" %5u", r.v[k]);
+    printf("\n");
+  }
+}
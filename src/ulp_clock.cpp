@@ -0,0 +1,412 @@
+/**
+ * @file ulp_clock.cpp
+ * @brief ULP-FSM-Programm (Sekunden zählen, Ziffern per I2C schreiben) und Tiefschlaf
+ *
+ * Das Programm wird zur Laufzeit aus den Makros von esp32/ulp.h gebaut, damit
+ * es ohne eigenen ULP-Assembler-Schritt auskommt. Daten und Glyphen liegen
+ * außerhalb des reservierten Bereichs in ulpMem (RTC-Slow-Memory); der ULP
+ * liest davon je Wort die unteren 16 Bit, deshalb zwei Bildbytes je Wort.
+ */
+#ifdef CLOCK_ULP
+
+#include "ulp_clock.h"
+
+#include <string.h>
+#include <sys/time.h>
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "esp32/ulp.h"
+#include "driver/rtc_io.h"
+#include "soc/rtc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+#define ULP_CLOCK_MAGIC 0x554C5031  // "ULP1"
+#define ULP_SDA_RTC 9               // GPIO 32
+#define ULP_SCL_RTC 8               // GPIO 33
+
+// Wortoffsets in ulpMem, gemeinsam für ULP und Hauptprozessor
+enum UlpWord : uint16_t {
+  U_SEC = 0,        // Sekunde der laufenden Minute
+  U_UNITS,          // angezeigte Minutenziffern
+  U_TENS,
+  U_WAKE_UNITS,     // bei dieser Minute Hauptprozessor wecken (0xFF = nie)
+  U_WAKE_TENS,
+  U_NACKS,          // I2C ohne ACK
+  U_FRAMES,         // gezeichnete Minuten
+  U_DRAW_TICKS,     // Dauer des letzten Minutenlaufs in RTC-Takten
+  U_PAGE0,          // Seitenbereich der Ziffern
+  U_PAGE_END,
+  U_WORDS,          // Wörter je Seite einer Ziffer
+  U_COL_UNITS,      // erste Spalte im Display-RAM (mit x-Offset)
+  U_COL_TENS,
+  U_CUR_COL,        // Arbeitsvariablen der Zeichenroutine
+  U_CUR_PTR,
+  U_RET,
+  U_PAGE_I,
+  U_WORD_I,
+  U_T0,
+  U_GLYPH_PTR,      // 10 Wortadressen, je Ziffer eine
+  U_GLYPH = U_GLYPH_PTR + 10,
+  U_MEM_WORDS = U_GLYPH + 10 * ULP_GLYPH_WORDS,
+};
+
+struct UlpClockMeta {
+  uint32_t magic;
+  int8_t   tableHour;     // Stunde, für die die Glyphen berechnet sind, -1 = keine
+  uint8_t  tableFace;     // Zifferblatt der Glyphen (clockFace())
+};
+
+RTC_DATA_ATTR static uint32_t ulpMem[U_MEM_WORDS];
+RTC_DATA_ATTR static UlpClockMeta meta;
+
+// --- ULP-Programm ---
+
+enum UlpLabel {
+  L_HALT = 1, L_CHECK, L_CHECK_TENS, L_TENS, L_UNITS, L_DONE, L_NACK, L_WAKE,
+  L_DRAW, L_PAGE, L_WORD, L_SEND, L_BIT, L_BIT0, L_CLK, L_ACK, L_TV1, L_TV2,
+  L_R1, L_R2, L_R3, L_R4, L_R5, L_R6, L_R7, L_R8, L_R9,
+};
+
+// Open-Drain nachgebildet: Ausgangswert ist 0, low = Ausgang an, high = Eingang mit Pull-up
+#define SDA_LOW  I_WR_REG_BIT(RTC_GPIO_ENABLE_W1TS_REG, RTC_GPIO_ENABLE_W1TS_S + ULP_SDA_RTC, 1)
+#define SDA_HIGH I_WR_REG_BIT(RTC_GPIO_ENABLE_W1TC_REG, RTC_GPIO_ENABLE_W1TC_S + ULP_SDA_RTC, 1)
+#define SCL_LOW  I_WR_REG_BIT(RTC_GPIO_ENABLE_W1TS_REG, RTC_GPIO_ENABLE_W1TS_S + ULP_SCL_RTC, 1)
+#define SCL_HIGH I_WR_REG_BIT(RTC_GPIO_ENABLE_W1TC_REG, RTC_GPIO_ENABLE_W1TC_S + ULP_SCL_RTC, 1)
+#define I2C_START SDA_HIGH, SCL_HIGH, SDA_LOW, SCL_LOW
+#define I2C_STOP  SDA_LOW, SCL_HIGH, SDA_HIGH
+
+// Byte in R1 senden; R3 = Rücksprung, danach R0 != 0 bei NACK
+#define SEND_R1(ret) M_MOVL(R3, ret), M_BX(L_SEND), M_LABEL(ret), M_BGE(L_NACK, 1)
+#define SEND_IMM(v, ret) I_MOVI(R1, v), SEND_R1(ret)
+
+// untere 16 Bit des RTC-Zählers nach R0
+#define RTC_TICKS(wait) \
+  I_WR_REG_BIT(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE_S, 1), \
+  M_LABEL(wait), \
+  I_RD_REG(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID_S, RTC_CNTL_TIME_VALID_S), \
+  M_BL(wait, 1), \
+  I_RD_REG(RTC_CNTL_TIME0_REG, 0, 15)
+
+static esp_err_t ulpLoadProgram() {
+  const uint16_t base = (uint16_t)(ulpMem - RTC_SLOW_MEM);
+
+  ulp_insn_t program[] = {
+    // Sekunde weiterzählen, sonst nichts zu tun
+    I_MOVI(R3, base),
+    I_LD(R0, R3, U_SEC), I_ADDI(R0, R0, 1), I_ST(R0, R3, U_SEC),
+    M_BL(L_HALT, 60),
+    I_MOVI(R0, 0), I_ST(R0, R3, U_SEC),
+    RTC_TICKS(L_TV1),
+    I_MOVI(R3, base), I_ST(R0, R3, U_T0),
+
+    // Minute: Einer, bei Überlauf Zehner, bei Stundenwechsel Hauptprozessor
+    I_LD(R0, R3, U_UNITS), I_ADDI(R0, R0, 1), I_ST(R0, R3, U_UNITS),
+    M_BL(L_CHECK, 10),
+    I_MOVI(R0, 0), I_ST(R0, R3, U_UNITS),
+    I_LD(R0, R3, U_TENS), I_ADDI(R0, R0, 1), I_ST(R0, R3, U_TENS),
+    M_BGE(L_WAKE, 6),
+
+    // Weckminute erreicht? Dann zeichnet der Hauptprozessor, auch die Zehner
+    M_LABEL(L_CHECK),
+    I_LD(R1, R3, U_UNITS), I_LD(R2, R3, U_WAKE_UNITS), I_SUBR(R0, R1, R2), M_BXZ(L_CHECK_TENS),
+    M_BX(L_TENS),
+    M_LABEL(L_CHECK_TENS),
+    I_LD(R1, R3, U_TENS), I_LD(R2, R3, U_WAKE_TENS), I_SUBR(R0, R1, R2), M_BXZ(L_WAKE),
+
+    // Zehner nur nach dem Überlauf der Einer
+    M_LABEL(L_TENS),
+    I_LD(R0, R3, U_UNITS), M_BGE(L_UNITS, 1),
+    I_LD(R0, R3, U_COL_TENS), I_ST(R0, R3, U_CUR_COL),
+    I_LD(R0, R3, U_TENS), I_ADDR(R2, R3, R0), I_LD(R0, R2, U_GLYPH_PTR), I_ST(R0, R3, U_CUR_PTR),
+    M_MOVL(R0, L_UNITS), I_ST(R0, R3, U_RET), M_BX(L_DRAW),
+
+    M_LABEL(L_UNITS),
+    I_MOVI(R3, base),
+    I_LD(R0, R3, U_COL_UNITS), I_ST(R0, R3, U_CUR_COL),
+    I_LD(R0, R3, U_UNITS), I_ADDR(R2, R3, R0), I_LD(R0, R2, U_GLYPH_PTR), I_ST(R0, R3, U_CUR_PTR),
+    M_MOVL(R0, L_DONE), I_ST(R0, R3, U_RET), M_BX(L_DRAW),
+
+    // Laufzeit merken, nächste Periode um diese Zeit kürzer (Periode 1)
+    M_LABEL(L_DONE),
+    RTC_TICKS(L_TV2),
+    I_MOVI(R3, base), I_LD(R1, R3, U_T0), I_SUBR(R0, R0, R1), I_ST(R0, R3, U_DRAW_TICKS),
+    I_LD(R0, R3, U_FRAMES), I_ADDI(R0, R0, 1), I_ST(R0, R3, U_FRAMES),
+    I_SLEEP_CYCLE_SEL(1),
+    I_HALT(),
+
+    M_LABEL(L_HALT),
+    I_SLEEP_CYCLE_SEL(0),
+    I_HALT(),
+
+    // Bus mit einem Stopp freigeben, sonst hält der ULP SCL bis zum Wecken auf low
+    M_LABEL(L_NACK),
+    I2C_STOP,
+    I_MOVI(R3, base), I_LD(R0, R3, U_NACKS), I_ADDI(R0, R0, 1), I_ST(R0, R3, U_NACKS),
+    M_LABEL(L_WAKE),
+    I_WAKE(),
+    I_END(),
+    I_HALT(),
+
+    // --- Ziffer U_CUR_PTR an Spalte U_CUR_COL zeichnen, zurück nach U_RET ---
+    M_LABEL(L_DRAW),
+    I_MOVI(R3, base), I_LD(R0, R3, U_PAGE0), I_ST(R0, R3, U_PAGE_I),
+    M_LABEL(L_PAGE),
+    I2C_START,
+    SEND_IMM(ULP_OLED_ADDR << 1, L_R1),
+    SEND_IMM(0x00, L_R2),                                   // Befehle
+    I_MOVI(R3, base), I_LD(R1, R3, U_PAGE_I), I_ORI(R1, R1, 0xB0), SEND_R1(L_R3),
+    I_MOVI(R3, base), I_LD(R1, R3, U_CUR_COL), I_RSHI(R1, R1, 4), I_ORI(R1, R1, 0x10), SEND_R1(L_R4),
+    I_MOVI(R3, base), I_LD(R1, R3, U_CUR_COL), I_ANDI(R1, R1, 0x0F), SEND_R1(L_R5),
+    I2C_STOP,
+    I2C_START,
+    SEND_IMM(ULP_OLED_ADDR << 1, L_R6),
+    SEND_IMM(0x40, L_R7),                                   // Daten
+    I_MOVI(R3, base), I_LD(R0, R3, U_WORDS), I_ST(R0, R3, U_WORD_I),
+    M_LABEL(L_WORD),
+    I_MOVI(R3, base), I_LD(R2, R3, U_CUR_PTR), I_LD(R1, R2, 0), SEND_R1(L_R8),
+    I_MOVI(R3, base), I_LD(R2, R3, U_CUR_PTR), I_LD(R1, R2, 0), I_RSHI(R1, R1, 8), SEND_R1(L_R9),
+    I_MOVI(R3, base), I_LD(R2, R3, U_CUR_PTR), I_ADDI(R2, R2, 1), I_ST(R2, R3, U_CUR_PTR),
+    I_LD(R0, R3, U_WORD_I), I_SUBI(R0, R0, 1), I_ST(R0, R3, U_WORD_I),
+    M_BGE(L_WORD, 1),
+    I2C_STOP,
+    I_MOVI(R3, base), I_LD(R0, R3, U_PAGE_I), I_ADDI(R0, R0, 1), I_ST(R0, R3, U_PAGE_I),
+    I_LD(R1, R3, U_PAGE_END), I_SUBR(R0, R1, R0),
+    M_BGE(L_PAGE, 1),
+    I_LD(R2, R3, U_RET), I_BXR(R2),
+
+    // --- Byte in R1 senden (MSB zuerst), ACK nach R0, zurück nach R3 ---
+    M_LABEL(L_SEND),
+    I_MOVI(R2, 8),
+    M_LABEL(L_BIT),
+    I_ANDI(R0, R1, 0x80),
+    M_BXZ(L_BIT0),
+    SDA_HIGH,
+    M_BX(L_CLK),
+    M_LABEL(L_BIT0),
+    SDA_LOW,
+    M_LABEL(L_CLK),
+    SCL_HIGH,
+    SCL_LOW,
+    I_LSHI(R1, R1, 1),
+    I_SUBI(R2, R2, 1),
+    M_BXZ(L_ACK),
+    M_BX(L_BIT),
+    M_LABEL(L_ACK),
+    SDA_HIGH,
+    SCL_HIGH,
+    I_RD_REG(RTC_GPIO_IN_REG, RTC_GPIO_IN_NEXT_S + ULP_SDA_RTC, RTC_GPIO_IN_NEXT_S + ULP_SDA_RTC),
+    SCL_LOW,
+    I_BXR(R3),
+  };
+
+  size_t size = sizeof(program) / sizeof(ulp_insn_t);
+  return ulp_process_macros_and_load(0, program, &size);
+}
+
+// --- Glyphen ---
+
+static uint8_t frameBase[128 * 8];
+
+// Bereich, in dem sich das Bild vom Ausgangsbild unterscheidet, erweitern
+static void diffRegion(const uint8_t* buf, int stride, int rows, int& c0, int& c1, int& p0, int& p1) {
+  for (int p = 0; p < rows; ++p) {
+    for (int c = 0; c < stride; ++c) {
+      if (buf[p * stride + c] == frameBase[p * stride + c]) continue;
+      if (c < c0) c0 = c;
+      if (c > c1) c1 = c;
+      if (p < p0) p0 = p;
+      if (p > p1) p1 = p;
+    }
+  }
+}
+
+static bool cellMatches(const uint8_t* buf, int stride, int col, int d) {
+  const uint32_t* g = &ulpMem[U_GLYPH + d * ULP_GLYPH_WORDS];
+  const int words = ulpMem[U_WORDS];
+  for (uint32_t p = ulpMem[U_PAGE0]; p < ulpMem[U_PAGE_END]; ++p) {
+    for (int w = 0; w < words; ++w, ++g) {
+      const uint8_t* b = &buf[p * stride + col + 2 * w];
+      if ((uint32_t)(b[0] | (b[1] << 8)) != *g) return false;
+    }
+  }
+  return true;
+}
+
+// Glyphen der Einerstelle aufnehmen und die Zehnerspalte suchen; false = Ziffern nicht gleich breit
+static bool ulpBuildGlyphs(u8g2_t* u8g2, int hour) {
+  uint8_t* buf = u8g2_GetBufferPtr(u8g2);
+  const int stride = u8g2_GetBufferTileWidth(u8g2) * 8;
+  const int rows = u8g2_GetBufferTileHeight(u8g2);
+  if (stride * rows > (int)sizeof(frameBase)) return false;
+
+  struct tm t = {};
+  t.tm_hour = hour;
+  composeTime(u8g2, &t);                       // hh:00
+  memcpy(frameBase, buf, stride * rows);
+
+  int c0 = stride, c1 = -1, p0 = rows, p1 = -1;
+  for (int d = 1; d <= 9; ++d) {
+    t.tm_min = d;
+    composeTime(u8g2, &t);
+    diffRegion(buf, stride, rows, c0, c1, p0, p1);
+  }
+  if (c1 < 0) return false;
+  if ((c1 - c0 + 1) & 1) {                     // zwei Spalten je Wort
+    if (c1 + 1 < stride) c1++; else c0--;
+  }
+  const int words = (c1 - c0 + 1) / 2;
+  if (words * (p1 - p0 + 1) > ULP_GLYPH_WORDS) {
+    CLOG(MSG_ULP_CELL_SIZE, c1 - c0 + 1, p1 - p0 + 1);
+    return false;
+  }
+  ulpMem[U_PAGE0] = p0;
+  ulpMem[U_PAGE_END] = p1 + 1;
+  ulpMem[U_WORDS] = words;
+
+  for (int d = 0; d <= 9; ++d) {
+    t.tm_min = d;
+    composeTime(u8g2, &t);
+    uint32_t* g = &ulpMem[U_GLYPH + d * ULP_GLYPH_WORDS];
+    for (int p = p0; p <= p1; ++p) {
+      for (int w = 0; w < words; ++w) {
+        const uint8_t* b = &buf[p * stride + c0 + 2 * w];
+        *g++ = b[0] | (b[1] << 8);
+      }
+    }
+    ulpMem[U_GLYPH_PTR + d] = (uint32_t)(&ulpMem[U_GLYPH + d * ULP_GLYPH_WORDS] - RTC_SLOW_MEM);
+  }
+
+  // Zehnerstelle: dieselben Glyphen, nur weiter links; passende Spalte suchen
+  int tensCol = -1;
+  for (int col = c0 - 1; col >= 0 && tensCol < 0; --col) {
+    bool ok = cellMatches(frameBase, stride, col, 0);
+    for (int d = 1; d <= 5 && ok; ++d) {
+      t.tm_min = d * 10;
+      composeTime(u8g2, &t);
+      ok = cellMatches(buf, stride, col, d);
+    }
+    if (ok) tensCol = col;
+  }
+  if (tensCol < 0) {
+    CLOG(MSG_ULP_TENS_CELL);
+    return false;
+  }
+
+  const uint8_t xOffset = u8g2_GetU8x8(u8g2)->x_offset;
+  ulpMem[U_COL_UNITS] = c0 + xOffset;
+  ulpMem[U_COL_TENS] = tensCol + xOffset;
+  meta.tableHour = (int8_t)hour;
+  meta.tableFace = clockFace();
+  return true;
+}
+
+// --- Hauptprozessor ---
+
+static void ulpPinsToRtc() {
+  const gpio_num_t pins[] = {(gpio_num_t)ULP_OLED_SDA, (gpio_num_t)ULP_OLED_SCL};
+  for (gpio_num_t pin : pins) {
+    rtc_gpio_init(pin);
+    rtc_gpio_set_direction(pin, RTC_GPIO_MODE_INPUT_ONLY);   // losgelassen = high über Pull-up
+    rtc_gpio_set_level(pin, 0);                              // Ausgangswert für "low"
+    rtc_gpio_pullup_en(pin);
+  }
+}
+
+bool ulpClockResumed() {
+  esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  if (meta.magic != ULP_CLOCK_MAGIC || (cause != ESP_SLEEP_WAKEUP_ULP && cause != ESP_SLEEP_WAKEUP_TIMER) ||
+      time(nullptr) < 1700000000) {
+    return false;
+  }
+  // ULP anhalten und einen laufenden Minutenlauf noch zu Ende schreiben lassen
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  vTaskDelay(pdMS_TO_TICKS(60));
+  rtc_gpio_deinit((gpio_num_t)ULP_OLED_SDA);
+  rtc_gpio_deinit((gpio_num_t)ULP_OLED_SCL);
+  return true;
+}
+
+void ulpClockReport() {
+  if (meta.magic != ULP_CLOCK_MAGIC || ((ulpMem[U_FRAMES] & 0xFFFF) == 0 && (ulpMem[U_NACKS] & 0xFFFF) == 0)) return;
+  uint32_t ticks = ulpMem[U_DRAW_TICKS] & 0xFFFF;
+  uint32_t us = (uint32_t)(((uint64_t)ticks * REG_READ(RTC_SLOW_CLK_CAL_REG)) >> RTC_CLK_CAL_FRACT);
+  CLOG(MSG_ULP_REPORT, ulpMem[U_FRAMES] & 0xFFFF, us, ulpMem[U_NACKS] & 0xFFFF);
+  uint16_t v[3] = {(uint16_t)ulpMem[U_FRAMES], (uint16_t)(us > 0xFFFF ? 0xFFFF : us), (uint16_t)ulpMem[U_NACKS]};
+  telemetryAdd(TELE_ULP, 0, v, 3);
+  ulpMem[U_FRAMES] = 0;
+  ulpMem[U_NACKS] = 0;
+}
+
+// ULP für die angezeigte Minute vorbereiten und starten; false = nicht möglich
+static bool ulpArm(u8g2_t* u8g2, const struct tm& shown) {
+  if (meta.magic != ULP_CLOCK_MAGIC) {
+    meta.magic = ULP_CLOCK_MAGIC;
+    meta.tableHour = -1;
+    ulpMem[U_DRAW_TICKS] = 0;
+  }
+  if ((meta.tableHour != shown.tm_hour || meta.tableFace != clockFace()) && !ulpBuildGlyphs(u8g2, shown.tm_hour)) {
+    meta.tableHour = -1;
+    return false;
+  }
+  composeTime(u8g2, &shown);   // Puffer wieder wie das Display
+
+  // am Sekundenwechsel starten, damit der Sekundenzähler im Raster liegt
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  vTaskDelay(pdMS_TO_TICKS(1000 - tv.tv_usec / 1000));
+  time_t now = time(nullptr);
+  struct tm lt;
+  localtime_r(&now, &lt);
+  if (lt.tm_min != shown.tm_min || lt.tm_hour != shown.tm_hour) return false;   // Minute verpasst
+
+  ulpMem[U_SEC] = lt.tm_sec;   // der erste Lauf kommt nach Periode 0, zur nächsten Sekunde
+  ulpMem[U_UNITS] = shown.tm_min % 10;
+  ulpMem[U_TENS] = shown.tm_min / 10;
+  if (shown.tm_hour >= clockSchedule.syncHour && clockSchedule.syncMin > shown.tm_min) {
+    ulpMem[U_WAKE_UNITS] = clockSchedule.syncMin % 10;
+    ulpMem[U_WAKE_TENS] = clockSchedule.syncMin / 10;
+  } else {
+    ulpMem[U_WAKE_UNITS] = 0xFF;
+    ulpMem[U_WAKE_TENS] = 0xFF;
+  }
+
+  // Periode 0: eine Sekunde; Periode 1 folgt einem Minutenlauf und ist um dessen Dauer kürzer
+  uint32_t drawUs = 20000;
+  if (ulpMem[U_DRAW_TICKS] & 0xFFFF) {   // obere 16 Bit schreibt der ULP mit
+    drawUs = (uint32_t)(((uint64_t)(ulpMem[U_DRAW_TICKS] & 0xFFFF) * REG_READ(RTC_SLOW_CLK_CAL_REG)) >> RTC_CLK_CAL_FRACT);
+    if (drawUs > 500000) drawUs = 20000;
+  }
+  ulp_set_wakeup_period(0, 1000000);
+  ulp_set_wakeup_period(1, 1000000 - drawUs);
+
+  if (ulpLoadProgram() != ESP_OK) {
+    CLOG(MSG_ULP_PROGRAM_SIZE);
+    return false;
+  }
+  ulpPinsToRtc();
+  return ulp_run(0) == ESP_OK;
+}
+
+void ulpClockSleep(u8g2_t* u8g2, const ClockState& st, const struct tm& shown, bool displayOn) {
+  time_t now = time(nullptr);
+  uint32_t sec = clockSecondsToNextEvent(st, shown, now);
+  if (displayOn && ulpArm(u8g2, shown)) {
+    esp_sleep_enable_ulp_wakeup();
+    // Rückfallebene, falls der ULP nicht weckt: kurz nach dem Stundenwechsel
+    uint32_t toHour = (59 - shown.tm_min) * 60 + (60 - shown.tm_sec) + 5;
+    if (toHour < sec) sec = toHour;
+  } else if (displayOn) {
+    sec = 60 - shown.tm_sec;   // ohne ULP jede Minute voll booten
+  }
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);
+  esp_sleep_enable_timer_wakeup((uint64_t)sec * 1000000ULL);
+  esp_deep_sleep_start();
+}
+
+#endif // CLOCK_ULP
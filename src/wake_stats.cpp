@@ -0,0 +1,138 @@
+/**
+ * @file wake_stats.cpp
+ * @brief Stundenbuckets der Wakeups im RTC-Speicher und Budgetprüfung
+ */
+#include "wake_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+#define WAKE_STATS_MAGIC 0x57414B31  // "WAK1"
+
+static_assert(MSG_WAKE_STORM_UNKNOWN - MSG_WAKE_STORM_TIMER == WAKE_UNKNOWN - WAKE_TIMER,
+              "WAKE-STORM-Meldungen in log_messages.h in der Reihenfolge von WakeCause");
+
+struct WakeStatsRtc {
+  uint32_t magic;
+  uint8_t  head;                        // aktueller Stundeneintrag
+  WakeHour hours[WAKE_STATS_HOURS];
+};
+
+RTC_NOINIT_ATTR static WakeStatsRtc rtc;
+static WakeHour unsynced;               // vor dem ersten Sync, wird nie abgeschlossen
+static uint64_t sleptUs;                // Light-Sleep seit dem Boot
+
+static const uint32_t budget[WAKE_CAUSE_COUNT] = {
+  WAKE_BUDGET_TIMER, WAKE_BUDGET_GPIO, WAKE_BUDGET_UART, WAKE_BUDGET_WIFI, WAKE_BUDGET_UNKNOWN,
+};
+
+static uint16_t sat16(uint32_t v) {
+  return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+// automatischer Light-Sleep ohne Exit-Callback: gezählt sind nur die Boots
+static bool bootsOnly() {
+  return powerAutoSleep() && !powerWakeCounting();
+}
+
+// abgeschlossene Stunde ausgeben und protokollieren
+static void closeHour(const WakeHour& h) {
+  uint32_t total = 0;
+  uint16_t v[WAKE_CAUSE_COUNT];
+  for (uint8_t c = 0; c < WAKE_CAUSE_COUNT; ++c) {
+    total += h.byCause[c];
+    v[c] = sat16(h.byCause[c]);
+  }
+  if (h.hour == 0 && total == 0) return;   // leerer Eintrag
+
+  const uint32_t* n = h.byCause;
+  if (bootsOnly()) CLOG(MSG_WAKE_HOUR_BOOTS, total);
+  else if (h.stormMask) CLOG(MSG_WAKE_HOUR_STORM, total, n[0], n[1], n[2], n[3], n[4]);
+  else CLOG(MSG_WAKE_HOUR, total, n[0], n[1], n[2], n[3], n[4]);
+  telemetryAdd(TELE_WAKE_HOUR, h.stormMask | (bootsOnly() ? WAKE_HOUR_BOOTS_ONLY : 0), v, WAKE_CAUSE_COUNT);
+}
+
+void wakeStatsInit() {
+  if (rtc.magic != WAKE_STATS_MAGIC || rtc.head >= WAKE_STATS_HOURS) {
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = WAKE_STATS_MAGIC;
+  }
+
+  // Boot selbst als Wakeup buchen (Deep-Sleep-Timer, Reset, ...)
+  esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  uint8_t c = powerClassifyWake(cause);
+  WakeHour& h = time(nullptr) < WAKE_STATS_TIME_VALID ? unsynced : rtc.hours[rtc.head];
+  h.byCause[c]++;
+  uint16_t v = (uint16_t)cause;
+  telemetryAdd(TELE_BOOT, (uint8_t)esp_reset_reason(), &v, 1);
+}
+
+void wakeStatsTick(time_t now) {
+  WakeStats ws;
+  powerWakeSnapshot(&ws, true);
+  sleptUs += ws.sleptUs;
+
+  // Uhr noch nicht gestellt: keine Stunde, keine Budgetprüfung, nur mitzählen
+  if (now < WAKE_STATS_TIME_VALID) {
+    for (uint8_t c = 0; c < WAKE_CAUSE_COUNT; ++c) unsynced.byCause[c] += ws.byCause[c];
+    return;
+  }
+  memset(&unsynced, 0, sizeof(unsynced));   // erste gültige Stunde: Zwischenzähler verwerfen
+
+  uint32_t hour = (uint32_t)(now / 3600);
+  WakeHour* cur = &rtc.hours[rtc.head];
+  if (cur->hour != hour) {
+    if (cur->hour >= WAKE_STATS_TIME_VALID / 3600) {
+      closeHour(*cur);
+      rtc.head = (rtc.head + 1) % WAKE_STATS_HOURS;
+      cur = &rtc.hours[rtc.head];
+      memset(cur, 0, sizeof(*cur));
+    } else if (cur->hour != 0) {
+      memset(cur, 0, sizeof(*cur));   // Stunde aus 1970 von einem älteren Stand: nie abschließen
+    }
+    cur->hour = hour;
+  }
+
+  for (uint8_t c = 0; c < WAKE_CAUSE_COUNT; ++c) {
+    cur->byCause[c] += ws.byCause[c];
+    uint8_t bit = 1 << c;
+    if (!(cur->stormMask & bit) && cur->byCause[c] > budget[c]) {
+      cur->stormMask |= bit;
+      CLOG_NTH(MSG_WAKE_STORM_TIMER, c, cur->byCause[c], budget[c]);
+      uint16_t v[3] = {(uint16_t)(cur->byCause[c] & 0xFFFF), (uint16_t)(cur->byCause[c] >> 16), sat16(budget[c])};
+      telemetryAdd(TELE_WAKE_STORM, c, v, 3);
+    }
+  }
+}
+
+uint64_t wakeStatsSleptUs() {
+  return sleptUs;
+}
+
+void wakeStatsPrint() {
+  printf("Stunde  ");
+  for (uint8_t c = 0; c < WAKE_CAUSE_COUNT; ++c) printf("%8s", wakeCauseName(c));
+  printf("\n");
+  for (uint8_t i = 1; i <= WAKE_STATS_HOURS; ++i) {
+    const WakeHour& h = rtc.hours[(rtc.head + i) % WAKE_STATS_HOURS];  // älteste zuerst
+    if (h.hour == 0) continue;
+    time_t t = (time_t)h.hour * 3600;
+    struct tm lt;
+    localtime_r(&t, &lt);
+    printf("%02d.%02d. %02d", lt.tm_mday, lt.tm_mon + 1, lt.tm_hour);
+    for (uint8_t c = 0; c < WAKE_CAUSE_COUNT; ++c) {
+      printf("%7lu%c", (unsigned long)h.byCause[c], (h.stormMask & (1 << c)) ? '!' : ' ');
+    }
+    printf("\n");
+  }
+  for (uint8_t c = 0; c < WAKE_CAUSE_COUNT; ++c) {
+    printf("%sBudget %s %lu/h", c ? ", " : "", wakeCauseName(c), (unsigned long)budget[c]);
+  }
+  printf("\n");
+  if (bootsOnly()) printf("Light-Sleep-Wakeups nicht verfügbar (IDF < 5.2), gezählt sind nur Boots\n");
+}
@@ -0,0 +1,270 @@
+/**
+ * @file wake_stub.cpp
+ * @brief Wake-Stub im RTC-IRAM: Einerziffer per Bit-Banging-I2C aktualisieren und weiterschlafen
+ *
+ * Im Stub ist nichts initialisiert: kein Flash-Cache, keine Treiber, kein RTOS.
+ * Alles, was er benutzt, liegt im RTC-Speicher (Code RTC_IRAM_ATTR, Daten
+ * RTC_DATA_ATTR) oder im ROM; keine Konstanten aus dem Flash, keine switch-Tabellen.
+ */
+#ifdef CLOCK_DEEP_SLEEP
+
+#include "wake_stub.h"
+
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "esp_rom_sys.h"
+#include "esp32/rom/rtc.h"
+#include "soc/rtc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/gpio_reg.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/io_mux_reg.h"
+#include "soc/timer_group_reg.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+#define WAKE_STUB_MAGIC 0x53545542  // "STUB"
+
+struct WakeStubRtc {
+  uint32_t magic;
+  uint8_t  left;                  // Minuten, die der Stub noch selbst zeichnen darf
+  uint8_t  next;                  // Index der nächsten Kachel
+  uint8_t  col0, cols;            // Bereich im Display-RAM (mit x-Offset des SH1106)
+  uint8_t  page0, pages;
+  uint64_t alarm;                 // RTC-Takte des laufenden Wakeups
+  uint64_t minuteTicks;           // RTC-Takte je Minute
+  uint16_t ticks[WAKE_STUB_LOG];  // Wake-Dauer je Stub-Minute in RTC-Takten
+  uint8_t  logCount;
+  uint8_t  errors;                // I2C ohne ACK
+  uint8_t  tiles[WAKE_STUB_DIGITS][WAKE_STUB_CELL_BYTES];
+};
+
+RTC_DATA_ATTR static WakeStubRtc stub;
+
+// --- Stub (RTC-IRAM) ---
+
+#define SDA_MASK (1UL << WAKE_STUB_SDA)
+#define SCL_MASK (1UL << WAKE_STUB_SCL)
+#define HALF_US  2    // ~200 kHz; der Stub läuft mit XTAL-Takt
+
+// Open-Drain nachgebildet: low = Ausgang 0, high = Eingang, Pull-up am Modul
+static inline void RTC_IRAM_ATTR lineLow(uint32_t mask) {
+  REG_WRITE(GPIO_OUT_W1TC_REG, mask);
+  REG_WRITE(GPIO_ENABLE_W1TS_REG, mask);
+}
+
+static inline void RTC_IRAM_ATTR lineHigh(uint32_t mask) {
+  REG_WRITE(GPIO_ENABLE_W1TC_REG, mask);
+}
+
+static void RTC_IRAM_ATTR i2cStart() {
+  lineHigh(SDA_MASK);
+  lineHigh(SCL_MASK);
+  esp_rom_delay_us(HALF_US);
+  lineLow(SDA_MASK);
+  esp_rom_delay_us(HALF_US);
+  lineLow(SCL_MASK);
+}
+
+static void RTC_IRAM_ATTR i2cStop() {
+  lineLow(SDA_MASK);
+  esp_rom_delay_us(HALF_US);
+  lineHigh(SCL_MASK);
+  esp_rom_delay_us(HALF_US);
+  lineHigh(SDA_MASK);
+  esp_rom_delay_us(HALF_US);
+}
+
+// true bei ACK
+static bool RTC_IRAM_ATTR i2cWrite(uint8_t b) {
+  for (int i = 0; i < 8; ++i, b <<= 1) {
+    if (b & 0x80) lineHigh(SDA_MASK); else lineLow(SDA_MASK);
+    esp_rom_delay_us(HALF_US);
+    lineHigh(SCL_MASK);
+    esp_rom_delay_us(HALF_US);
+    lineLow(SCL_MASK);
+  }
+  lineHigh(SDA_MASK);
+  esp_rom_delay_us(HALF_US);
+  lineHigh(SCL_MASK);
+  esp_rom_delay_us(HALF_US);
+  bool ack = (REG_READ(GPIO_IN_REG) & SDA_MASK) == 0;
+  lineLow(SCL_MASK);
+  return ack;
+}
+
+static uint64_t RTC_IRAM_ATTR stubRtcTicks() {
+  SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE);
+  while (GET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID) == 0) {
+    esp_rom_delay_us(1);
+  }
+  SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_TIME_VALID_INT_CLR);
+  uint64_t t = READ_PERI_REG(RTC_CNTL_TIME0_REG);
+  return t | ((uint64_t)READ_PERI_REG(RTC_CNTL_TIME1_REG) << 32);
+}
+
+// Kacheln einer Ziffer ins Display-RAM, seitenweise wie u8x8
+static bool RTC_IRAM_ATTR stubDrawTile(const uint8_t* tile) {
+  PIN_FUNC_SELECT(IO_MUX_GPIO21_REG, PIN_FUNC_GPIO);
+  PIN_FUNC_SELECT(IO_MUX_GPIO22_REG, PIN_FUNC_GPIO);
+  PIN_INPUT_ENABLE(IO_MUX_GPIO21_REG);
+  PIN_INPUT_ENABLE(IO_MUX_GPIO22_REG);
+  REG_WRITE(GPIO_FUNC21_OUT_SEL_CFG_REG, SIG_GPIO_OUT_IDX);
+  REG_WRITE(GPIO_FUNC22_OUT_SEL_CFG_REG, SIG_GPIO_OUT_IDX);
+
+  bool ok = true;
+  for (uint8_t p = 0; p < stub.pages && ok; ++p) {
+    REG_WRITE(TIMG_WDTFEED_REG(0), 1);
+    i2cStart();
+    ok = i2cWrite(WAKE_STUB_OLED_ADDR << 1) && i2cWrite(0x00) &&
+         i2cWrite(0xB0 | (stub.page0 + p)) && i2cWrite(0x10 | (stub.col0 >> 4)) && i2cWrite(stub.col0 & 0x0F);
+    i2cStop();
+    if (!ok) break;
+    i2cStart();
+    ok = i2cWrite(WAKE_STUB_OLED_ADDR << 1) && i2cWrite(0x40);
+    for (uint8_t c = 0; c < stub.cols && ok; ++c) ok = i2cWrite(tile[p * stub.cols + c]);
+    i2cStop();
+  }
+  lineHigh(SDA_MASK | SCL_MASK);
+  return ok;
+}
+
+void RTC_IRAM_ATTR esp_wake_deep_sleep(void) {
+  esp_default_wake_deep_sleep();
+  if (stub.magic != WAKE_STUB_MAGIC || stub.left == 0) return;   // voller Boot
+
+  if (!stubDrawTile(stub.tiles[stub.next])) {
+    stub.errors++;
+    stub.left = 0;
+    return;
+  }
+  uint64_t now = stubRtcTicks();
+  if (stub.logCount < WAKE_STUB_LOG) {
+    uint64_t d = now - stub.alarm;
+    stub.ticks[stub.logCount++] = d > 0xFFFF ? 0xFFFF : (uint16_t)d;
+  }
+  stub.next++;
+  stub.left--;
+
+  // nächster Minutenwechsel, fest auf das Raster des ersten Wakeups bezogen
+  stub.alarm += stub.minuteTicks;
+  WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, (uint32_t)stub.alarm);
+  WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, (uint32_t)(stub.alarm >> 32));
+  REG_WRITE(RTC_ENTRY_ADDR_REG, (uint32_t)&esp_wake_deep_sleep);
+  set_rtc_memory_crc();
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+  SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+  while (true) {
+  }
+}
+
+// --- voller Boot ---
+
+bool wakeStubResumed() {
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && stub.magic == WAKE_STUB_MAGIC &&
+         time(nullptr) > 1700000000;   // Uhrzeit hat den Tiefschlaf überstanden
+}
+
+void wakeStubReport() {
+  if (stub.magic != WAKE_STUB_MAGIC || (stub.logCount == 0 && stub.errors == 0)) return;
+  uint32_t cal = REG_READ(RTC_SLOW_CLK_CAL_REG);   // µs je Takt, Q13.19
+  uint32_t maxUs = 0;
+  uint64_t sumUs = 0;
+  for (uint8_t i = 0; i < stub.logCount; ++i) {
+    uint32_t us = (uint32_t)(((uint64_t)stub.ticks[i] * cal) >> RTC_CLK_CAL_FRACT);
+    sumUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+  uint32_t avgUs = stub.logCount ? (uint32_t)(sumUs / stub.logCount) : 0;
+  CLOG(MSG_STUB_REPORT, stub.logCount, avgUs, maxUs, stub.errors);
+
+  uint16_t v[4] = {stub.logCount, (uint16_t)(avgUs > 0xFFFF ? 0xFFFF : avgUs),
+                   (uint16_t)(maxUs > 0xFFFF ? 0xFFFF : maxUs), stub.errors};
+  telemetryAdd(TELE_WAKE_STUB, 0, v, 4);
+  stub.logCount = 0;
+  stub.errors = 0;
+}
+
+uint8_t wakeStubMinutes(const ClockState& st, const struct tm& shown, time_t now) {
+  if (clockIsNight(shown)) return 0;
+  int n = 9 - shown.tm_min % 10;          // Zehner- und Stundenwechsel zeichnet der volle Boot
+  const int syncMin = clockSchedule.syncMin;
+  if (shown.tm_hour >= clockSchedule.syncHour && syncMin > shown.tm_min && syncMin - shown.tm_min <= n) {
+    n = syncMin - shown.tm_min - 1;
+  }
+  if (st.retryAt) {
+    long m = (long)(st.retryAt - now) / 60;
+    if (m < n) n = m < 0 ? 0 : (int)m;
+  }
+  return n > WAKE_STUB_DIGITS ? WAKE_STUB_DIGITS : (uint8_t)n;
+}
+
+bool wakeStubArm(u8g2_t* u8g2, const struct tm& shown, uint8_t minutes) {
+  stub.magic = WAKE_STUB_MAGIC;
+  stub.left = 0;
+  stub.next = 0;
+  if (minutes == 0) return false;
+
+  uint8_t* buf = u8g2_GetBufferPtr(u8g2);
+  const uint16_t stride = u8g2_GetBufferTileWidth(u8g2) * 8;
+  const uint8_t rows = u8g2_GetBufferTileHeight(u8g2);
+  static uint8_t base[128 * 8];
+  if ((size_t)stride * rows > sizeof(base)) return false;
+
+  // 1. Bereich bestimmen, in dem sich die folgenden Minuten von der angezeigten unterscheiden
+  struct tm t = shown;
+  composeTime(u8g2, &t);
+  memcpy(base, buf, stride * rows);
+  int c0 = stride, c1 = -1, p0 = rows, p1 = -1;
+  for (uint8_t k = 1; k <= minutes; ++k) {
+    t.tm_min = shown.tm_min + k;
+    composeTime(u8g2, &t);
+    for (int p = 0; p < rows; ++p) {
+      for (int c = 0; c < stride; ++c) {
+        if (buf[p * stride + c] == base[p * stride + c]) continue;
+        if (c < c0) c0 = c;
+        if (c > c1) c1 = c;
+        if (p < p0) p0 = p;
+        if (p > p1) p1 = p;
+      }
+    }
+  }
+  const int cols = c1 - c0 + 1, pages = p1 - p0 + 1;
+  if (c1 < 0 || cols * pages > WAKE_STUB_CELL_BYTES) {
+    CLOG(MSG_STUB_CELL_SIZE, cols, pages);
+    composeTime(u8g2, &shown);
+    return false;
+  }
+
+  // 2. Kacheln je Minute ablegen
+  for (uint8_t k = 1; k <= minutes; ++k) {
+    t.tm_min = shown.tm_min + k;
+    composeTime(u8g2, &t);
+    for (int p = 0; p < pages; ++p) {
+      memcpy(&stub.tiles[k - 1][p * cols], &buf[(p0 + p) * stride + c0], cols);
+    }
+  }
+  composeTime(u8g2, &shown);   // Puffer wieder wie das Display
+
+  stub.col0 = (uint8_t)(c0 + u8g2_GetU8x8(u8g2)->x_offset);
+  stub.cols = (uint8_t)cols;
+  stub.page0 = (uint8_t)p0;
+  stub.pages = (uint8_t)pages;
+  stub.left = minutes;
+  return true;
+}
+
+void wakeStubSleep(uint32_t msToNextMinute) {
+  uint32_t cal = REG_READ(RTC_SLOW_CLK_CAL_REG);
+  uint64_t us = (uint64_t)msToNextMinute * 1000;
+  stub.minuteTicks = (60000000ULL << RTC_CLK_CAL_FRACT) / cal;
+  stub.alarm = rtc_time_get() + (us << RTC_CLK_CAL_FRACT) / cal;
+
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_ON);
+  esp_sleep_enable_timer_wakeup(us);
+  esp_deep_sleep_start();
+}
+
+#endif // CLOCK_DEEP_SLEEP
@@ -0,0 +1,193 @@
+/**
+ * @file wifi_creds.cpp
+ * @brief Zugangstabelle, Rangfolge und Verbindungsstrategie mit schnellem Wechsel
+ */
+#include "wifi_creds.h"
+
+#include <string.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "clock_log.h"
+#include "radio_guard.h"
+#include <secrets.h>
+
+static const WifiCred creds[] =
+#ifdef SECRET_WIFI_LIST
+    SECRET_WIFI_LIST;
+#else
+    {{SECRET_SSID, SECRET_PASS}};
+#endif
+
+static const uint8_t credCount =
+    sizeof(creds) / sizeof(creds[0]) > WIFI_CREDS_MAX ? WIFI_CREDS_MAX : sizeof(creds) / sizeof(creds[0]);
+
+// --- Zustand des laufenden Versuchs ---
+
+enum : uint8_t {
+  ATTEMPT_ABORTING = WIFI_ATTEMPT_FAILED + 1,   // disconnect() läuft, Trennung steht aus
+  ATTEMPT_IDLE,                                 // kein Versuch; Ereignisse sind Nachzügler
+};
+
+static std::atomic<uint8_t> attemptState{ATTEMPT_IDLE};
+static char attemptSsid[33];
+
+void wifiAttemptBegin(const char* ssid) {
+  strncpy(attemptSsid, ssid, sizeof(attemptSsid) - 1);
+  attemptSsid[sizeof(attemptSsid) - 1] = '\0';
+  attemptState.store(WIFI_ATTEMPT_PENDING, std::memory_order_release);
+}
+
+void wifiAttemptEvent(bool connected, const uint8_t* ssid, uint8_t ssidLen) {
+  uint8_t st = attemptState.load(std::memory_order_acquire);
+  if (connected) {
+    if (st == WIFI_ATTEMPT_PENDING) attemptState.compare_exchange_strong(st, WIFI_ATTEMPT_CONNECTED);
+    return;
+  }
+  if (ssidLen && (ssidLen != strlen(attemptSsid) || memcmp(ssid, attemptSsid, ssidLen) != 0)) return;
+  if (st == ATTEMPT_ABORTING) {
+    attemptState.compare_exchange_strong(st, ATTEMPT_IDLE);
+  } else if (st == WIFI_ATTEMPT_PENDING || st == WIFI_ATTEMPT_CONNECTED) {
+    attemptState.compare_exchange_strong(st, WIFI_ATTEMPT_FAILED);   // AP nicht gefunden, abgelehnt, ...
+  }
+}
+
+uint8_t wifiAttemptState() {
+  const uint8_t st = attemptState.load(std::memory_order_acquire);
+  return st <= WIFI_ATTEMPT_FAILED ? st : (uint8_t)WIFI_ATTEMPT_FAILED;
+}
+
+void wifiAttemptAbort(void (*disconnect)()) {
+  uint8_t st = attemptState.exchange(ATTEMPT_ABORTING);
+  if (st == WIFI_ATTEMPT_FAILED || st == ATTEMPT_IDLE) {
+    attemptState.store(ATTEMPT_IDLE);   // Treiber hat schon aufgegeben, es kommt keine Trennung mehr
+    return;
+  }
+  disconnect();
+  const int64_t t0 = esp_timer_get_time();
+  while (attemptState.load(std::memory_order_acquire) == ATTEMPT_ABORTING &&
+         esp_timer_get_time() - t0 < (int64_t)WIFI_ABORT_WAIT_MS * 1000) {
+    vTaskDelay(pdMS_TO_TICKS(5));
+  }
+  attemptState.store(ATTEMPT_IDLE);
+}
+
+uint8_t wifiCredCount() {
+  return credCount;
+}
+
+const WifiCred& wifiCred(uint8_t idx) {
+  return creds[idx < credCount ? idx : 0];
+}
+
+uint8_t wifiCredsRanked(uint8_t* order) {
+  ApTune tune[WIFI_CREDS_MAX];
+  for (uint8_t i = 0; i < credCount; ++i) {
+    wifiTuneLoad(creds[i].ssid, &tune[i]);
+    order[i] = i;
+  }
+  // Einfügesortierung: ohne Fehlschlag vor mit Fehlschlag, dann jüngster Erfolg zuerst
+  for (uint8_t i = 1; i < credCount; ++i) {
+    uint8_t k = order[i];
+    int j = i - 1;
+    while (j >= 0) {
+      const ApTune& a = tune[order[j]];
+      const ApTune& b = tune[k];
+      bool bBetter = (b.failures == 0 && a.failures != 0) ||
+                     ((b.failures == 0) == (a.failures == 0) && b.lastOk > a.lastOk);
+      if (!bBetter) break;
+      order[j + 1] = order[j];
+      --j;
+    }
+    order[j + 1] = k;
+  }
+  return credCount;
+}
+
+// ein Versuch: true bei Verbindung; bricht bei Fehlermeldung des Treibers sofort ab
+static bool attempt(const WifiConnectOps& ops, uint8_t idx, const WifiTuneHint& hint, uint32_t timeoutMs) {
+  const WifiCred& cred = creds[idx];
+  uint32_t left = radioGuardRemainingMs();
+  if (left == 0) return false;
+  if (timeoutMs > left) timeoutMs = left;
+
+  if (hint.channel) CLOG(MSG_WIFI_TRY_HINT, idx, hint.channel);
+  else CLOG(MSG_WIFI_TRY, idx);
+  int64_t t0 = esp_timer_get_time();
+  ops.begin(cred, hint);
+  uint8_t st = WIFI_ATTEMPT_PENDING;
+  while (st == WIFI_ATTEMPT_PENDING && !radioGuardExpired() &&
+         (esp_timer_get_time() - t0) / 1000 < (int64_t)timeoutMs) {
+    vTaskDelay(pdMS_TO_TICKS(WIFI_POLL_MS));
+    st = ops.poll();
+  }
+  uint32_t ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+  if (st == WIFI_ATTEMPT_CONNECTED) {
+    wifiTuneConnected(ms);
+    return true;
+  }
+  CLOG(MSG_WIFI_UNREACHED, idx, ms);
+  ops.abort();
+  wifiTuneFailed();
+  return false;
+}
+
+int wifiConnect(const WifiConnectOps& ops) {
+  uint8_t order[WIFI_CREDS_MAX];
+  uint8_t n = wifiCredsRanked(order);
+  bool tried[WIFI_CREDS_MAX] = {};
+  wifiTuneReset();
+
+  // 1. bekannte APs direkt auf ihrem Kanal
+  for (uint8_t i = 0; i < n; ++i) {
+    WifiTuneHint hint;
+    wifiTuneBegin(creds[order[i]].ssid, &hint);
+    if (!hint.channel) continue;
+    wifiTuneAfterStart();
+    tried[order[i]] = true;
+    if (attempt(ops, order[i], hint, WIFI_FAST_TIMEOUT_MS)) return order[i];
+    if (radioGuardExpired()) return -1;
+  }
+
+  // 2. ein Scan, stärkster bekannter AP zuerst
+  WifiScanRecord recs[16];
+  int found = ops.scan ? ops.scan(recs, 16) : -1;
+  if (found >= 0) {
+    for (;;) {
+      int best = -1, bestCred = -1;
+      for (int r = 0; r < found; ++r) {
+        for (uint8_t c = 0; c < n; ++c) {
+          if (recs[r].channel == 0 || strcmp(recs[r].ssid, creds[c].ssid) != 0) continue;
+          if (best < 0 || recs[r].rssi > recs[best].rssi) { best = r; bestCred = c; }
+        }
+      }
+      if (best < 0) break;
+
+      WifiTuneHint hint;
+      wifiTuneBegin(creds[bestCred].ssid, &hint);
+      hint.channel = recs[best].channel;
+      memcpy(hint.bssid, recs[best].bssid, sizeof(hint.bssid));
+      hint.bssidValid = true;
+      wifiTuneAfterStart();
+      if (attempt(ops, bestCred, hint, WIFI_SCAN_TIMEOUT_MS)) return bestCred;
+      if (radioGuardExpired()) return -1;
+      recs[best].channel = 0;   // diesen Eintrag nicht noch einmal
+    }
+    CLOG(MSG_WIFI_NO_AP);
+    return -1;
+  }
+
+  // 3. ohne Scan-Unterstützung: jeden übrigen Zugang mit Kanalsuche des Treibers
+  for (uint8_t i = 0; i < n; ++i) {
+    if (tried[order[i]]) continue;
+    WifiTuneHint hint;
+    wifiTuneBegin(creds[order[i]].ssid, &hint);
+    hint.channel = 0;
+    hint.bssidValid = false;
+    wifiTuneAfterStart();
+    if (attempt(ops, order[i], hint, WIFI_SCAN_TIMEOUT_MS)) return order[i];
+    if (radioGuardExpired()) return -1;
+  }
+  return -1;
+}
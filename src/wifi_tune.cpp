@@ -0,0 +1,156 @@
+/**
+ * @file wifi_tune.cpp
+ * @brief Lernende WLAN-Parameter je AP, gespeichert im NVS-Namensraum "wifitune"
+ */
+#include "wifi_tune.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "esp_idf_version.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+#include "clock_log.h"
+#include "telemetry.h"
+
+// Zustand eines Syncs; wifiTuneReset() leert ihn
+static ApTune cur;
+static char curKey[12];
+static bool curLoaded;
+static bool curTried;          // mit diesem AP wurde ein Versuch gestartet
+static bool curConnected;      // in diesem Sync verbunden
+static bool curFailCounted;    // Fehlschlag schon gebucht
+static int8_t usedTxPower;
+
+// NVS-Schlüssel höchstens 15 Zeichen: "ap" + FNV-1a-Hash der SSID
+static void keyForSsid(const char* ssid, char* key, size_t len) {
+  uint32_t h = 2166136261u;
+  for (const char* p = ssid; *p; ++p) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  snprintf(key, len, "ap%08lx", (unsigned long)h);
+}
+
+int8_t wifiTunePowerForRssi(int8_t rssi) {
+  // Reserve von rund 10 dB über der Empfindlichkeit für MCS-Raten behalten
+  if (rssi == 0)   return WIFI_TX_POWER_MAX;
+  if (rssi > -50)  return 34;   //  8,5 dBm
+  if (rssi > -60)  return 44;   // 11 dBm
+  if (rssi > -67)  return 60;   // 15 dBm
+  return WIFI_TX_POWER_MAX;
+}
+
+static bool loadKey(const char* key, ApTune* out) {
+  bool ok = false;
+  nvs_handle_t h;
+  if (nvs_open("wifitune", NVS_READONLY, &h) == ESP_OK) {
+    size_t len = sizeof(*out);
+    ok = nvs_get_blob(h, key, out, &len) == ESP_OK && len == sizeof(*out);
+    nvs_close(h);
+  }
+  if (!ok) memset(out, 0, sizeof(*out));
+  return ok;
+}
+
+static void saveCurrent() {
+  nvs_handle_t h;
+  if (nvs_open("wifitune", NVS_READWRITE, &h) == ESP_OK) {
+    nvs_set_blob(h, curKey, &cur, sizeof(cur));
+    nvs_commit(h);
+    nvs_close(h);
+  }
+}
+
+bool wifiTuneLoad(const char* ssid, ApTune* out) {
+  char key[12];
+  keyForSsid(ssid, key, sizeof(key));
+  return loadKey(key, out);
+}
+
+void wifiTuneReset() {
+  memset(&cur, 0, sizeof(cur));
+  curKey[0] = '\0';
+  curLoaded = false;
+  curTried = false;
+  curConnected = false;
+  curFailCounted = false;
+  usedTxPower = 0;
+}
+
+void wifiTuneBegin(const char* ssid, WifiTuneHint* hint) {
+  keyForSsid(ssid, curKey, sizeof(curKey));
+  curLoaded = loadKey(curKey, &cur);
+  curTried = false;
+  curConnected = false;
+  curFailCounted = false;
+
+  memset(hint, 0, sizeof(*hint));
+  if (curLoaded && cur.failures == 0 && cur.channel) {
+    hint->channel = cur.channel;
+    memcpy(hint->bssid, cur.bssid, sizeof(hint->bssid));
+    hint->bssidValid = true;
+  }
+}
+
+void wifiTuneAfterStart() {
+  curTried = true;
+  // nach einem Fehlschlag mit voller Leistung
+  usedTxPower = cur.failures ? WIFI_TX_POWER_MAX : wifiTunePowerForRssi(cur.rssi);
+  esp_wifi_set_max_tx_power(usedTxPower);
+
+  uint8_t proto = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N;
+  if (curLoaded && cur.protocol && !(cur.protocol & WIFI_PROTOCOL_11N)) {
+    proto = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G;   // AP ohne 11n
+  }
+  esp_wifi_set_protocol(WIFI_IF_STA, proto);
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+  // kürzere Verweilzeit je Kanal, falls doch gescannt werden muss
+  wifi_scan_default_params_t scan = {};
+  scan.scan_time.active.min = 20;
+  scan.scan_time.active.max = 60;
+  scan.scan_time.passive = 110;
+  scan.home_chan_dwell_time = 30;
+  esp_wifi_set_scan_parameters(&scan);
+#endif
+}
+
+void wifiTuneConnected(uint32_t connectMs) {
+  wifi_ap_record_t ap;
+  if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) return;
+  cur.rssi = ap.rssi;
+  cur.channel = ap.primary;
+  memcpy(cur.bssid, ap.bssid, sizeof(cur.bssid));
+  cur.protocol = (ap.phy_11b ? WIFI_PROTOCOL_11B : 0) | (ap.phy_11g ? WIFI_PROTOCOL_11G : 0) |
+                 (ap.phy_11n ? WIFI_PROTOCOL_11N : 0);
+  cur.connectMs = connectMs > 0xFFFF ? 0xFFFF : (uint16_t)connectMs;
+  cur.txPower = usedTxPower;
+  cur.failures = 0;
+  cur.lastOk = (uint32_t)time(nullptr);
+  curConnected = true;
+  CLOG(MSG_AP_DETAILS, cur.channel, cur.rssi, usedTxPower / 4, (usedTxPower % 4) * 25, connectMs);
+}
+
+void wifiTuneFailed() {
+  if (!curTried || curFailCounted) return;
+  if (cur.failures < 0xFF) cur.failures++;
+  curFailCounted = true;
+  saveCurrent();
+}
+
+void wifiTuneEnd(bool ok, uint32_t radioMs) {
+  // Fehlschläge zählen nur, wenn keine Verbindung zustande kam (nicht bei NTP-Fehlern);
+  // ohne Versuch in diesem Sync (Budget, keine Zugänge) wird nichts gespeichert
+  if (curConnected) saveCurrent();
+  else wifiTuneFailed();
+
+  uint16_t v[4] = {
+    (uint16_t)(radioMs > 0xFFFF ? 0xFFFF : radioMs),
+    curConnected ? cur.connectMs : (uint16_t)0,
+    (uint16_t)usedTxPower,
+    (uint16_t)(int16_t)(curTried ? cur.rssi : 0),
+  };
+  telemetryAdd(TELE_SYNC, ok, v, 4);
+  wifiTuneReset();   // der nächste Sync beginnt ohne Reste, auch wenn er wifiConnect() nicht erreicht
+}
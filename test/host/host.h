@@ -0,0 +1,265 @@
+/**
+ * @file host.h
+ * @brief Steuerung der Host-Umgebung für die Tests unter test/host
+ *
+ * Der Uhr-Code aus src/ läuft unverändert gegen die Ersatz-Header in
+ * test/host/include. Die Zeit ist virtuell: esp_timer_get_time() steht, bis
+ * vTaskDelay() sie vorrückt, und dabei feuern Zeitgeber und geplante
+ * WLAN-Ereignisse. Nur solange SNTP auf eine Antwort wartet, läuft die Uhr mit
+ * der echten Zeit mit (UDP an scripts/ntp_standin.py). Ein Sync mit 2 s
+ * simulierter Verbindungsdauer braucht so nur wenige Millisekunden.
+ *
+ * Die Systemzeit (time, gettimeofday, settimeofday, adjtime) wird über
+ * -Wl,--wrap auf die virtuelle Uhr umgelenkt und kann mit hostSetDriftPpm()
+ * gegen die Monotonuhr vor- oder nachgehen.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+#include <clib/u8g2.h>
+#include "esp_sleep.h"
+#include "wifi_creds.h"
+
+// --- Zeit ---
+
+// Einschalten: RTC-Speicher leeren, Uhr auf 1970, Zeitgeber und Ereignisse
+// verwerfen; NVS bleibt erhalten
+void hostPowerOn();
+// Neustart (esp_restart, Watchdog): wie hostPowerOn(), aber RTC-Speicher und
+// Systemzeit bleiben
+void hostReset();
+void hostEraseNvs();
+
+int64_t hostNowUs();
+void hostAdvanceMs(uint32_t ms);
+
+// Systemzeit setzen und ablesen (Sekunden mit Bruchteil)
+void hostSetWallClock(double t);
+double hostWallClock();
+// echte Zeit des Rechners, zum Vergleich mit dem Ergebnis eines Syncs
+double hostRealClock();
+
+// Gang der Systemzeit gegen die Monotonuhr, positiv: geht vor
+void hostSetDriftPpm(double ppm);
+
+// feste Werte für esp_heap_caps.h
+#define HOST_HEAP_FREE    181248
+#define HOST_HEAP_MIN     163840
+#define HOST_HEAP_LARGEST 110592
+
+// Light-Sleep seit dem Boot für wakeStatsSleptUs() (Telemetrie-Upload)
+void hostSetSleptUs(uint64_t us);
+
+// true, solange ein esp_timer-Callback läuft (Kontext des esp_timer-Tasks)
+bool hostInTimerCallback();
+
+// RTC-Watchdog: Zeit bis zum Reset in ms ab dem Scharfschalten, 0 = aus
+uint32_t hostWatchdogMs();
+
+typedef void (*HostFn)(void* arg);
+
+// fn zur virtuellen Zeit us aufrufen; liefert eine Nummer für hostCancel()
+uint32_t hostAt(int64_t us, HostFn fn, void* arg);
+void hostCancel(uint32_t id);
+
+// --- simuliertes WLAN ---
+
+struct HostAp {
+  char     ssid[33];
+  uint8_t  channel;
+  int8_t   rssi;
+  uint8_t  bssid[6];
+  bool     present;       // in Reichweite
+  bool     reject;        // Anmeldung wird nach connectMs abgelehnt
+  uint32_t connectMs;     // Verbinden inkl. DHCP; HOST_WIFI_NEVER: kein Ereignis, hängt
+};
+
+#define HOST_WIFI_NEVER 0xFFFFFFFFu
+
+struct HostWifiTiming {
+  uint32_t notFoundMs;     // AP fehlt oder falscher Kanal: Fehlschlag nach dieser Zeit
+  uint32_t scanMs;         // Dauer eines Scans
+  uint32_t disconnectMs;   // esp_wifi_disconnect() bis zum Trennungsereignis; HOST_WIFI_NEVER: keins
+};
+
+// alle APs entfernen, Zeiten auf Vorgabe (800 / 780 / 20 ms)
+void hostWifiReset();
+HostWifiTiming& hostWifiTiming();
+HostAp* hostWifiAdd(const char* ssid, uint8_t channel, int8_t rssi, uint32_t connectMs);
+HostAp* hostWifiAp(const char* ssid);
+
+// verbundener AP oder nullptr
+const HostAp* hostWifiConnected();
+bool hostWifiRunning();
+// Summe der Zeit zwischen esp_wifi_start() und esp_wifi_stop() seit hostWifiReset()
+uint32_t hostWifiRadioOnMs();
+uint32_t hostWifiAttempts();
+// Aufrufe von esp_wifi_stop()/esp_wifi_disconnect() aus einem esp_timer-Callback
+uint32_t hostWifiTimerContextCalls();
+
+// esp_wifi_get_mac(WIFI_IF_STA)
+#define HOST_WIFI_MAC {0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56}
+
+// WifiConnectOps wie in main_idf.cpp, über die Ereignisse des simulierten Treibers
+extern const WifiConnectOps hostWifiOps;
+
+// --- SNTP und Ersatzserver ---
+
+#define HOST_NTP_PORT 15123   // NTP_DNS_PORT steht in platformio.ini ([env:native])
+
+uint32_t hostSntpRequests();
+
+// scripts/ntp_standin.py auf 127.0.0.1 starten (NTP auf HOST_NTP_PORT, DNS auf
+// NTP_DNS_PORT), args wird angehängt, z. B. "--offset 3.5"; false ohne python3
+bool hostStandinStart(const char* args);
+void hostStandinStop();
+
+// scripts/delta_ota.py serve --dir dir auf 127.0.0.1:DELTA_OTA_PORT, args wird
+// angehängt, z. B. "--rate 20000 --drop 0.2"; false ohne python3
+bool hostDeltaServerStart(const char* dir, const char* args);
+void hostDeltaServerStop();
+
+// scripts/config_standin.py --file file auf 127.0.0.1:CLOCK_CONFIG_PORT, args wird
+// angehängt, z. B. "--truncate 20"; false ohne python3
+bool hostConfigServerStart(const char* file, const char* args);
+void hostConfigServerStop();
+
+// scripts/tele_collector.py auf 127.0.0.1:TELE_UPLOAD_PORT (UDP und HTTP), je Block
+// eine JSON-Zeile in out; args wird angehängt, z. B. "--drop-ack 1"; false ohne python3
+bool hostCollectorStart(const char* out, const char* args);
+void hostCollectorStop();
+
+// python3 scripts/<script> <args> starten, stdout zum Lesen; nullptr ohne python3
+FILE* hostScriptOpen(const char* script, const char* args);
+// Exit-Code des Skripts, 127: python3 oder Skript nicht gefunden
+int hostScriptClose(FILE* f);
+
+// --- OTA-Partitionen ---
+
+// app0 läuft mit image, app1 gelöscht; keine Boot-Partition gesetzt
+void hostOtaReset(const uint8_t* image, size_t len);
+// Neustart in die mit esp_ota_set_boot_partition() gesetzte Partition
+void hostOtaBoot();
+// Image der laufenden (target = false) oder der nächsten Partition, Länge bis zum höchsten geschriebenen Byte
+const uint8_t* hostOtaImage(bool target, size_t* len);
+// Partition für den nächsten Start oder nullptr
+const char* hostOtaBootLabel();
+// gelöschte 4-KB-Sektoren seit hostOtaReset()
+uint32_t hostOtaErases();
+void hostSha256(const uint8_t* data, size_t len, uint8_t* out);
+
+// --- SH1106 (host_sh1106.cpp) ---
+
+#define HOST_SH1106_PAGES   8
+#define HOST_SH1106_COLUMNS 132
+
+// Einschalten: RAM leer, Reset-Werte (Anzeige aus, Multiplex 64, kein Remap)
+void hostSh1106Reset();
+// eine I2C-Übertragung an die Adresse des Displays: Start, Bytes nach dem
+// Adressbyte, Stopp; false, wenn das Byte außerhalb einer Übertragung kommt
+void hostSh1106Start();
+bool hostSh1106Write(uint8_t b);
+void hostSh1106Stop();
+// Byte- und GPIO-Callback für u8g2_Setup_sh1106_i2c_128x64_noname_f()
+uint8_t hostSh1106ByteCb(u8x8_t* u8x8, uint8_t msg, uint8_t n, void* p);
+uint8_t hostSh1106GpioCb(u8x8_t* u8x8, uint8_t msg, uint8_t n, void* p);
+
+// Display einschalten wie oledBegin() in main_idf.cpp, aber an diesem Modell:
+// Reset, u8g2 mit rotation, panelReset(), Flip, Anzeige an, Puffer leer
+void hostSh1106Display(u8g2_t* u8g2, const u8g2_cb_t* rotation, uint8_t flip);
+
+// leuchtet das Glas an COM com (0..63), SEG seg (0..131)?
+bool hostSh1106Lit(uint8_t com, uint8_t seg);
+// das ganze Glas, 64 Zeilen zu HOST_SH1106_COLUMNS Byte, 1 = leuchtet
+typedef std::vector<uint8_t> HostGlass;
+HostGlass hostSh1106Glass();
+uint16_t hostSh1106LitCount();
+// RAM einer Seite, HOST_SH1106_COLUMNS Byte
+const uint8_t* hostSh1106Page(uint8_t page);
+
+struct HostSh1106Scan {
+  uint8_t mux, offset, startLine;   // Multiplex − 1, 0xD3, 0x40..0x7F
+  bool segRemap, comReverse, on;
+};
+HostSh1106Scan hostSh1106Scan();
+// geschriebene Daten- und Befehlsbytes (mit Argumenten) seit hostSh1106Reset()
+uint32_t hostSh1106DataBytes();
+uint32_t hostSh1106Commands();
+
+// --- ULP-Coprozessor, I2C an RTC_GPIO8/9 und Tiefschlaf (host_ulp.cpp) ---
+
+// Takt des ULP (RTC_FAST_CLK); die Takte je Befehl stehen in host_ulp.cpp
+#define HOST_ULP_HZ 8000000
+
+struct HostUlpRun {
+  double   wall;        // Systemzeit beim Start des Laufs
+  uint32_t cycles;      // bis I_HALT
+  uint32_t dataBytes;   // in diesem Lauf ans Display geschriebene Datenbytes
+  bool     wake;        // I_WAKE ausgeführt
+};
+
+typedef void (*HostUlpRunFn)(const HostUlpRun& run, void* arg);
+
+// nach jedem Lauf aufrufen; nullptr = keiner
+void hostUlpOnRun(HostUlpRunFn fn, void* arg);
+// Grund, aus dem der Interpreter den ULP angehalten hat (unbekannter Befehl,
+// Adresse außerhalb des RTC-Speichers, Lauf ohne I_HALT), sonst nullptr
+const char* hostUlpFault();
+bool hostUlpTimerOn();
+// Wörter des zuletzt geladenen Programms
+uint32_t hostUlpProgramWords();
+
+struct HostI2cBus {
+  bool     scl, sda;              // Pegel auf den Leitungen
+  uint32_t starts, stops;
+  uint32_t minLowNs, minHighNs;   // kürzeste SCL-Phasen seit hostPowerOn()
+};
+HostI2cBus hostI2cBus();
+// Display bestätigt seine Adresse nicht mehr (abgezogen)
+void hostI2cDisplayNack(bool on);
+
+// Tiefschlaf nach esp_deep_sleep_start() (wirft HostDeepSleep): Zeitgeber und
+// Ereignisse des Hauptprozessors verfallen, ULP-Läufe bis zum ersten
+// freigegebenen Wakeup, dann Neustart mit ESP_RST_DEEPSLEEP. RTC-Speicher, ULP
+// und Display laufen weiter. Liefert die Ursache wie esp_sleep_get_wakeup_cause().
+esp_sleep_wakeup_cause_t hostDeepSleep();
+
+// --- Hilfen für die Tests (host_util.cpp) ---
+
+struct TelemetryRecord;
+
+// jüngster Telemetrie-Eintrag eines Typs; false, wenn keiner im Ring steht
+bool hostLastTele(uint8_t type, TelemetryRecord* out);
+
+// Temperatur für driftInit() ohne Sensor: immer NAN
+float hostNoTemp();
+
+// Test auslassen statt scheitern, wenn ein Skript aus scripts/ nicht läuft (kein python3)
+#define HOST_REQUIRE_SCRIPT(started, script)                                        \
+  do {                                                                              \
+    if (!(started)) TEST_IGNORE_MESSAGE("python3 oder " script " nicht verfügbar"); \
+  } while (0)
+
+// --- intern, zwischen den host_*.cpp ---
+
+void hostSntpReset();
+// Radio aus, laufende Versuche verwerfen; APs bleiben
+void hostWifiChipReset();
+// wartet SNTP gerade auf eine Antwort?
+bool hostSntpWaiting();
+// höchstens maxUs echte Zeit auf die Antwort warten; liefert die gewartete Zeit
+int64_t hostSntpWait(int64_t maxUs);
+// Antwort abholen und auswerten, Anfrage wiederholen; zur aktuellen virtuellen Zeit
+void hostSntpPoll();
+// RTC-Zähler in µs seit dem Einschalten, läuft über Resets und Tiefschlaf weiter
+int64_t hostRtcUs();
+// Ereignisse abarbeiten, bis eins *stop setzt oder keins mehr aussteht
+void hostAdvanceUntil(const bool* stop);
+// Reset beim Eintritt in den Tiefschlaf und beim Wecken: wie hostReset(), Grund ESP_RST_DEEPSLEEP
+void hostSleepReset();
+// ULP nach einem Reset wieder einplanen; powerOn: Timer aus, Register auf Reset-Werte
+void hostUlpReset(bool powerOn);
@@ -0,0 +1,376 @@
+/**
+ * @file host_clock.cpp
+ * @brief Virtuelle Zeit, esp_timer, vTaskDelay und die umgelenkte Systemzeit
+ */
+#include "host.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <mutex>
+#include <vector>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hal/wdt_hal.h"
+#include "soc/rtc.h"
+#include "wake_stats.h"
+
+// Abschnitte von RTC_DATA_ATTR / RTC_NOINIT_ATTR; schwach, falls kein Modul sie benutzt
+extern char __start_host_rtc_data[] __attribute__((weak));
+extern char __stop_host_rtc_data[] __attribute__((weak));
+extern char __start_host_rtc_noinit[] __attribute__((weak));
+extern char __stop_host_rtc_noinit[] __attribute__((weak));
+
+struct HostEvent {
+  int64_t  at;
+  uint32_t id;
+  HostFn   fn;
+  void*    arg;
+};
+
+struct HostTimer {
+  esp_timer_cb_t cb;
+  void*    arg;
+  uint32_t event;     // 0 = nicht gestartet
+};
+
+static int64_t nowUs;
+static std::vector<HostEvent> events;
+static uint32_t nextId = 1;
+static bool inTimer;
+
+static uint32_t watchdogEvent;
+static uint32_t watchdogMs;
+
+static int64_t wallBaseUs, monoBaseUs;
+static int64_t rtcBaseUs;   // RTC-Zähler beim letzten Reset
+static double driftPpm;
+
+static std::recursive_mutex criticalMutex;
+
+// --- Ablaufsteuerung ---
+
+uint32_t hostAt(int64_t us, HostFn fn, void* arg) {
+  events.push_back({us, nextId, fn, arg});
+  return nextId++;
+}
+
+void hostCancel(uint32_t id) {
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (events[i].id == id) {
+      events.erase(events.begin() + i);
+      return;
+    }
+  }
+}
+
+// bis target vorrücken, fällige Ereignisse in zeitlicher Reihenfolge
+static void advanceTo(int64_t target) {
+  for (;;) {
+    int best = -1;
+    for (size_t i = 0; i < events.size(); ++i) {
+      const HostEvent& e = events[i];
+      if (e.at > target) continue;
+      if (best < 0 || e.at < events[best].at || (e.at == events[best].at && e.id < events[best].id)) best = (int)i;
+    }
+    if (best < 0) break;
+    HostEvent e = events[best];
+    events.erase(events.begin() + best);
+    if (e.at > nowUs) nowUs = e.at;
+    e.fn(e.arg);
+  }
+  if (target > nowUs) nowUs = target;
+}
+
+void hostAdvanceMs(uint32_t ms) {
+  advanceTo(nowUs + (int64_t)ms * 1000);
+}
+
+int64_t hostNowUs() {
+  return nowUs;
+}
+
+int64_t hostRtcUs() {
+  return rtcBaseUs + nowUs;
+}
+
+void hostAdvanceUntil(const bool* stop) {
+  while (!*stop && !events.empty()) {
+    int64_t next = events[0].at;
+    for (const HostEvent& e : events) {
+      if (e.at < next) next = e.at;
+    }
+    advanceTo(next);
+  }
+}
+
+bool hostInTimerCallback() {
+  return inTimer;
+}
+
+static int64_t wallUs();
+
+// was jeder Reset löscht: Zeitgeber, Ereignisse, Watchdog, Radio, SNTP
+static void chipReset() {
+  hostWifiChipReset();
+  const int64_t wall = wallUs();
+  events.clear();
+  rtcBaseUs += nowUs;
+  nowUs = 0;
+  wallBaseUs = wall;
+  monoBaseUs = 0;
+  inTimer = false;
+  watchdogEvent = 0;
+  watchdogMs = 0;
+  hostSntpReset();
+  hostUlpReset(false);
+}
+
+static esp_reset_reason_t resetReason = ESP_RST_POWERON;
+
+void hostPowerOn() {
+  if (__start_host_rtc_data) memset(__start_host_rtc_data, 0, __stop_host_rtc_data - __start_host_rtc_data);
+  if (__start_host_rtc_noinit) memset(__start_host_rtc_noinit, 0, __stop_host_rtc_noinit - __start_host_rtc_noinit);
+  chipReset();
+  hostUlpReset(true);
+  wallBaseUs = 0;
+  rtcBaseUs = 0;
+  driftPpm = 0;
+  resetReason = ESP_RST_POWERON;
+}
+
+void hostReset() {
+  chipReset();
+  resetReason = ESP_RST_SW;
+}
+
+void hostSleepReset() {
+  chipReset();
+  resetReason = ESP_RST_DEEPSLEEP;
+}
+
+// --- Systemzeit ---
+
+static int64_t wallUs() {
+  return wallBaseUs + (int64_t)((double)(nowUs - monoBaseUs) * (1.0 + driftPpm * 1e-6));
+}
+
+static void setWallUs(int64_t us) {
+  wallBaseUs = us;
+  monoBaseUs = nowUs;
+}
+
+void hostSetWallClock(double t) {
+  setWallUs((int64_t)(t * 1e6));
+}
+
+double hostWallClock() {
+  return wallUs() / 1e6;
+}
+
+double hostRealClock() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void hostSetDriftPpm(double ppm) {
+  setWallUs(wallUs());
+  driftPpm = ppm;
+}
+
+extern "C" time_t __wrap_time(time_t* out) {
+  const time_t t = (time_t)(wallUs() / 1000000);
+  if (out) *out = t;
+  return t;
+}
+
+extern "C" int __wrap_gettimeofday(struct timeval* tv, void*) {
+  const int64_t us = wallUs();
+  tv->tv_sec = (time_t)(us / 1000000);
+  tv->tv_usec = (suseconds_t)(us % 1000000);
+  return 0;
+}
+
+extern "C" int __wrap_settimeofday(const struct timeval* tv, const struct timezone*) {
+  if (tv) setWallUs((int64_t)tv->tv_sec * 1000000 + tv->tv_usec);
+  return 0;
+}
+
+// anders als im Kern wird die Korrektur sofort angebracht, es bleibt kein Rest
+extern "C" int __wrap_adjtime(const struct timeval* delta, struct timeval* old) {
+  if (old) *old = {0, 0};
+  if (delta) setWallUs(wallUs() + (int64_t)delta->tv_sec * 1000000 + delta->tv_usec);
+  return 0;
+}
+
+// --- esp_timer ---
+
+int64_t esp_timer_get_time() {
+  return nowUs;
+}
+
+static void timerFire(void* arg) {
+  HostTimer* t = (HostTimer*)arg;
+  t->event = 0;
+  inTimer = true;
+  t->cb(t->arg);
+  inTimer = false;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  *out = new HostTimer{args->callback, args->arg, 0};
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs) {
+  if (t->event) return ESP_ERR_INVALID_STATE;
+  t->event = hostAt(nowUs + (int64_t)timeoutUs, timerFire, t);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  if (!t->event) return ESP_ERR_INVALID_STATE;
+  hostCancel(t->event);
+  t->event = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t) {
+  if (t->event) return ESP_ERR_INVALID_STATE;
+  delete t;
+  return ESP_OK;
+}
+
+// --- RTC-Watchdog ---
+
+static void watchdogFire(void*) {
+  watchdogEvent = 0;
+  throw HostRestart();
+}
+
+static void watchdogCheckUnlocked(const wdt_hal_context_t* hal, const char* what) {
+  if (hal->locked) {
+    fprintf(stderr, "%s bei aktivem Schreibschutz\n", what);
+    abort();
+  }
+}
+
+void wdt_hal_init(wdt_hal_context_t* hal, wdt_inst_t inst, uint32_t, bool) {
+  *hal = {};
+  hal->inst = inst;
+  hal->locked = true;
+}
+
+void wdt_hal_write_protect_disable(wdt_hal_context_t* hal) {
+  hal->locked = false;
+}
+
+void wdt_hal_write_protect_enable(wdt_hal_context_t* hal) {
+  hal->locked = true;
+}
+
+void wdt_hal_config_stage(wdt_hal_context_t* hal, wdt_stage_t stage, uint32_t timeout, wdt_stage_action_t action) {
+  watchdogCheckUnlocked(hal, "wdt_hal_config_stage");
+  if (stage != WDT_STAGE0) return;
+  hal->ticks = timeout;
+  hal->action = action;
+}
+
+void wdt_hal_enable(wdt_hal_context_t* hal) {
+  watchdogCheckUnlocked(hal, "wdt_hal_enable");
+  if (watchdogEvent) hostCancel(watchdogEvent);
+  watchdogEvent = 0;
+  watchdogMs = 0;
+  if (hal->action != WDT_STAGE_ACTION_RESET_SYSTEM || !hal->ticks) return;
+  watchdogMs = (uint32_t)((uint64_t)hal->ticks * 1000 / rtc_clk_slow_freq_get_hz());
+  watchdogEvent = hostAt(nowUs + (int64_t)watchdogMs * 1000, watchdogFire, nullptr);
+}
+
+void wdt_hal_disable(wdt_hal_context_t* hal) {
+  watchdogCheckUnlocked(hal, "wdt_hal_disable");
+  if (watchdogEvent) hostCancel(watchdogEvent);
+  watchdogEvent = 0;
+  watchdogMs = 0;
+}
+
+void wdt_hal_feed(wdt_hal_context_t* hal) {
+  watchdogCheckUnlocked(hal, "wdt_hal_feed");
+  if (!watchdogEvent) return;
+  hostCancel(watchdogEvent);
+  watchdogEvent = hostAt(nowUs + (int64_t)watchdogMs * 1000, watchdogFire, nullptr);
+}
+
+uint32_t hostWatchdogMs() {
+  return watchdogMs;
+}
+
+// --- FreeRTOS ---
+
+void vTaskDelay(TickType_t ticks) {
+  const int64_t end = nowUs + (int64_t)ticks * 1000;
+  while (nowUs < end) {
+    if (hostSntpWaiting()) {
+      advanceTo(nowUs + hostSntpWait(end - nowUs));
+      hostSntpPoll();
+    } else {
+      advanceTo(end);
+      hostSntpPoll();   // Wiederholung der Anfrage fällig?
+    }
+  }
+}
+
+// select() aus lan_http.cpp (lwip/sockets.h): echte Wartezeit auf die virtuelle Uhr
+int hostSocketSelect(int n, fd_set* r, fd_set* w, fd_set* e, struct timeval* tv) {
+  const double t0 = hostRealClock();
+  const int rc = select(n, r, w, e, tv);
+  advanceTo(nowUs + (int64_t)((hostRealClock() - t0) * 1e6));
+  return rc;
+}
+
+void hostCriticalEnter() {
+  criticalMutex.lock();
+}
+
+void hostCriticalExit() {
+  criticalMutex.unlock();
+}
+
+void esp_restart() {
+  throw HostRestart();
+}
+
+esp_reset_reason_t esp_reset_reason() {
+  return resetReason;
+}
+
+// wake_stats.cpp (Stunden-Buckets über power.cpp) läuft nicht auf dem Host; der
+// Light-Sleep-Anteil im Telemetrie-Block kommt von hier
+static uint64_t sleptUs;
+
+void hostSetSleptUs(uint64_t us) {
+  sleptUs = us;
+}
+
+uint64_t wakeStatsSleptUs() {
+  return sleptUs;
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+  return HOST_HEAP_FREE;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t) {
+  return HOST_HEAP_MIN;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t) {
+  return HOST_HEAP_LARGEST;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file host_nvs.cpp
+ * @brief NVS im Speicher: Namensraum und Schlüssel auf Blobs
+ */
+#include "host.h"
+
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "nvs.h"
+
+static std::map<std::string, std::vector<uint8_t>> blobs;   // "namensraum/schlüssel"
+static std::vector<std::string> handles;                     // Handle - 1 = Index
+static std::vector<bool> writable;
+
+void hostEraseNvs() {
+  blobs.clear();
+}
+
+esp_err_t nvs_open(const char* ns, nvs_open_mode_t mode, nvs_handle_t* out) {
+  if (mode == NVS_READONLY) {
+    // wie im Kern: Namensraum ohne Einträge lässt sich nur zum Schreiben öffnen
+    const std::string prefix = std::string(ns) + "/";
+    auto it = blobs.lower_bound(prefix);
+    if (it == blobs.end() || it->first.compare(0, prefix.size(), prefix) != 0) return ESP_ERR_NVS_NOT_FOUND;
+  }
+  handles.push_back(ns);
+  writable.push_back(mode == NVS_READWRITE);
+  *out = (nvs_handle_t)handles.size();
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t) {}
+
+esp_err_t nvs_commit(nvs_handle_t) {
+  return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t h, const char* key, void* out, size_t* len) {
+  auto it = blobs.find(handles[h - 1] + "/" + key);
+  if (it == blobs.end()) return ESP_ERR_NVS_NOT_FOUND;
+  if (!out) {
+    *len = it->second.size();
+    return ESP_OK;
+  }
+  if (*len < it->second.size()) return ESP_ERR_INVALID_ARG;
+  memcpy(out, it->second.data(), it->second.size());
+  *len = it->second.size();
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t h, const char* key, const void* value, size_t len) {
+  if (!writable[h - 1]) return ESP_ERR_INVALID_STATE;
+  const uint8_t* p = (const uint8_t*)value;
+  blobs[handles[h - 1] + "/" + key].assign(p, p + len);
+  return ESP_OK;
+}
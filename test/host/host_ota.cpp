@@ -0,0 +1,200 @@
+/**
+ * @file host_ota.cpp
+ * @brief Zwei App-Partitionen im Speicher, OTA-Auswahl, SHA-256 und der Inflater für miniz.h
+ *
+ * Flash-Verhalten: Löschen setzt 4-KB-Sektoren auf 0xFF, Schreiben kann nur Bits
+ * löschen; ein Schreiben auf nicht gelöschten Flash schlägt fehl (ESP_FAIL),
+ * wie es auf dem Chip zu falschen Daten führen würde.
+ */
+#include "host.h"
+
+#include <string.h>
+#include <vector>
+#include <zlib.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+
+#define HOST_OTA_SIZE   0x140000
+#define HOST_OTA_SECTOR 4096
+
+static const esp_partition_t parts[2] = {
+    {0x010000, HOST_OTA_SIZE, "app0"},
+    {0x150000, HOST_OTA_SIZE, "app1"},
+};
+
+struct HostFlash {
+  std::vector<uint8_t> data;
+  size_t imageLen;        // höchstes geschriebenes Byte + 1 seit dem Löschen von Sektor 0
+};
+
+static HostFlash flash[2];
+static int running;
+static int boot = -1;
+static uint32_t erases;
+
+static int index(const esp_partition_t* p) {
+  return p == &parts[1] ? 1 : p == &parts[0] ? 0 : -1;
+}
+
+static void clear(int i) {
+  flash[i].data.assign(HOST_OTA_SIZE, 0xFF);
+  flash[i].imageLen = 0;
+}
+
+void hostOtaReset(const uint8_t* image, size_t len) {
+  running = 0;
+  boot = -1;
+  erases = 0;
+  clear(0);
+  clear(1);
+  memcpy(flash[0].data.data(), image, len);
+  flash[0].imageLen = len;
+}
+
+void hostOtaBoot() {
+  if (boot >= 0) running = boot;
+  boot = -1;
+}
+
+const uint8_t* hostOtaImage(bool target, size_t* len) {
+  const HostFlash& f = flash[target ? 1 - running : running];
+  *len = f.imageLen;
+  return f.data.data();
+}
+
+const char* hostOtaBootLabel() {
+  return boot >= 0 ? parts[boot].label : nullptr;
+}
+
+uint32_t hostOtaErases() {
+  return erases;
+}
+
+// --- esp_partition / esp_ota_ops ---
+
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size) {
+  const int i = index(part);
+  if (i < 0 || offset + size > part->size) return ESP_ERR_INVALID_ARG;
+  memcpy(dst, flash[i].data.data() + offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* part, size_t offset, const void* src, size_t size) {
+  const int i = index(part);
+  if (i < 0 || offset + size > part->size) return ESP_ERR_INVALID_ARG;
+  uint8_t* d = flash[i].data.data() + offset;
+  const uint8_t* s = (const uint8_t*)src;
+  for (size_t k = 0; k < size; ++k) {
+    if ((d[k] & s[k]) != s[k]) return ESP_FAIL;   // nicht gelöscht
+    d[k] = s[k];
+  }
+  if (offset + size > flash[i].imageLen) flash[i].imageLen = offset + size;
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* part, size_t offset, size_t size) {
+  const int i = index(part);
+  if (i < 0 || offset % HOST_OTA_SECTOR || size % HOST_OTA_SECTOR || offset + size > part->size) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memset(flash[i].data.data() + offset, 0xFF, size);
+  if (offset == 0) flash[i].imageLen = 0;   // ein neues Image beginnt
+  erases += size / HOST_OTA_SECTOR;
+  return ESP_OK;
+}
+
+// --- SHA-256 (FIPS 180-4) ---
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static uint32_t ror(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+static void shaBlock(uint32_t* h, const uint8_t* p) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) w[i] = (uint32_t)p[4 * i] << 24 | p[4 * i + 1] << 16 | p[4 * i + 2] << 8 | p[4 * i + 3];
+  for (int i = 16; i < 64; ++i) {
+    const uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+  for (int i = 0; i < 64; ++i) {
+    const uint32_t t1 = k + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+    const uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    k = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e, h[5] += f, h[6] += g, h[7] += k;
+}
+
+void hostSha256(const uint8_t* data, size_t len, uint8_t* out) {
+  uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) shaBlock(h, data + i);
+  uint8_t tail[128] = {};
+  const size_t rest = len - i;
+  memcpy(tail, data + i, rest);
+  tail[rest] = 0x80;
+  const size_t n = rest < 56 ? 64 : 128;
+  const uint64_t bits = (uint64_t)len * 8;
+  for (int k = 0; k < 8; ++k) tail[n - 1 - k] = (uint8_t)(bits >> (8 * k));
+  for (size_t k = 0; k < n; k += 64) shaBlock(h, tail + k);
+  for (int k = 0; k < 8; ++k) {
+    out[4 * k] = (uint8_t)(h[k] >> 24);
+    out[4 * k + 1] = (uint8_t)(h[k] >> 16);
+    out[4 * k + 2] = (uint8_t)(h[k] >> 8);
+    out[4 * k + 3] = (uint8_t)h[k];
+  }
+}
+
+esp_err_t esp_partition_get_sha256(const esp_partition_t* part, uint8_t* sha) {
+  const int i = index(part);
+  if (i < 0 || flash[i].imageLen == 0) return ESP_ERR_NOT_FOUND;
+  hostSha256(flash[i].data.data(), flash[i].imageLen, sha);
+  return ESP_OK;
+}
+
+const esp_partition_t* esp_ota_get_running_partition() {
+  return &parts[running];
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t*) {
+  return &parts[1 - running];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* part) {
+  const int i = index(part);
+  if (i < 0) return ESP_ERR_INVALID_ARG;
+  boot = i;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+  return ESP_OK;
+}
+
+// --- Inflater für esp32/rom/miniz.h ---
+
+z_stream* hostInflater() {
+  static z_stream z;
+  static bool init = false;
+  if (!init) init = inflateInit(&z) == Z_OK;
+  return &z;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file host_sh1106.cpp
+ * @brief SH1106 hinter dem I2C-Bus: Befehlsdecoder, 8 × 132 Byte RAM und das Bild auf dem Glas
+ *
+ * Jede Übertragung beginnt mit einem Steuerbyte (Co, D/C): 0x00 Befehle, 0x40
+ * Daten bis zum Stopp; mit gesetztem Co folgt nach einem Byte wieder ein
+ * Steuerbyte. Das Argument eines Zwei-Byte-Befehls darf in der nächsten
+ * Übertragung kommen (u8x8_cad_ssd13xx_i2c sendet jedes Byte einzeln).
+ *
+ * Glas: SEG s zeigt Spalte s (0xA0) oder 131 − s (0xA1). Scanzeile k < Multiplex
+ * zeigt RAM-Zeile (Startzeile + k) & 63 auf COM (k − Offset) & 63, mit 0xC8 auf
+ * COM 63 minus diesem Wert.
+ */
+#include "host.h"
+
+#include <string.h>
+#include "panel.h"
+
+struct Sh1106 {
+  uint8_t ram[HOST_SH1106_PAGES][HOST_SH1106_COLUMNS];
+  uint8_t page, column;
+  uint8_t startLine, mux, offset;
+  bool segRemap, comReverse, on, entireOn, inverse;
+  uint8_t contrast, pump, clock, precharge;
+  uint8_t pendingCmd;          // wartet auf sein Argument, 0 = keiner
+  // laufende Übertragung
+  bool inTransfer, expectControl, data, single;
+  uint32_t dataBytes, commands;
+};
+
+static Sh1106 dev;
+
+void hostSh1106Reset() {
+  memset(&dev, 0, sizeof(dev));
+  dev.mux = 63;
+  dev.contrast = 0x80;
+  dev.pump = 0x32;
+  dev.clock = 0x50;
+  dev.precharge = 0x22;
+}
+
+static bool hasArgument(uint8_t cmd) {
+  switch (cmd) {
+    case 0x20:   // Adressierungsart (SSD1306, u8g2 sendet ihn auch hier)
+    case 0x81:   // Kontrast
+    case 0x8D:   // Ladungspumpe (SSD1306)
+    case 0xA8:   // Multiplex-Ratio
+    case 0xAD:   // DC-DC
+    case 0xD3:   // Offset
+    case 0xD5:   // Oszillator
+    case 0xD9:   // Pre-Charge
+    case 0xDA:   // COM-Pins
+    case 0xDB:   // VCOM
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void argument(uint8_t cmd, uint8_t arg) {
+  switch (cmd) {
+    case 0x81: dev.contrast = arg; break;
+    case 0xA8: dev.mux = arg & 63; break;
+    case 0xD3: dev.offset = arg & 63; break;
+    case 0xD5: dev.clock = arg; break;
+    case 0xD9: dev.precharge = arg; break;
+    default: break;
+  }
+}
+
+static void command(uint8_t c) {
+  if (dev.pendingCmd) {
+    argument(dev.pendingCmd, c);
+    dev.pendingCmd = 0;
+    return;
+  }
+  if (hasArgument(c)) {
+    dev.pendingCmd = c;
+  } else if (c <= 0x0F) {
+    dev.column = (dev.column & 0xF0) | c;
+  } else if (c <= 0x1F) {
+    dev.column = (uint8_t)((dev.column & 0x0F) | (c & 0x0F) << 4);
+  } else if (c >= 0x30 && c <= 0x33) {
+    dev.pump = c;
+  } else if (c >= 0x40 && c <= 0x7F) {
+    dev.startLine = c & 63;
+  } else if (c == 0xA0 || c == 0xA1) {
+    dev.segRemap = c & 1;
+  } else if (c == 0xA4 || c == 0xA5) {
+    dev.entireOn = c & 1;
+  } else if (c == 0xA6 || c == 0xA7) {
+    dev.inverse = c & 1;
+  } else if (c == 0xAE || c == 0xAF) {
+    dev.on = c & 1;
+  } else if (c >= 0xB0 && c <= 0xB7) {
+    dev.page = c & 7;
+  } else if (c >= 0xC0 && c <= 0xCF) {
+    dev.comReverse = c & 8;
+  }
+  // übrige (0x2E, 0xE3, ...) ohne Wirkung
+}
+
+void hostSh1106Start() {
+  dev.inTransfer = true;
+  dev.expectControl = true;
+}
+
+bool hostSh1106Write(uint8_t b) {
+  if (!dev.inTransfer) return false;
+  if (dev.expectControl) {
+    dev.data = b & 0x40;
+    dev.single = b & 0x80;
+    dev.expectControl = false;
+    return true;
+  }
+  if (dev.data) {
+    if (dev.column < HOST_SH1106_COLUMNS) {   // hinter Spalte 131 wird nichts mehr geschrieben
+      dev.ram[dev.page][dev.column] = b;
+      ++dev.column;
+    }
+    ++dev.dataBytes;
+  } else {
+    command(b);
+    ++dev.commands;
+  }
+  if (dev.single) dev.expectControl = true;
+  return true;
+}
+
+void hostSh1106Stop() {
+  dev.inTransfer = false;
+}
+
+uint8_t hostSh1106ByteCb(u8x8_t* u8x8, uint8_t msg, uint8_t n, void* p) {
+  (void)u8x8;
+  switch (msg) {
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      hostSh1106Start();
+      break;
+    case U8X8_MSG_BYTE_SEND:
+      for (uint8_t i = 0; i < n; ++i) {
+        if (!hostSh1106Write(((const uint8_t*)p)[i])) return 0;
+      }
+      break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      hostSh1106Stop();
+      break;
+    default:
+      break;
+  }
+  return 1;
+}
+
+uint8_t hostSh1106GpioCb(u8x8_t* u8x8, uint8_t msg, uint8_t n, void* p) {
+  (void)u8x8;
+  (void)msg;
+  (void)n;
+  (void)p;
+  return 1;
+}
+
+bool hostSh1106Lit(uint8_t com, uint8_t seg) {
+  if (!dev.on || com > 63 || seg >= HOST_SH1106_COLUMNS) return false;
+  const uint8_t c = dev.comReverse ? 63 - com : com;
+  const uint8_t k = (c + dev.offset) & 63;   // Scanzeile, die diesen COM treibt
+  if (k > dev.mux) return false;
+  if (dev.entireOn) return true;
+  const uint8_t row = (dev.startLine + k) & 63;
+  const uint8_t col = dev.segRemap ? HOST_SH1106_COLUMNS - 1 - seg : seg;
+  const bool bit = dev.ram[row >> 3][col] >> (row & 7) & 1;
+  return bit != dev.inverse;
+}
+
+uint16_t hostSh1106LitCount() {
+  uint16_t n = 0;
+  for (uint8_t com = 0; com < 64; ++com) {
+    for (uint8_t seg = 0; seg < HOST_SH1106_COLUMNS; ++seg) n += hostSh1106Lit(com, seg);
+  }
+  return n;
+}
+
+const uint8_t* hostSh1106Page(uint8_t page) {
+  return dev.ram[page & 7];
+}
+
+HostSh1106Scan hostSh1106Scan() {
+  return {dev.mux, dev.offset, dev.startLine, dev.segRemap, dev.comReverse, dev.on};
+}
+
+uint32_t hostSh1106DataBytes() {
+  return dev.dataBytes;
+}
+
+uint32_t hostSh1106Commands() {
+  return dev.commands;
+}
+
+void hostSh1106Display(u8g2_t* u8g2, const u8g2_cb_t* rotation, uint8_t flip) {
+  hostSh1106Reset();
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(u8g2, rotation, hostSh1106ByteCb, hostSh1106GpioCb);
+  u8g2_InitDisplay(u8g2);
+  panelReset();
+  u8g2_SetFlipMode(u8g2, flip);
+  u8g2_SetPowerSave(u8g2, 0);
+  u8g2_ClearBuffer(u8g2);
+}
+
+HostGlass hostSh1106Glass() {
+  HostGlass g(64 * HOST_SH1106_COLUMNS);
+  for (uint8_t com = 0; com < 64; ++com) {
+    for (uint8_t seg = 0; seg < HOST_SH1106_COLUMNS; ++seg) {
+      g[com * HOST_SH1106_COLUMNS + seg] = hostSh1106Lit(com, seg);
+    }
+  }
+  return g;
+}
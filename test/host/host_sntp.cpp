@@ -0,0 +1,168 @@
+/**
+ * @file host_sntp.cpp
+ * @brief SNTP-Client für die Host-Tests: echte UDP-Anfragen, Zeit über sntp_sync_time()
+ */
+#include "host.h"
+
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/time.h>
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "lwip/dns.h"
+#include "lwip/sockets.h"
+
+#define HOST_SNTP_RETRY_US 15000000LL   // lwIP: SNTP_RETRY_TIMEOUT
+#define NTP_EPOCH 2208988800ULL
+
+static sntp_sync_status_t status = SNTP_SYNC_STATUS_RESET;
+static sntp_sync_time_cb_t notifyCb;
+static bool enabled;
+static ip_addr_t servers[SNTP_MAX_SERVERS];
+static bool named[SNTP_MAX_SERVERS];
+static int sock = -1;
+static int current;            // Server der laufenden Anfrage
+static bool waiting;           // Anfrage gesendet, keine Antwort
+static int64_t sentAtUs;       // virtuelle Zeit der Anfrage
+static uint8_t originate[8];   // Sendezeit, kommt in der Antwort zurück
+static double t1;              // Systemzeit beim Senden
+static uint32_t requests;
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+  notifyCb = callback;
+}
+
+void sntp_set_sync_status(sntp_sync_status_t s) {
+  status = s;
+}
+
+sntp_sync_status_t sntp_get_sync_status() {
+  return status;
+}
+
+void esp_sntp_setoperatingmode(esp_sntp_operatingmode_t) {}
+
+void esp_sntp_setservername(uint8_t idx, const char* server) {
+  if (idx < SNTP_MAX_SERVERS) named[idx] = server != nullptr;
+}
+
+void esp_sntp_setserver(uint8_t idx, const ip_addr_t* addr) {
+  if (idx < SNTP_MAX_SERVERS) servers[idx] = *addr;
+}
+
+bool esp_sntp_enabled() {
+  return enabled;
+}
+
+// Adresse eines Servers; ein Name löst (wie DNS-Ersatz) auf den DNS-Server auf
+static uint32_t serverAddr(int idx) {
+  if (servers[idx].u_addr.ip4.addr) return servers[idx].u_addr.ip4.addr;
+  if (named[idx]) return ip_2_ip4(dns_getserver(0))->addr;
+  return 0;
+}
+
+static void toNtp(double t, uint8_t* out) {
+  const uint64_t sec = (uint64_t)floor(t) + NTP_EPOCH;
+  const uint64_t frac = (uint64_t)((t - floor(t)) * 4294967296.0);
+  const uint64_t v = (sec << 32) | (frac & 0xFFFFFFFF);
+  for (int i = 0; i < 8; ++i) out[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static double fromNtp(const uint8_t* in) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) v = (v << 8) | in[i];
+  return (double)(v >> 32) - (double)NTP_EPOCH + (double)(v & 0xFFFFFFFF) / 4294967296.0;
+}
+
+static void sendRequest() {
+  for (int n = 0; n < SNTP_MAX_SERVERS; ++n, current = (current + 1) % SNTP_MAX_SERVERS) {
+    const uint32_t addr = serverAddr(current);
+    if (!addr) continue;
+    uint8_t req[48] = {};
+    req[0] = (0 << 6) | (4 << 3) | 3;   // LI 0, Version 4, Client
+    t1 = hostWallClock();
+    toNtp(t1, req + 40);
+    memcpy(originate, req + 40, 8);
+    struct sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(HOST_NTP_PORT);
+    to.sin_addr.s_addr = addr;
+    // verbunden, damit ein geschlossener Port (ICMP) als Fehler ankommt statt als Warten
+    connect(sock, (struct sockaddr*)&to, sizeof(to));
+    send(sock, req, sizeof(req), 0);
+    waiting = true;
+    sentAtUs = esp_timer_get_time();
+    requests++;
+    return;
+  }
+  waiting = false;
+  sentAtUs = esp_timer_get_time();
+}
+
+void esp_sntp_init() {
+  if (enabled) return;
+  sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  enabled = true;
+  current = 0;
+  sendRequest();
+}
+
+void esp_sntp_stop() {
+  if (sock >= 0) close(sock);
+  sock = -1;
+  enabled = false;
+  waiting = false;
+}
+
+void hostSntpReset() {
+  esp_sntp_stop();
+  status = SNTP_SYNC_STATUS_RESET;
+  notifyCb = nullptr;
+  memset(servers, 0, sizeof(servers));
+  memset(named, 0, sizeof(named));
+  requests = 0;
+}
+
+uint32_t hostSntpRequests() {
+  return requests;
+}
+
+bool hostSntpWaiting() {
+  return enabled && waiting;
+}
+
+int64_t hostSntpWait(int64_t maxUs) {
+  struct pollfd p = {sock, POLLIN, 0};
+  const double t0 = hostRealClock();
+  int ms = (int)((maxUs + 999) / 1000);
+  poll(&p, 1, ms);
+  const int64_t us = (int64_t)((hostRealClock() - t0) * 1e6);
+  return us < maxUs ? us : maxUs;
+}
+
+void hostSntpPoll() {
+  if (!enabled) return;
+  uint8_t buf[128];
+  const int len = (int)recv(sock, buf, sizeof(buf), MSG_DONTWAIT);
+  if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    waiting = false;   // Port geschlossen (ICMP): wie verlorene Antwort, später wiederholen
+  } else if (len >= 48 && waiting && memcmp(buf + 24, originate, 8) == 0 && buf[1] != 0) {
+    // Stratum 0 ist Kiss-of-Death: wie lwIP verwerfen
+    const double t4 = hostWallClock();
+    const double t2 = fromNtp(buf + 32), t3 = fromNtp(buf + 40);
+    const double offset = ((t2 - t1) + (t3 - t4)) / 2;
+    const double t = t4 + offset;
+    struct timeval tv;
+    tv.tv_sec = (time_t)floor(t);
+    tv.tv_usec = (suseconds_t)((t - floor(t)) * 1e6);
+    waiting = false;
+    sntp_sync_time(&tv);   // ruft bei ESP-IDF den Callback selbst; clock_events.cpp ersetzt sie
+    return;
+  }
+  if (status != SNTP_SYNC_STATUS_COMPLETED && esp_timer_get_time() - sentAtUs >= HOST_SNTP_RETRY_US) {
+    current = (current + 1) % SNTP_MAX_SERVERS;
+    sendRequest();
+  }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file host_standin.cpp
+ * @brief Skripte aus scripts/ als Kindprozesse: ntp_standin.py, delta_ota.py serve,
+ *        config_standin.py und tele_collector.py im Hintergrund, andere mit ihrer Ausgabe
+ */
+#include "host.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "clock_config.h"
+#include "delta_ota.h"
+#include "ntp_dns.h"
+#include "tele_upload.h"
+
+extern char** environ;
+
+// ein Skript als Kindprozess mit seiner Ausgabe
+struct Child {
+  pid_t pid = -1;
+  int   output = -1;
+};
+
+static Child standin, deltaServer, configServer, collector;
+
+// Projektverzeichnis aus dem Pfad dieser Datei (test/host/host_standin.cpp)
+static std::string projectDir() {
+  std::string f = __FILE__;
+  const size_t p = f.rfind("test/host/");
+  return p == std::string::npos ? "." : f.substr(0, p);
+}
+
+static void stop(Child& c) {
+  if (c.pid > 0) {
+    kill(c.pid, SIGTERM);
+    waitpid(c.pid, nullptr, 0);
+  }
+  if (c.output >= 0) close(c.output);
+  c.pid = -1;
+  c.output = -1;
+}
+
+// python3 -u scripts/<script> <fixed> <args> starten; bereit, sobald jede Zeichenkette
+// aus ready in der Ausgabe stand (höchstens 5 s)
+static bool start(Child& c, const char* script, std::vector<std::string> argv, const char* args,
+                  std::vector<const char*> ready) {
+  stop(c);
+  argv.insert(argv.begin(), {"python3", "-u", projectDir() + "scripts/" + script});
+  std::string rest = args ? args : "";
+  for (size_t pos = 0; pos < rest.size();) {
+    size_t end = rest.find(' ', pos);
+    if (end == std::string::npos) end = rest.size();
+    if (end > pos) argv.push_back(rest.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  std::vector<char*> cargv;
+  for (std::string& a : argv) cargv.push_back(&a[0]);
+  cargv.push_back(nullptr);
+
+  int pipeFd[2];
+  if (pipe(pipeFd) != 0) return false;
+  posix_spawn_file_actions_t fa;
+  posix_spawn_file_actions_init(&fa);
+  posix_spawn_file_actions_adddup2(&fa, pipeFd[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addclose(&fa, pipeFd[0]);
+  const int rc = posix_spawnp(&c.pid, "python3", &fa, nullptr, cargv.data(), environ);
+  posix_spawn_file_actions_destroy(&fa);
+  close(pipeFd[1]);
+  if (rc != 0) {
+    close(pipeFd[0]);
+    c.pid = -1;
+    return false;
+  }
+  c.output = pipeFd[0];
+
+  std::string seen;
+  auto allSeen = [&] {
+    for (const char* r : ready) {
+      if (seen.find(r) == std::string::npos) return false;
+    }
+    return true;
+  };
+  const double deadline = hostRealClock() + 5.0;
+  while (!allSeen()) {
+    const int left = (int)((deadline - hostRealClock()) * 1000);
+    struct pollfd p = {c.output, POLLIN, 0};
+    if (left <= 0 || poll(&p, 1, left) <= 0) break;
+    char buf[256];
+    const ssize_t n = read(c.output, buf, sizeof(buf));
+    if (n <= 0) break;
+    seen.append(buf, (size_t)n);
+  }
+  if (!allSeen()) {
+    fprintf(stderr, "%s nicht bereit: %s\n", script, seen.c_str());
+    stop(c);
+    return false;
+  }
+  return true;
+}
+
+bool hostStandinStart(const char* args) {
+  // bereit, sobald beide Sockets gebunden sind (je eine Zeile)
+  return start(standin, "ntp_standin.py",
+               {"--bind", "127.0.0.1", "--port", std::to_string(HOST_NTP_PORT), "--dns-port",
+                std::to_string(NTP_DNS_PORT)},
+               args, {"NTP-Ersatz", "DNS-Ersatz"});
+}
+
+void hostStandinStop() {
+  stop(standin);
+}
+
+bool hostDeltaServerStart(const char* dir, const char* args) {
+  return start(deltaServer, "delta_ota.py",
+               {"serve", "--dir", dir, "--bind", "127.0.0.1", "--port", std::to_string(DELTA_OTA_PORT)}, args,
+               {"Delta-Server"});
+}
+
+void hostDeltaServerStop() {
+  stop(deltaServer);
+}
+
+bool hostConfigServerStart(const char* file, const char* args) {
+  return start(configServer, "config_standin.py",
+               {"--file", file, "--bind", "127.0.0.1", "--port", std::to_string(CLOCK_CONFIG_PORT)}, args,
+               {"Konfiguration"});
+}
+
+void hostConfigServerStop() {
+  stop(configServer);
+}
+
+bool hostCollectorStart(const char* out, const char* args) {
+  return start(collector, "tele_collector.py",
+               {"--out", out, "--bind", "127.0.0.1", "--port", std::to_string(TELE_UPLOAD_PORT)}, args,
+               {"Sammler auf"});
+}
+
+void hostCollectorStop() {
+  stop(collector);
+}
+
+FILE* hostScriptOpen(const char* script, const char* args) {
+  const std::string cmd = "python3 " + projectDir() + "scripts/" + script + " " + (args ? args : "");
+  return popen(cmd.c_str(), "r");
+}
+
+int hostScriptClose(FILE* f) {
+  const int st = pclose(f);
+  return WIFEXITED(st) ? WEXITSTATUS(st) : -1;
+}
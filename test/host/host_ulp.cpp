@@ -0,0 +1,615 @@
+/**
+ * @file host_ulp.cpp
+ * @brief ULP-FSM auf dem Host: Laden mit Marken, Interpreter, RTC-Register,
+ *        Tiefschlaf und das Display als I2C-Slave an RTC_GPIO8/9
+ *
+ * ulp_process_macros_and_load() löst die Marken wie das IDF auf und legt die
+ * Befehlswörter im reservierten Bereich ab; der Interpreter dekodiert diese
+ * Wörter. Register sind 16 Bit breit, M_BXZ/M_BXF prüfen die Flags der letzten
+ * ALU-Operation, I_ST schreibt in die oberen 16 Bit den PC und das Adressregister
+ * mit. Jeder Lauf beginnt am Einsprung und endet mit I_HALT; der nächste folgt
+ * die mit I_SLEEP_CYCLE_SEL gewählte Periode nach dem HALT. Die Laufzeit zählt in
+ * Takten zu 8 MHz nach der Befehlsliste des ESP32 (ALU 6, LD/ST 8, Sprung 4,
+ * REG_RD 8, REG_WR 12), der RTC-Zähler läuft mit 150 kHz.
+ *
+ * SDA (RTC_GPIO9) und SCL (RTC_GPIO8) sind Open-Drain mit den Pull-ups des
+ * Display-Moduls: eine Leitung ist low, solange ihr RTC-Ausgang eingeschaltet
+ * ist (Ausgangswert 0) oder das Display SDA zum ACK zieht. Der I2C-Slave
+ * tastet bei steigendem SCL ab, erkennt Start und Stopp und reicht die Bytes
+ * nach seiner Adresse an das SH1106-Modell weiter.
+ */
+#include "host.h"
+
+#include <string.h>
+#include <map>
+#include "driver/rtc_io.h"
+#include "esp32/ulp.h"
+#include "esp_sleep.h"
+#include "soc/rtc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+
+extern char __start_host_rtc_data[] __attribute__((weak));
+extern char __stop_host_rtc_data[] __attribute__((weak));
+
+#define RESERVE_WORDS (CONFIG_ULP_COPROC_RESERVE_MEM / 4)
+#define NS_PER_CYCLE  (1000000000 / HOST_ULP_HZ)
+#define RUN_LIMIT     2000000   // Takte je Lauf, darüber gilt er als Endlosschleife
+#define SDA_RTC 9
+#define SCL_RTC 8
+#define DISPLAY_ADDR 0x3C   // SH1106, SA0 an GND
+
+struct Ulp {
+  uint32_t code[RESERVE_WORDS];
+  uint32_t words;
+  uint16_t r[4];
+  bool     zero, overflow;
+  uint32_t entry;
+  uint8_t  cycleSel;
+  uint32_t periodTicks[5];
+  int64_t  nextNs;          // RTC-Zeit des nächsten Laufs
+  uint32_t event;           // hostAt-Nummer, 0 = keiner eingeplant
+  const char* fault;
+  HostUlpRunFn onRun;
+  void*    onRunArg;
+};
+
+struct Regs {
+  uint32_t state0;
+  uint32_t gpioOut, gpioEnable;
+  uint32_t rtcMux, pullup;                      // Bits wie gpioEnable (14 + RTC-GPIO)
+  uint64_t timeLatched;
+  int64_t  timeValidNs;                         // ab dann ist RTC_CNTL_TIME_VALID gesetzt
+  uint32_t slowClkCal;
+  std::map<uint32_t, uint32_t> other;
+};
+
+enum SlaveState : uint8_t { BUS_IDLE, BUS_ADDRESS, BUS_DATA, BUS_IGNORE };
+
+struct Bus {
+  bool scl, sda, slaveSda;
+  SlaveState state;
+  uint8_t bits, byte;
+  bool ackSlot, acked, nack;
+  int64_t sclEdgeNs;
+  uint32_t starts, stops, minLowNs, minHighNs;
+};
+
+struct Sleep {
+  bool sleeping, woke;
+  bool ulpWakeup;
+  uint64_t timerUs;                             // 0 = kein Timer-Wakeup
+  uint32_t timerEvent;
+  esp_sleep_wakeup_cause_t cause;
+};
+
+static Ulp ulp;
+static Regs regs;
+static Bus bus;
+static Sleep deepSleep;
+
+// --- RTC-Speicher ---
+
+uint32_t* hostRtcSlowMem() {
+  return (uint32_t*)(uintptr_t)((uintptr_t)__start_host_rtc_data - CONFIG_ULP_COPROC_RESERVE_MEM);
+}
+
+// Wort addr des RTC-Slow-Memory, nullptr außerhalb
+static uint32_t* slowWord(uint32_t addr) {
+  if (addr < RESERVE_WORDS) return &ulp.code[addr];
+  const size_t off = (size_t)(addr - RESERVE_WORDS) * 4;
+  if (!__start_host_rtc_data || off + 4 > (size_t)(__stop_host_rtc_data - __start_host_rtc_data)) return nullptr;
+  return (uint32_t*)(__start_host_rtc_data + off);
+}
+
+// --- I2C-Bus mit dem Display als Slave ---
+
+static bool pinLow(uint8_t rtc) {
+  const uint32_t bit = 1u << (RTC_GPIO_ENABLE_S + rtc);
+  return (regs.rtcMux & bit) && (regs.gpioEnable & bit) && !(regs.gpioOut & bit);
+}
+
+static void slaveByte() {
+  if (bus.state == BUS_ADDRESS) {
+    bus.acked = !bus.nack && bus.byte == (DISPLAY_ADDR << 1);
+    if (bus.acked) hostSh1106Start();
+  } else {
+    bus.acked = hostSh1106Write(bus.byte);
+  }
+}
+
+static void sclRise(int64_t ns) {
+  if (ns - bus.sclEdgeNs < bus.minLowNs) bus.minLowNs = (uint32_t)(ns - bus.sclEdgeNs);
+  bus.sclEdgeNs = ns;
+  if ((bus.state == BUS_ADDRESS || bus.state == BUS_DATA) && !bus.ackSlot) {
+    bus.byte = (uint8_t)(bus.byte << 1 | bus.sda);
+    ++bus.bits;
+  }
+}
+
+static void sclFall(int64_t ns) {
+  if (ns - bus.sclEdgeNs < bus.minHighNs) bus.minHighNs = (uint32_t)(ns - bus.sclEdgeNs);
+  bus.sclEdgeNs = ns;
+  if (bus.ackSlot) {                  // Ende des neunten Takts: SDA loslassen
+    bus.ackSlot = false;
+    bus.slaveSda = false;
+    bus.bits = 0;
+    bus.byte = 0;
+    if (!bus.acked) bus.state = BUS_IGNORE;
+    else if (bus.state == BUS_ADDRESS) bus.state = BUS_DATA;
+  } else if (bus.bits == 8) {         // Byte vollständig: ACK im neunten Takt
+    slaveByte();
+    bus.ackSlot = true;
+    bus.slaveSda = bus.acked;
+  }
+}
+
+static void busStart() {
+  if (bus.state == BUS_DATA) hostSh1106Stop();   // wiederholter Start
+  bus.state = BUS_ADDRESS;
+  bus.bits = 0;
+  bus.byte = 0;
+  bus.ackSlot = false;
+  bus.slaveSda = false;
+  ++bus.starts;
+}
+
+static void busStop() {
+  if (bus.state == BUS_DATA) hostSh1106Stop();
+  bus.state = BUS_IDLE;
+  bus.ackSlot = false;
+  bus.slaveSda = false;
+  ++bus.stops;
+}
+
+// Pegel nach einer Änderung an Ausgängen oder Mux neu bestimmen, Flanken auswerten
+static void busUpdate(int64_t ns) {
+  const bool scl = !pinLow(SCL_RTC);
+  if (scl != bus.scl) {
+    bus.scl = scl;
+    if (scl) sclRise(ns);
+    else sclFall(ns);
+  }
+  const bool sda = !pinLow(SDA_RTC) && !bus.slaveSda;
+  if (sda != bus.sda) {
+    bus.sda = sda;
+    if (bus.scl) {
+      if (!sda) busStart();
+      else busStop();
+    }
+  }
+}
+
+HostI2cBus hostI2cBus() {
+  return {bus.scl, bus.sda, bus.starts, bus.stops, bus.minLowNs, bus.minHighNs};
+}
+
+void hostI2cDisplayNack(bool on) {
+  bus.nack = on;
+}
+
+// --- Register ---
+
+static bool rtcIoBit(uint32_t reg) {
+  return reg == RTC_GPIO_OUT_REG || reg == RTC_GPIO_ENABLE_REG || reg == RTC_GPIO_ENABLE_W1TS_REG ||
+         reg == RTC_GPIO_ENABLE_W1TC_REG;
+}
+
+static uint32_t regRead(uint32_t reg, int64_t ns) {
+  switch (reg) {
+    case RTC_CNTL_STATE0_REG: return regs.state0;
+    case RTC_CNTL_TIME_UPDATE_REG: return ns >= regs.timeValidNs ? RTC_CNTL_TIME_VALID : 0;
+    case RTC_CNTL_TIME0_REG: return (uint32_t)regs.timeLatched;
+    case RTC_CNTL_TIME1_REG: return (uint32_t)(regs.timeLatched >> 32) & 0xFFFF;
+    case RTC_SLOW_CLK_CAL_REG: return regs.slowClkCal;
+    case RTC_GPIO_OUT_REG: return regs.gpioOut;
+    case RTC_GPIO_ENABLE_REG: return regs.gpioEnable;
+    case RTC_GPIO_IN_REG:
+      return (uint32_t)bus.sda << (RTC_GPIO_IN_NEXT_S + SDA_RTC) | (uint32_t)bus.scl << (RTC_GPIO_IN_NEXT_S + SCL_RTC);
+    default: {
+      auto it = regs.other.find(reg);
+      return it == regs.other.end() ? 0 : it->second;
+    }
+  }
+}
+
+static void timerSchedule();
+
+static void regWrite(uint32_t reg, uint32_t v, int64_t ns) {
+  switch (reg) {
+    case RTC_CNTL_STATE0_REG: {
+      const bool was = regs.state0 & RTC_CNTL_ULP_CP_SLP_TIMER_EN;
+      regs.state0 = v;
+      if (!was && (v & RTC_CNTL_ULP_CP_SLP_TIMER_EN)) {   // Timer zählt von vorn
+        ulp.nextNs = ns + (int64_t)ulp.periodTicks[ulp.cycleSel] * 1000000000LL / HOST_RTC_SLOW_HZ;
+      }
+      if (was != (bool)(v & RTC_CNTL_ULP_CP_SLP_TIMER_EN)) timerSchedule();
+      break;
+    }
+    case RTC_CNTL_TIME_UPDATE_REG:
+      if (v & RTC_CNTL_TIME_UPDATE) {   // Zähler übernehmen, gültig nach einem Langsamtakt
+        regs.timeLatched = (uint64_t)(ns / 1000) * HOST_RTC_SLOW_HZ / 1000000;
+        regs.timeValidNs = ns + 1000000000LL / HOST_RTC_SLOW_HZ;
+      }
+      break;
+    case RTC_SLOW_CLK_CAL_REG: regs.slowClkCal = v; break;
+    case RTC_GPIO_OUT_REG: regs.gpioOut = v; break;
+    case RTC_GPIO_ENABLE_REG: regs.gpioEnable = v; break;
+    case RTC_GPIO_ENABLE_W1TS_REG: regs.gpioEnable |= v; break;
+    case RTC_GPIO_ENABLE_W1TC_REG: regs.gpioEnable &= ~v; break;
+    default: regs.other[reg] = v; break;
+  }
+  if (rtcIoBit(reg)) busUpdate(ns);
+}
+
+static int64_t nowNs() {
+  return hostRtcUs() * 1000;
+}
+
+uint32_t hostRegRead(uint32_t reg) {
+  return regRead(reg, nowNs());
+}
+
+void hostRegWrite(uint32_t reg, uint32_t value) {
+  regWrite(reg, value, nowNs());
+}
+
+// --- RTC-GPIO ---
+
+static int rtcGpio(gpio_num_t pin) {
+  switch (pin) {
+    case GPIO_NUM_32: return 9;
+    case GPIO_NUM_33: return 8;
+    default: return -1;
+  }
+}
+
+static esp_err_t pinBits(gpio_num_t pin, uint32_t* bit) {
+  const int n = rtcGpio(pin);
+  if (n < 0) return ESP_ERR_INVALID_ARG;
+  *bit = 1u << (RTC_GPIO_ENABLE_S + n);
+  return ESP_OK;
+}
+
+esp_err_t rtc_gpio_init(gpio_num_t gpio_num) {
+  uint32_t bit;
+  if (pinBits(gpio_num, &bit) != ESP_OK) return ESP_ERR_INVALID_ARG;
+  regs.rtcMux |= bit;
+  busUpdate(nowNs());
+  return ESP_OK;
+}
+
+esp_err_t rtc_gpio_deinit(gpio_num_t gpio_num) {
+  uint32_t bit;
+  if (pinBits(gpio_num, &bit) != ESP_OK) return ESP_ERR_INVALID_ARG;
+  regs.rtcMux &= ~bit;
+  busUpdate(nowNs());
+  return ESP_OK;
+}
+
+esp_err_t rtc_gpio_set_direction(gpio_num_t gpio_num, rtc_gpio_mode_t mode) {
+  uint32_t bit;
+  if (pinBits(gpio_num, &bit) != ESP_OK) return ESP_ERR_INVALID_ARG;
+  const bool out = mode == RTC_GPIO_MODE_OUTPUT_ONLY || mode == RTC_GPIO_MODE_INPUT_OUTPUT ||
+                   mode == RTC_GPIO_MODE_OUTPUT_OD || mode == RTC_GPIO_MODE_INPUT_OUTPUT_OD;
+  hostRegWrite(out ? RTC_GPIO_ENABLE_W1TS_REG : RTC_GPIO_ENABLE_W1TC_REG, bit);
+  return ESP_OK;
+}
+
+esp_err_t rtc_gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+  uint32_t bit;
+  if (pinBits(gpio_num, &bit) != ESP_OK) return ESP_ERR_INVALID_ARG;
+  hostRegWrite(RTC_GPIO_OUT_REG, level ? regs.gpioOut | bit : regs.gpioOut & ~bit);
+  return ESP_OK;
+}
+
+esp_err_t rtc_gpio_pullup_en(gpio_num_t gpio_num) {
+  uint32_t bit;
+  if (pinBits(gpio_num, &bit) != ESP_OK) return ESP_ERR_INVALID_ARG;
+  regs.pullup |= bit;
+  return ESP_OK;
+}
+
+// --- Laden ---
+
+esp_err_t ulp_process_macros_and_load(uint32_t load_addr, const ulp_insn_t* program, size_t* psize) {
+  std::map<uint16_t, uint32_t> labels;
+  uint32_t pc = load_addr;
+  for (size_t i = 0; i < *psize; ++i) {
+    const ulp_insn_t& in = program[i];
+    if (in.macro.opcode != OPCODE_MACRO) {
+      ++pc;
+    } else if (in.macro.sub_opcode == SUB_OPCODE_MACRO_LABEL) {
+      if (!labels.emplace((uint16_t)in.macro.label, pc).second) return ESP_ERR_ULP_DUPLICATE_LABEL;
+    }
+  }
+  const uint32_t words = pc - load_addr;
+  if (load_addr > RESERVE_WORDS) return ESP_ERR_ULP_INVALID_LOAD_ADDR;
+  if (pc > RESERVE_WORDS) return ESP_ERR_ULP_SIZE_TOO_BIG;
+
+  pc = load_addr;
+  for (size_t i = 0; i < *psize; ++i) {
+    const ulp_insn_t& in = program[i];
+    if (in.macro.opcode != OPCODE_MACRO) {
+      ulp.code[pc++] = in.instruction;
+      continue;
+    }
+    if (in.macro.sub_opcode == SUB_OPCODE_MACRO_LABEL) continue;
+    auto it = labels.find((uint16_t)in.macro.label);
+    if (it == labels.end()) return ESP_ERR_ULP_UNDEFINED_LABEL;
+    if (i + 1 >= *psize) return ESP_ERR_ULP_UNDEFINED_LABEL;
+    ulp_insn_t next = program[++i];   // der Befehl, dessen Ziel die Marke ist
+    if (in.macro.sub_opcode == SUB_OPCODE_MACRO_LABELPC) {
+      next.alu_imm.imm = it->second;
+    } else if (next.b.opcode == OPCODE_BRANCH && next.b.sub_opcode == SUB_OPCODE_B) {
+      const int32_t off = (int32_t)it->second - (int32_t)pc;
+      if (off > 127 || off < -127) return ESP_ERR_ULP_BRANCH_OUT_OF_RANGE;
+      next.b.offset = (uint32_t)(off < 0 ? -off : off);
+      next.b.sign = off < 0;
+    } else {
+      next.bx.addr = it->second;
+    }
+    ulp.code[pc++] = next.instruction;
+  }
+  ulp.words = words;
+  return ESP_OK;
+}
+
+uint32_t hostUlpProgramWords() {
+  return ulp.words;
+}
+
+esp_err_t ulp_set_wakeup_period(size_t period_index, uint32_t period_us) {
+  if (period_index > 4) return ESP_ERR_INVALID_ARG;
+  // wie rtc_time_us_to_slowclk() mit dem Kalibrierwert
+  ulp.periodTicks[period_index] = (uint32_t)(((uint64_t)period_us << RTC_CLK_CAL_FRACT) / regs.slowClkCal);
+  return ESP_OK;
+}
+
+esp_err_t ulp_run(uint32_t entry_point) {
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  ulp.entry = entry_point;
+  ulp.fault = nullptr;
+  SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  return ESP_OK;
+}
+
+// --- Interpreter ---
+
+static void fault(const char* why, uint32_t pc) {
+  static char msg[96];
+  snprintf(msg, sizeof(msg), "ULP: %s (PC %u)", why, pc);
+  ulp.fault = msg;
+  fprintf(stderr, "%s\n", msg);
+}
+
+static uint32_t periphReg(uint32_t sel, uint32_t addr) {
+  return DR_REG_RTCCNTL_BASE + (sel << 10) + addr * 4;
+}
+
+static uint16_t alu(uint32_t sel, uint16_t a, uint16_t b) {
+  uint32_t r;
+  switch (sel) {
+    case ALU_SEL_ADD: r = (uint32_t)a + b; ulp.overflow = r > 0xFFFF; break;
+    case ALU_SEL_SUB: r = (uint32_t)a - b; ulp.overflow = a < b; break;
+    case ALU_SEL_AND: r = a & b; break;
+    case ALU_SEL_OR:  r = a | b; break;
+    case ALU_SEL_MOV: r = b; break;
+    case ALU_SEL_LSH: r = (uint32_t)a << (b & 15); break;
+    default:          r = a >> (b & 15); break;
+  }
+  ulp.zero = (r & 0xFFFF) == 0;
+  return (uint16_t)r;
+}
+
+// ein Lauf ab dem Einsprung bis I_HALT; startNs = RTC-Zeit
+static void runOnce(int64_t startNs) {
+  HostUlpRun run = {hostWallClock(), 0, 0, false};
+  const uint32_t data0 = hostSh1106DataBytes();
+  uint32_t pc = ulp.entry;
+  uint64_t cycles = 0;
+  for (;;) {
+    if (cycles > RUN_LIMIT) return fault("kein HALT", pc);
+    if (pc >= RESERVE_WORDS) return fault("PC außerhalb des Programmbereichs", pc);
+    ulp_insn_t in;
+    in.instruction = ulp.code[pc];
+    const int64_t ns = startNs + (int64_t)cycles * NS_PER_CYCLE;
+    uint32_t next = pc + 1;
+    switch (in.halt.opcode) {
+      case OPCODE_ALU:
+        if (in.alu_reg.sub_opcode == SUB_OPCODE_ALU_REG) {
+          const uint16_t b = in.alu_reg.sel == ALU_SEL_MOV ? ulp.r[in.alu_reg.sreg] : ulp.r[in.alu_reg.treg];
+          ulp.r[in.alu_reg.dreg] = alu(in.alu_reg.sel, ulp.r[in.alu_reg.sreg], b);
+        } else if (in.alu_imm.sub_opcode == SUB_OPCODE_ALU_IMM) {
+          ulp.r[in.alu_imm.dreg] = alu(in.alu_imm.sel, ulp.r[in.alu_imm.sreg], (uint16_t)in.alu_imm.imm);
+        } else {
+          return fault("Stufenzähler nicht nachgebildet", pc);
+        }
+        cycles += 6;
+        break;
+      case OPCODE_LD: {
+        uint32_t* w = slowWord(ulp.r[in.ld.sreg] + in.ld.offset);
+        if (!w) return fault("LD außerhalb des RTC-Speichers", pc);
+        ulp.r[in.ld.dreg] = (uint16_t)*w;
+        cycles += 8;
+        break;
+      }
+      case OPCODE_ST: {
+        uint32_t* w = slowWord(ulp.r[in.st.sreg] + in.st.offset);
+        if (!w) return fault("ST außerhalb des RTC-Speichers", pc);
+        if (w < ulp.code + RESERVE_WORDS && w >= ulp.code) return fault("ST in den Programmbereich", pc);
+        // obere Hälfte wie auf dem Chip: PC[10:0], drei Nullbits, Adressregister
+        *w = (pc & 0x7FF) << 21 | in.st.sreg << 16 | ulp.r[in.st.dreg];
+        cycles += 8;
+        break;
+      }
+      case OPCODE_BRANCH:
+        if (in.bx.sub_opcode == SUB_OPCODE_BX) {
+          const uint32_t target = in.bx.reg ? ulp.r[in.bx.dreg] : in.bx.addr;
+          if (in.bx.type == BX_JUMP_TYPE_DIRECT || (in.bx.type == BX_JUMP_TYPE_ZERO && ulp.zero) ||
+              (in.bx.type == BX_JUMP_TYPE_OVF && ulp.overflow)) {
+            next = target;
+          }
+        } else if (in.b.sub_opcode == SUB_OPCODE_B) {
+          const bool take = in.b.cmp == B_CMP_L ? ulp.r[0] < in.b.imm : ulp.r[0] >= in.b.imm;
+          if (take) next = in.b.sign ? pc - in.b.offset : pc + in.b.offset;
+        } else {
+          return fault("Stufenzähler nicht nachgebildet", pc);
+        }
+        cycles += 4;
+        break;
+      case OPCODE_RD_REG: {
+        if (in.rd_reg.high < in.rd_reg.low || in.rd_reg.high - in.rd_reg.low > 15) return fault("REG_RD breiter als 16 Bit", pc);
+        const uint32_t width = in.rd_reg.high - in.rd_reg.low + 1;
+        const uint32_t v = regRead(periphReg(in.rd_reg.periph_sel, in.rd_reg.addr), ns);
+        ulp.r[0] = (uint16_t)((v >> in.rd_reg.low) & ((1u << width) - 1));
+        cycles += 8;
+        break;
+      }
+      case OPCODE_WR_REG: {
+        if (in.wr_reg.high < in.wr_reg.low || in.wr_reg.high - in.wr_reg.low > 7) return fault("REG_WR breiter als 8 Bit", pc);
+        const uint32_t reg = periphReg(in.wr_reg.periph_sel, in.wr_reg.addr);
+        const uint32_t width = in.wr_reg.high - in.wr_reg.low + 1;
+        const uint32_t mask = ((1u << width) - 1) << in.wr_reg.low;
+        const uint32_t bits = (in.wr_reg.data << in.wr_reg.low) & mask;
+        cycles += 12;
+        if (reg == RTC_GPIO_ENABLE_W1TS_REG || reg == RTC_GPIO_ENABLE_W1TC_REG) {
+          regWrite(reg, bits, startNs + (int64_t)cycles * NS_PER_CYCLE);   // nur gesetzte Bits wirken
+        } else {
+          regWrite(reg, (regRead(reg, ns) & ~mask) | bits, startNs + (int64_t)cycles * NS_PER_CYCLE);
+        }
+        break;
+      }
+      case OPCODE_END:
+        if (in.end.sub_opcode == SUB_OPCODE_END) {
+          if (in.end.wakeup) {
+            run.wake = true;
+            if (deepSleep.sleeping && deepSleep.ulpWakeup && !deepSleep.woke) {
+              deepSleep.woke = true;
+              deepSleep.cause = ESP_SLEEP_WAKEUP_ULP;
+            }
+          }
+        } else {
+          if (in.sleep.cycle_sel > 4) return fault("Periode > 4", pc);
+          ulp.cycleSel = (uint8_t)in.sleep.cycle_sel;
+        }
+        cycles += 6;
+        break;
+      case OPCODE_DELAY:
+        cycles += in.delay.cycles + 6;
+        break;
+      case OPCODE_HALT:
+        cycles += 2;
+        run.cycles = (uint32_t)cycles;
+        run.dataBytes = hostSh1106DataBytes() - data0;
+        ulp.nextNs = startNs + (int64_t)cycles * NS_PER_CYCLE +
+                     (int64_t)ulp.periodTicks[ulp.cycleSel] * 1000000000LL / HOST_RTC_SLOW_HZ;
+        if (ulp.onRun) ulp.onRun(run, ulp.onRunArg);
+        return;
+      default:
+        return fault("unbekannter Befehl", pc);
+    }
+    pc = next;
+  }
+}
+
+static void timerFire(void*) {
+  ulp.event = 0;
+  if (!(regs.state0 & RTC_CNTL_ULP_CP_SLP_TIMER_EN) || ulp.fault) return;
+  runOnce(ulp.nextNs);
+  if (ulp.fault) {
+    regs.state0 &= ~RTC_CNTL_ULP_CP_SLP_TIMER_EN;
+    return;
+  }
+  timerSchedule();
+}
+
+// Lauf für ulp.nextNs einplanen bzw. bei ausgeschaltetem Timer verwerfen
+static void timerSchedule() {
+  const bool on = regs.state0 & RTC_CNTL_ULP_CP_SLP_TIMER_EN;
+  if (ulp.event && !on) {
+    hostCancel(ulp.event);
+    ulp.event = 0;
+  }
+  if (!on || ulp.event) return;
+  const int64_t atUs = (ulp.nextNs + 999) / 1000 - (hostRtcUs() - hostNowUs());
+  ulp.event = hostAt(atUs, timerFire, nullptr);
+}
+
+void hostUlpOnRun(HostUlpRunFn fn, void* arg) {
+  ulp.onRun = fn;
+  ulp.onRunArg = arg;
+}
+
+const char* hostUlpFault() {
+  return ulp.fault;
+}
+
+bool hostUlpTimerOn() {
+  return regs.state0 & RTC_CNTL_ULP_CP_SLP_TIMER_EN;
+}
+
+void hostUlpReset(bool powerOn) {
+  if (powerOn) {
+    if (ulp.event) hostCancel(ulp.event);
+    ulp = Ulp();
+    regs = Regs();
+    // µs je Langsamtakt als Festkomma, wie rtc_clk_cal() ihn ablegt
+    regs.slowClkCal = (uint32_t)((1000000ULL << RTC_CLK_CAL_FRACT) / HOST_RTC_SLOW_HZ);
+    bus = Bus();
+    bus.scl = bus.sda = true;
+    bus.minLowNs = bus.minHighNs = UINT32_MAX;
+    deepSleep = Sleep();
+    return;
+  }
+  ulp.event = 0;   // die Ereignisse hat der Reset verworfen
+  timerSchedule();
+}
+
+// --- Tiefschlaf ---
+
+esp_err_t esp_sleep_enable_ulp_wakeup() {
+  deepSleep.ulpWakeup = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+  deepSleep.timerUs = time_in_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option) {
+  if (domain >= ESP_PD_DOMAIN_MAX || option > ESP_PD_OPTION_AUTO) return ESP_ERR_INVALID_ARG;
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return deepSleep.cause;
+}
+
+void esp_deep_sleep_start() {
+  throw HostDeepSleep();
+}
+
+static void sleepTimerFire(void*) {
+  deepSleep.timerEvent = 0;
+  if (!deepSleep.woke) {
+    deepSleep.woke = true;
+    deepSleep.cause = ESP_SLEEP_WAKEUP_TIMER;
+  }
+}
+
+esp_sleep_wakeup_cause_t hostDeepSleep() {
+  hostSleepReset();
+  deepSleep.sleeping = true;
+  deepSleep.woke = false;
+  deepSleep.cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+  if (deepSleep.timerUs) deepSleep.timerEvent = hostAt(hostNowUs() + (int64_t)deepSleep.timerUs, sleepTimerFire, nullptr);
+  hostAdvanceUntil(&deepSleep.woke);
+  deepSleep.sleeping = false;
+  // Wakeup-Quellen gelten nur für diesen Schlaf
+  deepSleep.ulpWakeup = false;
+  deepSleep.timerUs = 0;
+  hostSleepReset();
+  return deepSleep.cause;
+}
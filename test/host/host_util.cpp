@@ -0,0 +1,19 @@
+/**
+ * @file host_util.cpp
+ * @brief Kleine Hilfen, die mehrere Tests unter test/host brauchen
+ */
+#include "host.h"
+
+#include <math.h>
+#include "telemetry.h"
+
+bool hostLastTele(uint8_t type, TelemetryRecord* out) {
+  for (int i = telemetryCount() - 1; i >= 0; --i) {
+    if (telemetryGet((uint16_t)i, out) && out->type == type) return true;
+  }
+  return false;
+}
+
+float hostNoTemp() {
+  return NAN;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file host_wifi.cpp
+ * @brief Simuliertes WLAN: APs mit Kanal, Pegel, Verbindungsdauer und Fehlschlag
+ *
+ * esp_wifi_connect() plant je nach AP "verbunden" (nach connectMs) oder
+ * "getrennt" (abgelehnt nach connectMs, nicht gefunden nach notFoundMs); die
+ * Ereignisse kommen in vTaskDelay() an. Die Trennung nach esp_wifi_disconnect()
+ * ist ein eigenes Ereignis mit der SSID des abgebrochenen Versuchs und überholt
+ * einen folgenden esp_wifi_connect() nicht, wie beim echten Treiber. hostWifiOps
+ * meldet die Ereignisse wie onWifiEvent() in main_idf.cpp an wifiAttemptEvent().
+ */
+#include "host.h"
+
+#include <string.h>
+#include <deque>
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/dns.h"
+#include "lwip/sockets.h"
+
+enum HostWifiEvent : uint8_t { EV_CONNECTED = 1, EV_DISCONNECTED };
+
+static std::deque<HostAp> aps;   // Zeiger aus hostWifiAdd() bleiben gültig
+static HostWifiTiming timing;
+static bool started;
+static int64_t startedAtUs;
+static uint64_t radioOnUs;
+static wifi_config_t config;
+static int connectedAp = -1;
+static int pendingAp = -1;
+static uint32_t attempts;
+static uint32_t timerContextCalls;
+
+// geplantes Ereignis mit der SSID, die der Treiber dazu meldet
+struct PlannedEvent {
+  uint32_t id;      // hostAt(), 0 = keins
+  uint8_t  ev;
+  int      ap;      // Index in aps, -1 = AP nicht gefunden
+  char     ssid[33];
+};
+
+static PlannedEvent attemptEvent;      // Ergebnis des laufenden Versuchs
+static PlannedEvent disconnectEvent;   // Trennung nach esp_wifi_disconnect()
+
+static void onEvent(void* arg) {
+  PlannedEvent& e = *(PlannedEvent*)arg;
+  e.id = 0;
+  if (e.ev == EV_CONNECTED && !aps[e.ap].present) e.ev = EV_DISCONNECTED;   // AP während der Anmeldung verschwunden
+  if (e.ev == EV_CONNECTED) {
+    connectedAp = e.ap;
+    pendingAp = -1;
+    wifiAttemptEvent(true, nullptr, 0);
+    return;
+  }
+  if (&e == &attemptEvent) pendingAp = -1;
+  if (connectedAp == e.ap || &e == &attemptEvent) connectedAp = -1;
+  wifiAttemptEvent(false, (const uint8_t*)e.ssid, (uint8_t)strlen(e.ssid));
+}
+
+static void cancel(PlannedEvent& e) {
+  if (e.id) hostCancel(e.id);
+  e.id = 0;
+}
+
+static void schedule(PlannedEvent& e, uint8_t ev, int ap, const char* ssid, uint32_t ms) {
+  cancel(e);
+  e.ev = ev;
+  e.ap = ap;
+  strncpy(e.ssid, ssid, sizeof(e.ssid) - 1);
+  e.ssid[sizeof(e.ssid) - 1] = '\0';
+  e.id = hostAt(esp_timer_get_time() + (int64_t)ms * 1000, onEvent, &e);
+}
+
+void hostWifiReset() {
+  cancel(attemptEvent);
+  cancel(disconnectEvent);
+  aps.clear();
+  timing = {800, 780, 20};
+  started = false;
+  radioOnUs = 0;
+  connectedAp = pendingAp = -1;
+  attempts = 0;
+  timerContextCalls = 0;
+}
+
+void hostWifiChipReset() {
+  esp_wifi_stop();
+}
+
+HostWifiTiming& hostWifiTiming() {
+  return timing;
+}
+
+HostAp* hostWifiAdd(const char* ssid, uint8_t channel, int8_t rssi, uint32_t connectMs) {
+  HostAp ap = {};
+  strncpy(ap.ssid, ssid, sizeof(ap.ssid) - 1);
+  ap.channel = channel;
+  ap.rssi = rssi;
+  const uint8_t bssid[6] = {0x24, 0x0A, 0xC4, 0x00, (uint8_t)aps.size(), channel};
+  memcpy(ap.bssid, bssid, sizeof(bssid));
+  ap.present = true;
+  ap.connectMs = connectMs;
+  aps.push_back(ap);
+  return &aps.back();
+}
+
+HostAp* hostWifiAp(const char* ssid) {
+  for (HostAp& ap : aps) {
+    if (strcmp(ap.ssid, ssid) == 0) return &ap;
+  }
+  return nullptr;
+}
+
+const HostAp* hostWifiConnected() {
+  return connectedAp >= 0 ? &aps[connectedAp] : nullptr;
+}
+
+bool hostWifiRunning() {
+  return started;
+}
+
+uint32_t hostWifiRadioOnMs() {
+  uint64_t us = radioOnUs;
+  if (started) us += esp_timer_get_time() - startedAtUs;
+  return (uint32_t)(us / 1000);
+}
+
+uint32_t hostWifiAttempts() {
+  return attempts;
+}
+
+uint32_t hostWifiTimerContextCalls() {
+  return timerContextCalls;
+}
+
+// --- esp_wifi ---
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t) {
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_start() {
+  if (!started) {
+    started = true;
+    startedAtUs = esp_timer_get_time();
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop() {
+  if (hostInTimerCallback()) timerContextCalls++;
+  cancel(attemptEvent);
+  cancel(disconnectEvent);
+  pendingAp = connectedAp = -1;
+  if (started) radioOnUs += esp_timer_get_time() - startedAtUs;
+  started = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t, wifi_config_t* conf) {
+  config = *conf;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect() {
+  if (!started) return ESP_ERR_INVALID_STATE;
+  attempts++;
+  pendingAp = -1;
+  cancel(attemptEvent);
+  const char* ssid = (const char*)config.sta.ssid;
+  for (size_t i = 0; i < aps.size(); ++i) {
+    const HostAp& ap = aps[i];
+    if (!ap.present || strcmp(ap.ssid, ssid) != 0) continue;
+    if (config.sta.channel && config.sta.channel != ap.channel) continue;
+    if (config.sta.bssid_set && memcmp(config.sta.bssid, ap.bssid, 6) != 0) continue;
+    pendingAp = (int)i;
+    if (ap.connectMs != HOST_WIFI_NEVER) {
+      schedule(attemptEvent, ap.reject ? EV_DISCONNECTED : EV_CONNECTED, (int)i, ssid, ap.connectMs);
+    }
+    return ESP_OK;
+  }
+  schedule(attemptEvent, EV_DISCONNECTED, -1, ssid, timing.notFoundMs);
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect() {
+  if (hostInTimerCallback()) timerContextCalls++;
+  if (!started) return ESP_ERR_WIFI_NOT_CONNECT;
+  // laufender Versuch oder Verbindung: genau eine Trennung, mit deren SSID
+  const bool busy = connectedAp >= 0 || pendingAp >= 0 || attemptEvent.id;
+  if (!busy) return ESP_OK;
+  const int ap = connectedAp >= 0 ? connectedAp : pendingAp;
+  const char* ssid = ap >= 0 ? aps[ap].ssid : (const char*)config.sta.ssid;
+  cancel(attemptEvent);
+  pendingAp = -1;
+  if (timing.disconnectMs != HOST_WIFI_NEVER) {
+    schedule(disconnectEvent, EV_DISCONNECTED, ap, ssid, timing.disconnectMs);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t) {
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_max_tx_power(int8_t) {
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_protocol(wifi_interface_t, uint8_t) {
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_scan_parameters(const wifi_scan_default_params_t*) {
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t*, bool block) {
+  if (!started) return ESP_ERR_INVALID_STATE;
+  if (block) vTaskDelay(pdMS_TO_TICKS(timing.scanMs));
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* records) {
+  uint16_t n = 0;
+  for (const HostAp& ap : aps) {
+    if (!ap.present || n >= *number) continue;
+    wifi_ap_record_t& r = records[n++];
+    memset(&r, 0, sizeof(r));
+    memcpy(r.bssid, ap.bssid, 6);
+    strncpy((char*)r.ssid, ap.ssid, sizeof(r.ssid) - 1);
+    r.primary = ap.channel;
+    r.rssi = ap.rssi;
+  }
+  *number = n;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t, uint8_t mac[6]) {
+  static const uint8_t sta[6] = HOST_WIFI_MAC;
+  memcpy(mac, sta, 6);
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* info) {
+  if (connectedAp < 0) return ESP_ERR_WIFI_NOT_CONNECT;
+  const HostAp& ap = aps[connectedAp];
+  memset(info, 0, sizeof(*info));
+  memcpy(info->bssid, ap.bssid, 6);
+  strncpy((char*)info->ssid, ap.ssid, sizeof(info->ssid) - 1);
+  info->primary = ap.channel;
+  info->rssi = ap.rssi;
+  info->phy_11b = info->phy_11g = info->phy_11n = 1;
+  return ESP_OK;
+}
+
+// DHCP liefert den DNS-Ersatz von ntp_standin.py
+const ip_addr_t* dns_getserver(uint8_t) {
+  static ip_addr_t server;
+  server.type = IPADDR_TYPE_V4;
+  server.u_addr.ip4.addr = htonl(INADDR_LOOPBACK);
+  return &server;
+}
+
+// --- WifiConnectOps wie in main_idf.cpp ---
+
+static void opsBegin(const WifiCred& cred, const WifiTuneHint& hint) {
+  wifiAttemptBegin(cred.ssid);
+  wifi_config_t wc = {};
+  strncpy((char*)wc.sta.ssid, cred.ssid, sizeof(wc.sta.ssid));
+  strncpy((char*)wc.sta.password, cred.pass, sizeof(wc.sta.password));
+  wc.sta.channel = hint.channel;
+  if (hint.bssidValid) {
+    wc.sta.bssid_set = true;
+    memcpy(wc.sta.bssid, hint.bssid, sizeof(wc.sta.bssid));
+  }
+  esp_wifi_set_config(WIFI_IF_STA, &wc);
+  esp_wifi_connect();
+}
+
+static uint8_t opsPoll() {
+  return wifiAttemptState();
+}
+
+static void opsDisconnect() {
+  esp_wifi_disconnect();
+}
+
+static void opsAbort() {
+  wifiAttemptAbort(opsDisconnect);
+}
+
+static int opsScan(WifiScanRecord* out, int max) {
+  if (esp_wifi_scan_start(nullptr, true) != ESP_OK) return -1;
+  wifi_ap_record_t recs[16];
+  uint16_t n = max < 16 ? max : 16;
+  if (esp_wifi_scan_get_ap_records(&n, recs) != ESP_OK) return -1;
+  for (uint16_t i = 0; i < n; ++i) {
+    strncpy(out[i].ssid, (const char*)recs[i].ssid, sizeof(out[i].ssid) - 1);
+    out[i].ssid[sizeof(out[i].ssid) - 1] = '\0';
+    out[i].rssi = recs[i].rssi;
+    out[i].channel = recs[i].primary;
+    memcpy(out[i].bssid, recs[i].bssid, sizeof(out[i].bssid));
+  }
+  return n;
+}
+
+const WifiConnectOps hostWifiOps = {opsBegin, opsPoll, opsAbort, opsScan};
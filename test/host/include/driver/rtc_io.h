@@ -0,0 +1,31 @@
+/**
+ * @file rtc_io.h
+ * @brief Host-Ersatz: RTC-GPIO-Treiber für die Display-Pins des ULP (GPIO 32/33),
+ *        wirkt auf das Registermodell und den I2C-Bus in host_ulp.cpp
+ */
+#pragma once
+
+#include "esp_err.h"
+
+typedef enum {
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_32 = 32,
+  GPIO_NUM_33 = 33,
+  GPIO_NUM_MAX = 40,
+} gpio_num_t;
+
+typedef enum {
+  RTC_GPIO_MODE_INPUT_ONLY,
+  RTC_GPIO_MODE_OUTPUT_ONLY,
+  RTC_GPIO_MODE_INPUT_OUTPUT,
+  RTC_GPIO_MODE_DISABLED,
+  RTC_GPIO_MODE_OUTPUT_OD,
+  RTC_GPIO_MODE_INPUT_OUTPUT_OD,
+} rtc_gpio_mode_t;
+
+// ESP_ERR_INVALID_ARG für Pins ohne RTC-Funktion (hier nur 32 und 33)
+esp_err_t rtc_gpio_init(gpio_num_t gpio_num);
+esp_err_t rtc_gpio_deinit(gpio_num_t gpio_num);
+esp_err_t rtc_gpio_set_direction(gpio_num_t gpio_num, rtc_gpio_mode_t mode);
+esp_err_t rtc_gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+esp_err_t rtc_gpio_pullup_en(gpio_num_t gpio_num);
@@ -0,0 +1,53 @@
+/**
+ * @file miniz.h
+ * @brief Host-Ersatz: tinfl-Schnittstelle des ROM-Inflaters über zlib
+ *
+ * Nur was delta_ota.cpp braucht. zlib führt sein Fenster selbst; das
+ * Wörterbuch des Aufrufers dient nur als Ausgabepuffer. Ein Inflater zur Zeit
+ * (ein z_stream für alle tinfl_decompressor).
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE           32768
+#define TINFL_FLAG_PARSE_ZLIB_HEADER 1
+#define TINFL_FLAG_HAS_MORE_INPUT    2
+
+typedef enum {
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct {
+  uint32_t unused;
+} tinfl_decompressor;
+
+z_stream* hostInflater();
+
+static inline void tinfl_init(tinfl_decompressor* r) {
+  (void)r;
+  inflateReset(hostInflater());
+}
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in, size_t* inSize,
+                                            uint8_t* outStart, uint8_t* outNext, size_t* outSize, uint32_t flags) {
+  (void)r;
+  (void)outStart;
+  (void)flags;
+  z_stream* z = hostInflater();
+  z->next_in = (Bytef*)in;
+  z->avail_in = (uInt)*inSize;
+  z->next_out = outNext;
+  z->avail_out = (uInt)*outSize;
+  const int e = inflate(z, Z_NO_FLUSH);
+  *inSize -= z->avail_in;
+  *outSize -= z->avail_out;
+  if (e == Z_STREAM_END) return TINFL_STATUS_DONE;
+  if (e != Z_OK && e != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+  return z->avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file ulp.h
+ * @brief Host-Ersatz: ULP-FSM-Befehle und -Makros wie esp32/ulp.h des IDF
+ *
+ * Kodierung und Makros bitgenau wie im IDF, damit ulp_clock.cpp unverändert
+ * übersetzt und host_ulp.cpp die geladenen Befehlswörter ausführt. Das
+ * RTC-Slow-Memory beginnt mit dem reservierten Programmbereich
+ * (CONFIG_ULP_COPROC_RESERVE_MEM), dahinter liegen wie auf dem Chip die
+ * RTC_DATA_ATTR-Variablen (Abschnitt host_rtc_data). RTC_SLOW_MEM taugt auf dem
+ * Host nur für Adressdifferenzen, das Programm legt der Interpreter selbst ab.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "soc/rtc_cntl_reg.h"
+
+#define R0 0
+#define R1 1
+#define R2 2
+#define R3 3
+
+#define OPCODE_WR_REG 1
+#define OPCODE_RD_REG 2
+#define OPCODE_DELAY 4
+#define OPCODE_ST 6
+#define SUB_OPCODE_ST 4
+#define OPCODE_ALU 7
+#define SUB_OPCODE_ALU_REG 0
+#define SUB_OPCODE_ALU_IMM 1
+#define ALU_SEL_ADD 0
+#define ALU_SEL_SUB 1
+#define ALU_SEL_AND 2
+#define ALU_SEL_OR  3
+#define ALU_SEL_MOV 4
+#define ALU_SEL_LSH 5
+#define ALU_SEL_RSH 6
+#define OPCODE_BRANCH 8
+#define SUB_OPCODE_BX 0
+#define BX_JUMP_TYPE_DIRECT 0
+#define BX_JUMP_TYPE_ZERO 1
+#define BX_JUMP_TYPE_OVF 2
+#define SUB_OPCODE_B 1
+#define B_CMP_L 0
+#define B_CMP_GE 1
+#define OPCODE_END 9
+#define SUB_OPCODE_END 0
+#define SUB_OPCODE_SLEEP 1
+#define OPCODE_HALT 11
+#define OPCODE_LD 13
+#define OPCODE_MACRO 15
+#define SUB_OPCODE_MACRO_LABEL 0
+#define SUB_OPCODE_MACRO_BRANCH 1
+#define SUB_OPCODE_MACRO_LABELPC 2
+
+#define ESP_ERR_ULP_BASE                0x1200
+#define ESP_ERR_ULP_SIZE_TOO_BIG        (ESP_ERR_ULP_BASE + 1)
+#define ESP_ERR_ULP_INVALID_LOAD_ADDR   (ESP_ERR_ULP_BASE + 2)
+#define ESP_ERR_ULP_DUPLICATE_LABEL     (ESP_ERR_ULP_BASE + 3)
+#define ESP_ERR_ULP_UNDEFINED_LABEL     (ESP_ERR_ULP_BASE + 4)
+#define ESP_ERR_ULP_BRANCH_OUT_OF_RANGE (ESP_ERR_ULP_BASE + 5)
+
+typedef union {
+  struct {
+    uint32_t cycles : 16;
+    uint32_t unused : 12;
+    uint32_t opcode : 4;
+  } delay;
+  struct {
+    uint32_t unused : 28;
+    uint32_t opcode : 4;
+  } halt;
+  struct {
+    uint32_t dreg : 2;
+    uint32_t sreg : 2;
+    uint32_t unused1 : 6;
+    uint32_t offset : 11;
+    uint32_t unused2 : 7;
+    uint32_t opcode : 4;
+  } ld;
+  struct {
+    uint32_t dreg : 2;
+    uint32_t sreg : 2;
+    uint32_t unused1 : 6;
+    uint32_t offset : 11;
+    uint32_t unused2 : 4;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } st;
+  struct {
+    uint32_t dreg : 2;
+    uint32_t sreg : 2;
+    uint32_t treg : 2;
+    uint32_t unused : 15;
+    uint32_t sel : 4;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } alu_reg;
+  struct {
+    uint32_t dreg : 2;
+    uint32_t sreg : 2;
+    uint32_t imm : 16;
+    uint32_t unused : 1;
+    uint32_t sel : 4;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } alu_imm;
+  struct {
+    uint32_t dreg : 2;
+    uint32_t addr : 11;
+    uint32_t unused : 8;
+    uint32_t reg : 1;
+    uint32_t type : 3;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } bx;
+  struct {
+    uint32_t imm : 16;
+    uint32_t cmp : 1;
+    uint32_t offset : 7;
+    uint32_t sign : 1;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } b;
+  struct {
+    uint32_t wakeup : 1;
+    uint32_t unused : 24;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } end;
+  struct {
+    uint32_t cycle_sel : 4;
+    uint32_t unused : 21;
+    uint32_t sub_opcode : 3;
+    uint32_t opcode : 4;
+  } sleep;
+  struct {
+    uint32_t addr : 8;
+    uint32_t periph_sel : 2;
+    uint32_t data : 8;
+    uint32_t low : 5;
+    uint32_t high : 5;
+    uint32_t opcode : 4;
+  } wr_reg;
+  struct {
+    uint32_t addr : 8;
+    uint32_t periph_sel : 2;
+    uint32_t unused : 8;
+    uint32_t low : 5;
+    uint32_t high : 5;
+    uint32_t opcode : 4;
+  } rd_reg;
+  struct {
+    uint32_t label : 16;
+    uint32_t unused : 8;
+    uint32_t sub_opcode : 4;
+    uint32_t opcode : 4;
+  } macro;
+  uint32_t instruction;
+} ulp_insn_t;
+
+// Peripherie des Registers: 0 RTC_CNTL, 1 RTC_IO, 2 SENS, 3 RTC_I2C
+#define SOC_REG_TO_ULP_PERIPH_SEL(reg) ((((reg) - DR_REG_RTCCNTL_BASE) >> 10) & 3)
+
+#define I_DELAY(cycles_) { .delay = { \
+    .cycles = (uint32_t)(cycles_), .unused = 0, .opcode = OPCODE_DELAY } }
+
+#define I_HALT() { .halt = { .unused = 0, .opcode = OPCODE_HALT } }
+
+#define I_WAKE() { .end = { \
+    .wakeup = 1, .unused = 0, .sub_opcode = SUB_OPCODE_END, .opcode = OPCODE_END } }
+
+#define I_SLEEP_CYCLE_SEL(timer_idx) { .sleep = { \
+    .cycle_sel = (uint32_t)(timer_idx), .unused = 0, .sub_opcode = SUB_OPCODE_SLEEP, .opcode = OPCODE_END } }
+
+#define I_WR_REG(reg, low_bit, high_bit, val) { .wr_reg = { \
+    .addr = (uint32_t)(((reg) & 0xff) / sizeof(uint32_t)), \
+    .periph_sel = (uint32_t)SOC_REG_TO_ULP_PERIPH_SEL(reg), \
+    .data = (uint32_t)(val), \
+    .low = (uint32_t)(low_bit), \
+    .high = (uint32_t)(high_bit), \
+    .opcode = OPCODE_WR_REG } }
+
+#define I_RD_REG(reg, low_bit, high_bit) { .rd_reg = { \
+    .addr = (uint32_t)(((reg) & 0xff) / sizeof(uint32_t)), \
+    .periph_sel = (uint32_t)SOC_REG_TO_ULP_PERIPH_SEL(reg), \
+    .unused = 0, \
+    .low = (uint32_t)(low_bit), \
+    .high = (uint32_t)(high_bit), \
+    .opcode = OPCODE_RD_REG } }
+
+#define I_WR_REG_BIT(reg, shift, val) I_WR_REG(reg, shift, shift, val)
+
+// ULP-Timer aus; das laufende Programm endet erst mit I_HALT
+#define I_END() I_WR_REG_BIT(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN_S, 0)
+
+#define I_ST(reg_val, reg_addr, offset_) { .st = { \
+    .dreg = (uint32_t)(reg_val), .sreg = (uint32_t)(reg_addr), .unused1 = 0, \
+    .offset = (uint32_t)(offset_), .unused2 = 0, .sub_opcode = SUB_OPCODE_ST, .opcode = OPCODE_ST } }
+
+#define I_LD(reg_dest, reg_addr, offset_) { .ld = { \
+    .dreg = (uint32_t)(reg_dest), .sreg = (uint32_t)(reg_addr), .unused1 = 0, \
+    .offset = (uint32_t)(offset_), .unused2 = 0, .opcode = OPCODE_LD } }
+
+#define I_BL(pc_offset, imm_value) { .b = { \
+    .imm = (uint32_t)(imm_value), .cmp = B_CMP_L, \
+    .offset = (uint32_t)((pc_offset) < 0 ? -(pc_offset) : (pc_offset)), \
+    .sign = (uint32_t)((pc_offset) >= 0 ? 0 : 1), \
+    .sub_opcode = SUB_OPCODE_B, .opcode = OPCODE_BRANCH } }
+
+#define I_BGE(pc_offset, imm_value) { .b = { \
+    .imm = (uint32_t)(imm_value), .cmp = B_CMP_GE, \
+    .offset = (uint32_t)((pc_offset) < 0 ? -(pc_offset) : (pc_offset)), \
+    .sign = (uint32_t)((pc_offset) >= 0 ? 0 : 1), \
+    .sub_opcode = SUB_OPCODE_B, .opcode = OPCODE_BRANCH } }
+
+#define I_BX_(reg_pc, imm_pc, reg_, type_) { .bx = { \
+    .dreg = (uint32_t)(reg_pc), .addr = (uint32_t)(imm_pc), .unused = 0, .reg = reg_, \
+    .type = type_, .sub_opcode = SUB_OPCODE_BX, .opcode = OPCODE_BRANCH } }
+
+#define I_BXR(reg_pc)   I_BX_(reg_pc, 0, 1, BX_JUMP_TYPE_DIRECT)
+#define I_BXI(imm_pc)   I_BX_(0, imm_pc, 0, BX_JUMP_TYPE_DIRECT)
+#define I_BXZR(reg_pc)  I_BX_(reg_pc, 0, 1, BX_JUMP_TYPE_ZERO)
+#define I_BXZI(imm_pc)  I_BX_(0, imm_pc, 0, BX_JUMP_TYPE_ZERO)
+#define I_BXFR(reg_pc)  I_BX_(reg_pc, 0, 1, BX_JUMP_TYPE_OVF)
+#define I_BXFI(imm_pc)  I_BX_(0, imm_pc, 0, BX_JUMP_TYPE_OVF)
+
+#define I_ALUR_(reg_dest, reg_src1, reg_src2, sel_) { .alu_reg = { \
+    .dreg = (uint32_t)(reg_dest), .sreg = (uint32_t)(reg_src1), .treg = (uint32_t)(reg_src2), \
+    .unused = 0, .sel = sel_, .sub_opcode = SUB_OPCODE_ALU_REG, .opcode = OPCODE_ALU } }
+
+#define I_ADDR(reg_dest, reg_src1, reg_src2) I_ALUR_(reg_dest, reg_src1, reg_src2, ALU_SEL_ADD)
+#define I_SUBR(reg_dest, reg_src1, reg_src2) I_ALUR_(reg_dest, reg_src1, reg_src2, ALU_SEL_SUB)
+#define I_ANDR(reg_dest, reg_src1, reg_src2) I_ALUR_(reg_dest, reg_src1, reg_src2, ALU_SEL_AND)
+#define I_ORR(reg_dest, reg_src1, reg_src2)  I_ALUR_(reg_dest, reg_src1, reg_src2, ALU_SEL_OR)
+#define I_MOVR(reg_dest, reg_src)            I_ALUR_(reg_dest, reg_src, 0, ALU_SEL_MOV)
+#define I_LSHR(reg_dest, reg_src, reg_shift) I_ALUR_(reg_dest, reg_src, reg_shift, ALU_SEL_LSH)
+#define I_RSHR(reg_dest, reg_src, reg_shift) I_ALUR_(reg_dest, reg_src, reg_shift, ALU_SEL_RSH)
+
+#define I_ALUI_(reg_dest, reg_src, imm_, sel_) { .alu_imm = { \
+    .dreg = (uint32_t)(reg_dest), .sreg = (uint32_t)(reg_src), .imm = (uint32_t)(imm_), \
+    .unused = 0, .sel = sel_, .sub_opcode = SUB_OPCODE_ALU_IMM, .opcode = OPCODE_ALU } }
+
+#define I_ADDI(reg_dest, reg_src, imm_) I_ALUI_(reg_dest, reg_src, imm_, ALU_SEL_ADD)
+#define I_SUBI(reg_dest, reg_src, imm_) I_ALUI_(reg_dest, reg_src, imm_, ALU_SEL_SUB)
+#define I_ANDI(reg_dest, reg_src, imm_) I_ALUI_(reg_dest, reg_src, imm_, ALU_SEL_AND)
+#define I_ORI(reg_dest, reg_src, imm_)  I_ALUI_(reg_dest, reg_src, imm_, ALU_SEL_OR)
+#define I_MOVI(reg_dest, imm_)          I_ALUI_(reg_dest, 0, imm_, ALU_SEL_MOV)
+#define I_LSHI(reg_dest, reg_src, imm_) I_ALUI_(reg_dest, reg_src, imm_, ALU_SEL_LSH)
+#define I_RSHI(reg_dest, reg_src, imm_) I_ALUI_(reg_dest, reg_src, imm_, ALU_SEL_RSH)
+
+#define M_LABEL(label_num) { .macro = { \
+    .label = (uint32_t)(label_num), .unused = 0, .sub_opcode = SUB_OPCODE_MACRO_LABEL, .opcode = OPCODE_MACRO } }
+
+#define M_BRANCH(label_num) { .macro = { \
+    .label = (uint32_t)(label_num), .unused = 0, .sub_opcode = SUB_OPCODE_MACRO_BRANCH, .opcode = OPCODE_MACRO } }
+
+#define M_MOVL(reg_dest, label_num) { .macro = { \
+    .label = (uint32_t)(label_num), .unused = 0, .sub_opcode = SUB_OPCODE_MACRO_LABELPC, .opcode = OPCODE_MACRO } }, \
+    I_MOVI(reg_dest, 0)
+
+#define M_BL(label_num, imm_value)  M_BRANCH(label_num), I_BL(0, imm_value)
+#define M_BGE(label_num, imm_value) M_BRANCH(label_num), I_BGE(0, imm_value)
+#define M_BX(label_num)             M_BRANCH(label_num), I_BXI(0)
+#define M_BXZ(label_num)            M_BRANCH(label_num), I_BXZI(0)
+#define M_BXF(label_num)            M_BRANCH(label_num), I_BXFI(0)
+
+// Wortadresse 0 des RTC-Slow-Memory (nur für Differenzen)
+uint32_t* hostRtcSlowMem();
+#define RTC_SLOW_MEM (hostRtcSlowMem())
+
+// Marken auflösen und ab Wort load_addr laden; *psize: Einträge in program
+esp_err_t ulp_process_macros_and_load(uint32_t load_addr, const ulp_insn_t* program, size_t* psize);
+// Einsprung setzen und den ULP-Timer starten; der erste Lauf folgt nach Periode 0
+esp_err_t ulp_run(uint32_t entry_point);
+esp_err_t ulp_set_wakeup_period(size_t period_index, uint32_t period_us);
@@ -0,0 +1,11 @@
+/**
+ * @file esp_attr.h
+ * @brief Host-Ersatz: RTC-Speicher als eigene Abschnitte, damit hostPowerOn() ihn leeren kann
+ */
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_IRAM_ATTR
+#define RTC_DATA_ATTR   __attribute__((section("host_rtc_data")))
+#define RTC_NOINIT_ATTR __attribute__((section("host_rtc_noinit")))
@@ -0,0 +1,14 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief Host-Ersatz: feste Heap-Werte (HOST_HEAP_* in host.h)
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
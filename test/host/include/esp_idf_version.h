@@ -0,0 +1,8 @@
+/**
+ * @file esp_idf_version.h
+ * @brief Host-Ersatz: verhält sich wie ESP-IDF 5.2
+ */
+#pragma once
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(5, 2, 0)
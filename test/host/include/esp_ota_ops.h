@@ -0,0 +1,12 @@
+/**
+ * @file esp_ota_ops.h
+ * @brief Host-Ersatz: laufende und nächste OTA-Partition (host_ota.cpp)
+ */
+#pragma once
+
+#include "esp_partition.h"
+
+const esp_partition_t* esp_ota_get_running_partition();
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* part);
+esp_err_t esp_ota_mark_app_valid_cancel_rollback();
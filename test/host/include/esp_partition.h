@@ -0,0 +1,22 @@
+/**
+ * @file esp_partition.h
+ * @brief Host-Ersatz: zwei App-Partitionen im Speicher (host_ota.cpp), Schreiben wie
+ *        beim Flash nur auf gelöschte Bits
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct {
+  uint32_t address;
+  uint32_t size;
+  char     label[17];
+} esp_partition_t;
+
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* part, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* part, size_t offset, size_t size);
+// SHA-256 des Images; auf dem Host über die bis zum höchsten geschriebenen Byte reichenden Daten
+esp_err_t esp_partition_get_sha256(const esp_partition_t* part, uint8_t* sha);
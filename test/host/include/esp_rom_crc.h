@@ -0,0 +1,12 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief Host-Ersatz: CRC-32 aus zlib (gleiches Polynom und Vorzeichen wie das ROM)
+ */
+#pragma once
+
+#include <stdint.h>
+#include <zlib.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+  return (uint32_t)crc32(crc, buf, len);
+}
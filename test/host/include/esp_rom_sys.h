@@ -0,0 +1,9 @@
+/**
+ * @file esp_rom_sys.h
+ * @brief Host-Ersatz: ROM-printf
+ */
+#pragma once
+
+#include <stdio.h>
+
+#define esp_rom_printf printf
@@ -0,0 +1,44 @@
+/**
+ * @file esp_sntp.h
+ * @brief Host-Ersatz: SNTP über echte UDP-Sockets an scripts/ntp_standin.py (test/host/host_sntp.cpp)
+ *
+ * Wie lwIP im Modus SNTP_SYNC_MODE_IMMED: die Antwort des ersten Servers setzt die
+ * Zeit über sntp_sync_time(), die clock_events.cpp ersetzt. Ohne Antwort geht die
+ * Anfrage nach 15 s an den nächsten Server.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <sys/time.h>
+#include "sdkconfig.h"
+#include "lwip/ip_addr.h"
+
+#define SNTP_MAX_SERVERS CONFIG_LWIP_SNTP_MAX_SERVERS
+
+typedef enum {
+  SNTP_SYNC_STATUS_RESET,
+  SNTP_SYNC_STATUS_COMPLETED,
+  SNTP_SYNC_STATUS_IN_PROGRESS,
+} sntp_sync_status_t;
+
+typedef enum {
+  ESP_SNTP_OPMODE_POLL,
+  ESP_SNTP_OPMODE_LISTENONLY,
+} esp_sntp_operatingmode_t;
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+extern "C" {
+void sntp_sync_time(struct timeval* tv);
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+void sntp_set_sync_status(sntp_sync_status_t status);
+sntp_sync_status_t sntp_get_sync_status();
+
+void esp_sntp_setoperatingmode(esp_sntp_operatingmode_t mode);
+void esp_sntp_setservername(uint8_t idx, const char* server);
+void esp_sntp_setserver(uint8_t idx, const ip_addr_t* addr);
+void esp_sntp_init();
+void esp_sntp_stop();
+bool esp_sntp_enabled();
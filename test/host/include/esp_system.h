@@ -0,0 +1,25 @@
+/**
+ * @file esp_system.h
+ * @brief Host-Ersatz: esp_restart() wirft HostRestart, der Test fängt ihn;
+ *        Reset-Grund aus hostPowerOn()/hostReset()
+ */
+#pragma once
+
+struct HostRestart {};
+
+typedef enum {
+  ESP_RST_UNKNOWN = 0,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+[[noreturn]] void esp_restart();
+esp_reset_reason_t esp_reset_reason();
@@ -0,0 +1,81 @@
+/**
+ * @file esp_wifi.h
+ * @brief Host-Ersatz: simuliertes WLAN (test/host/host_wifi.cpp)
+ *
+ * APs, Verbindungsdauer und Fehlschläge stellt der Test über host.h ein;
+ * Ereignisse (verbunden, getrennt) kommen zeitversetzt in vTaskDelay().
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum { WIFI_MODE_NULL = 0, WIFI_MODE_STA, WIFI_MODE_AP, WIFI_MODE_APSTA } wifi_mode_t;
+typedef enum { WIFI_IF_STA = 0, WIFI_IF_AP } wifi_interface_t;
+typedef enum { WIFI_PS_NONE = 0, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+typedef enum { WIFI_FAST_SCAN = 0, WIFI_ALL_CHANNEL_SCAN } wifi_scan_method_t;
+
+#define WIFI_PROTOCOL_11B 1
+#define WIFI_PROTOCOL_11G 2
+#define WIFI_PROTOCOL_11N 4
+
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;
+  int8_t  rssi;
+  uint32_t phy_11b : 1;
+  uint32_t phy_11g : 1;
+  uint32_t phy_11n : 1;
+} wifi_ap_record_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t password[64];
+  wifi_scan_method_t scan_method;
+  bool bssid_set;
+  uint8_t bssid[6];
+  uint8_t channel;
+} wifi_sta_config_t;
+
+typedef union {
+  wifi_sta_config_t sta;
+} wifi_config_t;
+
+typedef struct {
+  uint32_t min;
+  uint32_t max;
+} wifi_active_scan_time_t;
+
+typedef struct {
+  wifi_active_scan_time_t active;
+  uint32_t passive;
+} wifi_scan_time_t;
+
+typedef struct {
+  const uint8_t* ssid;
+  const uint8_t* bssid;
+  uint8_t channel;
+  bool show_hidden;
+  wifi_scan_time_t scan_time;
+} wifi_scan_config_t;
+
+typedef struct {
+  wifi_scan_time_t scan_time;
+  uint8_t home_chan_dwell_time;
+} wifi_scan_default_params_t;
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_start();
+esp_err_t esp_wifi_stop();
+esp_err_t esp_wifi_connect();
+esp_err_t esp_wifi_disconnect();
+esp_err_t esp_wifi_set_config(wifi_interface_t iface, wifi_config_t* conf);
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_set_max_tx_power(int8_t power);
+esp_err_t esp_wifi_set_protocol(wifi_interface_t iface, uint8_t protocols);
+esp_err_t esp_wifi_set_scan_parameters(const wifi_scan_default_params_t* params);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t* config, bool block);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* records);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* info);
+esp_err_t esp_wifi_get_mac(wifi_interface_t iface, uint8_t mac[6]);   // HOST_WIFI_MAC
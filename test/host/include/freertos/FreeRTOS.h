@@ -0,0 +1,29 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host-Ersatz: Ticks in Millisekunden, kritische Abschnitte über einen Mutex
+ */
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define pdTRUE  1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+// ein gemeinsamer rekursiver Mutex für alle portMUX (Tests mit Threads, TSan)
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void hostCriticalEnter();
+void hostCriticalExit();
+
+#define portENTER_CRITICAL(mux)     ((void)(mux), hostCriticalEnter())
+#define portEXIT_CRITICAL(mux)      ((void)(mux), hostCriticalExit())
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux), hostCriticalEnter())
+#define portEXIT_CRITICAL_ISR(mux)  ((void)(mux), hostCriticalExit())
@@ -0,0 +1,11 @@
+/**
+ * @file task.h
+ * @brief Host-Ersatz: vTaskDelay() rückt die virtuelle Uhr vor
+ */
+#pragma once
+
+#include "FreeRTOS.h"
+
+// lässt Zeitgeber und geplante WLAN-Ereignisse feuern; wartet SNTP auf eine
+// Antwort, läuft die Uhr solange mit der echten Zeit mit
+void vTaskDelay(TickType_t ticks);
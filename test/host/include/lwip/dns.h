@@ -0,0 +1,9 @@
+/**
+ * @file dns.h
+ * @brief Host-Ersatz: DNS-Server per DHCP ist immer 127.0.0.1 (DNS-Ersatz von ntp_standin.py)
+ */
+#pragma once
+
+#include "lwip/ip_addr.h"
+
+const ip_addr_t* dns_getserver(uint8_t numdns);
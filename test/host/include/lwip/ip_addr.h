@@ -0,0 +1,25 @@
+/**
+ * @file ip_addr.h
+ * @brief Host-Ersatz: nur IPv4
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_V6 6U
+
+typedef struct {
+  uint32_t addr;    // Netzwerk-Byte-Reihenfolge
+} ip4_addr_t;
+
+typedef struct {
+  union {
+    ip4_addr_t ip4;
+  } u_addr;
+  uint8_t type;
+} ip_addr_t;
+
+#define IP_IS_V4(ipaddr)              ((ipaddr)->type == IPADDR_TYPE_V4)
+#define ip_2_ip4(ipaddr)              (&((ipaddr)->u_addr.ip4))
+#define IP_SET_TYPE_VAL(ipaddr, iptype) ((ipaddr).type = (iptype))
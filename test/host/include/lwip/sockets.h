@@ -0,0 +1,19 @@
+/**
+ * @file sockets.h
+ * @brief Host-Ersatz: lwIP-Sockets sind auf dem Rechner die POSIX-Sockets
+ *
+ * select() geht an hostSocketSelect(): die echte Wartezeit rückt die virtuelle
+ * Uhr vor, wie beim Warten von SNTP. Fristen in lan_http.cpp laufen so ab.
+ */
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+int hostSocketSelect(int n, fd_set* r, fd_set* w, fd_set* e, struct timeval* tv);
+#define select hostSocketSelect
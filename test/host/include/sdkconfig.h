@@ -0,0 +1,10 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host-Ersatz: die Optionen, die der Uhr-Code abfragt (wie sdkconfig.defaults)
+ */
+#pragma once
+
+#define CONFIG_LWIP_SNTP_MAX_SERVERS 3
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_ULP_COPROC_ENABLED 1
+#define CONFIG_ULP_COPROC_RESERVE_MEM 768
@@ -0,0 +1,7 @@
+/**
+ * @file secrets.h
+ * @brief Zugänge der Host-Tests; die APs dazu legt der Test im simulierten WLAN an
+ */
+#pragma once
+
+#define SECRET_WIFI_LIST { {"Werkstatt", "test1"}, {"Zuhause", "test2"}, {"Gast", "test3"} }
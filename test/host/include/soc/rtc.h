@@ -0,0 +1,16 @@
+/**
+ * @file rtc.h
+ * @brief Host-Ersatz: RTC-Langsamtakt wie der interne 150-kHz-Oszillator
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define HOST_RTC_SLOW_HZ 150000
+
+inline uint32_t rtc_clk_slow_freq_get_hz() {
+  return HOST_RTC_SLOW_HZ;
+}
+
+// Kalibrierwert in RTC_SLOW_CLK_CAL_REG: µs je Takt als Festkomma mit so vielen Nachkommabits
+#define RTC_CLK_CAL_FRACT 19
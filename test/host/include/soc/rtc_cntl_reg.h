@@ -0,0 +1,20 @@
+/**
+ * @file rtc_cntl_reg.h
+ * @brief Host-Ersatz: die RTC_CNTL-Register, die ULP und Uhr-Code benutzen (Adressen wie ESP32)
+ */
+#pragma once
+
+#include "soc/soc.h"
+
+#define RTC_CNTL_TIME_UPDATE_REG (DR_REG_RTCCNTL_BASE + 0x0C)
+#define RTC_CNTL_TIME_UPDATE     BIT(31)
+#define RTC_CNTL_TIME_UPDATE_S   31
+#define RTC_CNTL_TIME_VALID      BIT(30)
+#define RTC_CNTL_TIME_VALID_S    30
+#define RTC_CNTL_TIME0_REG       (DR_REG_RTCCNTL_BASE + 0x10)
+#define RTC_CNTL_TIME1_REG       (DR_REG_RTCCNTL_BASE + 0x14)
+#define RTC_CNTL_STATE0_REG      (DR_REG_RTCCNTL_BASE + 0x18)
+#define RTC_CNTL_ULP_CP_SLP_TIMER_EN   BIT(24)
+#define RTC_CNTL_ULP_CP_SLP_TIMER_EN_S 24
+#define RTC_CNTL_STORE1_REG      (DR_REG_RTCCNTL_BASE + 0x50)
+#define RTC_SLOW_CLK_CAL_REG     RTC_CNTL_STORE1_REG
@@ -0,0 +1,18 @@
+/**
+ * @file rtc_io_reg.h
+ * @brief Host-Ersatz: RTC-GPIO-Register (Adressen und Feldlagen wie ESP32)
+ */
+#pragma once
+
+#include "soc/soc.h"
+
+#define RTC_GPIO_OUT_REG         (DR_REG_RTCIO_BASE + 0x00)
+#define RTC_GPIO_OUT_DATA_S      14
+#define RTC_GPIO_ENABLE_REG      (DR_REG_RTCIO_BASE + 0x0C)
+#define RTC_GPIO_ENABLE_S        14
+#define RTC_GPIO_ENABLE_W1TS_REG (DR_REG_RTCIO_BASE + 0x10)
+#define RTC_GPIO_ENABLE_W1TS_S   14
+#define RTC_GPIO_ENABLE_W1TC_REG (DR_REG_RTCIO_BASE + 0x14)
+#define RTC_GPIO_ENABLE_W1TC_S   14
+#define RTC_GPIO_IN_REG          (DR_REG_RTCIO_BASE + 0x24)
+#define RTC_GPIO_IN_NEXT_S       14
@@ -0,0 +1,25 @@
+/**
+ * @file soc.h
+ * @brief Host-Ersatz: Basisadressen der RTC-Peripherie und Registerzugriff über
+ *        das Registermodell in host_ulp.cpp
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef BIT
+#define BIT(n) (1UL << (n))
+#endif
+
+#define DR_REG_RTCCNTL_BASE 0x3ff48000
+#define DR_REG_RTCIO_BASE   0x3ff48400
+#define DR_REG_SENS_BASE    0x3ff48800
+#define DR_REG_RTC_I2C_BASE 0x3ff48C00
+
+uint32_t hostRegRead(uint32_t reg);
+void hostRegWrite(uint32_t reg, uint32_t value);
+
+#define REG_READ(reg)                 hostRegRead(reg)
+#define REG_WRITE(reg, value)         hostRegWrite((reg), (value))
+#define SET_PERI_REG_MASK(reg, mask)   hostRegWrite((reg), hostRegRead(reg) | (mask))
+#define CLEAR_PERI_REG_MASK(reg, mask) hostRegWrite((reg), hostRegRead(reg) & ~(uint32_t)(mask))
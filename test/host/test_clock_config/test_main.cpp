@@ -0,0 +1,197 @@
+/**
+ * @file test_main.cpp
+ * @brief Bedingter Abruf des Zeitplans (clock_config.cpp) gegen scripts/config_standin.py
+ *
+ * Das Skript liefert eine Datei aus dem Testverzeichnis mit einem ETag aus ihrem
+ * Inhalt und liest sie bei jeder Anfrage neu; der Test schreibt sie zwischen
+ * den Abrufen um. Jeder Abruf läuft wie im Sync-Fenster mit gestartetem
+ * Radio-Budget, das Ergebnis steht im TELE_CONFIG-Eintrag. Der gespeicherte
+ * Zeitplan wird als NVS-Blob ("clockcfg"/"plan") Byte für Byte verglichen.
+ */
+#include <stdlib.h>
+#include <unistd.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "clock_config.h"
+#include "clock_core.h"
+#include "host.h"
+#include "nvs.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+
+static std::string dir, file;
+
+static const char* const docDefault = "# Vorgabe\nsleep_start=22\nsleep_end=6\nsync_hour=4\nsync_min=30\n";
+static const char* const docLate = "sleep_start=23\r\nsleep_end=7\r\nsync_hour=5\r\nsync_min=15\r\n";
+
+static bool writeDoc(const char* doc) {
+  FILE* f = fopen(file.c_str(), "wb");
+  if (!f) return false;
+  fputs(doc, f);
+  return fclose(f) == 0;
+}
+
+// doc als Datei von config_standin.py ausliefern; false ohne python3
+static bool serve(const char* doc, const char* args) {
+  TEST_ASSERT_TRUE(writeDoc(doc));
+  return hostConfigServerStart(file.c_str(), args);
+}
+
+// ein Abruf im Sync-Fenster; Flags des TELE_CONFIG-Eintrags
+static uint8_t fetch(bool* stored = nullptr) {
+  radioGuardStart();
+  const bool s = clockConfigFetch();
+  radioGuardStop();
+  if (stored) *stored = s;
+  TelemetryRecord r;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_CONFIG, &r));
+  return r.flags;
+}
+
+// gespeicherter Blob, leer ohne Eintrag
+static std::vector<uint8_t> storedBlob() {
+  std::vector<uint8_t> b(256);
+  nvs_handle_t h;
+  if (nvs_open("clockcfg", NVS_READONLY, &h) != ESP_OK) return {};
+  size_t len = b.size();
+  if (nvs_get_blob(h, "plan", b.data(), &len) != ESP_OK) len = 0;
+  nvs_close(h);
+  b.resize(len);
+  return b;
+}
+
+static void assertSchedule(uint8_t start, uint8_t end, uint8_t hour, uint8_t min) {
+  TEST_ASSERT_EQUAL_UINT8(start, clockSchedule.sleepStart);
+  TEST_ASSERT_EQUAL_UINT8(end, clockSchedule.sleepEnd);
+  TEST_ASSERT_EQUAL_UINT8(hour, clockSchedule.syncHour);
+  TEST_ASSERT_EQUAL_UINT8(min, clockSchedule.syncMin);
+}
+
+// Einschalten: RTC-Kopie weg, Zeitplan aus dem NVS oder Vorgabe
+static void powerOn() {
+  hostPowerOn();
+  telemetryInit();
+  radioGuardInit();
+  clockConfigTick();   // Rest aus dem vorigen Test verwerfen
+  clockSchedule = ClockSchedule();
+  clockConfigInit();
+}
+
+void setUp() {
+  hostEraseNvs();
+  powerOn();
+}
+
+void tearDown() {
+  hostConfigServerStop();
+}
+
+// 200 speichert Zeitplan und ETag, wirksam erst mit clockConfigTick(); danach 304,
+// auch nach dem Einschalten mit dem ETag aus dem NVS
+void test_config_stored_then_not_modified() {
+  HOST_REQUIRE_SCRIPT(serve(docLate, ""), "config_standin.py");
+  bool stored = false;
+  TEST_ASSERT_EQUAL_UINT8(2, fetch(&stored));
+  TEST_ASSERT_TRUE(stored);
+  TEST_ASSERT_FALSE(storedBlob().empty());
+  assertSchedule(22, 6, 4, 30);   // noch nicht übernommen
+  clockConfigTick();
+  assertSchedule(23, 7, 5, 15);
+  clockSchedule.syncMin = 0;
+  clockConfigTick();              // nichts mehr ausstehend
+  TEST_ASSERT_EQUAL_UINT8(0, clockSchedule.syncMin);
+  clockSchedule.syncMin = 15;
+
+  TEST_ASSERT_EQUAL_UINT8(1, fetch(&stored));
+  TEST_ASSERT_FALSE(stored);
+
+  powerOn();
+  assertSchedule(23, 7, 5, 15);
+  TEST_ASSERT_EQUAL_UINT8(1, fetch());
+}
+
+// geänderte Datei: neues ETag, 200 mit dem neuen Zeitplan, danach wieder 304
+void test_config_new_etag() {
+  HOST_REQUIRE_SCRIPT(serve(docDefault, ""), "config_standin.py");
+  TEST_ASSERT_EQUAL_UINT8(2, fetch());
+  clockConfigTick();
+  const std::vector<uint8_t> first = storedBlob();
+
+  TEST_ASSERT_TRUE(writeDoc(docLate));
+  TEST_ASSERT_EQUAL_UINT8(2, fetch());
+  TEST_ASSERT_TRUE(first != storedBlob());
+  clockConfigTick();
+  assertSchedule(23, 7, 5, 15);
+  TEST_ASSERT_EQUAL_UINT8(1, fetch());
+}
+
+// ungültige Dokumente: verworfen, Blob und Zeitplan bleiben, nichts ausstehend
+void test_config_invalid_rejected() {
+  HOST_REQUIRE_SCRIPT(serve(docLate, ""), "config_standin.py");
+  TEST_ASSERT_EQUAL_UINT8(2, fetch());
+  clockConfigTick();
+  const std::vector<uint8_t> before = storedBlob();
+
+  static const char* const bad[] = {
+    "sleep_start=6\nsleep_end=22\n",     // Nacht nicht über Mitternacht
+    "sync_hour=24\n",                    // außerhalb des Bereichs
+    "sync_min=60\n",
+    "sleep_start=22\nsleep_end\n",       // ohne '='
+    "wake=7\n",                          // unbekannter Schlüssel
+    "sync_min=-5\n",                     // keine Zahl
+    "sync_min=123\n",                    // mehr als zwei Stellen
+    "sync_hour=\n",                      // Wert fehlt
+  };
+  for (const char* doc : bad) {
+    TEST_ASSERT_TRUE(writeDoc(doc));
+    bool stored = true;
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(4, fetch(&stored), doc);
+    TEST_ASSERT_FALSE(stored);
+    TEST_ASSERT_TRUE_MESSAGE(before == storedBlob(), doc);
+    clockConfigTick();
+    assertSchedule(23, 7, 5, 15);
+  }
+}
+
+// Rumpf kürzer als Content-Length: verworfen, obwohl der Anfang gültig ist
+void test_config_truncated_body_rejected() {
+  HOST_REQUIRE_SCRIPT(serve(docDefault, ""), "config_standin.py");
+  TEST_ASSERT_EQUAL_UINT8(2, fetch());
+  clockConfigTick();
+  const std::vector<uint8_t> before = storedBlob();
+  hostConfigServerStop();
+
+  // "sleep_start=23\r\nsleep_end=7\r\n" allein wäre gültig
+  HOST_REQUIRE_SCRIPT(serve(docLate, "--truncate 29"), "config_standin.py");
+  TEST_ASSERT_EQUAL_UINT8(4, fetch());
+  TEST_ASSERT_TRUE(before == storedBlob());
+  clockConfigTick();
+  assertSchedule(22, 6, 4, 30);
+}
+
+// ohne Server: nicht erreichbar, Zeitplan bleibt
+void test_config_unreachable() {
+  bool stored = true;
+  TEST_ASSERT_EQUAL_UINT8(8, fetch(&stored));
+  TEST_ASSERT_FALSE(stored);
+  TEST_ASSERT_TRUE(storedBlob().empty());
+  assertSchedule(22, 6, 4, 30);
+}
+
+int main() {
+  char tmpl[] = "/tmp/clock_config_XXXXXX";
+  if (!mkdtemp(tmpl)) return 1;
+  dir = tmpl;
+  file = dir + "/clock.cfg";
+  UNITY_BEGIN();
+  RUN_TEST(test_config_stored_then_not_modified);
+  RUN_TEST(test_config_new_etag);
+  RUN_TEST(test_config_invalid_rejected);
+  RUN_TEST(test_config_truncated_body_rejected);
+  RUN_TEST(test_config_unreachable);
+  const int rc = UNITY_END();
+  remove(file.c_str());
+  rmdir(dir.c_str());
+  return rc;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file test_main.cpp
+ * @brief Beschnittener Scan (panelCrop, -DCLOCK_MUX_CROP) auf dem SH1106-Modell
+ *
+ * Mit Multiplex-Ratio 48, Offset 56 und Startzeile 8 werden nur die Seiten
+ * CLOCK_FACE_PAGE0..+CLOCK_FACE_PAGES−1 (1..6) gescannt und übertragen. Jede
+ * Minute des Tages muss dabei in jedem Zifferblatt genau so auf dem Glas
+ * stehen wie ohne Beschnitt, in beiden Drehungen (Flip im Controller und
+ * U8G2_R2). COM 0..7 und 56..63 bleiben dunkel.
+ */
+#include <string.h>
+#include <unity.h>
+#include "clock_core.h"
+#include "host.h"
+#include "panel.h"
+
+static u8g2_t oled;
+
+static uint16_t litRows(const HostGlass& g, int com0, int com1) {
+  uint16_t n = 0;
+  for (int i = com0 * HOST_SH1106_COLUMNS; i < com1 * HOST_SH1106_COLUMNS; ++i) n += g[i];
+  return n;
+}
+
+static void assertCropped() {
+  const HostSh1106Scan s = hostSh1106Scan();
+  TEST_ASSERT_EQUAL_UINT8(CLOCK_FACE_PAGES * 8 - 1, s.mux);
+  TEST_ASSERT_EQUAL_UINT8(64 - CLOCK_FACE_PAGE0 * 8, s.offset);
+  TEST_ASSERT_EQUAL_UINT8(CLOCK_FACE_PAGE0 * 8, s.startLine);
+}
+
+static void assertFullScan() {
+  const HostSh1106Scan s = hostSh1106Scan();
+  TEST_ASSERT_EQUAL_UINT8(63, s.mux);
+  TEST_ASSERT_EQUAL_UINT8(0, s.offset);
+  TEST_ASSERT_EQUAL_UINT8(0, s.startLine);
+}
+
+// alle Minuten eines Tages in allen Zifferblättern: einmal ganz gesendet und
+// voll gescannt, einmal nur die Seiten des Zifferblatts in ein leeres RAM und beschnitten
+static void checkDay(const u8g2_cb_t* rotation, uint8_t flip) {
+  const int com0 = CLOCK_FACE_PAGE0 * 8, com1 = com0 + CLOCK_FACE_PAGES * 8;
+  for (int minute = 0; minute < 24 * 60; ++minute) {
+    struct tm t = {};
+    t.tm_hour = minute / 60;
+    t.tm_min = minute % 60;
+    for (uint8_t f = 0; f < FACE_COUNT; ++f) {
+      hostSh1106Display(&oled, rotation, flip);
+      composeFace(&oled, &t, (ClockFace)f);
+      u8g2_SendBuffer(&oled);
+      const HostGlass full = hostSh1106Glass();
+
+      hostSh1106Display(&oled, rotation, flip);
+      panelCrop(&oled, true);
+      composeFace(&oled, &t, (ClockFace)f);
+      u8g2_UpdateDisplayArea(&oled, 0, CLOCK_FACE_PAGE0, u8g2_GetBufferTileWidth(&oled), CLOCK_FACE_PAGES);
+      assertCropped();
+      const HostGlass cropped = hostSh1106Glass();
+
+      char msg[48];
+      snprintf(msg, sizeof(msg), "%02d:%02d Zifferblatt %d", t.tm_hour, t.tm_min, f);
+      TEST_ASSERT_GREATER_THAN_MESSAGE(0, litRows(full, com0, com1), msg);
+      TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, litRows(full, 0, com0) + litRows(full, com1, 64), msg);
+      TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, litRows(cropped, 0, com0) + litRows(cropped, com1, 64), msg);
+      TEST_ASSERT_TRUE_MESSAGE(full == cropped, msg);
+    }
+  }
+}
+
+void setUp() {
+  hostPowerOn();
+}
+
+void tearDown() {
+}
+
+void test_crop_matches_full_scan_flip() {
+  checkDay(U8G2_R0, 1);
+}
+
+void test_crop_matches_full_scan_r2() {
+  checkDay(U8G2_R2, 0);
+}
+
+// Statusmeldung nach dem Beschnitt: wieder alle 64 Zeilen, die Statuszeile
+// (Grundlinie 60) steht auf dem Glas; der zweite Aufruf sendet nichts mehr
+void test_crop_undone_for_status() {
+  hostSh1106Display(&oled, U8G2_R0, 1);
+  panelCrop(&oled, true);
+  assertCropped();
+  renderStatus(&oled, "NTP-Sync");
+  assertFullScan();
+  TEST_ASSERT_GREATER_THAN(0, litRows(hostSh1106Glass(), 56, 62));
+
+  const uint32_t commands = hostSh1106Commands();
+  panelCrop(&oled, false);
+  TEST_ASSERT_EQUAL_UINT32(commands, hostSh1106Commands());
+  assertFullScan();
+}
+
+// Wecken aus dem Tiefschlaf (Wake-Stub, ULP): das Display wird nicht neu
+// initialisiert und panelReset() nicht aufgerufen, der Beschnitt steht noch im
+// Controller. Der Zustand dazu liegt im RTC-Speicher: nach dem Einschalten
+// (RTC leer, Controller frisch) wird der Beschnitt neu gesendet, nach dem
+// Wecken die Statusmeldung wieder voll gescannt.
+void test_crop_state_in_rtc_memory() {
+  hostSh1106Display(&oled, U8G2_R0, 1);
+  panelCrop(&oled, true);
+
+  hostReset();   // RTC-Speicher bleibt, Controller läuft weiter
+  renderStatus(&oled, "Sync fehlgeschlagen");
+  assertFullScan();
+  panelCrop(&oled, true);
+  assertCropped();
+
+  hostPowerOn();
+  hostSh1106Reset();
+  u8g2_InitDisplay(&oled);
+  u8g2_SetFlipMode(&oled, 1);
+  u8g2_SetPowerSave(&oled, 0);
+  panelCrop(&oled, true);
+  assertCropped();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crop_matches_full_scan_flip);
+  RUN_TEST(test_crop_matches_full_scan_r2);
+  RUN_TEST(test_crop_undone_for_status);
+  RUN_TEST(test_crop_state_in_rtc_memory);
+  return UNITY_END();
+}
@@ -0,0 +1,221 @@
+/**
+ * @file test_main.cpp
+ * @brief Delta-Update (delta_ota.cpp) über mehrere Sync-Fenster gegen scripts/delta_ota.py serve
+ *
+ * Altes und neues Image sind Zufallsdaten (keine ESP-Images, also SHA-256 der
+ * ganzen Datei), das Delta erzeugt delta_ota.py make. Die Partitionen liegen im
+ * Speicher (host_ota.cpp); die Antworten kommen über TCP vom Skript, gedrosselt
+ * mit --rate oder mit --drop abgebrochen.
+ *
+ * Das Zeitbudget eines Schritts ist der Rest des Radio-Budgets: der Test startet
+ * radioGuardStart() und rückt die virtuelle Uhr bis STEP_MS (plus
+ * DELTA_OTA_RESERVE_MS) vor dem Ende vor. Solange lan_http.cpp in select()
+ * wartet, läuft die virtuelle Uhr mit der echten mit, die Frist ist also echte
+ * Zeit.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "delta_ota.h"
+#include "host.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+
+#define OLD_SIZE (160 * 1024)
+#define STEP_MS  1200   // Zeitbudget je Sync-Fenster
+
+static std::string dir;
+static std::vector<uint8_t> oldImage, newImage;
+
+static uint32_t rnd = 1;
+
+static uint8_t nextByte() {
+  rnd = rnd * 1103515245u + 12345u;
+  return (uint8_t)(rnd >> 16);
+}
+
+static bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  const bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+  return fclose(f) == 0 && ok;
+}
+
+// neues Image: je 32-KB-Block 3 KB neue Bytes, ein paar einzelne Änderungen und
+// 100 eingefügte Byte, die alles Folgende verschieben; Delta etwa 20 KB
+static void makeImages() {
+  rnd = 1;
+  oldImage.resize(OLD_SIZE);
+  for (uint8_t& b : oldImage) b = nextByte();
+  newImage = oldImage;
+  for (size_t at = 5000; at + 3072 < newImage.size(); at += 32768) {
+    for (size_t k = 0; k < 3072; ++k) newImage[at + k] = nextByte();
+  }
+  for (size_t at = 20000; at < newImage.size(); at += 7001) newImage[at] ^= 0x5A;
+  std::vector<uint8_t> inserted(100);
+  for (uint8_t& b : inserted) b = nextByte();
+  newImage.insert(newImage.begin() + 70000, inserted.begin(), inserted.end());
+}
+
+// old.bin, new.bin und delta.bin (Blöcke zu 32 KB) in dir; false ohne python3
+static bool makeDelta(const std::vector<uint8_t>& from, const std::vector<uint8_t>& to) {
+  if (!writeFile(dir + "/old.bin", from) || !writeFile(dir + "/new.bin", to)) return false;
+  std::string args = "make " + dir + "/old.bin " + dir + "/new.bin " + dir + "/delta.bin";
+  FILE* f = hostScriptOpen("delta_ota.py", args.c_str());
+  if (!f) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+  }
+  return hostScriptClose(f) == 0;
+}
+
+// Delta von oldImage zu newImage erzeugen und ausliefern; false ohne python3
+static bool serve(const char* args) {
+  return makeDelta(oldImage, newImage) && hostDeltaServerStart(dir.c_str(), args);
+}
+
+struct Step {
+  bool done;
+  uint8_t flags;
+  uint16_t next, count;
+};
+
+// ein Sync-Fenster: Radio an, Budget bis auf STEP_MS verbraucht, deltaOtaStep(), Neustart
+static Step step() {
+  radioGuardStart();
+  hostAdvanceMs(RADIO_ON_BUDGET_MS - DELTA_OTA_RESERVE_MS - STEP_MS);
+  Step s = {};
+  s.done = deltaOtaStep();
+  radioGuardStop();
+  TelemetryRecord r;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_OTA, &r));
+  s.flags = r.flags;
+  s.next = r.v[2];
+  s.count = r.v[3];
+  hostReset();   // bis zum nächsten Fenster: Fortschritt nur aus dem NVS
+  return s;
+}
+
+// höchstens maxSteps Fenster bis zum fertigen Update; Anzahl der Fenster
+static int runUntilDone(int maxSteps, int* resumed) {
+  *resumed = 0;
+  for (int i = 1; i <= maxSteps; ++i) {
+    Step s = step();
+    TEST_ASSERT_FALSE_MESSAGE(s.flags & 16, "Update verworfen");
+    if (s.done) return i;
+    if (s.flags & 32) ++*resumed;
+  }
+  return 0;
+}
+
+static void assertTargetIsNewImage() {
+  size_t len = 0;
+  const uint8_t* img = hostOtaImage(true, &len);
+  TEST_ASSERT_EQUAL_UINT32(newImage.size(), len);
+  TEST_ASSERT_EQUAL_MEMORY(newImage.data(), img, len);
+  TEST_ASSERT_EQUAL_STRING("app1", hostOtaBootLabel());
+}
+
+void setUp() {
+  hostEraseNvs();
+  hostPowerOn();
+  telemetryInit();
+  radioGuardInit();
+  if (oldImage.empty()) makeImages();
+  hostOtaReset(oldImage.data(), oldImage.size());
+}
+
+void tearDown() {
+  hostDeltaServerStop();
+}
+
+// gedrosselt auf 8 KB/s: etwa ein Block je Fenster, Fortsetzung nach dem Neustart,
+// Ziel gleich neu.bin; im neuen Image wird nichts mehr geladen, ein Delta dazu aber angenommen
+void test_delta_resumes_over_throttled_link() {
+  HOST_REQUIRE_SCRIPT(serve("--rate 8000"), "delta_ota.py");
+  int resumed = 0;
+  const int steps = runUntilDone(10, &resumed);
+  TEST_ASSERT_GREATER_THAN(0, steps);
+  TEST_ASSERT_GREATER_THAN(1, steps);   // passt nicht in ein Fenster
+  TEST_ASSERT_GREATER_THAN(0, resumed);
+  assertTargetIsNewImage();
+
+  hostOtaBoot();
+  const uint32_t erases = hostOtaErases();
+  Step s = step();
+  TEST_ASSERT_FALSE(s.done);
+  TEST_ASSERT_EQUAL_UINT8(1, s.flags);   // 304, neues Image läuft
+  TEST_ASSERT_EQUAL_UINT32(erases, hostOtaErases());
+  TEST_ASSERT_NULL(hostOtaBootLabel());
+
+  // nächstes Update: Quelle ist jetzt das neue Image in app1
+  std::vector<uint8_t> next = newImage;
+  next[4321] ^= 0xFF;
+  TEST_ASSERT_TRUE(makeDelta(newImage, next));
+  s = step();
+  TEST_ASSERT_EQUAL_UINT8(2, s.flags & 18);
+}
+
+// 40 % der Antworten brechen mittendrin ab: abgebrochene Blöcke werden wiederholt,
+// das Ergebnis stimmt trotzdem
+void test_delta_survives_dropped_connections() {
+  HOST_REQUIRE_SCRIPT(serve("--rate 200000 --drop 0.4"), "delta_ota.py");
+  int resumed = 0;
+  TEST_ASSERT_GREATER_THAN(0, runUntilDone(30, &resumed));
+  assertTargetIsNewImage();
+}
+
+// Delta zu einem anderen Quell-Image: verworfen, ohne die Zielpartition anzufassen;
+// danach nur noch 304
+void test_delta_for_other_image_rejected() {
+  std::vector<uint8_t> other = oldImage;
+  other[100] ^= 1;
+  HOST_REQUIRE_SCRIPT(makeDelta(other, newImage) && hostDeltaServerStart(dir.c_str(), ""), "delta_ota.py");
+  Step s = step();
+  TEST_ASSERT_FALSE(s.done);
+  TEST_ASSERT_EQUAL_UINT8(16, s.flags);
+  TEST_ASSERT_EQUAL_UINT32(0, hostOtaErases());
+
+  s = step();
+  TEST_ASSERT_EQUAL_UINT8(1, s.flags);
+  TEST_ASSERT_EQUAL_UINT32(0, hostOtaErases());
+  TEST_ASSERT_NULL(hostOtaBootLabel());
+}
+
+// neues Delta mitten im Update: der Kopf wird neu übernommen und das Update
+// beginnt von vorn, am Ende steht das Image des neuen Deltas
+void test_delta_replaced_mid_update() {
+  HOST_REQUIRE_SCRIPT(serve("--rate 8000"), "delta_ota.py");
+  Step s = step();
+  TEST_ASSERT_EQUAL_UINT8(2, s.flags & 2);
+  TEST_ASSERT_FALSE(s.done);
+
+  newImage[1234] ^= 0xFF;
+  TEST_ASSERT_TRUE(makeDelta(oldImage, newImage));
+  s = step();
+  TEST_ASSERT_EQUAL_UINT8(2, s.flags & 2);   // neuer Kopf statt 304
+
+  int resumed = 0;
+  TEST_ASSERT_GREATER_THAN(0, runUntilDone(10, &resumed));
+  assertTargetIsNewImage();
+  makeImages();
+}
+
+int main() {
+  char tmpl[] = "/tmp/delta_ota_XXXXXX";
+  if (!mkdtemp(tmpl)) return 1;
+  dir = tmpl;
+  UNITY_BEGIN();
+  RUN_TEST(test_delta_resumes_over_throttled_link);
+  RUN_TEST(test_delta_survives_dropped_connections);
+  RUN_TEST(test_delta_for_other_image_rejected);
+  RUN_TEST(test_delta_replaced_mid_update);
+  const int rc = UNITY_END();
+  for (const char* f : {"/old.bin", "/new.bin", "/delta.bin"}) remove((dir + f).c_str());
+  rmdir(dir.c_str());
+  return rc;
+}
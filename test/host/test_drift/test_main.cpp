@@ -0,0 +1,153 @@
+/**
+ * @file test_main.cpp
+ * @brief Verläufe aus scripts/drift_sim.py durch clock_drift.cpp: gleiche Abweichung wie das Python-Modell
+ *
+ * drift_sim.py --trace liefert je Minute Sensorwert und wahren Gang. Der Test
+ * lässt die Systemzeit mit diesem Gang laufen (hostSetDriftPpm), ruft jede
+ * Minute driftTick() und im Sync-Abstand sntp_sync_time() mit der wahren Zeit,
+ * wie SNTP es täte. Gemessen wird wie im Skript die größte Abweichung vor einem
+ * Sync nach der Einlaufzeit.
+ *
+ * Unterschiede zum Skript: float statt double, adjtime() in ganzen µs, Δt aus
+ * time() in ganzen Sekunden, und clock_drift.cpp wertet erst ab dem ersten Sync
+ * aus (deshalb hier ein Sync beim Start). Toleranz: 5 % oder 1 ms.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <unity.h>
+#include <vector>
+#include "clock_drift.h"
+#include "esp_sntp.h"
+#include "host.h"
+#include "telemetry.h"
+
+#define TRACE_START 1760000000   // wahre Zeit beim Start, nach 2024 (driftSynced)
+
+struct Trace {
+  uint32_t intervalMin, warmupMin;
+  double worstNone, worstMean, worstTemp;   // ms, aus dem Skript
+  std::vector<float> sensor;
+  std::vector<double> ppm;
+};
+
+static bool loadTrace(const char* args, Trace* t) {
+  char cmd[160];
+  snprintf(cmd, sizeof(cmd), "--trace - %s", args);
+  FILE* f = hostScriptOpen("drift_sim.py", cmd);
+  if (!f) return false;
+  bool ok = fscanf(f, "# %u %u %lf %lf %lf", &t->intervalMin, &t->warmupMin, &t->worstNone, &t->worstMean,
+                   &t->worstTemp) == 5;
+  float s;
+  double p;
+  while (ok && fscanf(f, "%f %lf", &s, &p) == 2) {
+    t->sensor.push_back(s);
+    t->ppm.push_back(p);
+  }
+  return hostScriptClose(f) == 0 && ok && !t->sensor.empty();
+}
+
+static float sensorNow = NAN;
+
+static float readSensor() {
+  return sensorNow;
+}
+
+// wahre Zeit: Start plus Monotonuhr
+static int64_t trueUs(int64_t startUs) {
+  return (int64_t)TRACE_START * 1000000 + hostNowUs() - startUs;
+}
+
+static void syncNow(int64_t startUs) {
+  const int64_t us = trueUs(startUs);
+  struct timeval tv = {(time_t)(us / 1000000), (suseconds_t)(us % 1000000)};
+  sntp_sync_time(&tv);
+}
+
+// Verlauf abspielen; größte Abweichung vor einem Sync in ms
+static double replay(const Trace& t, bool withSensor) {
+  hostPowerOn();
+  telemetryInit();
+  driftInit(withSensor ? readSensor : hostNoTemp);
+  const int64_t startUs = hostNowUs();
+  syncNow(startUs);
+
+  double worst = 0;
+  uint32_t sinceSync = 0;
+  for (size_t m = 0; m < t.sensor.size(); ++m) {
+    hostSetDriftPpm(t.ppm[m]);
+    hostAdvanceMs(60 * 1000);
+    sensorNow = t.sensor[m];
+    driftTick(time(nullptr));
+    if (++sinceSync >= t.intervalMin) {
+      const double errMs = (hostWallClock() * 1e6 - trueUs(startUs)) / 1000;
+      if (m >= t.warmupMin) worst = fmax(worst, fabs(errMs));
+      syncNow(startUs);
+      sinceSync = 0;
+    }
+  }
+  return worst;
+}
+
+static void checkInterval(const char* args) {
+  Trace t;
+  HOST_REQUIRE_SCRIPT(loadTrace(args, &t), "drift_sim.py");
+
+  const double mean = replay(t, false);
+  const double temp = replay(t, true);
+  printf("Abstand %u min: ohne %.1f ms, Mittelwert %.1f (Skript %.1f), Temperatur %.1f (Skript %.1f)\n",
+         t.intervalMin, t.worstNone, mean, t.worstMean, temp, t.worstTemp);
+  TEST_ASSERT_DOUBLE_WITHIN(fmax(1.0, t.worstMean * 0.05), t.worstMean, mean);
+  TEST_ASSERT_DOUBLE_WITHIN(fmax(1.0, t.worstTemp * 0.05), t.worstTemp, temp);
+  TEST_ASSERT_TRUE(temp < mean);
+  TEST_ASSERT_TRUE(mean < t.worstNone);
+}
+
+// Hauptschleife ohne Stromsparen: driftTick() jede Sekunde. Ein Gang von 0,3 ppm
+// gäbe je Aufruf nur 0,3 µs; wirksam wird er trotzdem, und zwar minütlich
+void test_drift_small_ppm_ticked_every_second() {
+  hostPowerOn();
+  telemetryInit();
+  driftInit(hostNoTemp);
+  const int64_t startUs = hostNowUs();
+  hostSetDriftPpm(0.3);
+  syncNow(startUs);
+  for (int s = 0; s < 2 * 3600; ++s) {
+    hostAdvanceMs(1000);
+    driftTick(time(nullptr));
+  }
+  syncNow(startUs);   // Stichprobe: 0,3 ppm
+
+  for (int s = 0; s < 2 * 3600; ++s) {
+    hostAdvanceMs(1000);
+    driftTick(time(nullptr));
+  }
+  const double errUs = hostWallClock() * 1e6 - trueUs(startUs);
+  TEST_ASSERT_DOUBLE_WITHIN(100, 0, errUs);   // ohne Korrektur 2160 µs
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_drift_daily_sync() {
+  checkInterval("--days 40 --interval 1");
+}
+
+void test_drift_four_day_sync() {
+  checkInterval("--days 40 --interval 4");
+}
+
+// RC-Oszillator: linearer Gang über der Temperatur, ohne Parabel
+void test_drift_linear_slope() {
+  checkInterval("--days 40 --interval 2 --base 30 --slope 1.5 --curve 0");
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_drift_daily_sync);
+  RUN_TEST(test_drift_four_day_sync);
+  RUN_TEST(test_drift_linear_slope);
+  RUN_TEST(test_drift_small_ppm_ticked_every_second);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+/**
+ * @file test_main.cpp
+ * @brief EventRing unter Last: ein Erzeuger-Thread, ein Verbraucher, 2 Mio. Ereignisse
+ *
+ * Läuft in [env:native] und mit ThreadSanitizer in [env:native_tsan]; dort
+ * meldet TSan jeden Zugriff auf buf_, der nicht über Acquire/Release der
+ * Indizes geordnet ist.
+ */
+#include <sys/time.h>
+#include <thread>
+#include <unity.h>
+#include "clock_drift.h"
+#include "clock_events.h"
+#include "esp_sntp.h"
+#include "event_ring.h"
+#include "host.h"
+
+#define STRESS_EVENTS 2000000u
+
+#ifdef __SANITIZE_THREAD__
+// erste Meldung von TSan bricht den Test ab, statt nur am Ende den Exit-Code zu setzen
+extern "C" const char* __tsan_default_options() {
+  return "halt_on_error=1";
+}
+#endif
+
+// Prüfsumme über alle Felder, erkennt halb kopierte Einträge
+static uint16_t check(const ClockEvent& ev) {
+  return (uint16_t)(ev.time * 40503u >> 16) ^ ev.arg;
+}
+
+static ClockEvent make(uint32_t seq) {
+  ClockEvent ev = {};
+  ev.type = EVT_TIME_SYNCED;
+  ev.arg = (uint8_t)(seq * 7);
+  ev.time = seq;
+  ev.data = check(ev);
+  return ev;
+}
+
+void setUp() {
+  hostPowerOn();
+}
+
+void tearDown() {}
+
+// Erzeuger wiederholt bei vollem Ring: alles kommt an, in Reihenfolge, unversehrt
+void test_ring_lossless_in_order() {
+  static EventRing<ClockEvent, 16> ring;
+  uint32_t retries = 0;
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < STRESS_EVENTS; ++i) {
+      const ClockEvent ev = make(i);
+      while (!ring.push(ev)) {
+        ++retries;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t next = 0, bad = 0;
+  ClockEvent ev;
+  while (next < STRESS_EVENTS) {
+    if (!ring.pop(ev)) {
+      std::this_thread::yield();   // auch mit nur einem Kern vorankommen
+      continue;
+    }
+    if (ev.time != next || ev.data != check(ev)) ++bad;
+    next = ev.time + 1;
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, bad);
+  TEST_ASSERT_FALSE(ring.pop(ev));
+  TEST_ASSERT_EQUAL_UINT32(retries, ring.dropped());
+}
+
+// Erzeuger wie eine ISR: bei vollem Ring verwerfen; Reihenfolge bleibt, nichts doppelt,
+// angekommen + verworfen = erzeugt
+void test_ring_drop_when_full() {
+  static EventRing<ClockEvent, 16> ring;
+  std::atomic<bool> done{false};
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < STRESS_EVENTS; ++i) ring.push(make(i));
+    done.store(true, std::memory_order_release);
+  });
+
+  uint32_t received = 0, bad = 0;
+  int64_t last = -1;
+  ClockEvent ev;
+  for (;;) {
+    const bool finished = done.load(std::memory_order_acquire);
+    while (ring.pop(ev)) {
+      if ((int64_t)ev.time <= last || ev.data != check(ev)) ++bad;
+      last = ev.time;
+      ++received;
+    }
+    if (finished) break;
+    std::this_thread::yield();
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, bad);
+  TEST_ASSERT_EQUAL_UINT32(STRESS_EVENTS, received + ring.dropped());
+}
+
+// SNTP setzt die Zeit in einem anderen Thread, die Hauptschleife leert den Ring
+void test_drain_time_synced_from_other_thread() {
+  driftInit(hostNoTemp);
+  clockEventsInit();
+  ClockState st;
+  st.lastDisplayedMinute = 12;
+
+  std::thread net([] {
+    struct timeval tv = {1760000000, 0};
+    sntp_sync_time(&tv);
+  });
+  net.join();
+
+  clockEventsDrain(st);
+  TEST_ASSERT_EQUAL(-1, st.lastDisplayedMinute);
+  TEST_ASSERT_EQUAL_UINT32(0, netEvents.size());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_lossless_in_order);
+  RUN_TEST(test_ring_drop_when_full);
+  RUN_TEST(test_drain_time_synced_from_other_thread);
+  return UNITY_END();
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_main.cpp
+ * @brief Zifferblätter: Leuchtfläche über den Tag und Auswahl nach CLOCK_EMISSION_BUDGET
+ *
+ * Die Übersicht zeichnet alle 1440 Minutenbilder je Zifferblatt und gibt Pixel
+ * min/mittel/max und die Tagessumme aus (Anhaltswert für das Budget). Die
+ * Auswahl läuft über einen ganzen Tag mit renderTime() gegen das SH1106-Modell,
+ * einmal neu gezeichnet und einmal mit clockPrepareNext() vorbereitet.
+ *
+ * Das Budget ist eine Compile-Option: pio test -e native läuft ohne Budget,
+ * pio test -e native_budget mit -DCLOCK_EMISSION_BUDGET aus platformio.ini.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "clock_core.h"
+#include "host.h"
+
+struct FaceSurvey {
+  uint16_t lo, hi;
+  uint32_t sum, day;   // Pixelminuten über 24 h und zwischen sleepEnd und sleepStart
+};
+
+static u8g2_t oled, ref;
+static FaceSurvey survey[FACE_COUNT];
+
+static struct tm at(int minute) {
+  struct tm t = {};
+  t.tm_year = 126;
+  t.tm_yday = 289;
+  t.tm_hour = minute / 60;
+  t.tm_min = minute % 60;
+  return t;
+}
+
+static uint16_t litFace(const struct tm& t, uint8_t f) {
+  composeFace(&ref, &t, (ClockFace)f);
+  return clockLitPixels(&ref);
+}
+
+static void takeSurvey() {
+  printf("Zifferblatt   min  mittel   max  Pixelminuten Tag (%d-%d Uhr)\n", clockSchedule.sleepEnd,
+         clockSchedule.sleepStart);
+  for (uint8_t f = 0; f < FACE_COUNT; ++f) {
+    FaceSurvey& s = survey[f];
+    s = {0xFFFF, 0, 0, 0};
+    for (int m = 0; m < 24 * 60; ++m) {
+      const struct tm t = at(m);
+      const uint16_t n = litFace(t, f);
+      s.sum += n;
+      if (!clockIsNight(t)) s.day += n;
+      if (n < s.lo) s.lo = n;
+      if (n > s.hi) s.hi = n;
+    }
+    printf("%-11s %5u %7lu %5u %13lu\n", clockFaceName(f), s.lo, (unsigned long)(s.sum / (24 * 60)), s.hi,
+           (unsigned long)s.day);
+  }
+}
+
+static bool nightEdge(const struct tm& t) {
+  return t.tm_hour == clockSchedule.sleepEnd || t.tm_hour == (clockSchedule.sleepStart + 23) % 24;
+}
+
+struct DayResult {
+  uint32_t lit;
+  uint16_t minutes[FACE_COUNT];
+  uint16_t forcedSmall;   // außerhalb der Randstunden, weil nichts anderes ins Budget passte
+};
+
+// ein Tag von sleepEnd bis sleepStart mit renderTime(); jede Minute gegen die
+// Regel: das hellste Zifferblatt mit höchstens (Budget − bisher) / restliche
+// Minuten Pixeln, sonst und in den Randstunden „klein“
+static DayResult runDay(bool prepared) {
+  hostSh1106Display(&oled, OLED_ROTATION, OLED_FLIP);
+  ClockState st;
+  DayResult r = {};
+  const uint32_t budget = CLOCK_EMISSION_BUDGET;
+  for (int m = clockSchedule.sleepEnd * 60; m < clockSchedule.sleepStart * 60; ++m) {
+    const struct tm t = at(m);
+    uint16_t lit[FACE_COUNT];
+    for (uint8_t f = 0; f < FACE_COUNT; ++f) lit[f] = litFace(t, f);
+
+    uint8_t want = FACE_BOLD;
+    if (budget && nightEdge(t)) {
+      want = FACE_SMALL;
+    } else if (budget) {
+      const int left = clockSchedule.sleepStart * 60 - m;
+      const uint32_t perMinute = st.litToday < budget ? (budget - st.litToday) / left : 0;
+      want = FACE_BOLD;
+      while (want < FACE_SMALL && lit[want] > perMinute) ++want;
+      if (want == FACE_SMALL) ++r.forcedSmall;
+    }
+
+    const uint32_t before = st.litToday;
+    renderTime(&oled, st, &t);
+    char msg[48];
+    snprintf(msg, sizeof(msg), "%02d:%02d %s", t.tm_hour, t.tm_min, prepared ? "vorbereitet" : "neu");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(want, clockFace(), msg);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(before + lit[want], st.litToday, msg);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(lit[want], clockLitPixels(&oled), msg);
+    if (budget && want != FACE_SMALL) TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(budget, st.litToday, msg);
+    ++r.minutes[want];
+    if (prepared) clockPrepareNext(&oled, st, t);
+  }
+  r.lit = st.litToday;
+  return r;
+}
+
+void setUp() {
+  hostPowerOn();
+  clockSchedule = ClockSchedule();
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(&ref, U8G2_R0, hostSh1106ByteCb, hostSh1106GpioCb);
+  if (survey[0].hi == 0) takeSurvey();
+}
+
+void tearDown() {
+}
+
+// jedes Zifferblatt leuchtet in jeder Minute; fett, dünn und Umriss nehmen in
+// dieser Reihenfolge ab (so probiert selectFace() sie durch), klein liegt unter fett
+void test_faces_survey_totals() {
+  for (uint8_t f = 0; f < FACE_COUNT; ++f) {
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, survey[f].lo, clockFaceName(f));
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(128 * CLOCK_FACE_PAGES * 8, survey[f].hi, clockFaceName(f));
+    TEST_ASSERT_GREATER_THAN_MESSAGE(survey[f].day, survey[f].sum, clockFaceName(f));
+  }
+  TEST_ASSERT_GREATER_THAN(survey[FACE_THIN].day, survey[FACE_BOLD].day);
+  TEST_ASSERT_GREATER_THAN(survey[FACE_OUTLINE].day, survey[FACE_THIN].day);
+  TEST_ASSERT_GREATER_THAN(survey[FACE_SMALL].day, survey[FACE_BOLD].day);
+}
+
+// ohne Budget: immer fett, die Tagessumme in ClockState ist die der Übersicht
+void test_faces_without_budget() {
+#if CLOCK_EMISSION_BUDGET
+  TEST_IGNORE_MESSAGE("nur ohne -DCLOCK_EMISSION_BUDGET (pio test -e native)");
+#else
+  const DayResult r = runDay(false);
+  TEST_ASSERT_EQUAL_UINT16((clockSchedule.sleepStart - clockSchedule.sleepEnd) * 60, r.minutes[FACE_BOLD]);
+  TEST_ASSERT_EQUAL_UINT32(survey[FACE_BOLD].day, r.lit);
+#endif
+}
+
+// mit Budget: Auswahl nach der Regel in jeder Minute; ohne erzwungenes „klein“
+// bleibt die Tagessumme im Budget. Vorbereitete Bilder wählen genauso.
+void test_faces_respect_budget() {
+#if CLOCK_EMISSION_BUDGET
+  const DayResult fresh = runDay(false);
+  printf("Budget %lu: %lu Pixelminuten; fett %u, dünn %u, Umriss %u, klein %u min (%u erzwungen)\n",
+         (unsigned long)CLOCK_EMISSION_BUDGET, (unsigned long)fresh.lit, fresh.minutes[FACE_BOLD],
+         fresh.minutes[FACE_THIN], fresh.minutes[FACE_OUTLINE], fresh.minutes[FACE_SMALL], fresh.forcedSmall);
+  TEST_ASSERT_EQUAL_UINT16(2 * 60, fresh.minutes[FACE_SMALL] - fresh.forcedSmall);   // Randstunden
+  if (fresh.forcedSmall == 0) TEST_ASSERT_LESS_OR_EQUAL(CLOCK_EMISSION_BUDGET, fresh.lit);
+
+  const DayResult prepared = runDay(true);
+  TEST_ASSERT_EQUAL_UINT32(fresh.lit, prepared.lit);
+  TEST_ASSERT_EQUAL_MEMORY(fresh.minutes, prepared.minutes, sizeof(fresh.minutes));
+#else
+  TEST_IGNORE_MESSAGE("nur mit -DCLOCK_EMISSION_BUDGET (pio test -e native_budget)");
+#endif
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_faces_survey_totals);
+  RUN_TEST(test_faces_without_budget);
+  RUN_TEST(test_faces_respect_budget);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_main.cpp
+ * @brief Radio-Budget (radio_guard.cpp): hält, wenn das WLAN nie fertig wird; Watchdog bei hängendem Sync
+ *
+ * Latenzen wie in test_sync: Scan 780 ms, Trennen 20 ms, NTP-Abfrage alle 100 ms.
+ */
+#include <string.h>
+#include <unity.h>
+#include "clock_drift.h"
+#include "clock_events.h"
+#include "clock_sync.h"
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+
+static bool hangOnRadioOn;
+static uint32_t watchdogDuringSync;
+
+static void opsStatus(const char*) {}
+
+static void opsCpu(bool) {}
+
+static void opsRadioOn() {
+  watchdogDuringSync = hostWatchdogMs();
+  esp_wifi_set_mode(WIFI_MODE_STA);
+  esp_wifi_start();
+  // Treiber kommt nicht zurück: weder Budget noch Flag können hier etwas tun
+  if (hangOnRadioOn) vTaskDelay(pdMS_TO_TICKS(120000));
+}
+
+static void opsRadioOff(bool) {
+  esp_wifi_disconnect();
+  esp_wifi_stop();
+}
+
+static const SyncOps ops = {&hostWifiOps, opsStatus, opsCpu, opsRadioOn, opsRadioOff, nullptr};
+
+static void boot() {
+  telemetryInit();
+  driftInit(hostNoTemp);
+  radioGuardInit();
+  clockEventsInit();
+}
+
+void setUp() {
+  hostEraseNvs();
+  hostWifiReset();
+  hostPowerOn();
+  boot();
+  hangOnRadioOn = false;
+}
+
+void tearDown() {
+  hostStandinStop();
+}
+
+// drei APs, keiner wird je fertig: Abbruch am Budget, nicht erst nach 3 × 10 s
+void test_budget_holds_when_wifi_never_connects() {
+  hostWifiAdd("Werkstatt", 1, -50, HOST_WIFI_NEVER);
+  hostWifiAdd("Zuhause", 6, -60, HOST_WIFI_NEVER);
+  hostWifiAdd("Gast", 11, -70, HOST_WIFI_NEVER);
+
+  TEST_ASSERT_EQUAL(SYNC_FAILED, clockSyncRun(ops));
+  TEST_ASSERT_EQUAL(RADIO_ON_BUDGET_MS + RADIO_GRACE_MS, watchdogDuringSync);
+  TEST_ASSERT_FALSE(hostWifiRunning());
+  TEST_ASSERT_EQUAL(0, hostWatchdogMs());
+  TEST_ASSERT_EQUAL(3, hostWifiAttempts());
+  // das Warten auf die letzte Trennung (20 ms) liegt hinter der Grenze
+  TEST_ASSERT_GREATER_OR_EQUAL(RADIO_ON_BUDGET_MS, hostWifiRadioOnMs());
+  TEST_ASSERT_LESS_OR_EQUAL(RADIO_ON_BUDGET_MS + 100, hostWifiRadioOnMs());
+  TEST_ASSERT_EQUAL(0, hostWifiTimerContextCalls());
+
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_RADIO_BUDGET, &t));
+  TEST_ASSERT_EQUAL(1, t.flags);
+}
+
+// verbunden, aber NTP antwortet nie: der Timer setzt nur das Flag, die NTP-Schleife
+// bricht spätestens eine Abfrage später ab und schaltet selbst ab
+void test_budget_holds_when_ntp_never_answers() {
+  hostWifiAdd("Zuhause", 6, -55, 2000);
+
+  TEST_ASSERT_EQUAL(SYNC_FAILED, clockSyncRun(ops));
+  TEST_ASSERT_FALSE(hostWifiRunning());
+  TEST_ASSERT_GREATER_OR_EQUAL(RADIO_ON_BUDGET_MS, hostWifiRadioOnMs());
+  TEST_ASSERT_LESS_OR_EQUAL(RADIO_ON_BUDGET_MS + CLOCK_SYNC_POLL_MS, hostWifiRadioOnMs());
+  TEST_ASSERT_EQUAL(0, hostWifiTimerContextCalls());
+
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_SYNC, &t));
+  TEST_ASSERT_EQUAL(0, t.flags);
+  TEST_ASSERT_TRUE(hostLastTele(TELE_RADIO_BUDGET, &t));
+  TEST_ASSERT_EQUAL(1, t.flags);
+}
+
+// Sync-Task hängt: Reset durch den RTC-Watchdog nach Budget + Nachfrist, gemeldet nach dem Neustart
+void test_watchdog_resets_hung_sync() {
+  hostWifiAdd("Zuhause", 6, -55, 600);
+  hangOnRadioOn = true;
+
+  bool restarted = false;
+  try {
+    clockSyncRun(ops);
+  } catch (const HostRestart&) {
+    restarted = true;
+  }
+  TEST_ASSERT_TRUE(restarted);
+  TEST_ASSERT_EQUAL((int64_t)(RADIO_ON_BUDGET_MS + RADIO_GRACE_MS) * 1000, hostNowUs());
+  TEST_ASSERT_TRUE(radioGuardExpired());   // Flag gesetzt, WLAN aber nicht angefasst
+  TEST_ASSERT_EQUAL(0, hostWifiTimerContextCalls());
+
+  hostReset();
+  boot();
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_RADIO_BUDGET, &t));
+  TEST_ASSERT_EQUAL(2, t.flags);
+  TEST_ASSERT_EQUAL((RADIO_ON_BUDGET_MS + RADIO_GRACE_MS) / 1000, t.v[0]);
+
+  // nach einem normalen Neustart keine Meldung mehr
+  const uint16_t n = telemetryCount();
+  hostReset();
+  boot();
+  TEST_ASSERT_EQUAL(n, telemetryCount());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_budget_holds_when_wifi_never_connects);
+  RUN_TEST(test_budget_holds_when_ntp_never_answers);
+  RUN_TEST(test_watchdog_resets_hung_sync);
+  return UNITY_END();
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_main.cpp
+ * @brief Drehung um 180°: U8G2_R2 (je Pixel in u8g2) gegen U8G2_R0 mit Flip im SH1106
+ *
+ * Beide Wege laufen mit der echten u8g2-Initialisierung gegen das Controller-
+ * Modell aus host_sh1106.cpp, verglichen wird das Glas: Segment-Remap,
+ * COM-Scan und der x-Offset von 2 Spalten (132 Spalten RAM, 128 sichtbar).
+ * Erwartet wird auf beiden Wegen dasselbe Bild, und zwar das R0-Bild aus dem
+ * Puffer, um 2 Segmente verschoben.
+ */
+#include <string.h>
+#include <unity.h>
+#include <vector>
+#include "clock_core.h"
+#include "host.h"
+
+static u8g2_t oled, ref;
+
+static struct tm at(int hour, int min) {
+  struct tm t = {};
+  t.tm_year = 126;
+  t.tm_mon = 9;
+  t.tm_mday = 17;
+  t.tm_hour = hour;
+  t.tm_min = min;
+  t.tm_isdst = -1;
+  mktime(&t);
+  return t;
+}
+
+// Glas gleich dem R0-Bild der Uhrzeit im Zifferblatt f: Pixel (x, y) auf SEG x + 2, COM y
+static void assertGlassShowsFace(const HostGlass& g, const struct tm& t, ClockFace f, const char* what) {
+  composeFace(&ref, &t, f);
+  const uint8_t* buf = u8g2_GetBufferPtr(&ref);
+  uint16_t lit = 0;
+  for (int y = 0; y < 64; ++y) {
+    for (int seg = 0; seg < HOST_SH1106_COLUMNS; ++seg) {
+      const int x = seg - 2;
+      const uint8_t want = x >= 0 && x < 128 ? buf[(y >> 3) * 128 + x] >> (y & 7) & 1 : 0;
+      lit += want;
+      if (g[y * HOST_SH1106_COLUMNS + seg] != want) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s %02d:%02d Zifferblatt %d: COM %d, SEG %d", what, t.tm_hour, t.tm_min, f, y, seg);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(0, lit);
+}
+
+static const int times[][2] = {{0, 0}, {1, 11}, {4, 30}, {7, 59}, {10, 8}, {12, 34}, {17, 45}, {20, 0}, {23, 59}};
+
+void setUp() {
+  hostPowerOn();
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(&ref, U8G2_R0, hostSh1106ByteCb, hostSh1106GpioCb);
+}
+
+void tearDown() {
+}
+
+// jedes Zifferblatt, ganzer Puffer mit u8g2_SendBuffer()
+void test_rotation_faces_identical() {
+  for (const auto& hm : times) {
+    const struct tm t = at(hm[0], hm[1]);
+    for (uint8_t f = 0; f < FACE_COUNT; ++f) {
+      hostSh1106Display(&oled, U8G2_R2, 0);
+      composeFace(&oled, &t, (ClockFace)f);
+      u8g2_SendBuffer(&oled);
+      const HostGlass sw = hostSh1106Glass();
+      TEST_ASSERT_TRUE(hostSh1106Scan().segRemap);
+      TEST_ASSERT_TRUE(hostSh1106Scan().comReverse);
+
+      hostSh1106Display(&oled, U8G2_R0, 1);
+      composeFace(&oled, &t, (ClockFace)f);
+      u8g2_SendBuffer(&oled);
+      const HostGlass hw = hostSh1106Glass();
+      TEST_ASSERT_FALSE(hostSh1106Scan().segRemap);
+      TEST_ASSERT_FALSE(hostSh1106Scan().comReverse);
+
+      TEST_ASSERT_TRUE(sw == hw);
+      assertGlassShowsFace(hw, t, (ClockFace)f, "R0 + Flip");
+    }
+  }
+}
+
+// renderTime() über einen Stundenwechsel, ab der zweiten Minute vorbereitet mit
+// clockPrepareNext(): nur die geänderten Seiten gehen hinaus, in R2 liegen sie im
+// Puffer gespiegelt
+void test_rotation_prepared_frames_identical() {
+  std::vector<HostGlass> sw;
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 0) hostSh1106Display(&oled, U8G2_R2, 0);
+    else hostSh1106Display(&oled, U8G2_R0, 1);
+    ClockState st;
+    for (int m = 0; m < 12; ++m) {
+      const struct tm t = at(9, 54 + m);
+      renderTime(&oled, st, &t);
+      const HostGlass g = hostSh1106Glass();
+      if (pass == 0) {
+        sw.push_back(g);
+      } else {
+        TEST_ASSERT_TRUE_MESSAGE(sw[m] == g, "R2 und R0 + Flip verschieden");
+        assertGlassShowsFace(g, t, FACE_BOLD, "renderTime");
+      }
+      clockPrepareNext(&oled, st, t);
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rotation_faces_identical);
+  RUN_TEST(test_rotation_prepared_frames_identical);
+  return UNITY_END();
+}
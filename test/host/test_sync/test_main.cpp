@@ -0,0 +1,206 @@
+/**
+ * @file test_main.cpp
+ * @brief Sync-Ablauf (clock_sync.cpp) gegen simuliertes WLAN und scripts/ntp_standin.py
+ *
+ * Die Zeiten der Erwartungen ergeben sich aus den simulierten Latenzen:
+ * Scan 780 ms, "AP nicht gefunden" nach 800 ms, Trennen 20 ms (host.h), dazu
+ * die Abfrageraster von wifiConnect() (50 ms) und clockSyncRun() (100 ms).
+ * Die NTP-Antwort kommt über UDP vom Ersatzserver und braucht echte Zeit im
+ * Millisekundenbereich.
+ */
+#include <string.h>
+#include <unity.h>
+#include "clock_drift.h"
+#include "clock_events.h"
+#include "clock_sync.h"
+#include "esp_sntp.h"
+#include "esp_wifi.h"
+#include "host.h"
+#include "radio_guard.h"
+#include "telemetry.h"
+
+static const char* lastStatus;
+static char onlineSsid[33];
+static double onlineOffset;     // Systemzeit minus echte Zeit, solange das WLAN noch an ist
+
+static void opsStatus(const char* msg) {
+  lastStatus = msg;
+}
+
+static void opsCpu(bool) {}
+
+static void opsRadioOn() {
+  esp_wifi_set_mode(WIFI_MODE_STA);
+  esp_wifi_start();
+}
+
+static void opsRadioOff(bool) {
+  esp_wifi_disconnect();
+  esp_wifi_stop();
+}
+
+static bool opsOnline() {
+  const HostAp* ap = hostWifiConnected();
+  strcpy(onlineSsid, ap ? ap->ssid : "");
+  onlineOffset = hostWallClock() - hostRealClock();
+  return false;
+}
+
+static const SyncOps ops = {&hostWifiOps, opsStatus, opsCpu, opsRadioOn, opsRadioOff, opsOnline};
+
+// wie setup(): die Module, die ein Sync braucht
+static void boot() {
+  hostPowerOn();
+  telemetryInit();
+  driftInit(hostNoTemp);
+  radioGuardInit();
+  clockEventsInit();
+}
+
+struct SyncRun {
+  uint8_t  result;
+  uint32_t durationMs;
+  uint32_t radioMs;
+};
+
+static SyncRun runSync() {
+  const int64_t t0 = hostNowUs();
+  const uint32_t radio0 = hostWifiRadioOnMs();
+  onlineSsid[0] = '\0';
+  SyncRun r;
+  r.result = clockSyncRun(ops);
+  r.durationMs = (uint32_t)((hostNowUs() - t0) / 1000);
+  r.radioMs = hostWifiRadioOnMs() - radio0;
+  return r;
+}
+
+void setUp() {
+  hostEraseNvs();
+  hostWifiReset();
+  boot();
+  lastStatus = nullptr;
+}
+
+void tearDown() {
+  hostStandinStop();
+}
+
+// Scan, Verbinden, NTP mit 3,5 s Versatz: Zeit übernommen, Radio nur so lange wie nötig an
+void test_sync_sets_offset_time() {
+  HOST_REQUIRE_SCRIPT(hostStandinStart("--offset 3.5"), "ntp_standin.py");
+  hostWifiAdd("Werkstatt", 6, -58, 900);
+
+  SyncRun r = runSync();
+  TEST_ASSERT_EQUAL(SYNC_OK, r.result);
+  TEST_ASSERT_EQUAL_STRING("Werkstatt", onlineSsid);
+  TEST_ASSERT_EQUAL(SNTP_SYNC_STATUS_COMPLETED, sntp_get_sync_status());
+  // Rest des 100-ms-Rasters nach der Antwort läuft virtuell weiter
+  TEST_ASSERT_FLOAT_WITHIN(0.15, 3.55, onlineOffset);
+
+  // Scan 780 + Verbinden 900 + eine Runde NTP (100)
+  TEST_ASSERT_UINT32_WITHIN(20, 1790, r.durationMs);
+  TEST_ASSERT_UINT32_WITHIN(20, 1790, r.radioMs);
+  TEST_ASSERT_FALSE(hostWifiRunning());
+  TEST_ASSERT_EQUAL_STRING("NTP Sync…", lastStatus);
+
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_SYNC, &t));
+  TEST_ASSERT_EQUAL(1, t.flags);
+  TEST_ASSERT_UINT32_WITHIN(1, r.radioMs, t.v[0]);
+  TEST_ASSERT_EQUAL(900, t.v[1]);
+}
+
+// gelernter AP ist weg: nach "nicht gefunden" sofort zum Scan und zum zweiten AP
+void test_sync_falls_back_to_second_ap() {
+  HOST_REQUIRE_SCRIPT(hostStandinStart(""), "ntp_standin.py");
+  hostWifiAdd("Zuhause", 11, -52, 700);
+  TEST_ASSERT_EQUAL(SYNC_OK, runSync().result);
+  TEST_ASSERT_EQUAL_STRING("Zuhause", onlineSsid);
+
+  hostWifiAp("Zuhause")->present = false;
+  hostWifiAdd("Werkstatt", 1, -70, 2000);
+  const uint32_t attempts = hostWifiAttempts();
+
+  SyncRun r = runSync();
+  TEST_ASSERT_EQUAL(SYNC_OK, r.result);
+  TEST_ASSERT_EQUAL_STRING("Werkstatt", onlineSsid);
+  TEST_ASSERT_EQUAL(2, hostWifiAttempts() - attempts);
+  // Zuhause auf Kanal 11: 800 (Treiber gibt auf, kein Warten beim Abbruch), Scan 780, Werkstatt 2000, NTP 100
+  TEST_ASSERT_UINT32_WITHIN(25, 3680, r.radioMs);
+
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_SYNC, &t));
+  TEST_ASSERT_EQUAL(2000, t.v[1]);
+}
+
+// Verbinden dauert länger als WIFI_SCAN_TIMEOUT_MS: Abbruch, kein NTP
+void test_sync_connect_too_slow() {
+  HOST_REQUIRE_SCRIPT(hostStandinStart(""), "ntp_standin.py");
+  hostWifiAdd("Werkstatt", 6, -60, 12000);
+
+  SyncRun r = runSync();
+  TEST_ASSERT_EQUAL(SYNC_FAILED, r.result);
+  TEST_ASSERT_EQUAL_STRING("WLAN Timeout", lastStatus);
+  TEST_ASSERT_FALSE(hostWifiRunning());
+  TEST_ASSERT_EQUAL(0, hostSntpRequests());
+  // Scan, Timeout, Abbruch bis zur Trennung (20)
+  TEST_ASSERT_UINT32_WITHIN(25, 780 + WIFI_SCAN_TIMEOUT_MS + 20, r.radioMs);
+
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_SYNC, &t));
+  TEST_ASSERT_EQUAL(0, t.flags);
+}
+
+// kein AP in Reichweite, danach alle lehnen ab
+void test_sync_all_aps_fail() {
+  SyncRun r = runSync();
+  TEST_ASSERT_EQUAL(SYNC_FAILED, r.result);
+  TEST_ASSERT_UINT32_WITHIN(5, 780, r.radioMs);
+
+  hostWifiAdd("Werkstatt", 1, -50, 1500)->reject = true;
+  hostWifiAdd("Zuhause", 6, -60, 1500)->reject = true;
+  hostWifiAdd("Gast", 11, -70, 1500)->reject = true;
+  r = runSync();
+  TEST_ASSERT_EQUAL(SYNC_FAILED, r.result);
+  TEST_ASSERT_EQUAL_STRING("WLAN Timeout", lastStatus);
+  // Scan, dann je AP 1500 ms bis zur Ablehnung; der Abbruch wartet nicht mehr
+  TEST_ASSERT_UINT32_WITHIN(25, 780 + 3 * 1500, r.radioMs);
+  TEST_ASSERT_FALSE(hostWifiRunning());
+}
+
+// zweiter Sync nimmt die Adressen aus dem Cache, nach dem Einschalten aus dem NVS
+void test_sync_dns_cache() {
+  HOST_REQUIRE_SCRIPT(hostStandinStart("--dns-ttl 86400"), "ntp_standin.py");
+  hostWifiAdd("Zuhause", 6, -55, 600);
+  hostSetWallClock(hostRealClock());
+
+  TEST_ASSERT_EQUAL(SYNC_OK, runSync().result);
+  TelemetryRecord t;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_DNS, &t));
+  TEST_ASSERT_EQUAL(0, t.flags);
+  TEST_ASSERT_EQUAL(1, t.v[2]);
+
+  hostAdvanceMs(3600 * 1000);
+  TEST_ASSERT_EQUAL(SYNC_OK, runSync().result);
+  TEST_ASSERT_TRUE(hostLastTele(TELE_DNS, &t));
+  TEST_ASSERT_EQUAL(1, t.flags);
+  TEST_ASSERT_EQUAL(0, t.v[0]);
+
+  boot();   // RTC-Kopie weg, Uhr unbekannt: Cache aus dem NVS
+  SyncRun r = runSync();
+  TEST_ASSERT_EQUAL(SYNC_OK, r.result);
+  TEST_ASSERT_TRUE(hostLastTele(TELE_DNS, &t));
+  TEST_ASSERT_EQUAL(1, t.flags);
+  // bekannter Kanal, kein Scan: Verbinden 600 + NTP 100
+  TEST_ASSERT_UINT32_WITHIN(20, 700, r.radioMs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sync_sets_offset_time);
+  RUN_TEST(test_sync_falls_back_to_second_ap);
+  RUN_TEST(test_sync_connect_too_slow);
+  RUN_TEST(test_sync_all_aps_fail);
+  RUN_TEST(test_sync_dns_cache);
+  return UNITY_END();
+}
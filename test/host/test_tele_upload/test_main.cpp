@@ -0,0 +1,239 @@
+/**
+ * @file test_main.cpp
+ * @brief Telemetrie-Upload (tele_upload.cpp) per UDP an scripts/tele_collector.py
+ *
+ * Der Sammler entpackt jeden CTU1-Block mit seinem eigenen Decoder und schreibt
+ * ihn als JSON-Zeile (--out); der Test vergleicht Kopf und Einträge daraus mit
+ * dem Telemetrie-Ring. Bestätigt wird mit "ACK1" und der nächsten Nummer;
+ * --drop-ack unterdrückt die ersten Bestätigungen, --delay hält die Antwort
+ * über das Zeitbudget hinaus zurück. Solange teleUpload() auf die Bestätigung
+ * wartet, läuft die virtuelle Uhr mit der echten mit.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "host.h"
+#include "radio_guard.h"
+#include "tele_upload.h"
+#include "telemetry.h"
+
+#define START_TIME 1760000000
+
+static std::string dir, out;
+
+struct Block {
+  std::string mac;
+  uint32_t first, count, uptime, heapFree, heapMin, heapLargest, sleepPermille, reset;
+  bool repeated;
+  std::vector<TelemetryRecord> recs;
+  std::vector<std::string> names;
+};
+
+static bool field(const std::string& line, const char* key, uint32_t* v) {
+  const std::string k = std::string("\"") + key + "\": ";
+  const size_t at = line.find(k);
+  return at != std::string::npos && sscanf(line.c_str() + at + k.size(), "%u", v) == 1;
+}
+
+// eine JSON-Zeile von tele_collector.py --out, ohne allgemeinen JSON-Parser:
+// json.dumps schreibt Schlüssel und Trenner immer gleich
+static bool parseBlock(const std::string& line, Block* b) {
+  char mac[32] = "";
+  const size_t m = line.find("\"mac\": \"");
+  if (m == std::string::npos || sscanf(line.c_str() + m + 8, "%31[^\"]", mac) != 1) return false;
+  b->mac = mac;
+  b->repeated = line.find("\"repeated\": true") != std::string::npos;
+  if (!field(line, "first", &b->first) || !field(line, "count", &b->count) || !field(line, "uptime", &b->uptime) ||
+      !field(line, "heap_free", &b->heapFree) || !field(line, "heap_min", &b->heapMin) ||
+      !field(line, "heap_largest", &b->heapLargest) || !field(line, "light_sleep_permille", &b->sleepPermille) ||
+      !field(line, "reset_reason", &b->reset)) {
+    return false;
+  }
+  for (size_t at = line.find("{\"time\": "); at != std::string::npos; at = line.find("{\"time\": ", at + 1)) {
+    TelemetryRecord r = {};
+    char name[16] = "";
+    unsigned t, flags, v[TELEMETRY_VALUES];
+    if (sscanf(line.c_str() + at, "{\"time\": %u, \"type\": \"%15[^\"]\", \"flags\": %u, \"v\": [%u, %u, %u, %u, %u]}",
+               &t, name, &flags, &v[0], &v[1], &v[2], &v[3], &v[4]) != 8) {
+      return false;
+    }
+    r.time = t;
+    r.flags = (uint8_t)flags;
+    for (int i = 0; i < TELEMETRY_VALUES; ++i) r.v[i] = (uint16_t)v[i];
+    b->recs.push_back(r);
+    b->names.push_back(name);
+  }
+  return b->recs.size() == b->count;
+}
+
+static std::vector<Block> blocks() {
+  std::vector<Block> all;
+  FILE* f = fopen(out.c_str(), "r");
+  if (!f) return all;
+  char line[16384];
+  while (fgets(line, sizeof(line), f)) {
+    Block b;
+    TEST_ASSERT_TRUE_MESSAGE(parseBlock(line, &b), line);
+    all.push_back(b);
+  }
+  fclose(f);
+  return all;
+}
+
+// tele_collector.py mit leerer Ausgabedatei; false ohne python3
+static bool collect(const char* args) {
+  remove(out.c_str());
+  return hostCollectorStart(out.c_str(), args);
+}
+
+// Upload im Sync-Fenster, nachdem schon usedMs des Radio-Budgets verbraucht sind
+static TelemetryRecord upload(bool expectOk, uint32_t usedMs = 1500) {
+  radioGuardStart();
+  hostAdvanceMs(usedMs);
+  const bool ok = teleUpload();
+  radioGuardStop();
+  TEST_ASSERT_EQUAL(expectOk, ok);
+  TelemetryRecord r;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_UPLOAD, &r));
+  TEST_ASSERT_EQUAL_UINT8(ok ? 1 : 0, r.flags & 1);
+  return r;
+}
+
+// Einträge mit allen Wertebereichen: 0 (nicht übertragen), Varint-Grenzen, negativ
+static void addRecords(int n) {
+  static uint16_t k = 0;
+  for (int i = 0; i < n; ++i, ++k) {
+    uint16_t v[TELEMETRY_VALUES] = {k, (uint16_t)(k * 127), 0, (uint16_t)(k & 1 ? 0xFFFF : 128),
+                                    (uint16_t)(int16_t)-k};
+    telemetryAdd((uint8_t)(TELE_BOOT + k % TELE_OTA), (uint8_t)k, v, TELEMETRY_VALUES);
+    hostAdvanceMs(i == 2 ? 90000000 : 1500);   // einmal mehr als ein Tag
+  }
+}
+
+static const char* const typeNames[] = {"none", "boot", "wake/h", "storm", "heap", "radio", "sync",
+                                        "stub", "ulp", "dns", "drift", "upload", "config", "ota"};
+
+// Block gegen den Ring ab Nummer first
+static void assertBlockMatchesRing(const Block& b) {
+  TEST_ASSERT_EQUAL_STRING("24:0a:c4:12:34:56", b.mac.c_str());
+  TEST_ASSERT_EQUAL_UINT32(HOST_HEAP_FREE, b.heapFree);
+  TEST_ASSERT_EQUAL_UINT32(HOST_HEAP_MIN, b.heapMin);
+  TEST_ASSERT_EQUAL_UINT32(HOST_HEAP_LARGEST, b.heapLargest);
+  const uint32_t oldest = telemetrySeq() - telemetryCount();
+  for (uint32_t i = 0; i < b.count; ++i) {
+    TelemetryRecord r;
+    TEST_ASSERT_TRUE(telemetryGet((uint16_t)(b.first + i - oldest), &r));
+    TEST_ASSERT_EQUAL_UINT32(r.time, b.recs[i].time);
+    TEST_ASSERT_EQUAL_STRING(typeNames[r.type], b.names[i].c_str());
+    TEST_ASSERT_EQUAL_UINT8(r.flags, b.recs[i].flags);
+    TEST_ASSERT_EQUAL_MEMORY(r.v, b.recs[i].v, sizeof(r.v));
+  }
+}
+
+void setUp() {
+  hostPowerOn();
+  hostSetWallClock(START_TIME);
+  hostSetSleptUs(0);
+  telemetryInit();
+  radioGuardInit();
+}
+
+void tearDown() {
+  hostCollectorStop();
+}
+
+// drei Uploads: jeder beginnt bei der zuletzt bestätigten Nummer, auch nach einem
+// Neustart; der Sammler entpackt Kopf und Einträge wie gepackt
+void test_upload_ack_sequence() {
+  HOST_REQUIRE_SCRIPT(collect(""), "tele_collector.py");
+  addRecords(5);
+  hostSetSleptUs(esp_timer_get_time() / 4);   // 250 ‰ Light-Sleep
+  TelemetryRecord r = upload(true);
+  TEST_ASSERT_EQUAL_UINT16(5, r.v[2]);
+  TEST_ASSERT_EQUAL_UINT16(0, r.v[3]);   // nichts mehr offen
+
+  addRecords(3);
+  r = upload(true);
+  TEST_ASSERT_EQUAL_UINT16(4, r.v[2]);   // drei neue und der erste Upload-Eintrag
+
+  hostReset();   // Stand im RTC-Speicher
+  telemetryInit();
+  radioGuardInit();
+  addRecords(2);
+  upload(true);
+
+  const std::vector<Block> b = blocks();
+  TEST_ASSERT_EQUAL(3, b.size());
+  TEST_ASSERT_EQUAL_UINT32(0, b[0].first);
+  TEST_ASSERT_EQUAL_UINT32(5, b[0].count);
+  TEST_ASSERT_EQUAL_UINT32(5, b[1].first);
+  TEST_ASSERT_EQUAL_UINT32(4, b[1].count);
+  TEST_ASSERT_EQUAL_UINT32(9, b[2].first);
+  TEST_ASSERT_EQUAL_UINT32(3, b[2].count);
+  for (const Block& k : b) {
+    TEST_ASSERT_FALSE(k.repeated);
+    assertBlockMatchesRing(k);
+  }
+  TEST_ASSERT_UINT32_WITHIN(5, 250, b[0].sleepPermille);
+  TEST_ASSERT_EQUAL_UINT32(ESP_RST_POWERON, b[1].reset);
+  TEST_ASSERT_EQUAL_UINT32(ESP_RST_SW, b[2].reset);
+  TEST_ASSERT_EQUAL_UINT32(4, b[2].uptime);   // Laufzeit ab dem Neustart, 4,5 s
+}
+
+// Bestätigung verloren: der Sammler hat den Block, die Uhr wartet bis zum Ende
+// des Budgets und sendet beim nächsten Mal dieselben Nummern noch einmal
+void test_upload_resend_after_lost_ack() {
+  HOST_REQUIRE_SCRIPT(collect("--drop-ack 1"), "tele_collector.py");
+  addRecords(4);
+  TelemetryRecord r = upload(false);
+  TEST_ASSERT_EQUAL_UINT8(2, r.flags);   // Zeitbudget erschöpft
+  TEST_ASSERT_UINT32_WITHIN(60, TELE_UPLOAD_BUDGET_MS, r.v[0]);
+  TEST_ASSERT_EQUAL_UINT16(4, r.v[2]);
+  TEST_ASSERT_EQUAL_UINT16(4, r.v[3]);   // weiter offen
+
+  r = upload(true);
+  TEST_ASSERT_EQUAL_UINT16(5, r.v[2]);
+
+  const std::vector<Block> b = blocks();
+  TEST_ASSERT_EQUAL(2, b.size());
+  TEST_ASSERT_EQUAL_UINT32(0, b[0].first);
+  TEST_ASSERT_EQUAL_UINT32(0, b[1].first);
+  TEST_ASSERT_TRUE(b[1].repeated);
+  TEST_ASSERT_EQUAL_UINT32(5, b[1].count);   // dazu der Eintrag des gescheiterten Uploads
+  assertBlockMatchesRing(b[1]);
+}
+
+// Rest des Radio-Budgets kleiner als TELE_UPLOAD_BUDGET_MS: Abbruch dort; ohne Rest
+// wird gar nicht erst gesendet
+void test_upload_budget_cutoff() {
+  HOST_REQUIRE_SCRIPT(collect("--delay 0.5"), "tele_collector.py");
+  addRecords(2);
+  TelemetryRecord r = upload(false, RADIO_ON_BUDGET_MS - 80);
+  TEST_ASSERT_EQUAL_UINT8(2, r.flags);
+  TEST_ASSERT_LESS_OR_EQUAL(80 + 20, r.v[0]);
+  TEST_ASSERT_GREATER_OR_EQUAL(70, r.v[0]);
+
+  r = upload(false, RADIO_ON_BUDGET_MS + 10);
+  TEST_ASSERT_EQUAL_UINT8(2, r.flags);
+  TEST_ASSERT_EQUAL_UINT16(0, r.v[0]);
+}
+
+int main() {
+  char tmpl[] = "/tmp/tele_upload_XXXXXX";
+  if (!mkdtemp(tmpl)) return 1;
+  dir = tmpl;
+  out = dir + "/tele.jsonl";
+  UNITY_BEGIN();
+  RUN_TEST(test_upload_ack_sequence);
+  RUN_TEST(test_upload_resend_after_lost_ack);
+  RUN_TEST(test_upload_budget_cutoff);
+  const int rc = UNITY_END();
+  remove(out.c_str());
+  rmdir(dir.c_str());
+  return rc;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file test_main.cpp
+ * @brief ULP-Uhr (-DCLOCK_ULP): das Programm aus ulpLoadProgram() im Interpreter
+ *        von host_ulp.cpp, das Display als I2C-Slave am SH1106-Modell
+ *
+ * Der Hauptprozessor zeichnet wie in loop() mit renderTime() und geht mit
+ * ulpClockSleep() schlafen, danach laufen nur noch ULP-Läufe im Sekundentakt.
+ * Nach jedem Lauf, der Bilddaten geschrieben hat, muss das RAM des Controllers
+ * genau das u8g2-Bild der dann gültigen Minute enthalten (Spalte x auf Spalte
+ * x + x-Offset), und zwar für jede Minute einer Stunde. Geweckt wird zur vollen
+ * Stunde, zur Sync-Minute und nach einem NACK; die Bilanz geht als TELE_ULP ins
+ * Telemetrie-Protokoll.
+ *
+ * Nur im Env native_ulp (pio test -e native_ulp), sonst IGNORE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+#include "clock_core.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "host.h"
+#include "sdkconfig.h"
+#include "telemetry.h"
+#include "ulp_clock.h"
+
+#ifdef CLOCK_ULP
+
+#define DAY_START 1792188000.0   // 2026-10-17 00:00 Uhr MESZ
+
+struct Frame {
+  double  wall;
+  uint8_t ram[HOST_SH1106_PAGES][HOST_SH1106_COLUMNS];
+};
+
+struct Watch {
+  std::vector<Frame> frames;   // nach jedem Lauf mit Bilddaten
+  uint32_t runs, wakes;
+  double   lastWall;
+  double   nackFrom;           // ab dieser Systemzeit antwortet das Display nicht, 0 = nie
+};
+
+static u8g2_t oled, ref;
+static Watch watch;
+
+static void onRun(const HostUlpRun& run, void* arg) {
+  Watch& w = *(Watch*)arg;
+  ++w.runs;
+  w.lastWall = run.wall;
+  if (run.wake) ++w.wakes;
+  if (run.dataBytes) {
+    Frame f;
+    f.wall = run.wall;
+    for (uint8_t p = 0; p < HOST_SH1106_PAGES; ++p) memcpy(f.ram[p], hostSh1106Page(p), HOST_SH1106_COLUMNS);
+    w.frames.push_back(f);
+  }
+  if (w.nackFrom && run.wall >= w.nackFrom) hostI2cDisplayNack(true);
+}
+
+static struct tm localAt(double wall) {
+  const time_t t = (time_t)wall;
+  struct tm lt;
+  localtime_r(&t, &lt);
+  return lt;
+}
+
+// RAM gleich dem u8g2-Bild von hh:mm (Spalte x auf x + x-Offset)?
+static bool ramShows(const uint8_t ram[][HOST_SH1106_COLUMNS], int hour, int min, char* why, size_t len) {
+  struct tm t = localAt(DAY_START);
+  t.tm_hour = hour;
+  t.tm_min = min;
+  composeTime(&ref, &t);
+  const uint8_t* buf = u8g2_GetBufferPtr(&ref);
+  const uint8_t xOffset = u8g2_GetU8x8(&oled)->x_offset;
+  for (int p = 0; p < 8; ++p) {
+    for (int x = 0; x < 128; ++x) {
+      if (ram[p][x + xOffset] != buf[p * 128 + x]) {
+        snprintf(why, len, "%02d:%02d: Seite %d, Spalte %d: 0x%02X statt 0x%02X", hour, min, p, x + xOffset,
+                 ram[p][x + xOffset], buf[p * 128 + x]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void assertDisplayShows(int hour, int min) {
+  uint8_t ram[HOST_SH1106_PAGES][HOST_SH1106_COLUMNS];
+  for (uint8_t p = 0; p < HOST_SH1106_PAGES; ++p) memcpy(ram[p], hostSh1106Page(p), HOST_SH1106_COLUMNS);
+  char why[96];
+  TEST_ASSERT_TRUE_MESSAGE(ramShows(ram, hour, min, why, sizeof(why)), why);
+}
+
+// wie loop() im Env _ulp: Uhrzeit zeichnen, ULP starten, Tiefschlaf
+static void drawAndSleep(ClockState& st, double wall) {
+  hostSetWallClock(wall);
+  const struct tm shown = localAt(wall);
+  renderTime(&oled, st, &shown);
+  watch = Watch();
+  bool slept = false;
+  try {
+    ulpClockSleep(&oled, st, shown, true);
+  } catch (const HostDeepSleep&) {
+    slept = true;
+  }
+  TEST_ASSERT_TRUE(slept);
+  TEST_ASSERT_TRUE_MESSAGE(hostUlpTimerOn(), "ULP läuft nicht");
+}
+
+// Minutenbilder ab hh:(min0+1) bis vor die Weckminute: jedes im RAM wie von
+// u8g2, gesendet höchstens maxLateMs nach bzw. maxEarlyMs vor dem Minutenwechsel
+static void checkFrames(int hour, int min0, int wakeMin, double maxEarlyMs, double maxLateMs) {
+  TEST_ASSERT_NULL(hostUlpFault());
+  TEST_ASSERT_EQUAL_UINT32(wakeMin - min0 - 1, watch.frames.size());
+  double early = 0, late = 0;
+  for (size_t i = 0; i < watch.frames.size(); ++i) {
+    const Frame& f = watch.frames[i];
+    const int min = min0 + 1 + (int)i;
+    char why[96];
+    TEST_ASSERT_TRUE_MESSAGE(ramShows(f.ram, hour, min, why, sizeof(why)), why);
+    struct tm t = localAt(DAY_START);
+    t.tm_hour = hour;
+    t.tm_min = min;
+    t.tm_sec = 0;
+    const double dueMs = (f.wall - (double)mktime(&t)) * 1000;
+    if (-dueMs > early) early = -dueMs;
+    if (dueMs > late) late = dueMs;
+  }
+  printf("%02d:%02d bis Minute %02d: %u Bilder, bis %.1f ms zu früh, bis %.1f ms zu spät\n", hour, min0, wakeMin,
+         (unsigned)watch.frames.size(), early, late);
+  TEST_ASSERT_TRUE_MESSAGE(early <= maxEarlyMs, "Minutenbild zu früh");
+  TEST_ASSERT_TRUE_MESSAGE(late <= maxLateMs, "Minutenbild zu spät");
+}
+
+// Wecken wie setup() im Env _ulp: ULP anhalten, Display-Pins zurück, Bilanz
+static void resume() {
+  TEST_ASSERT_EQUAL(ESP_RST_DEEPSLEEP, esp_reset_reason());
+  TEST_ASSERT_TRUE(ulpClockResumed());
+  TEST_ASSERT_FALSE(hostUlpTimerOn());
+  ulpClockReport();
+}
+
+void setUp() {
+  hostPowerOn();
+  setenv("TZ", TIMEZONE, 1);
+  tzset();
+  clockSchedule = ClockSchedule();
+  telemetryInit();
+  hostSh1106Display(&oled, OLED_ROTATION, OLED_FLIP);
+  u8g2_Setup_sh1106_i2c_128x64_noname_f(&ref, U8G2_R0, hostSh1106ByteCb, hostSh1106GpioCb);
+  hostUlpOnRun(onRun, &watch);
+}
+
+void tearDown() {
+  hostUlpOnRun(nullptr, nullptr);
+}
+
+// 10:00 bis 11:00 ohne Sync-Minute: 59 Minutenbilder vom ULP, Wecken um 11:00
+// ohne Bild; danach 11:00 bis 12:00 mit der gemessenen Laufzeit als Periode 1
+void test_ulp_draws_every_minute_of_an_hour() {
+  clockSchedule.syncHour = 12;
+  ClockState st;
+  drawAndSleep(st, DAY_START + 10 * 3600 + 37.4);   // mitten in der Sekunde
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(CONFIG_ULP_COPROC_RESERVE_MEM / 4, hostUlpProgramWords());
+
+  TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_ULP, hostDeepSleep());
+  // die ersten Minuten mit der geschätzten Laufzeit von 20 ms
+  checkFrames(10, 0, 60, 250, 250);
+  TEST_ASSERT_EQUAL_UINT32(1, watch.wakes);
+  TEST_ASSERT_DOUBLE_WITHIN(0.25, DAY_START + 11 * 3600, watch.lastWall);
+  assertDisplayShows(10, 59);                      // 11:00 zeichnet der Hauptprozessor
+
+  resume();
+  TelemetryRecord r;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_ULP, &r));
+  TEST_ASSERT_EQUAL_UINT16(59, r.v[0]);
+  TEST_ASSERT_GREATER_THAN_UINT16(0, r.v[1]);
+  TEST_ASSERT_LESS_THAN_UINT16(50000, r.v[1]);
+  TEST_ASSERT_EQUAL_UINT16(0, r.v[2]);
+
+  drawAndSleep(st, DAY_START + 11 * 3600 + 0.3);   // geweckt bis zu 250 ms vor 11:00
+  assertDisplayShows(11, 0);
+  TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_ULP, hostDeepSleep());
+  checkFrames(11, 0, 60, 100, 100);
+  assertDisplayShows(11, 59);
+
+  const HostI2cBus bus = hostI2cBus();
+  TEST_ASSERT_TRUE(bus.scl && bus.sda);
+  TEST_ASSERT_EQUAL_UINT32(bus.starts, bus.stops);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1300, bus.minLowNs);   // 400 kHz: SCL low ≥ 1,3 µs
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(600, bus.minHighNs);   // high ≥ 0,6 µs
+}
+
+// Sync ab 4 Uhr zur Minute 30: der ULP weckt um 10:30 und zeichnet sie nicht
+void test_ulp_wakes_for_sync_minute() {
+  ClockState st;
+  drawAndSleep(st, DAY_START + 10 * 3600 + 4 * 60 + 12.9);
+  TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_ULP, hostDeepSleep());
+  checkFrames(10, 4, 30, 250, 250);
+  TEST_ASSERT_DOUBLE_WITHIN(0.25, DAY_START + 10 * 3600 + 30 * 60, watch.lastWall);
+  assertDisplayShows(10, 29);
+  resume();
+  TelemetryRecord r;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_ULP, &r));
+  TEST_ASSERT_EQUAL_UINT16(25, r.v[0]);
+}
+
+// Display ab 10:17:30 abgezogen: um 10:18 kein ACK auf die Adresse, keine
+// Daten, Stopp auf dem Bus und Wecken; die Bilanz zählt den Fehler
+void test_ulp_nack_wakes_main_cpu() {
+  ClockState st;
+  drawAndSleep(st, DAY_START + 10 * 3600 + 0.2);
+  watch.nackFrom = DAY_START + 10 * 3600 + 17 * 60 + 30;
+  TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_ULP, hostDeepSleep());
+  checkFrames(10, 0, 18, 250, 250);
+  TEST_ASSERT_DOUBLE_WITHIN(0.25, DAY_START + 10 * 3600 + 18 * 60, watch.lastWall);
+  assertDisplayShows(10, 17);
+
+  const HostI2cBus bus = hostI2cBus();
+  TEST_ASSERT_TRUE_MESSAGE(bus.scl && bus.sda, "Bus nach dem NACK nicht freigegeben");
+  TEST_ASSERT_EQUAL_UINT32(bus.starts, bus.stops);
+
+  resume();
+  TelemetryRecord r;
+  TEST_ASSERT_TRUE(hostLastTele(TELE_ULP, &r));
+  TEST_ASSERT_EQUAL_UINT16(17, r.v[0]);
+  TEST_ASSERT_EQUAL_UINT16(1, r.v[2]);
+}
+
+#else
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void ulpOnly() {
+  TEST_IGNORE_MESSAGE("nur mit -DCLOCK_ULP (pio test -e native_ulp)");
+}
+
+void test_ulp_draws_every_minute_of_an_hour() {
+  ulpOnly();
+}
+
+void test_ulp_wakes_for_sync_minute() {
+  ulpOnly();
+}
+
+void test_ulp_nack_wakes_main_cpu() {
+  ulpOnly();
+}
+
+#endif
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ulp_draws_every_minute_of_an_hour);
+  RUN_TEST(test_ulp_wakes_for_sync_minute);
+  RUN_TEST(test_ulp_nack_wakes_main_cpu);
+  return UNITY_END();
+}
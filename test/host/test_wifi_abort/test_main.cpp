@@ -0,0 +1,126 @@
+/**
+ * @file test_main.cpp
+ * @brief Abbruch eines Verbindungsversuchs (wifiAttemptAbort): späte Trennung,
+ *        fehlende Trennung, APs, die zwischen den Syncs kommen und gehen
+ *
+ * Nur wifiConnect() gegen das simulierte WLAN, ohne NTP. Latenzen wie in
+ * test_sync: Scan 780 ms, "AP nicht gefunden" nach 800 ms, Trennen 20 ms,
+ * wenn ein Test nichts anderes einstellt.
+ */
+#include <string.h>
+#include <unity.h>
+#include "esp_wifi.h"
+#include "host.h"
+#include "radio_guard.h"
+#include "wifi_creds.h"
+#include "wifi_tune.h"
+
+// Index von ssid in secrets.h
+static int credIndex(const char* ssid) {
+  for (uint8_t i = 0; i < wifiCredCount(); ++i) {
+    if (strcmp(wifiCred(i).ssid, ssid) == 0) return i;
+  }
+  return -1;
+}
+
+// wie clockSyncRun(), nur bis zur Verbindung
+static int connect(uint32_t* radioMs = nullptr) {
+  const uint32_t radio0 = hostWifiRadioOnMs();
+  radioGuardStart();
+  esp_wifi_set_mode(WIFI_MODE_STA);
+  esp_wifi_start();
+  const int ap = wifiConnect(hostWifiOps);
+  const bool ok = ap >= 0 && hostWifiConnected() != nullptr;
+  esp_wifi_disconnect();
+  esp_wifi_stop();
+  const uint32_t ms = radioGuardStop();
+  wifiTuneEnd(ok, ms);
+  if (radioMs) *radioMs = hostWifiRadioOnMs() - radio0;
+  return ok ? ap : -1;
+}
+
+void setUp() {
+  hostEraseNvs();
+  hostWifiReset();
+  hostPowerOn();
+  radioGuardInit();
+}
+
+void tearDown() {}
+
+// Trennung des abgebrochenen Versuchs kommt erst nach 120 ms, also nach dem
+// Start des nächsten: sie darf diesen nicht als gescheitert markieren
+void test_late_disconnect_does_not_fail_next_attempt() {
+  hostWifiAdd("Zuhause", 6, -50, 12000);   // hängt bis zum Timeout
+  hostWifiAdd("Werkstatt", 1, -65, 1500);
+  hostWifiTiming().disconnectMs = 120;
+
+  uint32_t radioMs;
+  TEST_ASSERT_EQUAL(credIndex("Werkstatt"), connect(&radioMs));
+  TEST_ASSERT_EQUAL(2, hostWifiAttempts());
+  // Scan, Timeout, Warten auf die Trennung (120), Werkstatt
+  TEST_ASSERT_UINT32_WITHIN(30, 780 + WIFI_SCAN_TIMEOUT_MS + 120 + 1500, radioMs);
+}
+
+// Trennungsereignis kommt nie: der Abbruch wartet höchstens WIFI_ABORT_WAIT_MS
+void test_missing_disconnect_is_bounded() {
+  hostWifiAdd("Zuhause", 6, -50, 12000);
+  hostWifiAdd("Werkstatt", 1, -65, 1500);
+  hostWifiTiming().disconnectMs = HOST_WIFI_NEVER;
+
+  uint32_t radioMs;
+  TEST_ASSERT_EQUAL(credIndex("Werkstatt"), connect(&radioMs));
+  TEST_ASSERT_UINT32_WITHIN(30, 780 + WIFI_SCAN_TIMEOUT_MS + WIFI_ABORT_WAIT_MS + 1500, radioMs);
+}
+
+// Treiber meldet "nicht gefunden" selbst: kein disconnect(), kein Warten
+void test_failed_attempt_aborts_without_wait() {
+  hostWifiAdd("Zuhause", 11, -52, 700);
+  TEST_ASSERT_EQUAL(credIndex("Zuhause"), connect());
+
+  hostWifiAp("Zuhause")->present = false;
+  hostWifiAdd("Werkstatt", 1, -70, 2000);
+  uint32_t radioMs;
+  TEST_ASSERT_EQUAL(credIndex("Werkstatt"), connect(&radioMs));
+  // 800 nicht gefunden, Scan 780, Werkstatt 2000
+  TEST_ASSERT_UINT32_WITHIN(20, 800 + 780 + 2000, radioMs);
+}
+
+// AP verschwindet mitten im Versuch: Fehlschlag statt Verbindung, weiter mit
+// dem nächsten AP aus demselben Scan
+void test_ap_disappears_mid_attempt() {
+  HostAp* home = hostWifiAdd("Zuhause", 6, -50, 3000);
+  hostWifiAdd("Gast", 11, -75, 1200);
+  hostAt(1500 * 1000, [](void* ap) { ((HostAp*)ap)->present = false; }, home);
+
+  uint32_t radioMs;
+  TEST_ASSERT_EQUAL(credIndex("Gast"), connect(&radioMs));
+  TEST_ASSERT_EQUAL(2, hostWifiAttempts());
+  TEST_ASSERT_EQUAL(0, hostWifiTimerContextCalls());
+  // Scan, Zuhause bis zum Ende der Anmeldung, Gast
+  TEST_ASSERT_UINT32_WITHIN(20, 780 + 3000 + 1200, radioMs);
+}
+
+// AP erscheint zwischen zwei Syncs: der erste scheitert, der zweite findet ihn
+// im Scan und lernt den Kanal für den dritten
+void test_ap_appears_between_syncs() {
+  TEST_ASSERT_EQUAL(-1, connect());
+
+  hostWifiAdd("Gast", 11, -70, 1100);
+  uint32_t radioMs;
+  TEST_ASSERT_EQUAL(credIndex("Gast"), connect(&radioMs));
+  TEST_ASSERT_UINT32_WITHIN(20, 780 + 1100, radioMs);
+
+  TEST_ASSERT_EQUAL(credIndex("Gast"), connect(&radioMs));
+  TEST_ASSERT_UINT32_WITHIN(20, 1100, radioMs);   // bekannter Kanal, kein Scan
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_late_disconnect_does_not_fail_next_attempt);
+  RUN_TEST(test_missing_disconnect_is_bounded);
+  RUN_TEST(test_failed_attempt_aborts_without_wait);
+  RUN_TEST(test_ap_disappears_mid_attempt);
+  RUN_TEST(test_ap_appears_between_syncs);
+  return UNITY_END();
+}